@@ -0,0 +1,13 @@
+10 T = 0 : I = 0 : J = 0 : X = 1 : N = 0
+20 FOR I = 1 TO 20000
+30 FOR J = 1 TO 50
+40 GOSUB 100
+50 NEXT J
+60 IF I = 10000 THEN X = 0.5
+70 NEXT I
+80 PRINT T
+85 PRINT N
+90 END
+100 T = T + I - J + X
+110 IF T > 5000 THEN T = T - 4999 : N = N + 1
+120 RETURN
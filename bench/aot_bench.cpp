@@ -0,0 +1,97 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Runs the programs in bench/aot translated to C++ by daw_basic_aot and
+// compares what they print with RUN of the compiled program, then times both.
+// Fails when any output differs
+
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "bench_run.h"
+#include "dawbasic.h"
+
+// Made by daw_basic_aot --function when this is built
+int run_integer_for( );
+int run_real_goto( );
+int run_array( );
+int run_gosub( );
+
+namespace {
+	using daw::basic::bench::capture;
+	using daw::basic::bench::fastest;
+	using daw::basic::bench::run;
+
+	int const repeats = 5;
+
+	struct Program {
+		char const *name;
+		int ( *translated )( );
+	};
+
+	// The lines of the program daw_basic_aot translated
+	std::vector<std::string> lines( std::string const &name ) {
+		std::ifstream file( std::string( DAW_BASIC_AOT_PROGRAMS ) + "/" + name + ".bas" );
+		std::vector<std::string> result;
+		for( std::string line; std::getline( file, line ); ) {
+			result.push_back( line );
+		}
+		return result;
+	}
+} // namespace
+
+int main( ) {
+	std::vector<Program> const programs = {
+	  {"integer_for", &run_integer_for}, {"real_goto", &run_real_goto}, {"array", &run_array}, {"gosub", &run_gosub}};
+
+	bool failed = false;
+	std::cout << std::setw( 14 ) << "" << std::setw( 10 ) << "result" << std::setw( 13 ) << "compiled ms"
+	          << std::setw( 13 ) << "native ms" << '\n';
+	for( auto const &program : programs ) {
+		std::string expected;
+		std::string actual;
+		auto const program_lines = lines( program.name );
+		auto const compiled = fastest( repeats, [&]( ) {
+			auto const result = run( program_lines );
+			expected = result.printed;
+			return result.milliseconds;
+		} );
+		// Loading and compiling the program again is part of running a translation
+		auto const native = fastest( repeats, [&]( ) {
+			auto const result = capture( program.translated );
+			actual = result.printed;
+			return result.milliseconds;
+		} );
+		auto const same = expected == actual;
+		std::cout << std::setw( 14 ) << program.name << std::setw( 10 ) << ( same ? "same" : "DIFFERS" ) << std::fixed
+		          << std::setprecision( 2 ) << std::setw( 13 ) << compiled << std::setw( 13 ) << native << '\n';
+		if( !same ) {
+			std::cout << "expected:\n" << expected << "actual:\n" << actual;
+		}
+		failed |= !same;
+	}
+	return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,98 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Measures the cost of one arithmetic operator for each pairing of operand
+// types.  Integer with integer and real with real take the typed fast paths,
+// mixed pairings go through the type lattice and overflow promotes to real.
+// The kernels are called directly so nothing else is in the time
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+
+#include "bench_timing.h"
+#include "dawbasic.h"
+
+namespace {
+	using daw::basic::BasicValue;
+	using daw::basic::Operator;
+	using daw::basic::ValueType;
+	using daw::basic::bench::fastest;
+	using daw::basic::bench::milliseconds;
+	using daw::basic::integer;
+	using daw::basic::real;
+
+	int const iterations = 10000000;
+	int const repeats = 5;
+
+	// Results are counted so the calls cannot be left out
+	size_t real_results = 0;
+
+	// Nanoseconds for each application of oper
+	double time_operator( Operator oper, BasicValue const &lhs, BasicValue const &rhs ) {
+		auto const elapsed = fastest( repeats, [&]( ) {
+			return milliseconds( [&]( ) {
+				for( int n = 0; n < iterations; ++n ) {
+					real_results += ValueType::REAL == daw::basic::evaluate_operator( oper, lhs, rhs ).type( ) ? 1 : 0;
+				}
+			} );
+		} );
+		return elapsed * 1000000.0 / static_cast<double>( iterations );
+	}
+
+	struct Pairing {
+		char const *title;
+		BasicValue lhs;
+		BasicValue rhs;
+	};
+
+	struct Oper {
+		char const *title;
+		Operator oper;
+	};
+} // namespace
+
+int main( ) {
+	Pairing const pairings[] = {{"integer integer", BasicValue( integer{7} ), BasicValue( integer{3} )},
+	                            {"real real", BasicValue( real{7.5} ), BasicValue( real{3.25} )},
+	                            {"integer real", BasicValue( integer{7} ), BasicValue( real{3.25} )},
+	                            {"real integer", BasicValue( real{7.5} ), BasicValue( integer{3} )},
+	                            {"overflow", BasicValue( integer{2000000000} ), BasicValue( integer{2000000000} )}};
+	Oper const operators[] = {
+	  {"+", Operator::ADD}, {"-", Operator::SUBTRACT}, {"*", Operator::MULTIPLY}, {"/", Operator::DIVIDE}};
+
+	std::cout << "ns per operator\n";
+	std::cout << std::setw( 18 ) << "";
+	for( auto const &oper : operators ) {
+		std::cout << std::setw( 8 ) << oper.title;
+	}
+	std::cout << '\n';
+	for( auto const &pairing : pairings ) {
+		std::cout << std::setw( 18 ) << pairing.title;
+		for( auto const &oper : operators ) {
+			std::cout << std::setw( 8 ) << std::fixed << std::setprecision( 1 )
+			          << time_operator( oper.oper, pairing.lhs, pairing.rhs );
+		}
+		std::cout << '\n';
+	}
+	return 0 < real_results ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,117 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Measures reading and writing elements of a matrix and of a vector indexed
+// by the counter of a FOR loop, with the allocations each element access
+// makes.  The accesses are counted from the difference between a short and
+// a long run so that compiling the program is not counted
+
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include "bench_allocations.h"
+#include "bench_run.h"
+#include "dawbasic.h"
+
+namespace {
+	using daw::basic::Basic;
+	using daw::basic::bench::allocations;
+	using daw::basic::bench::load;
+
+	struct Run {
+		std::string printed;
+		double milliseconds;
+		size_t allocations;
+	};
+
+	Run run( std::vector<std::string> const &lines, bool optimize ) {
+		Basic basic;
+		basic.set_optimize( optimize );
+		load( basic, lines );
+		auto const allocations_before = allocations( );
+		auto const result = daw::basic::bench::run( basic );
+		return Run{result.printed, result.milliseconds, allocations( ) - allocations_before};
+	}
+
+	// Writes then sums a size x size matrix, 2 * size * size accesses
+	std::vector<std::string> matrix( int size ) {
+		auto const last = std::to_string( size - 1 );
+		return {"10 DIM A(" + std::to_string( size ) + ", " + std::to_string( size ) + ")",
+		        "20 FOR I = 0 TO " + last,
+		        "30 FOR J = 0 TO " + last,
+		        "40 A(I, J) = I - J",
+		        "50 NEXT J",
+		        "60 NEXT I",
+		        "70 S = 0",
+		        "80 FOR I = 0 TO " + last,
+		        "90 FOR J = 0 TO " + last,
+		        "100 S = S + A(I, J)",
+		        "110 NEXT J",
+		        "120 NEXT I",
+		        "130 PRINT S"};
+	}
+
+	// Writes then sums a vector of size elements size times, 2 * size * size accesses
+	std::vector<std::string> vector( int size ) {
+		auto const last = std::to_string( size - 1 );
+		return {"10 DIM A(" + std::to_string( size ) + ")",
+		        "20 S = 0",
+		        "30 FOR K = 1 TO " + std::to_string( size ),
+		        "40 FOR I = 0 TO " + last,
+		        "50 A(I) = I + K",
+		        "60 NEXT I",
+		        "70 FOR I = 0 TO " + last,
+		        "80 S = S + A(I)",
+		        "90 NEXT I",
+		        "100 NEXT K",
+		        "110 PRINT S"};
+	}
+
+	bool bench( std::string const &name, std::vector<std::string> ( *program )( int ) ) {
+		int const small = 10;
+		int const large = 400;
+		auto const accesses = 2.0 * ( large * large - small * small );
+		std::string printed;
+		auto same = true;
+		for( auto const optimize : {false, true} ) {
+			auto const before = run( program( small ), optimize );
+			auto const after = run( program( large ), optimize );
+			std::cout << std::setw( 8 ) << name << std::setw( 10 ) << ( optimize ? "optimize" : "" ) << std::fixed
+			          << std::setprecision( 2 ) << std::setw( 10 ) << after.milliseconds << " ms" << std::setw( 10 )
+			          << static_cast<double>( after.allocations - before.allocations ) / accesses
+			          << " allocations/access\n";
+			same = same && ( printed.empty( ) || printed == after.printed );
+			printed = after.printed;
+		}
+		if( !same ) {
+			std::cout << name << " printed different results when optimizing\n";
+		}
+		return same;
+	}
+} // namespace
+
+int main( ) {
+	auto const matrix_same = bench( "A(I, J)", matrix );
+	auto const vector_same = bench( "A(I)", vector );
+	return matrix_same && vector_same ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,67 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstdlib>
+#include <new>
+
+// Replaces the global allocation functions so that a bench can count the
+// allocations and bytes allocated while a program runs.  Only one file of a program may
+// include this header
+
+namespace daw {
+	namespace basic {
+		namespace bench {
+			//////////////////////////////////////////////////////////////////////////
+			/// Summary: The number of times operator new has been called so far
+			inline size_t &allocations( ) noexcept {
+				static size_t count = 0;
+				return count;
+			}
+
+			//////////////////////////////////////////////////////////////////////////
+			/// Summary: The bytes asked of operator new so far
+			inline size_t &allocated_bytes( ) noexcept {
+				static size_t bytes = 0;
+				return bytes;
+			}
+		} // namespace bench
+	}   // namespace basic
+} // namespace daw
+
+void *operator new( size_t size ) {
+	++daw::basic::bench::allocations( );
+	daw::basic::bench::allocated_bytes( ) += size;
+	if( auto result = std::malloc( size ) ) {
+		return result;
+	}
+	throw std::bad_alloc{};
+}
+
+void operator delete( void *ptr ) noexcept {
+	std::free( ptr );
+}
+
+void operator delete( void *ptr, size_t ) noexcept {
+	std::free( ptr );
+}
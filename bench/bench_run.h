@@ -0,0 +1,88 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "bench_timing.h"
+#include "dawbasic.h"
+
+namespace daw {
+	namespace basic {
+		namespace bench {
+			//////////////////////////////////////////////////////////////////////////
+			/// Summary: What an action printed to std::cout and std::cerr, without
+			/// the READY lines of interactive use, and the milliseconds it took
+			struct Captured {
+				std::string printed;
+				double milliseconds;
+			};
+
+			//////////////////////////////////////////////////////////////////////////
+			/// Summary: Times action with std::cout and std::cerr sent to a string
+			template<typename Action>
+			Captured capture( Action action ) {
+				std::ostringstream output;
+				auto const out = std::cout.rdbuf( output.rdbuf( ) );
+				auto const err = std::cerr.rdbuf( output.rdbuf( ) );
+				auto const elapsed = bench::milliseconds( action );
+				std::cout.rdbuf( out );
+				std::cerr.rdbuf( err );
+
+				std::istringstream lines( output.str( ) );
+				Captured result{"", elapsed};
+				for( std::string line; std::getline( lines, line ); ) {
+					if( !line.empty( ) && "READY" != line ) {
+						result.printed += line + '\n';
+					}
+				}
+				return result;
+			}
+
+			//////////////////////////////////////////////////////////////////////////
+			/// Summary: Enters lines into basic
+			inline void load( Basic &basic, std::vector<std::string> const &lines ) {
+				for( auto const &line : lines ) {
+					basic.parse_line( line, false );
+				}
+			}
+
+			//////////////////////////////////////////////////////////////////////////
+			/// Summary: Captures RUN of the program entered into basic
+			inline Captured run( Basic &basic ) {
+				return capture( [&basic]( ) { basic.parse_line( "RUN", false ); } );
+			}
+
+			//////////////////////////////////////////////////////////////////////////
+			/// Summary: Captures RUN of lines in a new Basic
+			inline Captured run( std::vector<std::string> const &lines ) {
+				Basic basic;
+				load( basic, lines );
+				return run( basic );
+			}
+		} // namespace bench
+	}   // namespace basic
+} // namespace daw
@@ -0,0 +1,54 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+
+namespace daw {
+	namespace basic {
+		namespace bench {
+			//////////////////////////////////////////////////////////////////////////
+			/// Summary: Milliseconds taken by action
+			template<typename Action>
+			double milliseconds( Action action ) {
+				auto const start = std::chrono::steady_clock::now( );
+				action( );
+				auto const finish = std::chrono::steady_clock::now( );
+				return std::chrono::duration<double, std::milli>( finish - start ).count( );
+			}
+
+			//////////////////////////////////////////////////////////////////////////
+			/// Summary: The smallest time returned by repeats calls of run.  The
+			/// fastest run is the one least disturbed by the rest of the machine
+			template<typename Run>
+			double fastest( int repeats, Run run ) {
+				auto result = run( );
+				for( int n = 1; n < repeats; ++n ) {
+					result = std::min( result, run( ) );
+				}
+				return result;
+			}
+		} // namespace bench
+	}   // namespace basic
+} // namespace daw
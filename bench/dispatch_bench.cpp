@@ -0,0 +1,175 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Measures the cost of dispatching a statement to its keyword handler.  The
+// previous dispatch looked the keyword name up in an unordered_map of
+// std::function.  Built in keywords are now resolved once by the perfect hash
+// in basic_keywords.h and dispatched with a switch to member functions
+
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "basic_keywords.h"
+#include "bench_timing.h"
+#include "dawbasic.h"
+
+namespace {
+	using daw::basic::Keyword;
+	using daw::basic::bench::milliseconds;
+	namespace keywords = daw::basic::keywords;
+
+	size_t const iterations = 20000000;
+
+	template<typename Function>
+	double nanoseconds_per_iteration( Function func ) {
+		return milliseconds( func ) * 1000000.0 / static_cast<double>( iterations );
+	}
+
+	struct Handlers {
+		uint64_t count = 0;
+
+		bool handle( size_t n ) {
+			count += n;
+			return true;
+		}
+
+		// Same shape as Basic::execute_keyword
+		bool execute( Keyword keyword ) {
+			switch( keyword ) {
+			case Keyword::CLR:
+			case Keyword::CONT:
+			case Keyword::DELETE:
+			case Keyword::DIM:
+			case Keyword::END:
+			case Keyword::EXIT:
+			case Keyword::FOR:
+			case Keyword::FUNCTIONS:
+			case Keyword::GOSUB:
+			case Keyword::GOTO:
+			case Keyword::IF:
+			case Keyword::KEYWORDS:
+				return handle( static_cast<size_t>( keyword ) );
+			case Keyword::LET:
+			case Keyword::LIST:
+			case Keyword::MAT:
+			case Keyword::NEW:
+			case Keyword::NEXT:
+			case Keyword::PRINT:
+			case Keyword::QUIT:
+			case Keyword::REM:
+			case Keyword::RETURN:
+			case Keyword::RUN:
+			case Keyword::SORT:
+			case Keyword::STEP:
+			case Keyword::STOP:
+			case Keyword::THEN:
+			case Keyword::TO:
+			case Keyword::VARS:
+				return handle( static_cast<size_t>( keyword ) + 1 );
+			}
+			return false;
+		}
+	};
+
+	void bench_dispatch( ) {
+		std::vector<std::string> names( std::begin( keywords::names ), std::end( keywords::names ) );
+
+		Handlers map_handlers;
+		std::unordered_map<std::string, std::function<bool( size_t )>> map;
+		for( size_t n = 0; n < names.size( ); ++n ) {
+			map[names[n]] = [&map_handlers]( size_t value ) { return map_handlers.handle( value ); };
+		}
+		auto const by_map = nanoseconds_per_iteration( [&]( ) {
+			for( size_t n = 0; n < iterations; ++n ) {
+				map[names[n % names.size( )]]( n % names.size( ) );
+			}
+		} );
+
+		Handlers switch_handlers;
+		std::vector<Keyword> crunched;
+		for( auto const &name : names ) {
+			Keyword keyword = Keyword::REM;
+			keywords::find( name.data( ), name.size( ), keyword );
+			crunched.push_back( keyword );
+		}
+		auto const by_switch = nanoseconds_per_iteration( [&]( ) {
+			for( size_t n = 0; n < iterations; ++n ) {
+				switch_handlers.execute( crunched[n % crunched.size( )] );
+			}
+		} );
+
+		std::cout << "dispatch unordered_map<std::function>: " << by_map << " ns\n";
+		std::cout << "dispatch switch on Keyword:            " << by_switch << " ns\n";
+		std::cout << "(checksums " << map_handlers.count << " " << switch_handlers.count << ")\n";
+	}
+
+	void bench_lookup( ) {
+		std::vector<std::string> names( std::begin( keywords::names ), std::end( keywords::names ) );
+		names.push_back( "COUNTER" ); // Identifiers are looked up too when crunching
+
+		std::unordered_map<std::string, size_t> map;
+		for( size_t n = 0; n < keywords::count; ++n ) {
+			map[keywords::names[n]] = n;
+		}
+		size_t found_map = 0;
+		auto const by_map = nanoseconds_per_iteration( [&]( ) {
+			for( size_t n = 0; n < iterations; ++n ) {
+				found_map += map.count( names[n % names.size( )] );
+			}
+		} );
+
+		size_t found_hash = 0;
+		auto const by_hash = nanoseconds_per_iteration( [&]( ) {
+			for( size_t n = 0; n < iterations; ++n ) {
+				auto const &name = names[n % names.size( )];
+				Keyword keyword = Keyword::REM;
+				found_hash += keywords::find( name.data( ), name.size( ), keyword ) ? 1 : 0;
+			}
+		} );
+
+		std::cout << "lookup unordered_map:  " << by_map << " ns\n";
+		std::cout << "lookup perfect hash:   " << by_hash << " ns\n";
+		std::cout << "(found " << found_map << " " << found_hash << ")\n";
+	}
+
+	void bench_interpreter( ) {
+		// Statements that do nothing but dispatch, run by the interpreter
+		daw::basic::Basic basic;
+		basic.set_execution_mode( daw::basic::ExecutionMode::INTERPRETED );
+		basic.parse_line( "10 I = 0", false );
+		basic.parse_line( "20 I = I + 1 : REM : REM : REM : REM : REM : REM : REM : REM", false );
+		basic.parse_line( "30 IF I < 100000 THEN 20", false );
+		auto const elapsed = milliseconds( [&basic]( ) { basic.parse_line( "RUN", false ); } );
+		std::cout << "interpreter, 100000 lines of 10 statements: " << elapsed << " ms\n";
+	}
+} // namespace
+
+int main( ) {
+	bench_dispatch( );
+	bench_lookup( );
+	bench_interpreter( );
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,101 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Times numeric programs compiled with and without the JIT and reports how
+// often the JIT entered its traces.  That the JIT prints what the interpreter
+// does is checked by the programs in tests/jit
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "bench_run.h"
+#include "dawbasic.h"
+
+namespace {
+	using daw::basic::Basic;
+	using daw::basic::ExecutionMode;
+	using daw::basic::JitStatistics;
+	using daw::basic::bench::fastest;
+	using daw::basic::bench::load;
+	namespace bench = daw::basic::bench;
+
+	int const repeats = 5;
+
+	struct Program {
+		char const *title;
+		std::vector<std::string> lines;
+	};
+
+	std::vector<Program> programs( ) {
+		return {{"integer FOR",
+		         {"10 S = 0 : T = 0", "20 FOR I = 1 TO 2000000", "30 S = ( S + I * 7 - I / 3 ) % 100000",
+		          "40 T = T - I % 13 + 2", "50 NEXT I", "60 PRINT S", "70 PRINT T", "80 PRINT I"}},
+		        {"real GOTO",
+		         {"10 I = 0 : R = 0.5 : X = 0.0", "20 I = I + 1",
+		          "30 R = ( R * 1.5 + 1.0 ) / 1.25 - R / 2.0 + -R ^ 2 / 8.0", "40 X = X + R * 0.25",
+		          "50 IF I < 1000000 THEN 20", "60 PRINT R", "70 PRINT X"}},
+		        {"array",
+		         {"10 DIM A(1000) : S = 0 : J = 0", "20 FOR K = 1 TO 300", "30 FOR J = 0 TO 999", "40 A(J) = J * K",
+		          "50 NEXT J", "60 FOR J = 0 TO 999", "70 S = ( S + A(J) ) % 1000003", "80 NEXT J", "90 NEXT K",
+		          "100 PRINT S"}}};
+	}
+
+	// Milliseconds RUN takes compiled, with what it prints left out
+	double run( Program const &program, bool jit, JitStatistics &statistics ) {
+		Basic basic;
+		basic.set_execution_mode( ExecutionMode::COMPILED );
+		basic.set_jit( jit );
+		basic.set_jit_threshold( 16 );
+		load( basic, program.lines );
+		auto const elapsed = bench::run( basic ).milliseconds;
+		statistics = basic.jit_statistics( );
+		return elapsed;
+	}
+
+	double time_program( Program const &program, bool jit, JitStatistics &statistics ) {
+		return fastest( repeats, [&]( ) { return run( program, jit, statistics ); } );
+	}
+} // namespace
+
+int main( ) {
+	Basic probe;
+	probe.set_jit( true );
+	if( !probe.jit( ) ) {
+		std::cout << "The JIT is not available on this machine\n";
+		return EXIT_SUCCESS;
+	}
+
+	std::cout << std::setw( 18 ) << "" << std::setw( 13 ) << "compiled ms" << std::setw( 10 ) << "jit ms" << std::setw( 8 )
+	          << "traces" << std::setw( 10 ) << "entries" << std::setw( 8 ) << "deopts" << '\n';
+	for( auto const &program : programs( ) ) {
+		JitStatistics statistics{};
+		auto const compiled = time_program( program, false, statistics );
+		auto const jit = time_program( program, true, statistics );
+		std::cout << std::setw( 18 ) << program.title << std::fixed << std::setprecision( 2 ) << std::setw( 13 )
+		          << compiled << std::setw( 10 ) << jit << std::setw( 8 ) << statistics.traces << std::setw( 10 )
+		          << statistics.entries << std::setw( 8 ) << statistics.deopts << '\n';
+	}
+	return EXIT_SUCCESS;
+}
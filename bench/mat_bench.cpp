@@ -0,0 +1,143 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Measures the kernels of MAT with each kind of instruction the machine
+// has against a plain triple loop, and MAT in a program against the same
+// work written as FOR loops.  Every kernel must give the same results
+
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "basic_mat.h"
+#include "bench_run.h"
+#include "dawbasic.h"
+
+namespace {
+	using daw::basic::bench::milliseconds;
+	using daw::basic::bench::run;
+	using daw::basic::real;
+	namespace mat = daw::basic::mat;
+
+	std::vector<real> matrix( size_t size, real seed ) {
+		std::vector<real> result( size * size );
+		for( size_t n = 0; n < result.size( ); ++n ) {
+			result[n] = static_cast<real>( ( n * 7 + 3 ) % 101 ) / seed - 1.0;
+		}
+		return result;
+	}
+
+	bool bench_kernels( ) {
+		size_t const size = 400;
+		auto const lhs = matrix( size, 37.0 );
+		auto const rhs = matrix( size, 53.0 );
+
+		// Element ( i, j ) summed over k in order, like the kernels do
+		std::vector<real> expected( size * size );
+		auto const naive = milliseconds( [&]( ) {
+			for( size_t i = 0; i < size; ++i ) {
+				for( size_t j = 0; j < size; ++j ) {
+					real sum = 0.0;
+					for( size_t k = 0; k < size; ++k ) {
+						sum += lhs[i + k * size] * rhs[k + j * size];
+					}
+					expected[i + j * size] = sum;
+				}
+			}
+		} );
+		std::cout << std::fixed << std::setprecision( 2 ) << std::setw( 8 ) << "naive" << std::setw( 10 ) << naive
+		          << " ms multiply\n";
+
+		std::vector<real> sum( size * size );
+		mat::add( mat::Kernel::SCALAR, lhs.data( ), rhs.data( ), sum.data( ), sum.size( ) );
+		auto same = true;
+		for( auto const kernel : {mat::Kernel::SCALAR, mat::Kernel::SSE2, mat::Kernel::AVX2} ) {
+			if( !mat::supported( kernel ) ) {
+				std::cout << std::setw( 8 ) << mat::kernel_name( kernel ) << " not supported\n";
+				continue;
+			}
+			std::vector<real> product( size * size );
+			auto const multiply = milliseconds( [&]( ) {
+				mat::multiply( kernel, lhs.data( ), rhs.data( ), product.data( ), size, size, size );
+			} );
+			std::vector<real> added( size * size );
+			auto const add = milliseconds( [&]( ) {
+				for( size_t n = 0; n < 100; ++n ) {
+					mat::add( kernel, lhs.data( ), rhs.data( ), added.data( ), added.size( ) );
+				}
+			} );
+			std::cout << std::setw( 8 ) << mat::kernel_name( kernel ) << std::setw( 10 ) << multiply << " ms multiply"
+			          << std::setw( 10 ) << add << " ms 100 adds\n";
+			if( 0 != std::memcmp( product.data( ), expected.data( ), product.size( ) * sizeof( real ) ) ||
+			    0 != std::memcmp( added.data( ), sum.data( ), added.size( ) * sizeof( real ) ) ) {
+				std::cout << mat::kernel_name( kernel ) << " gave different results\n";
+				same = false;
+			}
+		}
+		return same;
+	}
+
+	bool bench_program( ) {
+		auto const size = std::to_string( 60 );
+		auto const last = std::to_string( 59 );
+		std::vector<std::string> const setup = {"10 DIM A#(" + size + ", " + size + ")",
+		                                        "20 DIM B#(" + size + ", " + size + ")",
+		                                        "30 DIM C#(" + size + ", " + size + ")",
+		                                        "40 FOR I = 0 TO " + last,
+		                                        "50 FOR J = 0 TO " + last,
+		                                        "60 A#(I, J) = I - J",
+		                                        "70 B#(I, J) = ( I + J ) % 7",
+		                                        "80 NEXT J",
+		                                        "90 NEXT I"};
+		auto loops = setup;
+		loops.insert( std::end( loops ), {"100 FOR I = 0 TO " + last, "110 FOR J = 0 TO " + last, "120 S = 0",
+		                                  "130 FOR K = 0 TO " + last, "140 S = S + A#(I, K) * B#(K, J)", "150 NEXT K",
+		                                  "160 C#(I, J) = S", "170 NEXT J", "180 NEXT I"} );
+		auto with_mat = setup;
+		with_mat.push_back( "100 MAT C# = A# * B#" );
+		for( auto lines : {&loops, &with_mat} ) {
+			lines->push_back( "200 PRINT C#(3, 5)" );
+			lines->push_back( "210 PRINT C#(" + last + ", 0)" );
+		}
+
+		auto const by_loops = run( loops );
+		auto const by_mat = run( with_mat );
+		std::cout << std::setw( 8 ) << "FOR" << std::setw( 10 ) << by_loops.milliseconds << " ms " << size << "x" << size
+		          << " product in BASIC\n";
+		std::cout << std::setw( 8 ) << "MAT" << std::setw( 10 ) << by_mat.milliseconds << " ms " << size << "x" << size
+		          << " product in BASIC\n";
+		if( by_loops.printed != by_mat.printed ) {
+			std::cout << "MAT printed " << by_mat.printed << "instead of " << by_loops.printed;
+			return false;
+		}
+		return true;
+	}
+} // namespace
+
+int main( ) {
+	auto const kernels_same = bench_kernels( );
+	auto const program_same = bench_program( );
+	return kernels_same && program_same ? EXIT_SUCCESS : EXIT_FAILURE;
+}
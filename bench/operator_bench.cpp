@@ -0,0 +1,73 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Measures applying operators in a running program and counts the heap
+// allocations made while doing so.  Built in operators run through typed
+// kernels and should not allocate
+
+#include <iostream>
+
+#include "bench_allocations.h"
+#include "bench_timing.h"
+#include "dawbasic.h"
+
+namespace {
+	using daw::basic::Basic;
+	using daw::basic::bench::allocations;
+	using daw::basic::bench::milliseconds;
+	using daw::basic::BasicValue;
+	using daw::basic::ExecutionMode;
+	using daw::basic::integer;
+
+	integer const iterations = 200000;
+
+	void bench_program( ExecutionMode mode, char const *title ) {
+		Basic basic;
+		basic.set_execution_mode( mode );
+		// MAXOP is added with add_binary_operator and binds like *
+		basic.add_binary_operator( "MAXOP", 3, []( BasicValue lhs, BasicValue rhs ) {
+			return lhs.integer_value( ) < rhs.integer_value( ) ? rhs : lhs;
+		} );
+		basic.parse_line( "10 I = 0 : X = 0 : R = 0.5", false );
+		basic.parse_line( "20 I = I + 1", false );
+		basic.parse_line( "30 X = ( X + I * 3 - I / 2 ) % 1000", false );
+		basic.parse_line( "40 R = R * 1.5 / 1.25 - R ^ 2 + -R", false );
+		basic.parse_line( "50 Y = I MAXOP X", false );
+		basic.parse_line( "60 IF I < " + std::to_string( iterations ) + " AND I >= 0 THEN 20", false );
+
+		auto const allocations_before = allocations( );
+		auto const elapsed = milliseconds( [&basic]( ) { basic.parse_line( "RUN", false ); } );
+		auto const made = allocations( ) - allocations_before;
+
+		// 16 operators are applied each time around the loop
+		auto const applied = static_cast<double>( iterations ) * 16.0;
+		std::cout << title << ": " << elapsed * 1000000.0 / applied
+		          << " ns per operator, " << static_cast<double>( made ) / applied << " allocations per operator ("
+		          << made << " in total)\n";
+	}
+} // namespace
+
+int main( ) {
+	bench_program( ExecutionMode::COMPILED, "compiled" );
+	bench_program( ExecutionMode::INTERPRETED, "interpreted" );
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,192 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Measures the reductions behind SUM, MIN, MAX, MEAN and DOT with each
+// kind of instruction the machine has, and SUM in a program against the
+// same work written as a FOR loop.  Every kernel must give the same
+// results and compensated sums must be closer to the exact one
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "basic_mat.h"
+#include "bench_run.h"
+#include "dawbasic.h"
+
+namespace {
+	using daw::basic::bench::fastest;
+	using daw::basic::bench::milliseconds;
+	using daw::basic::bench::run;
+	using daw::basic::integer;
+	using daw::basic::real;
+	namespace mat = daw::basic::mat;
+
+	struct Results {
+		real sum;
+		real compensated;
+		real minimum;
+		real maximum;
+		real dot;
+		int64_t integer_sum;
+		integer integer_minimum;
+		integer integer_maximum;
+
+		bool operator==( Results const &rhs ) const {
+			return 0 == std::memcmp( this, &rhs, sizeof( Results ) );
+		}
+	};
+
+	bool bench_kernels( ) {
+		size_t const size = 100003; // Not a multiple of the lanes, and fits in cache
+		size_t const repeats = 500;
+		std::vector<real> reals( size );
+		std::vector<real> others( size );
+		std::vector<integer> integers( size );
+		for( size_t n = 0; n < size; ++n ) {
+			reals[n] = static_cast<real>( ( n * 7 + 3 ) % 1001 ) / 37.0 - 13.0;
+			others[n] = static_cast<real>( ( n * 11 + 5 ) % 103 ) / 53.0;
+			integers[n] = static_cast<integer>( ( n * 7919 ) % 200003 ) - 100000;
+		}
+
+		auto same = true;
+		Results expected{};
+		auto first = true;
+		for( auto const kernel : {mat::Kernel::SCALAR, mat::Kernel::SSE2, mat::Kernel::AVX2} ) {
+			if( !mat::supported( kernel ) ) {
+				std::cout << std::setw( 8 ) << mat::kernel_name( kernel ) << " not supported\n";
+				continue;
+			}
+			Results results{};
+			auto const sum = milliseconds( [&]( ) {
+				for( size_t n = 0; n < repeats; ++n ) {
+					results.sum = mat::sum( kernel, mat::Summation::FAST, reals.data( ), size );
+				}
+			} );
+			auto const compensated = milliseconds( [&]( ) {
+				for( size_t n = 0; n < repeats; ++n ) {
+					results.compensated = mat::sum( kernel, mat::Summation::COMPENSATED, reals.data( ), size );
+				}
+			} );
+			auto const extremes = milliseconds( [&]( ) {
+				for( size_t n = 0; n < repeats; ++n ) {
+					results.minimum = mat::minimum( kernel, reals.data( ), size );
+					results.maximum = mat::maximum( kernel, reals.data( ), size );
+				}
+			} );
+			auto const dot = milliseconds( [&]( ) {
+				for( size_t n = 0; n < repeats; ++n ) {
+					results.dot = mat::dot( kernel, reals.data( ), others.data( ), size );
+				}
+			} );
+			auto const integer_sum = milliseconds( [&]( ) {
+				for( size_t n = 0; n < repeats; ++n ) {
+					results.integer_sum = mat::sum( kernel, integers.data( ), size );
+					results.integer_minimum = mat::minimum( kernel, integers.data( ), size );
+					results.integer_maximum = mat::maximum( kernel, integers.data( ), size );
+				}
+			} );
+			std::cout << std::fixed << std::setprecision( 2 ) << std::setw( 8 ) << mat::kernel_name( kernel )
+			          << std::setw( 9 ) << sum << " ms sum" << std::setw( 9 ) << compensated << " ms compensated"
+			          << std::setw( 9 ) << extremes << " ms min and max" << std::setw( 9 ) << dot << " ms dot"
+			          << std::setw( 9 ) << integer_sum << " ms integers, " << repeats << " times\n";
+			if( first ) {
+				expected = results;
+				first = false;
+			} else if( !( results == expected ) ) {
+				std::cout << mat::kernel_name( kernel ) << " gave different results\n";
+				same = false;
+			}
+		}
+
+		// 1 followed by many values too small to change it one at a time
+		std::vector<real> small( size, 1e-16 );
+		small[0] = 1.0;
+		auto const exact = 1.0 + 1e-16 * static_cast<real>( size - 1 );
+		auto const kernel = mat::best_kernel( );
+		auto const fast_error = std::abs( mat::sum( kernel, mat::Summation::FAST, small.data( ), size ) - exact );
+		auto const compensated_error =
+		  std::abs( mat::sum( kernel, mat::Summation::COMPENSATED, small.data( ), size ) - exact );
+		std::cout << std::scientific << std::setprecision( 3 ) << "error of sum " << fast_error << ", compensated "
+		          << compensated_error << "\n"
+		          << std::fixed << std::setprecision( 2 );
+		if( !( compensated_error < fast_error ) ) {
+			std::cout << "compensated sum was no more accurate\n";
+			same = false;
+		}
+		return same;
+	}
+
+	bool bench_program( ) {
+		auto const size = std::to_string( 100000 );
+		auto const last = std::to_string( 99999 );
+		size_t const loop_repeats = 5;
+		size_t const sum_repeats = 2000;
+		// Halves and small integers so that every order of adding is exact
+		std::vector<std::string> const setup = {"10 DIM A#(" + size + ")", "20 FOR I = 0 TO " + last,
+		                                        "30 A#(I) = ( I % 17 ) / 2 - 4", "40 NEXT I", "50 S = 0"};
+		auto loops = setup;
+		loops.insert( std::end( loops ), {"100 FOR R = 1 TO " + std::to_string( loop_repeats ), "110 S = 0",
+		                                  "120 FOR I = 0 TO " + last, "130 S = S + A#(I)", "140 NEXT I", "150 NEXT R"} );
+		auto with_sum = setup;
+		with_sum.insert( std::end( with_sum ),
+		                 {"100 FOR R = 1 TO " + std::to_string( sum_repeats ), "110 S = SUM(A#)", "150 NEXT R"} );
+		auto only_setup = setup;
+		for( auto lines : {&loops, &with_sum, &only_setup} ) {
+			lines->push_back( "200 PRINT S" );
+		}
+
+		std::string loops_printed;
+		std::string sum_printed;
+		// The setup is taken off the others, so each is the fastest of a few runs
+		auto const timed = [&]( std::vector<std::string> const &lines, std::string &printed ) {
+			return fastest( 3, [&]( ) {
+				auto const result = run( lines );
+				printed = result.printed;
+				return result.milliseconds;
+			} );
+		};
+		std::string setup_printed;
+		auto const by_setup = timed( only_setup, setup_printed );
+		auto const by_loops = timed( loops, loops_printed ) - by_setup;
+		auto const by_sum = timed( with_sum, sum_printed ) - by_setup;
+		std::cout << std::setprecision( 4 ) << std::setw( 8 ) << "FOR" << std::setw( 10 ) << by_loops / loop_repeats
+		          << " ms a sum of " << size << " reals in BASIC\n";
+		std::cout << std::setw( 8 ) << "SUM" << std::setw( 10 ) << by_sum / sum_repeats << " ms a sum of " << size
+		          << " reals in BASIC\n";
+		if( loops_printed != sum_printed ) {
+			std::cout << "SUM printed " << sum_printed << "instead of " << loops_printed;
+			return false;
+		}
+		return true;
+	}
+} // namespace
+
+int main( ) {
+	auto const kernels_same = bench_kernels( );
+	auto const program_same = bench_program( );
+	return kernels_same && program_same ? EXIT_SUCCESS : EXIT_FAILURE;
+}
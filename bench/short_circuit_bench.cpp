@@ -0,0 +1,78 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Measures conditions whose right operand of AND or OR rarely needs to be
+// evaluated, with short circuit evaluation off and on.  Both must print the
+// same counts
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "bench_run.h"
+#include "dawbasic.h"
+
+namespace {
+	using daw::basic::Basic;
+	using daw::basic::ExecutionMode;
+	using daw::basic::bench::run;
+
+	int const iterations = 300000;
+
+	// What RUN prints
+	std::string bench_program( ExecutionMode mode, bool short_circuit, char const *title ) {
+		Basic basic;
+		basic.set_execution_mode( mode );
+		basic.set_short_circuit( short_circuit );
+		basic.parse_line( "10 X = 0 : Y = 0 : Z = 0", false );
+		basic.parse_line( "20 FOR I = 1 TO " + std::to_string( iterations ), false );
+		basic.parse_line( "30 IF I % 100 = 0 AND ( I % 97 ) * ( I % 89 ) % 7 < 3 AND I > 5 THEN X = X + 1", false );
+		basic.parse_line( "40 IF I % 2 = 0 OR ( I * 3 - I * 4 ) % 5 = 1 THEN Y = Y + 1", false );
+		basic.parse_line( "50 B = I > 10 AND ( I % 1000 ) * ( I % 1000 ) % 3 = 1", false );
+		basic.parse_line( "60 IF B THEN Z = Z + 1", false );
+		basic.parse_line( "70 NEXT I", false );
+		basic.parse_line( "80 PRINT X : PRINT Y : PRINT Z", false );
+
+		auto const result = run( basic );
+		std::cout << title << ": " << result.milliseconds << " ms\n";
+		return result.printed;
+	}
+
+	bool same( std::string const &expected, std::string const &printed, char const *title ) {
+		if( expected == printed ) {
+			return true;
+		}
+		std::cout << title << " printed\n" << printed << "instead of\n" << expected;
+		return false;
+	}
+} // namespace
+
+int main( ) {
+	auto const compiled = bench_program( ExecutionMode::COMPILED, false, "compiled" );
+	auto const compiled_same =
+	  same( compiled, bench_program( ExecutionMode::COMPILED, true, "compiled short circuit" ), "compiled" );
+	auto const interpreted = bench_program( ExecutionMode::INTERPRETED, false, "interpreted" );
+	auto const interpreted_same =
+	  same( interpreted, bench_program( ExecutionMode::INTERPRETED, true, "interpreted short circuit" ), "interpreted" );
+	std::cout << compiled;
+	return compiled_same && interpreted_same && compiled == interpreted ? EXIT_SUCCESS : EXIT_FAILURE;
+}
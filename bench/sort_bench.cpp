@@ -0,0 +1,140 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Measures the parallel sorts behind SORT against std::sort on one
+// thread, and SORT in a program against a bubble sort written in BASIC.
+// The results must be the same and stable orders must keep ties in place
+
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "basic_sort.h"
+#include "bench_run.h"
+#include "dawbasic.h"
+
+namespace {
+	using daw::basic::bench::milliseconds;
+	using daw::basic::bench::run;
+	using daw::basic::integer;
+	using daw::basic::real;
+	namespace parallel = daw::basic::parallel;
+
+	// A permutation of 0 to size - 1, scattered
+	integer scattered( size_t n, size_t size ) {
+		return static_cast<integer>( ( n * 2654435761u ) % size );
+	}
+
+	template<typename T>
+	bool bench_numbers( char const *kind, std::vector<T> values ) {
+		auto expected = values;
+		auto const one_thread = milliseconds( [&]( ) { std::sort( std::begin( expected ), std::end( expected ) ); } );
+		auto const threads = milliseconds( [&]( ) { parallel::sort( values.data( ), values.size( ) ); } );
+		std::cout << std::fixed << std::setprecision( 2 ) << std::setw( 8 ) << kind << std::setw( 10 ) << one_thread
+		          << " ms std::sort" << std::setw( 10 ) << threads << " ms on " << parallel::thread_count( )
+		          << " threads, " << values.size( ) << " elements\n";
+		if( values != expected ) {
+			std::cout << kind << " were sorted differently\n";
+			return false;
+		}
+		return true;
+	}
+
+	// Few distinct keys so that stability shows
+	bool bench_order( size_t size ) {
+		std::vector<integer> keys( size );
+		for( size_t n = 0; n < size; ++n ) {
+			keys[n] = scattered( n, size ) % 1000;
+		}
+		std::vector<std::pair<integer, size_t>> expected( size );
+		for( size_t n = 0; n < size; ++n ) {
+			expected[n] = std::make_pair( keys[n], n );
+		}
+		auto const one_thread = milliseconds( [&]( ) {
+			std::stable_sort( std::begin( expected ), std::end( expected ),
+			                  []( std::pair<integer, size_t> const &lhs, std::pair<integer, size_t> const &rhs ) {
+				                  return lhs.first < rhs.first;
+			                  } );
+		} );
+		std::vector<size_t> order;
+		auto const threads = milliseconds( [&]( ) { order = parallel::order( keys.data( ), size, true ); } );
+		std::cout << std::setw( 8 ) << "stable" << std::setw( 10 ) << one_thread << " ms std::stable_sort"
+		          << std::setw( 10 ) << threads << " ms on " << parallel::thread_count( ) << " threads, " << size
+		          << " elements\n";
+		for( size_t n = 0; n < size; ++n ) {
+			if( order[n] != expected[n].second ) {
+				std::cout << "stable order differs at " << n << "\n";
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool bench_program( ) {
+		auto const size = std::to_string( 1000 );
+		auto const last = std::to_string( 999 );
+		std::vector<std::string> const setup = {"10 DIM A#(" + size + ")", "20 FOR I = 0 TO " + last,
+		                                        "30 A#(I) = ( I * 7919 ) % 1009 / 3", "40 NEXT I"};
+		auto bubble = setup;
+		bubble.insert( std::end( bubble ),
+		               {"100 FOR I = 0 TO " + last, "110 FOR J = 0 TO " + last + " - I - 1",
+		                "120 IF A#(J) <= A#(J + 1) THEN 160", "130 T = A#(J)", "140 A#(J) = A#(J + 1)",
+		                "150 A#(J + 1) = T", "160 NEXT J", "170 NEXT I"} );
+		auto with_sort = setup;
+		with_sort.push_back( "100 SORT A#" );
+		for( auto lines : {&bubble, &with_sort} ) {
+			lines->insert( std::end( *lines ),
+			               {"200 PRINT A#(0)", "210 PRINT A#(500)", "220 PRINT A#(" + last + ")", "230 PRINT SUM(A#)"} );
+		}
+
+		auto const by_bubble = run( bubble );
+		auto const by_sort = run( with_sort );
+		std::cout << std::setw( 8 ) << "bubble" << std::setw( 10 ) << by_bubble.milliseconds << " ms sorting " << size
+		          << " reals in BASIC\n";
+		std::cout << std::setw( 8 ) << "SORT" << std::setw( 10 ) << by_sort.milliseconds << " ms sorting " << size
+		          << " reals in BASIC\n";
+		if( by_bubble.printed != by_sort.printed ) {
+			std::cout << "SORT printed " << by_sort.printed << "instead of " << by_bubble.printed;
+			return false;
+		}
+		return true;
+	}
+} // namespace
+
+int main( ) {
+	size_t const size = 10000000;
+	std::vector<integer> integers( size );
+	std::vector<real> reals( size );
+	for( size_t n = 0; n < size; ++n ) {
+		integers[n] = scattered( n, size ) - static_cast<integer>( size / 2 );
+		reals[n] = static_cast<real>( integers[n] ) / 7.0;
+	}
+	auto same = bench_numbers( "integers", std::move( integers ) );
+	same = bench_numbers( "reals", std::move( reals ) ) && same;
+	same = bench_order( size ) && same;
+	same = bench_program( ) && same;
+	return same ? EXIT_SUCCESS : EXIT_FAILURE;
+}
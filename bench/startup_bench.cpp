@@ -0,0 +1,67 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Measures the latency of creating a Basic and of RUN.  Both used to build
+// every builtin into the instance, RUN because it creates the Basic that runs
+// the program
+
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "bench_timing.h"
+#include "dawbasic.h"
+
+namespace {
+	using daw::basic::Basic;
+	using daw::basic::bench::milliseconds;
+
+	size_t const instances = 10000;
+
+	template<typename Function>
+	double microseconds_each( Function func ) {
+		auto const elapsed = milliseconds( [&func]( ) {
+			for( size_t n = 0; n < instances; ++n ) {
+				func( );
+			}
+		} );
+		return elapsed * 1000.0 / static_cast<double>( instances );
+	}
+} // namespace
+
+int main( ) {
+	std::vector<std::unique_ptr<Basic>> interpreters;
+	interpreters.reserve( instances );
+	auto const construct = microseconds_each( [&]( ) { interpreters.emplace_back( new Basic( ) ); } );
+
+	for( auto &basic : interpreters ) {
+		basic->parse_line( "10 X = 1", false );
+		basic->parse_line( "20 END", false );
+	}
+	size_t current = 0;
+	auto const run = microseconds_each( [&]( ) { interpreters[current++]->parse_line( "RUN", false ); } );
+
+	std::cout << "construct Basic: " << construct << " us\n";
+	std::cout << "first RUN:       " << run << " us\n";
+	return EXIT_SUCCESS;
+}
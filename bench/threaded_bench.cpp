@@ -0,0 +1,101 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Runs the same compiled programs with switch dispatch and with threaded
+// dispatch through computed goto.  Threaded dispatch is only there when the
+// library was built with DAW_BASIC_THREADED_DISPATCH
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "bench_run.h"
+#include "dawbasic.h"
+
+namespace {
+	using daw::basic::Basic;
+	using daw::basic::DispatchMode;
+	using daw::basic::bench::fastest;
+	using daw::basic::bench::load;
+	using daw::basic::bench::run;
+
+	int const repeats = 5;
+
+	struct Program {
+		char const *title;
+		std::vector<std::string> lines;
+	};
+
+	// Best of several runs in milliseconds
+	double time_program( Program const &program, DispatchMode mode ) {
+		return fastest( repeats, [&]( ) {
+			Basic basic;
+			basic.set_dispatch_mode( mode );
+			load( basic, program.lines );
+			return run( basic ).milliseconds;
+		} );
+	}
+} // namespace
+
+int main( ) {
+	std::vector<Program> const programs = {
+	  {"sieve",
+	   {"10 N = 30000 : C = 0",
+	    "20 DIM F( N + 1 )",
+	    "30 FOR I = 2 TO N : F( I ) = 0 : NEXT I",
+	    "40 FOR I = 2 TO N",
+	    "50 IF F( I ) = 0 THEN GOSUB 100",
+	    "60 NEXT I",
+	    "70 END",
+	    "100 C = C + 1 : FOR J = I * I TO N STEP I : F( J ) = 1 : NEXT J : RETURN"}},
+	  {"matrix",
+	   {"10 N = 24",
+	    "20 DIM A( N, N ) : DIM B( N, N ) : DIM C( N, N )",
+	    "30 FOR I = 0 TO N - 1 : FOR J = 0 TO N - 1",
+	    "40 A( I, J ) = I + J : B( I, J ) = I - J : C( I, J ) = 0",
+	    "50 NEXT J : NEXT I",
+	    "60 FOR I = 0 TO N - 1 : FOR J = 0 TO N - 1 : S = 0",
+	    "70 FOR K = 0 TO N - 1 : S = S + A( I, K ) * B( K, J ) : NEXT K",
+	    "80 C( I, J ) = S : NEXT J : NEXT I"}},
+	  {"scalar loop",
+	   {"10 I = 0 : X = 0 : R = 0.5", "20 I = I + 1", "30 X = ( X + I * 3 - I / 2 ) % 1000",
+	    "40 R = R * 1.5 / 1.25 - R ^ 2 + -R", "50 IF I < 300000 THEN 20"}}};
+
+	{
+		Basic basic;
+		basic.set_dispatch_mode( DispatchMode::THREADED );
+		if( DispatchMode::THREADED != basic.dispatch_mode( ) ) {
+			std::cout << "Built without threaded dispatch, both columns use the switch\n";
+		}
+	}
+	std::cout << std::setw( 12 ) << "" << std::setw( 12 ) << "switch ms" << std::setw( 12 ) << "threaded ms"
+	          << std::setw( 10 ) << "speedup\n";
+	for( auto const &program : programs ) {
+		auto const switched = time_program( program, DispatchMode::SWITCH );
+		auto const threaded = time_program( program, DispatchMode::THREADED );
+		std::cout << std::setw( 12 ) << program.title << std::fixed << std::setprecision( 2 ) << std::setw( 12 )
+		          << switched << std::setw( 12 ) << threaded << std::setw( 9 ) << switched / threaded << "x\n";
+	}
+	return EXIT_SUCCESS;
+}
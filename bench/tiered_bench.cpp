@@ -0,0 +1,96 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Measures RUN of a long program whose lines each run once and of a short
+// program that loops, compiled up front, tiered and interpreted.  Tiered
+// should start like the interpreter and loop like the compiler
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "bench_run.h"
+#include "dawbasic.h"
+
+namespace {
+	using daw::basic::Basic;
+	using daw::basic::ExecutionMode;
+	using daw::basic::bench::fastest;
+	using daw::basic::bench::load;
+	using daw::basic::bench::run;
+
+	int const repeats = 5;
+
+	std::vector<std::string> long_program( ) {
+		std::vector<std::string> lines;
+		lines.push_back( "1 X = 0 : Y = 0" );
+		for( int n = 2; n < 50000; ++n ) {
+			lines.push_back( std::to_string( n ) + " X = X + " + std::to_string( n % 97 ) + " * 2 : Y = Y - X / 3" );
+		}
+		lines.push_back( "50000 END" );
+		return lines;
+	}
+
+	std::vector<std::string> loop_program( ) {
+		return {"10 I = 0 : X = 0 : R = 0.5", "20 FOR I = 1 TO 500000", "30 X = ( X + I * 3 - I / 2 ) % 1000",
+		        "40 R = R * 1.5 / 1.25 - R ^ 2 + -R", "50 NEXT I"};
+	}
+
+	double time_program( ExecutionMode mode, std::vector<std::string> const &lines ) {
+		return fastest( repeats, [&]( ) {
+			Basic basic;
+			basic.set_execution_mode( mode );
+			load( basic, lines );
+			return run( basic ).milliseconds;
+		} );
+	}
+} // namespace
+
+int main( ) {
+	struct Program {
+		char const *title;
+		std::vector<std::string> lines;
+	};
+	Program const programs[] = {{"long, run once", long_program( )}, {"short loop", loop_program( )}};
+
+	std::cout << std::setw( 16 ) << "" << std::setw( 13 ) << "compiled ms" << std::setw( 13 ) << "tiered ms"
+	          << std::setw( 16 ) << "interpreted ms" << '\n';
+	for( auto const &program : programs ) {
+		std::cout << std::setw( 16 ) << program.title << std::fixed << std::setprecision( 2 );
+		std::cout << std::setw( 13 ) << time_program( ExecutionMode::COMPILED, program.lines );
+		std::cout << std::setw( 13 ) << time_program( ExecutionMode::TIERED, program.lines );
+		std::cout << std::setw( 16 ) << time_program( ExecutionMode::INTERPRETED, program.lines ) << '\n';
+	}
+
+	Basic basic;
+	basic.set_execution_mode( ExecutionMode::TIERED );
+	load( basic, loop_program( ) );
+	basic.parse_line( "RUN", false );
+	std::cout << "\nshort loop compiled lines\n";
+	for( auto const &transition : basic.tier_transitions( ) ) {
+		std::cout << "  " << transition.first_line << " to " << transition.last_line << " after line "
+		          << transition.line_number << " ran " << transition.executions << " times\n";
+	}
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,92 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Measures filling and summing a matrix held in an array of any values and
+// in arrays of integers and of reals, with the bytes DIM allocates for each
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include "bench_allocations.h"
+#include "bench_run.h"
+#include "dawbasic.h"
+
+namespace {
+	using daw::basic::Basic;
+	using daw::basic::ExecutionMode;
+	using daw::basic::bench::allocated_bytes;
+	using daw::basic::bench::run;
+
+	int const rows = 300;
+	int const columns = 300;
+
+	// Bytes allocated by DIM of the matrix
+	size_t dim_bytes( std::string const &dim ) {
+		Basic basic;
+		auto const allocated_before = allocated_bytes( );
+		basic.parse_line( dim, false );
+		return allocated_bytes( ) - allocated_before;
+	}
+
+	// What RUN prints
+	std::string bench_program( std::string const &name, bool jit ) {
+		auto const dim = "DIM " + name + "(" + std::to_string( rows ) + ", " + std::to_string( columns ) + ")";
+		Basic basic;
+		basic.set_jit( jit );
+		basic.parse_line( "10 " + dim, false );
+		basic.parse_line( "20 FOR I = 0 TO " + std::to_string( rows - 1 ), false );
+		basic.parse_line( "30 FOR J = 0 TO " + std::to_string( columns - 1 ), false );
+		basic.parse_line( "40 " + name + "(I, J) = ( I * 7 + J ) % 100", false );
+		basic.parse_line( "50 NEXT J", false );
+		basic.parse_line( "60 NEXT I", false );
+		basic.parse_line( "70 S = 0", false );
+		basic.parse_line( "80 FOR I = 0 TO " + std::to_string( rows - 1 ), false );
+		basic.parse_line( "90 FOR J = 0 TO " + std::to_string( columns - 1 ), false );
+		basic.parse_line( "100 S = S + " + name + "(I, J)", false );
+		basic.parse_line( "110 NEXT J", false );
+		basic.parse_line( "120 NEXT I", false );
+		basic.parse_line( "130 PRINT S", false );
+
+		auto const result = run( basic );
+		std::cout << std::setw( 8 ) << name << std::setw( 5 ) << ( jit ? "jit" : "" ) << std::fixed
+		          << std::setprecision( 2 ) << std::setw( 10 ) << result.milliseconds << " ms" << std::setw( 10 )
+		          << static_cast<double>( dim_bytes( dim ) ) / 1024.0 << " KiB\n";
+		return result.printed;
+	}
+} // namespace
+
+int main( ) {
+	auto result = EXIT_SUCCESS;
+	for( auto const jit : {false, true} ) {
+		auto const any = bench_program( "A", jit );
+		for( auto const name : {"A%", "A#"} ) {
+			auto const printed = bench_program( name, jit );
+			if( printed != any ) {
+				std::cout << name << " printed " << printed << "instead of " << any;
+				result = EXIT_FAILURE;
+			}
+		}
+	}
+	return result;
+}
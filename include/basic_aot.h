@@ -0,0 +1,415 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "dawbasic.h"
+
+namespace daw {
+	namespace basic {
+		namespace aot {
+			//////////////////////////////////////////////////////////////////////////
+			/// Summary: What programs translated to C++ run on.  The program is
+			/// loaded and compiled into a Basic again, so the pools, symbols and
+			/// lines that the generated code refers to by index are the ones it
+			/// was translated from.  The generated code does the control flow and
+			/// the unboxed arithmetic and calls the runtime for the rest.  A
+			/// variable kept in a local of the generated code is passed with a flag
+			/// that is false while the Basic holds it instead
+			class Runtime {
+				Basic m_basic;
+				std::vector<Basic::BasicArray *> m_arrays; // By name in the compiled program, once found
+
+				bytecode::Instruction const &instruction( int32_t pc ) const;
+				Basic::Variable &variable( int32_t symbol );
+				Basic::Variable const &variable( int32_t symbol ) const;
+				Basic::BasicArray *array( int32_t name );
+
+				friend class Translator;
+
+			public:
+				std::vector<BasicValue> stack;
+
+				Runtime( std::string const &program_text, bool optimize, bool short_circuit );
+				uint64_t code_hash( ) const;
+				int run( bool ( *program )( Runtime & ), uint64_t code_hash );
+
+				void line( int32_t index );
+				void execute( int32_t pc );
+				bool load_integer( int32_t symbol, int64_t &value ) const;
+				bool load_real( int32_t symbol, real &value ) const;
+				void store( int32_t symbol, BasicValue value );
+				bool reload( int32_t symbol, integer &local ) const;
+				bool reload( int32_t symbol, real &local ) const;
+				template<typename T>
+				void load( int32_t pc, T const &local, bool set );
+				template<typename T>
+				void store( int32_t pc, T &local, bool &set );
+				void increment( int32_t pc, integer &local, bool &set );
+				void increment( int32_t pc, real &local, bool &set );
+				void load_element( int32_t pc );
+				void store_element( int32_t pc );
+				template<typename T>
+				void load_element( int32_t pc, T const &index, bool set );
+				template<typename T>
+				void store_element( int32_t pc, T const &index, bool set );
+				bool enter_loop( int32_t pc );
+				template<typename T>
+				bool enter_loop( int32_t pc, T &counter, bool &set );
+				bool next_loop( int32_t symbol, size_t &body );
+				bool next_loop( int32_t symbol, size_t &body, integer &counter, bool &set );
+				bool next_loop( int32_t symbol, size_t &body, real &counter, bool &set );
+				void print( );
+				void print( BasicValue const &value );
+				void print_variable( int32_t pc );
+				template<typename T>
+				void print_variable( int32_t pc, T const &local, bool set );
+				void print_newline( );
+				bool condition( );
+				bool short_circuit( int32_t pc );
+				bool compare( int32_t pc );
+				bool keyword( int32_t pc, bool &result );
+				void stop( );
+				[[noreturn]] void fail( char const *message );
+				static bool equal( real lhs, real rhs );
+				static bool fits( int64_t value );
+				static bool power( int64_t &lhs, int64_t rhs );
+			}; // class Runtime
+
+			//////////////////////////////////////////////////////////////////////////
+			/// Summary: Translates a saved program, its numbered lines as they would
+			/// be typed, into a C++ translation unit that runs it on Runtime.  The
+			/// program is compiled like RUN does and each instruction becomes code
+			/// of its own.  Jumps are gotos between labels, GOSUB pushes where to
+			/// return to and RETURN and NEXT go through a switch over those places.
+			/// Variables that type inference finds only ever hold an integer, or
+			/// only a real, are kept in locals of that type
+			class Translator {
+			public:
+				struct Options {
+					std::string source; // Named in the comment at the top
+					std::string entry;  // int entry( ) runs the program.  main when empty
+					bool optimize;
+					bool short_circuit;
+
+					Options( );
+				};
+
+				static std::string translate( std::string const &program_text, Options const &options );
+
+			private:
+				Runtime m_runtime;
+				Basic::CompiledProgram const &m_program;
+				std::vector<bool> m_labels;       // By pc, those jumped to
+				std::vector<size_t> m_returns;    // Where GOSUB returns to and NEXT continues a loop
+				std::vector<ValueType> m_locals;  // By symbol.  EMPTY when the variable stays in the Basic
+				std::vector<size_t> m_bodies;     // By symbol of counter, where the body of its only FOR starts
+				std::vector<ValueType> m_slots;   // Of the values on the unboxed stack before the pc being translated
+				size_t m_integer_slots;
+				size_t m_real_slots;
+				std::string m_code;
+
+				Translator( std::string const &program_text, Options const &options );
+				void analyze( );
+				void advance( size_t pc );
+				void translate_instruction( size_t pc );
+				std::string slot( size_t index ) const;
+				std::string local( int32_t symbol ) const;
+				std::string flush_locals( ) const;
+				std::string reload_locals( ) const;
+				[[noreturn]] void fail( size_t pc, std::string const &message ) const;
+			}; // class Translator
+
+			inline bytecode::Instruction const &Runtime::instruction( int32_t pc ) const {
+				return m_basic.m_compiled.code[static_cast<size_t>( pc )];
+			}
+
+			inline Basic::Variable &Runtime::variable( int32_t symbol ) {
+				return m_basic.m_variables[static_cast<size_t>( symbol )];
+			}
+
+			inline Basic::Variable const &Runtime::variable( int32_t symbol ) const {
+				return m_basic.m_variables[static_cast<size_t>( symbol )];
+			}
+
+			inline void Runtime::line( int32_t index ) {
+				m_basic.m_program_it = std::begin( m_basic.m_program ) + index;
+			}
+
+			//////////////////////////////////////////////////////////////////////////
+			/// Summary: Run the instruction at pc on stack like the VM does
+			inline void Runtime::execute( int32_t pc ) {
+				m_basic.execute_instruction( m_basic.m_compiled, instruction( pc ), stack );
+			}
+
+			//////////////////////////////////////////////////////////////////////////
+			/// Summary: Guards of LOAD_INTEGER and LOAD_REAL.  False unless the
+			/// variable holds a value of the type
+			inline bool Runtime::load_integer( int32_t symbol, int64_t &value ) const {
+				auto const &current = variable( symbol );
+				if( !current.is_set || ValueType::INTEGER != current.value.type( ) ) {
+					return false;
+				}
+				value = current.value.integer_value( );
+				return true;
+			}
+
+			inline bool Runtime::load_real( int32_t symbol, real &value ) const {
+				auto const &current = variable( symbol );
+				if( !current.is_set || ValueType::REAL != current.value.type( ) ) {
+					return false;
+				}
+				value = current.value.real_value( );
+				return true;
+			}
+
+			inline void Runtime::store( int32_t symbol, BasicValue value ) {
+				auto &current = variable( symbol );
+				current.value = std::move( value );
+				current.is_set = true;
+			}
+
+			//////////////////////////////////////////////////////////////////////////
+			/// Summary: Take the value of a variable kept in a local back from the
+			/// Basic after something ran there.  Returns whether the local has it,
+			/// it stays in the Basic when it is unset or of another type
+			inline bool Runtime::reload( int32_t symbol, integer &local ) const {
+				int64_t value = 0;
+				if( !load_integer( symbol, value ) ) {
+					return false;
+				}
+				local = static_cast<integer>( value );
+				return true;
+			}
+
+			inline bool Runtime::reload( int32_t symbol, real &local ) const {
+				return load_real( symbol, local );
+			}
+
+			template<typename T>
+			void Runtime::load( int32_t pc, T const &local, bool set ) {
+				if( set ) {
+					stack.emplace_back( local );
+				} else {
+					execute( pc );
+				}
+			}
+
+			//////////////////////////////////////////////////////////////////////////
+			/// Summary: STORE_VARIABLE into a local.  A value of another type goes to
+			/// the Basic and stays there until the local is stored to again
+			template<typename T>
+			void Runtime::store( int32_t pc, T &local, bool &set ) {
+				T value{};
+				auto const &top = stack.back( );
+				if( std::is_same<T, integer>::value ? ValueType::INTEGER == top.type( ) : ValueType::REAL == top.type( ) ) {
+					value = std::is_same<T, integer>::value ? static_cast<T>( top.integer_value( ) )
+					                                         : static_cast<T>( top.real_value( ) );
+					stack.pop_back( );
+					local = value;
+					set = true;
+					return;
+				}
+				execute( pc );
+				set = false;
+			}
+
+			//////////////////////////////////////////////////////////////////////////
+			/// Summary: INCREMENT_VARIABLE and DECREMENT_VARIABLE of a local.  An
+			/// integer that overflows is handed to the Basic, which makes it real
+			inline void Runtime::increment( int32_t pc, integer &local, bool &set ) {
+				auto const &current = instruction( pc );
+				if( set ) {
+					auto const amount = bytecode::OpCode::INCREMENT_VARIABLE == current.op ? static_cast<int64_t>( current.b )
+					                                                                      : -static_cast<int64_t>( current.b );
+					auto const value = static_cast<int64_t>( local ) + amount;
+					if( fits( value ) ) {
+						local = static_cast<integer>( value );
+						return;
+					}
+					store( current.a, BasicValue( local ) );
+					set = false;
+				}
+				execute( pc );
+			}
+
+			inline void Runtime::increment( int32_t pc, real &local, bool &set ) {
+				auto const &current = instruction( pc );
+				if( !set ) {
+					execute( pc );
+				} else if( bytecode::OpCode::INCREMENT_VARIABLE == current.op ) {
+					local += static_cast<real>( current.b );
+				} else {
+					local -= static_cast<real>( current.b );
+				}
+			}
+
+			//////////////////////////////////////////////////////////////////////////
+			/// Summary: LOAD_ELEMENT and STORE_ELEMENT.  Elements of one dimensional
+			/// arrays at an integer index are found here, the VM does the rest and
+			/// reports the errors
+			inline void Runtime::load_element( int32_t pc ) {
+				auto const &current = instruction( pc );
+				auto const &index = variable( current.b );
+				if( index.is_set && ValueType::INTEGER == index.value.type( ) ) {
+					auto const found = array( current.a );
+					BasicValue value;
+					if( nullptr != found && found->get( index.value.integer_value( ), value ) ) {
+						stack.push_back( std::move( value ) );
+						return;
+					}
+				}
+				execute( pc );
+			}
+
+			inline void Runtime::store_element( int32_t pc ) {
+				auto const &current = instruction( pc );
+				auto const &index = variable( current.b );
+				if( index.is_set && ValueType::INTEGER == index.value.type( ) ) {
+					auto const found = array( current.a );
+					if( nullptr != found && found->set( index.value.integer_value( ), stack.back( ) ) ) {
+						stack.pop_back( );
+						return;
+					}
+				}
+				execute( pc );
+			}
+
+			template<typename T>
+			void Runtime::load_element( int32_t pc, T const &index, bool set ) {
+				auto const &current = instruction( pc );
+				if( set ) {
+					if( std::is_same<T, integer>::value ) {
+						auto const found = array( current.a );
+						BasicValue value;
+						if( nullptr != found && found->get( static_cast<integer>( index ), value ) ) {
+							stack.push_back( std::move( value ) );
+							return;
+						}
+					}
+					store( current.b, BasicValue( index ) );
+				}
+				execute( pc );
+			}
+
+			template<typename T>
+			void Runtime::store_element( int32_t pc, T const &index, bool set ) {
+				auto const &current = instruction( pc );
+				if( set ) {
+					if( std::is_same<T, integer>::value ) {
+						auto const found = array( current.a );
+						if( nullptr != found && found->set( static_cast<integer>( index ), stack.back( ) ) ) {
+							stack.pop_back( );
+							return;
+						}
+					}
+					store( current.b, BasicValue( index ) );
+				}
+				execute( pc );
+			}
+
+			//////////////////////////////////////////////////////////////////////////
+			/// Summary: FOR_LOOP at pc with its counter in a local
+			template<typename T>
+			bool Runtime::enter_loop( int32_t pc, T &counter, bool &set ) {
+				auto const runs = enter_loop( pc );
+				set = reload( instruction( pc ).a, counter );
+				return runs;
+			}
+
+			//////////////////////////////////////////////////////////////////////////
+			/// Summary: NEXT_LOOP with its counter in a local.  The counter is
+			/// stepped here like next_iteration does while it stays the type of
+			/// the local
+			inline bool Runtime::next_loop( int32_t symbol, size_t &body, integer &counter, bool &set ) {
+				if( set ) {
+					auto const loop = m_basic.m_loop_stack.find( static_cast<uint32_t>( symbol ) );
+					if( nullptr != loop && loop->is_integer ) {
+						auto const value = static_cast<int64_t>( counter ) + loop->integer_step;
+						if( fits( value ) ) {
+							counter = static_cast<integer>( value );
+							body = loop->body_pc;
+							if( 0 <= loop->integer_step ? value <= loop->integer_limit : value >= loop->integer_limit ) {
+								return true;
+							}
+							m_basic.m_loop_stack.pop( );
+							return false;
+						}
+					}
+					store( symbol, BasicValue( counter ) );
+				}
+				auto const runs = next_loop( symbol, body );
+				set = reload( symbol, counter );
+				return runs;
+			}
+
+			inline bool Runtime::next_loop( int32_t symbol, size_t &body, real &counter, bool &set ) {
+				if( set ) {
+					if( auto const loop = m_basic.m_loop_stack.find( static_cast<uint32_t>( symbol ) ) ) {
+						counter += loop->real_step;
+						body = loop->body_pc;
+						if( 0 <= loop->real_step ? counter <= loop->real_limit : counter >= loop->real_limit ) {
+							return true;
+						}
+						m_basic.m_loop_stack.pop( );
+						return false;
+					}
+				}
+				auto const runs = next_loop( symbol, body );
+				set = reload( symbol, counter );
+				return runs;
+			}
+
+			template<typename T>
+			void Runtime::print_variable( int32_t pc, T const &local, bool set ) {
+				if( set ) {
+					print( BasicValue( local ) );
+				} else {
+					print_variable( pc );
+				}
+			}
+
+			inline bool Runtime::fits( int64_t value ) {
+				return std::numeric_limits<integer>::min( ) <= value && value <= std::numeric_limits<integer>::max( );
+			}
+
+			//////////////////////////////////////////////////////////////////////////
+			/// Summary: ^ of unboxed integers.  False when the result is not an
+			/// integer, the tagged code then makes it real
+			inline bool Runtime::power( int64_t &lhs, int64_t rhs ) {
+				auto const value = std::pow( static_cast<real>( lhs ), static_cast<real>( rhs ) );
+				if( !( static_cast<real>( std::numeric_limits<integer>::min( ) ) <= value &&
+				       value <= static_cast<real>( std::numeric_limits<integer>::max( ) ) ) ) {
+					return false;
+				}
+				lhs = static_cast<integer>( value );
+				return true;
+			}
+		} // namespace aot
+	}   // namespace basic
+} // namespace daw
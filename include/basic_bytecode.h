@@ -0,0 +1,95 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#pragma once
+
+#include <cstdint>
+
+namespace daw {
+	namespace basic {
+		namespace bytecode {
+			//////////////////////////////////////////////////////////////////////////
+			/// Summary: Instructions understood by the Basic VM.  Operands a and b
+			/// are indexes into the pools of the compiled program unless noted.
+			/// Unboxed instructions work on a stack of plain numbers and continue
+			/// with the tagged code after them when a guard fails.  The ones after
+			/// BRANCH_UNBOXED up to PRINT_VARIABLE fuse the instructions of common
+			/// statements.  The *_IN_BOUNDS ones replace element instructions in FOR
+			/// loops over their index when COMPILED.  The last ones before KEYWORD
+			/// are only in TIERED mode
+			enum class OpCode : uint8_t {
+				LINE,               // a = index of line in program.  Marks start of line
+				PUSH_CONSTANT,      // a = constant
+				LOAD_VARIABLE,      // a = symbol of variable
+				LOAD_ARRAY,         // a = name, b = number of indexes on stack.  No indexes pushes a reference to the array
+				STORE_VARIABLE,     // a = symbol of variable
+				STORE_ARRAY,        // a = name, b = number of indexes on stack
+				CALL_FUNCTION,      // a = function, b = number of arguments on stack
+				UNARY_OPERATOR,     // a = Operator
+				BINARY_OPERATOR,    // a = Operator
+				USER_OPERATOR,      // a = operator.  Runs handler from m_binary_operators
+				DUPLICATE,          // Push a copy of the top of the stack
+				PRINT,              // Pop value and print it
+				PRINT_NEWLINE,
+				JUMP,               // a = program counter
+				JUMP_IF_FALSE,      // a = program counter.  Pops condition
+				SHORT_CIRCUIT,      // a = program counter after right operand, b = Operator AND or OR.  Pops left operand
+				TO_BOOLEAN,         // Replace the top of the stack with its boolean, the right operand of SHORT_CIRCUIT
+				GOTO,               // a = line number.  Replaced by JUMP when linked
+				GOSUB,              // a = line number, program counter once linked
+				RETURN,
+				FOR_LOOP,           // a = symbol of counter, b = program counter after NEXT.  Pops start, limit, step
+				NEXT_LOOP,          // a = symbol of counter
+				LOAD_INTEGER,       // a = symbol of variable, b = program counter of tagged code.  Unboxed
+				LOAD_REAL,          // a = symbol of variable, b = program counter of tagged code.  Unboxed
+				PUSH_INTEGER,       // a = value.  Unboxed
+				PUSH_REAL,          // a = constant.  Unboxed
+				INTEGER_OPERATOR,   // a = Operator, b = program counter of tagged code.  Unboxed
+				REAL_OPERATOR,      // a = Operator.  Unboxed
+				DUPLICATE_UNBOXED,
+				STORE_INTEGER,      // a = symbol of variable, b = program counter after tagged code.  Unboxed
+				STORE_REAL,         // a = symbol of variable, b = program counter after tagged code.  Unboxed
+				BRANCH_UNBOXED,     // a = program counter when false, b = program counter after tagged code
+				INCREMENT_VARIABLE, // a = symbol of variable, b = amount.  X = X + b
+				DECREMENT_VARIABLE, // a = symbol of variable, b = amount.  X = X - b
+				COMPARE_AND_JUMP,   // a = line number, program counter once linked, b = Operator.  Pops two values
+				LOAD_ELEMENT,       // a = name, b = symbol of index.  A( I )
+				STORE_ELEMENT,      // a = name, b = symbol of index.  A( I ) = value popped
+				PRINT_VARIABLE,     // a = symbol of variable
+				LOAD_IN_BOUNDS,     // a = name, b = symbol of counter.  LOAD_ELEMENT, unchecked once FOR checked the bounds
+				STORE_IN_BOUNDS,    // a = name, b = symbol of counter.  STORE_ELEMENT, unchecked once FOR checked the bounds
+				TIERED_GOSUB,       // a = line number, program counter once linked, b = parameters of GOSUB
+				TIERED_RETURN,      // Returns to the statement after the GOSUB on m_program_stack
+				EXIT_TO_LINE,       // a = line number.  Leaves for the interpreter, replaced by JUMP once compiled
+				KEYWORD,            // a = Keyword, b = parameters.  Runs built in keyword
+				USER_KEYWORD,       // a = keyword, b = parameters.  Runs handler from m_keywords
+				STOP,
+				END
+			};
+
+			struct Instruction {
+				OpCode op;
+				int32_t a;
+				int32_t b;
+			}; // struct Instruction
+		}    // namespace bytecode
+	}      // namespace basic
+} // namespace daw
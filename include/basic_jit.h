@@ -0,0 +1,58 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace daw {
+	namespace basic {
+		namespace jit {
+			//////////////////////////////////////////////////////////////////////////
+			/// Summary: Whether the library was built with the JIT and runs on a
+			/// machine it generates code for, x86-64 Linux
+			bool supported( ) noexcept;
+
+			//////////////////////////////////////////////////////////////////////////
+			/// Summary: Machine code in pages of its own.  The code is copied in while
+			/// the pages are writable and they are then made executable instead, so
+			/// they are never both.  entry is nullptr when the pages could not be
+			/// had
+			class NativeCode {
+				void *m_memory;
+				size_t m_size;
+
+			public:
+				NativeCode( ) noexcept;
+				explicit NativeCode( std::vector<uint8_t> const &code ) noexcept;
+				NativeCode( NativeCode const & ) = delete;
+				NativeCode &operator=( NativeCode const & ) = delete;
+				NativeCode( NativeCode &&other ) noexcept;
+				NativeCode &operator=( NativeCode &&other ) noexcept;
+				~NativeCode( );
+
+				void const *entry( ) const noexcept;
+			}; // class NativeCode
+		}    // namespace jit
+	}      // namespace basic
+} // namespace daw
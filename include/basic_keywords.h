@@ -0,0 +1,148 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace daw {
+	namespace basic {
+		//////////////////////////////////////////////////////////////////////////
+		/// Summary: The built in keywords.  They are dispatched by a switch to
+		/// member handlers of Basic.  Keywords added with add_keyword go through
+		/// m_keywords instead
+		enum class Keyword : uint8_t {
+			CLR,
+			CONT,
+			DELETE,
+			DIM,
+			END,
+			EXIT,
+			FOR,
+			FUNCTIONS,
+			GOSUB,
+			GOTO,
+			IF,
+			KEYWORDS,
+			LET,
+			LIST,
+			MAT,
+			NEW,
+			NEXT,
+			PRINT,
+			QUIT,
+			REM,
+			RETURN,
+			RUN,
+			SORT,
+			STEP,
+			STOP,
+			THEN,
+			TO,
+			VARS
+		};
+
+		namespace keywords {
+			// In the same order as Keyword
+			constexpr char const *names[] = {"CLR", "CONT", "DELETE", "DIM", "END", "EXIT", "FOR", "FUNCTIONS", "GOSUB",
+			                                 "GOTO", "IF", "KEYWORDS", "LET", "LIST", "MAT", "NEW", "NEXT", "PRINT", "QUIT",
+			                                 "REM", "RETURN", "RUN", "SORT", "STEP", "STOP", "THEN", "TO", "VARS"};
+			constexpr size_t count = sizeof( names ) / sizeof( names[0] );
+			constexpr size_t table_size = 64;
+
+			static_assert( static_cast<size_t>( Keyword::VARS ) + 1 == count, "names must match Keyword" );
+
+			constexpr size_t length( char const *str ) {
+				size_t result = 0;
+				while( '\0' != str[result] ) {
+					++result;
+				}
+				return result;
+			}
+
+			constexpr size_t hash( char const *name, size_t size, uint32_t seed ) {
+				uint32_t result = 0;
+				for( size_t n = 0; n < size; ++n ) {
+					result = result * seed + static_cast<unsigned char>( name[n] );
+				}
+				return ( result ^ ( result >> 15 ) ) % table_size;
+			}
+
+			struct Table {
+				uint32_t seed;
+				uint8_t slots[table_size]; // Keyword + 1, 0 when empty
+			};
+
+			constexpr bool try_seed( uint32_t seed, Table &table ) {
+				for( auto &slot : table.slots ) {
+					slot = 0;
+				}
+				for( size_t n = 0; n < count; ++n ) {
+					auto &slot = table.slots[hash( names[n], length( names[n] ), seed )];
+					if( 0 != slot ) {
+						return false;
+					}
+					slot = static_cast<uint8_t>( n + 1 );
+				}
+				table.seed = seed;
+				return true;
+			}
+
+			//////////////////////////////////////////////////////////////////////////
+			/// Summary: Search for a multiplier that hashes every keyword to its own
+			/// slot.  Runs at compile time so adding a keyword needs no tuning
+			constexpr Table make_table( ) {
+				Table table{0, {}};
+				for( uint32_t seed = 1; seed < 100000; ++seed ) {
+					if( try_seed( seed, table ) ) {
+						return table;
+					}
+				}
+				return Table{0, {}};
+			}
+
+			constexpr Table table = make_table( );
+			static_assert( 0 != table.seed, "No perfect hash for the keywords.  Increase table_size" );
+
+			//////////////////////////////////////////////////////////////////////////
+			/// Summary: Find the built in keyword called name.  name must be upper
+			/// case
+			constexpr bool find( char const *name, size_t size, Keyword &keyword ) {
+				auto const slot = table.slots[hash( name, size, table.seed )];
+				if( 0 == slot ) {
+					return false;
+				}
+				auto const candidate = names[slot - 1];
+				for( size_t n = 0; n < size; ++n ) {
+					if( candidate[n] != name[n] ) {
+						return false;
+					}
+				}
+				if( '\0' != candidate[size] ) {
+					return false;
+				}
+				keyword = static_cast<Keyword>( slot - 1 );
+				return true;
+			}
+		} // namespace keywords
+	}   // namespace basic
+} // namespace daw
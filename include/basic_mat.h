@@ -0,0 +1,91 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "basic_value.h"
+
+namespace daw {
+	namespace basic {
+		namespace mat {
+			//////////////////////////////////////////////////////////////////////////
+			/// Summary: The instructions the kernels of MAT and the reductions of
+			/// arrays are written with.  Each kernel gives the same results, bit for
+			/// bit, as the others
+			enum class Kernel : uint8_t { SCALAR, SSE2, AVX2 };
+
+			//////////////////////////////////////////////////////////////////////////
+			/// Summary: Whether the library was built with kernel and the machine
+			/// runs it.  SCALAR always is
+			bool supported( Kernel kernel ) noexcept;
+
+			//////////////////////////////////////////////////////////////////////////
+			/// Summary: The widest supported kernel, found once
+			Kernel best_kernel( ) noexcept;
+
+			//////////////////////////////////////////////////////////////////////////
+			/// Summary: The name of kernel in lower case, such as "avx2"
+			char const *kernel_name( Kernel kernel ) noexcept;
+
+			// result may be lhs, rhs or values in the element wise operations
+			void add( Kernel kernel, real const *lhs, real const *rhs, real *result, size_t size ) noexcept;
+			void subtract( Kernel kernel, real const *lhs, real const *rhs, real *result, size_t size ) noexcept;
+			void scale( Kernel kernel, real factor, real const *values, real *result, size_t size ) noexcept;
+
+			//////////////////////////////////////////////////////////////////////////
+			/// Summary: result = lhs * rhs of a rows x inner and an inner x columns
+			/// matrix.  Matrices are stored like arrays, element ( i, j ) at
+			/// i + j * rows, and result must not overlap lhs or rhs.  Every element
+			/// is summed in the order of inner so blocking does not change it
+			void multiply( Kernel kernel, real const *lhs, real const *rhs, real *result, size_t rows, size_t inner,
+			               size_t columns ) noexcept;
+
+			//////////////////////////////////////////////////////////////////////////
+			/// Summary: result = the transpose of a rows x columns matrix.  result
+			/// must not overlap values
+			void transpose( real const *values, real *result, size_t rows, size_t columns ) noexcept;
+
+			//////////////////////////////////////////////////////////////////////////
+			/// Summary: How sum adds reals.  COMPENSATED carries the rounding error
+			/// of each addition along, Kahan style, so long sums stay accurate
+			enum class Summation : uint8_t { FAST, COMPENSATED };
+
+			//////////////////////////////////////////////////////////////////////////
+			/// Summary: Reductions of the elements of arrays.  Reals are reduced in
+			/// sixteen lanes, element n in lane n % 16, that are combined in a fixed
+			/// order so every kernel gives the same result.  minimum and maximum
+			/// require at least one element
+			real sum( Kernel kernel, Summation summation, real const *values, size_t size ) noexcept;
+			real minimum( Kernel kernel, real const *values, size_t size ) noexcept;
+			real maximum( Kernel kernel, real const *values, size_t size ) noexcept;
+			real dot( Kernel kernel, real const *lhs, real const *rhs, size_t size ) noexcept;
+
+			// Integers are reduced exactly, the sum of any array of them fits
+			int64_t sum( Kernel kernel, integer const *values, size_t size ) noexcept;
+			integer minimum( Kernel kernel, integer const *values, size_t size ) noexcept;
+			integer maximum( Kernel kernel, integer const *values, size_t size ) noexcept;
+			bool dot( integer const *lhs, integer const *rhs, size_t size, int64_t &result ) noexcept; // false on overflow
+		} // namespace mat
+	}   // namespace basic
+} // namespace daw
@@ -0,0 +1,84 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace daw {
+	namespace basic {
+		//////////////////////////////////////////////////////////////////////////
+		/// Summary: The built in operators.  They are applied by typed kernels
+		/// selected with a switch.  Operators added with add_binary_operator go
+		/// through m_binary_operators instead
+		enum class Operator : uint8_t {
+			POWER,
+			MULTIPLY,
+			DIVIDE,
+			MODULO,
+			ADD,
+			SUBTRACT,
+			EQUAL,
+			LESS,
+			LESS_EQUAL,
+			GREATER,
+			GREATER_EQUAL,
+			AND,
+			OR,
+			NEGATE // Never crunched, a SUBTRACT with no left hand side
+		};
+
+		enum class Associativity : uint8_t { LEFT, RIGHT };
+
+		namespace operators {
+			struct Info {
+				char const *name;
+				uint8_t precedence; // Lower binds tighter
+				Associativity associativity;
+				uint8_t arity;
+			};
+
+			// In the same order as Operator
+			constexpr Info table[] = {{"^", 2, Associativity::LEFT, 2},   {"*", 3, Associativity::LEFT, 2},
+			                          {"/", 3, Associativity::LEFT, 2},   {"%", 4, Associativity::LEFT, 2},
+			                          {"+", 4, Associativity::LEFT, 2},   {"-", 4, Associativity::LEFT, 2},
+			                          {"=", 7, Associativity::LEFT, 2},   {"<", 6, Associativity::LEFT, 2},
+			                          {"<=", 6, Associativity::LEFT, 2},  {">", 6, Associativity::LEFT, 2},
+			                          {">=", 6, Associativity::LEFT, 2},  {"AND", 8, Associativity::LEFT, 2},
+			                          {"OR", 9, Associativity::LEFT, 2},  {"NEG", 1, Associativity::RIGHT, 1}};
+			constexpr size_t count = sizeof( table ) / sizeof( table[0] );
+
+			static_assert( static_cast<size_t>( Operator::NEGATE ) + 1 == count, "table must match Operator" );
+
+			constexpr uint8_t unary_precedence = 1;
+			constexpr uint8_t lowest_precedence = 9;
+
+			constexpr Info const &info( Operator oper ) {
+				return table[static_cast<size_t>( oper )];
+			}
+
+			constexpr bool is_comparison( Operator oper ) {
+				return Operator::EQUAL <= oper && oper <= Operator::GREATER_EQUAL;
+			}
+		} // namespace operators
+	}   // namespace basic
+} // namespace daw
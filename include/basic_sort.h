@@ -0,0 +1,54 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#pragma once
+
+#include <boost/utility/string_ref.hpp>
+#include <cstddef>
+#include <vector>
+
+#include "basic_value.h"
+
+namespace daw {
+	namespace basic {
+		namespace parallel {
+			//////////////////////////////////////////////////////////////////////////
+			/// Summary: Threads a sort is split across, one per core.  Arrays too
+			/// small to gain from more are sorted on the calling thread
+			size_t thread_count( ) noexcept;
+
+			//////////////////////////////////////////////////////////////////////////
+			/// Summary: Sort values in ascending order.  -0 goes before 0 and NaN
+			/// after every other real, so equal numbers cannot be told apart and
+			/// there is no stable version
+			void sort( integer *values, size_t size );
+			void sort( real *values, size_t size );
+
+			//////////////////////////////////////////////////////////////////////////
+			/// Summary: Where each element of values goes when sorted, element n of
+			/// the result is values[order[n]].  stable keeps equal values in the
+			/// order they were in
+			std::vector<size_t> order( integer const *values, size_t size, bool stable );
+			std::vector<size_t> order( real const *values, size_t size, bool stable );
+			std::vector<size_t> order( boost::string_ref const *values, size_t size, bool stable );
+		} // namespace parallel
+	}   // namespace basic
+} // namespace daw
@@ -0,0 +1,51 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#pragma once
+
+#include <cstdint>
+
+namespace daw {
+	namespace basic {
+		enum class TokenType : uint8_t {
+			KEYWORD,       // value = Keyword
+			USER_KEYWORD,  // value = symbol of keyword added with add_keyword
+			IDENTIFIER,    // value = symbol of name
+			INTEGER,       // value = the integer
+			LITERAL,       // value = index into literals of line.  Reals and strings
+			OPERATOR,      // value = Operator
+			USER_OPERATOR, // value = symbol of operator added with add_binary_operator
+			OPEN_BRACKET,  // (
+			CLOSE_BRACKET, // )
+			COMMA,         // ,
+			COLON          // : statement separator
+		};
+
+		//////////////////////////////////////////////////////////////////////////
+		/// Summary: A crunched token.  Lines are tokenized once when entered and
+		/// everything that runs them works from the tokens
+		struct Token {
+			TokenType type;
+			uint16_t position; // Offset of token in line text
+			uint32_t value;
+		}; // struct Token
+	}    // namespace basic
+} // namespace daw
@@ -0,0 +1,257 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#pragma once
+
+#include <boost/utility/string_ref.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace daw {
+	namespace basic {
+		enum class ValueType : uint8_t { EMPTY, STRING, INTEGER, REAL, BOOLEAN, ARRAY };
+		using boolean = bool;
+		using real = double;
+		using integer = int32_t;
+
+		//////////////////////////////////////////////////////////////////////////
+		/// Summary: A set of ValueType's.  Describes what a variable may hold or
+		/// a function may return when a program is analysed before it runs
+		using ValueTypes = uint8_t;
+
+		constexpr ValueTypes value_types( ValueType type ) noexcept {
+			return static_cast<ValueTypes>( 1u << static_cast<uint8_t>( type ) );
+		}
+
+		constexpr ValueTypes numeric_value_types =
+		  static_cast<ValueTypes>( value_types( ValueType::INTEGER ) | value_types( ValueType::REAL ) );
+		constexpr ValueTypes any_value_types = 0xFF;
+
+		//////////////////////////////////////////////////////////////////////////
+		/// Summary: A value of any Basic type in 16 bytes.  Numbers and booleans
+		/// are stored inline as are strings of up to 14 characters.  Longer
+		/// strings own a buffer on the heap.  An ARRAY refers to an array it does
+		/// not own, for the arguments of functions that take arrays.  Every
+		/// alternative starts with the type so it can be read through any of them
+		class BasicValue {
+			static constexpr uint8_t large_string = 0xFF;
+
+			struct Empty {
+				ValueType type;
+				uint8_t size;
+			};
+
+			template<typename T>
+			struct Inline {
+				ValueType type;
+				uint8_t size;
+				T value;
+			};
+
+			struct SmallString {
+				ValueType type;
+				uint8_t size;
+				char data[14];
+			};
+
+			struct LargeString {
+				ValueType type;
+				uint8_t size; // Always large_string
+				uint32_t length;
+				char *data;
+			};
+
+			struct Reference {
+				ValueType type;
+				uint8_t size;
+				void const *target;
+			};
+
+			union {
+				Empty m_empty;
+				Inline<integer> m_integer;
+				Inline<real> m_real;
+				Inline<boolean> m_boolean;
+				SmallString m_small;
+				LargeString m_large;
+				Reference m_reference;
+			};
+
+			bool is_large( ) const noexcept {
+				return ValueType::STRING == m_empty.type && large_string == m_empty.size;
+			}
+
+			void copy_from( BasicValue const &other ) {
+				switch( other.m_empty.type ) {
+				case ValueType::INTEGER:
+					m_integer = other.m_integer;
+					break;
+				case ValueType::REAL:
+					m_real = other.m_real;
+					break;
+				case ValueType::BOOLEAN:
+					m_boolean = other.m_boolean;
+					break;
+				case ValueType::STRING:
+					if( other.is_large( ) ) {
+						// Allocate before touching *this so a throwing new leaves it as it was
+						char *const data = new char[other.m_large.length];
+						std::memcpy( data, other.m_large.data, other.m_large.length );
+						m_large = other.m_large;
+						m_large.data = data;
+					} else {
+						m_small = other.m_small;
+					}
+					break;
+				case ValueType::ARRAY:
+					m_reference = other.m_reference;
+					break;
+				case ValueType::EMPTY:
+					m_empty = other.m_empty;
+					break;
+				}
+			}
+
+			void move_from( BasicValue &other ) noexcept {
+				if( other.is_large( ) ) {
+					m_large = other.m_large;
+					other.m_empty = Empty{ValueType::EMPTY, 0};
+				} else {
+					copy_from( other );
+				}
+			}
+
+			void release( ) noexcept {
+				if( is_large( ) ) {
+					delete[] m_large.data;
+				}
+				m_empty = Empty{ValueType::EMPTY, 0};
+			}
+
+		public:
+			static constexpr size_t small_string_capacity = sizeof( SmallString::data );
+
+			// Where the type and the numbers are kept, for machine code that reads
+			// and writes values directly.  A value of another type is replaced by
+			// writing the type with a size of 0 and then the number
+			static constexpr size_t type_offset( ) noexcept {
+				return offsetof( Empty, type );
+			}
+
+			static constexpr size_t integer_offset( ) noexcept {
+				return offsetof( Inline<integer>, value );
+			}
+
+			static constexpr size_t real_offset( ) noexcept {
+				return offsetof( Inline<real>, value );
+			}
+
+			static constexpr size_t boolean_offset( ) noexcept {
+				return offsetof( Inline<boolean>, value );
+			}
+
+			BasicValue( ) noexcept : m_empty{ValueType::EMPTY, 0} {}
+			explicit BasicValue( integer value ) noexcept : m_integer{ValueType::INTEGER, 0, value} {}
+			explicit BasicValue( real value ) noexcept : m_real{ValueType::REAL, 0, value} {}
+			explicit BasicValue( boolean value ) noexcept : m_boolean{ValueType::BOOLEAN, 0, value} {}
+
+			explicit BasicValue( boost::string_ref value ) : m_empty{ValueType::STRING, 0} {
+				if( value.size( ) <= small_string_capacity ) {
+					m_small.size = static_cast<uint8_t>( value.size( ) );
+					std::memcpy( m_small.data, value.data( ), value.size( ) );
+				} else {
+					m_large = LargeString{ValueType::STRING, large_string, static_cast<uint32_t>( value.size( ) ),
+					                      new char[value.size( )]};
+					std::memcpy( m_large.data, value.data( ), value.size( ) );
+				}
+			}
+
+			// An ARRAY referring to array, which must outlive it
+			static BasicValue array_reference( void const *array ) noexcept {
+				BasicValue result;
+				result.m_reference = Reference{ValueType::ARRAY, 0, array};
+				return result;
+			}
+
+			BasicValue( BasicValue const &other ) : m_empty{ValueType::EMPTY, 0} {
+				copy_from( other );
+			}
+
+			BasicValue( BasicValue &&other ) noexcept : m_empty{ValueType::EMPTY, 0} {
+				move_from( other );
+			}
+
+			BasicValue &operator=( BasicValue const &rhs ) {
+				if( this != &rhs ) {
+					// Copy first, the old value is only released once the copy exists
+					BasicValue copy( rhs );
+					release( );
+					move_from( copy );
+				}
+				return *this;
+			}
+
+			BasicValue &operator=( BasicValue &&rhs ) noexcept {
+				if( this != &rhs ) {
+					release( );
+					move_from( rhs );
+				}
+				return *this;
+			}
+
+			~BasicValue( ) {
+				release( );
+			}
+
+			ValueType type( ) const noexcept {
+				return m_empty.type;
+			}
+
+			// The accessors do not check the type
+			integer integer_value( ) const noexcept {
+				return m_integer.value;
+			}
+
+			real real_value( ) const noexcept {
+				return m_real.value;
+			}
+
+			boolean boolean_value( ) const noexcept {
+				return m_boolean.value;
+			}
+
+			void const *array_value( ) const noexcept {
+				return m_reference.target;
+			}
+
+			boost::string_ref string_value( ) const noexcept {
+				if( is_large( ) ) {
+					return boost::string_ref( m_large.data, m_large.length );
+				}
+				return boost::string_ref( m_small.data, m_small.size );
+			}
+		}; // class BasicValue
+
+		static_assert( sizeof( BasicValue ) <= 16, "BasicValue must fit in 16 bytes" );
+	} // namespace basic
+} // namespace daw
@@ -22,33 +22,93 @@
 #pragma once
 
 #include <array>
-#include <boost/any.hpp>
 #include <boost/utility/string_ref.hpp>
 #include <cstdint>
 #include <functional>
+#include <limits>
 #include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
-#include "mostlyimmutable.h"
+#include "basic_bytecode.h"
+#include "basic_jit.h"
+#include "basic_keywords.h"
+#include "basic_operators.h"
+#include "basic_token.h"
+#include "basic_value.h"
 
 namespace daw {
 	namespace basic {
 		enum class ErrorTypes { SYNTAX, FATAL };
-		enum class ValueType { EMPTY, STRING, INTEGER, REAL, BOOLEAN, ARRAY };
-		using BasicValue = std::pair<ValueType, boost::any>;
-		using boolean = bool;
-		using real = double;
-		using integer = int32_t;
+		enum class ExecutionMode { INTERPRETED, COMPILED, TIERED }; // TIERED compiles lines once they are hot
+		enum class DispatchMode { SWITCH, THREADED }; // How the compiled program picks the next instruction
 
 		using BasicFunction = std::function<BasicValue( std::vector<BasicValue> )>;
-		using BasicUnaryOperand = std::function<BasicValue( BasicValue )>;
 		using BasicBinaryOperand = std::function<BasicValue( BasicValue, BasicValue )>;
-		using BasicKeyword = std::function<bool( boost::string_ref )>;
-		using ProgramLine = std::pair<integer, boost::string_ref>;
+
+		//////////////////////////////////////////////////////////////////////////
+		/// Summary: A program line crunched into tokens.  The text is kept for
+		/// LIST and the tokens refer to it by position.  Reals and strings are
+		/// parsed once into literals
+		struct ProgramLine {
+			integer number;
+			std::string text;
+			std::vector<Token> tokens;
+			std::vector<BasicValue> literals;
+
+			ProgramLine( );
+			ProgramLine( integer line_number, std::string line_text );
+		}; // struct ProgramLine
+
 		using ProgramType = std::vector<ProgramLine>;
 
+		//////////////////////////////////////////////////////////////////////////
+		/// Summary: How often the interpreter started a line of the program last
+		/// run in TIERED mode, and whether the line was compiled
+		struct LineProfile {
+			integer line_number;
+			size_t executions;
+			bool compiled;
+		};
+
+		//////////////////////////////////////////////////////////////////////////
+		/// Summary: Lines compiled together in TIERED mode once line_number had
+		/// been started executions times
+		struct TierTransition {
+			integer line_number;
+			size_t executions;
+			integer first_line;
+			integer last_line;
+		};
+
+		//////////////////////////////////////////////////////////////////////////
+		/// Summary: What the JIT did in the program last run with it.  Deopts are
+		/// guards of the machine code that failed and handed the statement they
+		/// were in back to the VM
+		struct JitStatistics {
+			size_t traces;
+			size_t entries;
+			size_t deopts;
+		};
+
+		//////////////////////////////////////////////////////////////////////////
+		/// Summary: A range of tokens within a line.  Used for statements and the
+		/// expressions within them
+		struct StatementTokens {
+			ProgramLine const *line;
+			size_t first;
+			size_t last;
+
+			bool empty( ) const;
+			size_t size( ) const;
+			Token const &operator[]( size_t pos ) const;
+			StatementTokens sub_range( size_t pos, size_t count = std::numeric_limits<size_t>::max( ) ) const;
+			boost::string_ref text( ) const;
+		}; // struct StatementTokens
+
+		using BasicKeyword = std::function<bool( StatementTokens )>;
+
 		struct BasicException : public std::runtime_error {
 			BasicException( ) = delete;
 			~BasicException( );
@@ -62,7 +122,21 @@ namespace daw {
 			ErrorTypes error_type;
 		}; // struct BasicException
 
+		//////////////////////////////////////////////////////////////////////////
+		/// Summary: Apply a built in binary operator the way a running program
+		/// does, with the typed kernels and overflow promotion
+		BasicValue evaluate_operator( Operator oper, BasicValue const &lhs, BasicValue const &rhs );
+
+		namespace aot {
+			class Runtime;
+			class Translator;
+		} // namespace aot
+
 		class Basic {
+			// Programs translated to C++ run on the compiled program of a Basic
+			friend class aot::Runtime;
+			friend class aot::Translator;
+
 		private:
 			struct ConstantType {
 				std::string description;
@@ -74,108 +148,344 @@ namespace daw {
 			struct FunctionType {
 				std::string description;
 				BasicFunction func;
-				FunctionType( ) {}
-				FunctionType( std::string Description, BasicFunction Function )
-				  : description( Description ), func( Function ) {}
+				ValueTypes result; // What func may return
+				bool pure;         // Same result for the same arguments.  Called once by the compiler on constants
+				bool arrays;       // Names alone as arguments are passed as ARRAY references to arrays
+				FunctionType( ) : result( any_value_types ), pure( false ), arrays( false ) {}
+				FunctionType( std::string Description, BasicFunction Function, ValueTypes Result = any_value_types,
+				              bool Pure = false )
+				  : description( Description ), func( Function ), result( Result ), pure( Pure ), arrays( false ) {}
+			};
+
+			struct BinaryOperatorType {
+				uint8_t precedence;
+				BasicBinaryOperand func;
+			};
+
+			struct Variable {
+				BasicValue value;
+				bool is_set = false;
 			};
 
+			//////////////////////////////////////////////////////////////////////////
+			/// Summary: An array made by DIM.  The suffix of its name chooses what it
+			/// holds.  A% holds integers and A# reals, in buffers of those numbers,
+			/// A$ holds strings and other names any value.  Numbers start as 0 and
+			/// strings as "" while elements of other arrays are empty until set
 			class BasicArray {
+			public:
+				enum class ElementType : uint8_t { ANY, INTEGER, REAL, STRING };
+				static constexpr size_t max_dimensions = 8;
+
+				//////////////////////////////////////////////////////////////////////////
+				/// Summary: The indexes of one element.  Held in place so addressing an
+				/// element allocates nothing
+				struct Indexes {
+					std::array<integer, max_dimensions> values;
+					size_t size;
+				}; // struct Indexes
+
+			private:
 				std::vector<size_t> m_dimensions;
-				std::vector<BasicValue> m_values;
+				std::vector<size_t> m_strides; // Elements between consecutive indexes of each dimension, set by DIM
+				ElementType m_type;
+				std::vector<BasicValue> m_values; // ANY and STRING
+				std::vector<integer> m_integers;
+				std::vector<real> m_reals;
+
+				size_t position( Indexes const &indexes ) const;
+				bool fits( BasicValue const &value ) const;
+				BasicException type_mismatch( std::string const &value ) const;
 
 			public:
 				BasicArray( );
-				BasicArray( std::vector<size_t> dimensions );
+				BasicArray( std::vector<size_t> dimensions, ElementType type = ElementType::ANY );
 				BasicArray( BasicArray const &other );
 				BasicArray( BasicArray &&other );
 
 				BasicArray &operator=( BasicArray other );
 				bool operator==( BasicArray const &rhs ) const;
 
-				BasicValue &operator( )( std::vector<size_t> dimensions );
-				BasicValue const &operator( )( std::vector<size_t> dimensions ) const;
+				static ElementType element_type( boost::string_ref name );
+				ElementType element_type( ) const;
+
+				BasicValue at( size_t pos ) const;          // pos is not checked
+				bool store( size_t pos, BasicValue &value ); // pos is not checked.  false when value does not fit
+
+				Indexes indexes( BasicValue const *values, size_t count ) const;
+				bool offset( Indexes const &indexes, size_t &pos ) const noexcept; // false when out of bounds
+				BasicValue get( Indexes const &indexes ) const;
+				void set( Indexes const &indexes, BasicValue value );
+
+				// One dimensional arrays at an index in bounds.  Return false when the
+				// element is elsewhere or, for set, value is not of the element type
+				bool get( integer index, BasicValue &value ) const;
+				bool set( integer index, BasicValue &value );
+
+				BasicValue *element( integer index ); // nullptr unless holding any value, one dimensional and in bounds
+				integer *integer_element( integer index ); // Like element for arrays of integers
+				real *real_element( integer index );       // Like element for arrays of reals
 
 				std::vector<size_t> dimensions( ) const;
 				size_t total_items( ) const;
+
+				// Every element as a number, for MAT and the functions taking arrays
+				real *reals( );                   // nullptr unless holding reals
+				real const *reals( ) const;       // nullptr unless holding reals
+				integer const *integers( ) const; // nullptr unless holding integers
+				std::vector<real> to_reals( ) const;
+				void assign( std::vector<real> const &values );
+
+				// For SORT.  sort returns where each element came from, which is empty
+				// when numbers were sorted in place as keep_order was false
+				std::vector<size_t> sort( bool stable, bool keep_order );
+				void permute( std::vector<size_t> const &order ); // Element n becomes element order[n]
 			}; // class BasicArray
 
 			std::unique_ptr<Basic> m_basic;
-			std::unordered_map<std::string, std::function<bool( boost::string_ref )>> m_keywords;
-			std::unordered_map<std::string, BasicBinaryOperand> m_binary_operators;
-			std::unordered_map<std::string, BasicUnaryOperand> m_unary_operators;
-			std::unordered_map<std::string, BasicValue> m_variables;
+			std::unordered_map<std::string, BasicKeyword> m_keywords; // Added with add_keyword
+			std::unordered_map<std::string, BinaryOperatorType> m_binary_operators; // Added with add_binary_operator
+			std::vector<Variable> m_variables; // Indexed by symbol id, sized with m_symbols
 			std::unordered_map<std::string, BasicArray> m_arrays;
-			std::unordered_map<std::string, ConstantType> m_constants;
-			std::unordered_map<std::string, FunctionType> m_functions;
-			std::vector<ProgramType::iterator> m_program_stack; // GOSUB/RETURN
+			std::unordered_map<std::string, ConstantType> m_constants; // Added with add_constant, hide builtins
+			std::unordered_map<std::string, FunctionType> m_functions; // Added with add_function, hide builtins
 
-			struct LoopStackType {
-				class LoopType {
-				protected:
-					LoopType( ) = default;
+			//////////////////////////////////////////////////////////////////////////
+			/// Summary: The functions and constants every Basic starts with.  Built
+			/// once and shared, instances only hold what was added to them
+			struct Builtins {
+				std::unordered_map<std::string, FunctionType> functions;
+				std::unordered_map<std::string, ConstantType> constants;
+			};
+			static Builtins const &builtins( );
+			static void add_array_functions( Builtins &registry );
+			ConstantType const *find_constant( boost::string_ref name ) const;
+			FunctionType const *find_function( boost::string_ref name ) const;
+			std::vector<std::pair<ProgramType::iterator, size_t>> m_program_stack; // GOSUB/RETURN line and token
 
-				public:
-					virtual ~LoopType( );
-					virtual bool can_enter_loop_body( ) = 0;
+			//////////////////////////////////////////////////////////////////////////
+			/// Summary: The FOR loops being run.  The counter stays in its variable
+			/// so the body can change it.  Limit and step are kept unboxed so NEXT
+			/// does not evaluate anything
+			struct LoopStackType {
+				struct ForLoop {
+					uint32_t variable; // Symbol of counter
+					bool is_integer;
+					integer integer_limit;
+					integer integer_step;
+					real real_limit;
+					real real_step;
+					size_t body_pc;                  // When compiled
+					ProgramType::iterator body_line; // When interpreted
+					size_t body_token;
 				};
 
-				class ForLoop : public LoopType {
-					std::string m_variable_name;
-					daw::MostlyImmutable<BasicValue> m_start_value;
-					daw::MostlyImmutable<BasicValue> m_end_value;
-					daw::MostlyImmutable<BasicValue> m_step_value;
-					ForLoop( boost::string_ref variable_name, BasicValue start_value, BasicValue end_value,
-					         BasicValue step_value );
-
-				public:
-					static std::shared_ptr<LoopType> create_for_loop( ProgramType::iterator program_line );
-					bool can_enter_loop_body( ) override;
-					~ForLoop( ) = default;
-					ForLoop( ) = delete;
-					ForLoop( ForLoop const & ) = default;
-					ForLoop( ForLoop && ) = default;
-					ForLoop &operator=( ForLoop const & ) = default;
-					ForLoop &operator=( ForLoop && ) = default;
-				}; // class ForLoop
+				//////////////////////////////////////////////////////////////////////////
+				/// Summary: Where to continue when a loop does not run.  Found for each
+				/// FOR by matching it with its NEXT before the program runs
+				struct Position {
+					size_t line; // Index in m_program
+					size_t token;
+				};
 
 			private:
-				struct LoopStackValueType {
-					std::shared_ptr<LoopType> loop_control;
-					ProgramType::iterator start_of_loop;
-
-					LoopStackValueType( std::shared_ptr<LoopType> loopControl, ProgramType::iterator program_line );
-					LoopStackValueType( ) = delete;
-					~LoopStackValueType( ) = default;
-					LoopStackValueType( LoopStackValueType const & ) = default;
-					LoopStackValueType( LoopStackValueType && ) = default;
-					LoopStackValueType &operator=( LoopStackValueType const & ) = default;
-					LoopStackValueType &operator=( LoopStackValueType && ) = default;
-					bool can_enter_loop_body( );
-				}; // struct LoopStackValueType
-
-				std::vector<LoopStackValueType> loop_stack;
-				LoopStackValueType &peek_full( );
+				std::vector<ForLoop> loop_stack;
+				std::unordered_map<uint64_t, Position> loop_exits; // Keyed by position of FOR
 
 			public:
-				ProgramType::iterator peek( );
-				ProgramType::iterator pop( );
+				static uint64_t key( size_t line, size_t token );
+				void push( ForLoop loop );
+				ForLoop *find( uint32_t variable );
+				ForLoop *peek( );
+				void pop( );
 				bool empty( ) const;
 				size_t size( ) const;
-				void push( std::shared_ptr<LoopType> type_of_loop, ProgramType::iterator start_of_loop );
+				void clear( );
+				void add_exit( uint64_t for_key, Position exit );
+				Position const &exit( uint64_t for_key ) const;
 			} m_loop_stack;
 
 			std::vector<BasicValue> m_data_array;
 
-			std::vector<BasicValue> evaluate_parameters( boost::string_ref value );
+			//////////////////////////////////////////////////////////////////////////
+			/// Summary: Program compiled by RUN.  Names are stored upper case and
+			/// builtins are resolved to their handlers so that the VM does not lex
+			/// or hash anything but variable names while running
+			struct CompiledProgram {
+				std::vector<bytecode::Instruction> code;
+				std::vector<BasicValue> constants;
+				std::vector<std::string> names;
+				std::vector<FunctionType const *> functions;
+				std::vector<BasicBinaryOperand const *> binary_operators;
+				std::vector<BasicKeyword const *> keywords;
+				std::vector<StatementTokens> parameters;
+				std::unordered_map<integer, size_t> line_starts;
+				std::unordered_map<uint64_t, size_t> statement_starts; // By LoopStackType::key of line and token.  TIERED only
+				std::unordered_map<integer, size_t> exit_stubs;        // EXIT_TO_LINE by line number until it is compiled
+				std::vector<std::pair<size_t, integer>> open_loops; // FOR instruction and line, waiting for NEXT
+				std::vector<ValueTypes> variable_types; // Indexed by symbol id.  Empty unless inferred
+				std::unordered_map<size_t, std::vector<size_t>> hoisted; // *_IN_BOUNDS indexed by the counter, by FOR
+
+				void clear( );
+				int32_t add_constant( BasicValue value );
+				int32_t add_name( std::string name );
+				void emit( bytecode::OpCode op, int32_t a = 0, int32_t b = 0 );
+			} m_compiled;
+
+			enum class ExpressionKind { VALUE, LIST, ASSIGNMENT };
+
+			//////////////////////////////////////////////////////////////////////////
+			/// Summary: Expressions of program lines compiled the first time they
+			/// are evaluated.  Entries are found by line number and token range and
+			/// share the pools of program
+			struct ExpressionCache {
+				struct Entry {
+					size_t first_token;
+					size_t last_token;
+					ExpressionKind kind;
+					size_t first_pc;
+					size_t last_pc;
+				};
+				CompiledProgram program;
+				std::unordered_map<integer, std::vector<Entry>> lines;
+
+				void clear( );
+				void invalidate( integer line_number );
+			} m_expressions;
+			std::vector<BasicValue> m_evaluation_stack;
+
+			struct Compiler;
+			ExecutionMode m_execution_mode;
+			DispatchMode m_dispatch_mode;
+			bool m_optimize;      // Fold constants and reduce operators when compiling
+			bool m_short_circuit; // Skip the right operand of AND and OR when the left decides the result
+			void compile( );
+			void compile_lines( CompiledProgram &program, ProgramType::iterator first, ProgramType::iterator last );
+			bool infer_types( CompiledProgram &program );
+			void link( size_t first = 0 );
+			void hoist_bounds_checks( );
+			void check_hoisted_bounds( size_t for_pc, std::vector<BasicValue> const &stack );
+			std::vector<BasicArray *> m_hoisted; // By program counter, arrays FOR checked its counter against
+			int32_t exit_stub( integer line_number );
+			bool execute( size_t pc );
+			template<bool threaded>
+			bool execute_code( size_t pc );
+			bool run_compiled( integer line_number );
+			bool report_run_error( );
+
+			//////////////////////////////////////////////////////////////////////////
+			/// Summary: State of TIERED execution.  Lines are interpreted until the
+			/// interpreter has started them threshold times, then compiled into
+			/// m_compiled with the loops they are in
+			struct TierState {
+				size_t threshold;
+				std::vector<size_t> counts;                   // Indexed by line in m_program
+				std::vector<bool> failed;                     // Lines that did not compile and stay interpreted
+				std::vector<std::pair<size_t, size_t>> loops; // Lines of each FOR and of its NEXT
+				std::vector<TierTransition> transitions;
+				bool exited; // Compiled code stopped for the interpreter to continue from m_program_it
+			} m_tier;
+			size_t tier_up( size_t token );
+			bool compile_region( size_t hot );
+			size_t compiled_pc( ProgramType::iterator line, size_t token );
+
+			//////////////////////////////////////////////////////////////////////////
+			/// Summary: State of the JIT.  execute_code counts the backward jumps to
+			/// each pc and has the loop starting at a hot one translated into
+			/// machine code, which it calls from then on.  The machine code returns
+			/// the pc the VM continues from
+			struct JitContext {
+				Basic *basic;
+				Variable *variables;
+				int64_t line;    // Index in m_program of the last LINE run
+				uint64_t deopts; // Guards that failed
+			};
+
+			struct JitTarget {
+				uint32_t count;    // Backward jumps to it
+				int32_t trace;     // Index in code.  -1 until it is compiled, -2 when it will not be
+				uint32_t deopts;   // Of trace since it was compiled
+				uint32_t compiles; // Traces that ended up with too many deopts are compiled again
+			};
+
+			struct JitState {
+				bool enabled;
+				size_t threshold;
+				std::vector<JitTarget> targets; // Indexed by pc
+				std::vector<jit::NativeCode> code;
+				JitStatistics statistics;
+
+				void clear( );
+			} m_jit;
+
+			struct JitCompiler;
+			size_t jit_enter( size_t pc );
+			bool jit_compile( size_t pc );
+			static int64_t jit_next_loop( JitContext *context, uint32_t symbol ) noexcept;
+			static void *jit_element( BasicArray *array, integer index ) noexcept;
+
+			std::unordered_map<std::string, uint32_t> m_symbol_ids;
+			std::vector<std::string> m_symbols;
+			uint32_t intern( boost::string_ref name );
+			ProgramLine crunch( integer line_number, boost::string_ref text );
+
+			void execute_instruction( CompiledProgram const &program, bytecode::Instruction instruction,
+			                          std::vector<BasicValue> &stack );
+			void execute_expression( CompiledProgram const &program, size_t first, size_t last );
+			size_t evaluate_compiled( StatementTokens tokens, ExpressionKind kind );
+			BasicValue evaluate( StatementTokens expression );
+			std::vector<BasicValue> evaluate_parameters( StatementTokens parameters );
+			bool execute_line( ProgramLine const &line, bool show_ready, size_t first_token = 0 );
+			bool execute_statement( StatementTokens statement );
+			bool execute_keyword( Keyword keyword, StatementTokens params );
+			bool enter_loop( LoopStackType::ForLoop loop, BasicValue const &start, BasicValue const &limit,
+			                 BasicValue const &step );
+			bool next_iteration( LoopStackType::ForLoop const &loop );
+			void resolve_loops( );
+
+			bool keyword_clr( StatementTokens params );
+			bool keyword_cont( StatementTokens params );
+			bool keyword_delete( StatementTokens params );
+			bool keyword_dim( StatementTokens params );
+			bool keyword_end( StatementTokens params );
+			bool keyword_exit( StatementTokens params );
+			bool keyword_for( StatementTokens params );
+			bool keyword_functions( StatementTokens params );
+			bool keyword_gosub( StatementTokens params );
+			bool keyword_goto( StatementTokens params );
+			bool keyword_if( StatementTokens params );
+			bool keyword_keywords( StatementTokens params );
+			bool keyword_let( StatementTokens params );
+			bool keyword_list( StatementTokens params );
+			bool keyword_mat( StatementTokens params );
+			bool keyword_new( StatementTokens params );
+			bool keyword_next( StatementTokens params );
+			bool keyword_print( StatementTokens params );
+			bool keyword_quit( StatementTokens params );
+			bool keyword_rem( StatementTokens params );
+			bool keyword_return( StatementTokens params );
+			bool keyword_run( StatementTokens params );
+			bool keyword_sort( StatementTokens params );
+			bool keyword_step( StatementTokens params );
+			bool keyword_stop( StatementTokens params );
+			bool keyword_then( StatementTokens params );
+			bool keyword_to( StatementTokens params );
+			bool keyword_vars( StatementTokens params );
 
 			BasicException create_basic_exception( ErrorTypes error_type, std::string msg );
 			BasicValue exec_function( boost::string_ref name, std::vector<BasicValue> arguments );
 			BasicValue &get_variable( boost::string_ref name );
-			BasicValue &get_array_variable( boost::string_ref name, std::vector<BasicValue> params );
-			BasicValue &get_array_variable( boost::string_ref name );
-			std::pair<boost::string_ref, std::vector<BasicValue>>
-			split_arrayfunction_from_string( boost::string_ref value, bool throw_on_missing_bracket = true );
-			ProgramType m_program;
+			Variable *find_variable( boost::string_ref name );
+			BasicArray &find_array( std::string const &name );
+			std::string array_name( StatementTokens params, size_t &pos ) const;
+			bool dims_integer_array( ProgramLine const &line, boost::string_ref name ) const;
+			bool may_be_integer_array( std::string const &name ) const;
+			BasicValue get_array_variable( std::string const &name, BasicValue const *params, size_t count );
+			void set_array_variable( std::string const &name, BasicValue const *params, size_t count, BasicValue value );
+			BasicValue get_array_element( std::string const &name, uint32_t index_symbol );
+			void set_array_element( std::string const &name, uint32_t index_symbol, BasicValue value );
+			ProgramType m_program; // Sorted by line number.  Starts with a sentinel line -1
+			ProgramType::iterator lower_bound_line( integer line_number );
 			ProgramType::iterator find_line( integer line_number );
 			ProgramType::iterator first_line( );
 			ProgramType::iterator m_program_it;
@@ -186,11 +496,11 @@ namespace daw {
 			bool continue_run( );
 
 			bool is_array( boost::string_ref name );
-			bool is_binary_operator( boost::string_ref oper );
-			bool is_unary_operator( boost::string_ref oper );
-			bool let_helper( boost::string_ref parse_string, bool show_error = true );
+			bool let_helper( StatementTokens statement );
 			bool m_exiting;
+			bool m_jumped;
 			bool m_has_syntax_error;
+			size_t m_resume_token; // Token of line m_program_it + 1 to continue from after a jump
 			bool run( integer line_number = -1 );
 			static std::vector<std::string> split( std::string text, std::string delimiter );
 			static std::vector<std::string> split( std::string text, char delimiter );
@@ -200,7 +510,6 @@ namespace daw {
 			void init( );
 			void reset( );
 			void set_program_it( integer line_number, integer offset = 0 );
-			void sort_program_code( );
 
 		public:
 			Basic( );
@@ -211,6 +520,23 @@ namespace daw {
 			std::string list_keywords( );
 			std::string list_variables( );
 			BasicValue evaluate( boost::string_ref value );
+			ExecutionMode execution_mode( ) const;
+			void set_execution_mode( ExecutionMode mode );
+			DispatchMode dispatch_mode( ) const;
+			void set_dispatch_mode( DispatchMode mode );
+			bool optimize( ) const;
+			void set_optimize( bool enabled );
+			bool short_circuit( ) const;
+			void set_short_circuit( bool enabled );
+			size_t tier_threshold( ) const;
+			void set_tier_threshold( size_t threshold );
+			std::vector<LineProfile> line_profile( ) const;
+			std::vector<TierTransition> tier_transitions( ) const;
+			bool jit( ) const;
+			void set_jit( bool enabled );
+			size_t jit_threshold( ) const;
+			void set_jit_threshold( size_t threshold );
+			JitStatistics jit_statistics( ) const;
 			BasicValue &get_variable_constant( boost::string_ref name );
 			bool is_constant( boost::string_ref name );
 			bool is_function( boost::string_ref name );
@@ -218,9 +544,14 @@ namespace daw {
 			bool is_variable( boost::string_ref name );
 			bool parse_line( boost::string_ref parse_string, bool show_ready = true );
 			void add_constant( boost::string_ref name, std::string description, BasicValue value );
-			void add_function( boost::string_ref name, std::string description, BasicFunction func );
+			void add_function( boost::string_ref name, std::string description, BasicFunction func,
+			                   ValueTypes result = any_value_types );
+			void add_keyword( boost::string_ref name, BasicKeyword keyword );
+			void add_binary_operator( boost::string_ref name, uint8_t precedence, BasicBinaryOperand oper );
 			void add_line( integer line_number, boost::string_ref line );
 			void add_variable( boost::string_ref name, BasicValue value );
+			void invalidate_expressions( );
+			void invalidate_expressions( integer line_number );
 			void remove_array( boost::string_ref name, bool throw_on_nonexist = true );
 			void remove_constant( boost::string_ref name, bool throw_on_nonexist );
 			void remove_line( integer line );
@@ -0,0 +1,91 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Translates a saved BASIC program into C++.  The output is compiled with the
+// daw_basic headers and linked with daw_basic_lib:
+//   daw_basic_aot program.bas -o program.cpp
+//   c++ -std=c++14 -O2 -I include program.cpp -L build -ldaw_basic_lib -o program
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "basic_aot.h"
+
+int main( int argc, char *argv[] ) {
+	daw::basic::aot::Translator::Options options;
+	std::string input;
+	std::string output;
+	for( int n = 1; n < argc; ++n ) {
+		if( 0 == std::strcmp( argv[n], "-o" ) && n + 1 < argc ) {
+			output = argv[++n];
+		} else if( 0 == std::strcmp( argv[n], "--function" ) && n + 1 < argc ) {
+			// int name( ) runs the program instead of main, to link it into another program
+			options.entry = argv[++n];
+		} else if( 0 == std::strcmp( argv[n], "--no-optimize" ) ) {
+			options.optimize = false;
+		} else if( 0 == std::strcmp( argv[n], "--short-circuit" ) ) {
+			options.short_circuit = true;
+		} else if( input.empty( ) && '-' != argv[n][0] ) {
+			input = argv[n];
+		} else {
+			input.clear( );
+			break;
+		}
+	}
+	if( input.empty( ) ) {
+		std::cerr << "Usage: " << argv[0] << " program.bas [-o output.cpp] [--function name] [--no-optimize]\n"
+		          << "       [--short-circuit]\n";
+		return EXIT_FAILURE;
+	}
+
+	std::ifstream file( input );
+	if( !file ) {
+		std::cerr << "Cannot read " << input << '\n';
+		return EXIT_FAILURE;
+	}
+	std::stringstream program_text;
+	program_text << file.rdbuf( );
+	options.source = input;
+
+	std::string translation;
+	try {
+		translation = daw::basic::aot::Translator::translate( program_text.str( ), options );
+	} catch( std::exception const &ex ) {
+		std::cerr << input << ": " << ex.what( ) << '\n';
+		return EXIT_FAILURE;
+	}
+	if( output.empty( ) ) {
+		std::cout << translation;
+		return EXIT_SUCCESS;
+	}
+	std::ofstream out( output );
+	out << translation;
+	if( !out ) {
+		std::cerr << "Cannot write " << output << '\n';
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,664 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "basic_aot.h"
+
+namespace daw {
+	namespace basic {
+		namespace aot {
+			namespace {
+				std::string label( size_t pc ) {
+					return "pc_" + std::to_string( pc );
+				}
+
+				// A line of the program as a string literal
+				std::string quote( std::string const &text ) {
+					std::ostringstream result;
+					result << '"';
+					for( auto const c : text ) {
+						if( '"' == c || '\\' == c ) {
+							result << '\\' << c;
+						} else if( ' ' <= c && c <= '~' && '?' != c ) {
+							result << c;
+						} else {
+							// Octal so that no digit after it can be read as part of it
+							result << '\\' << std::oct << std::setw( 3 ) << std::setfill( '0' )
+							       << static_cast<unsigned>( static_cast<unsigned char>( c ) ) << std::dec;
+						}
+					}
+					result << "\\n\"";
+					return result.str( );
+				}
+
+				// A line of the program as a comment.  A backslash or trigraph could
+				// carry the comment on to the next line
+				std::string comment( std::string const &text ) {
+					std::string result;
+					for( auto const c : text ) {
+						result += ' ' <= c && c <= '~' && '\\' != c && '?' != c ? c : ' ';
+					}
+					return result;
+				}
+
+				std::string real_literal( real value ) {
+					if( std::isnan( value ) ) {
+						return "std::numeric_limits<real>::quiet_NaN( )";
+					}
+					if( std::isinf( value ) ) {
+						return 0 < value ? "std::numeric_limits<real>::infinity( )"
+						                 : "-std::numeric_limits<real>::infinity( )";
+					}
+					std::ostringstream result;
+					result << std::scientific << std::setprecision( std::numeric_limits<real>::max_digits10 ) << value;
+					return result.str( );
+				}
+
+				char const *operator_text( Operator oper ) {
+					switch( oper ) {
+					case Operator::MULTIPLY:
+						return "*";
+					case Operator::DIVIDE:
+						return "/";
+					case Operator::MODULO:
+						return "%";
+					case Operator::ADD:
+						return "+";
+					case Operator::SUBTRACT:
+						return "-";
+					case Operator::EQUAL:
+						return "==";
+					case Operator::LESS:
+						return "<";
+					case Operator::LESS_EQUAL:
+						return "<=";
+					case Operator::GREATER:
+						return ">";
+					case Operator::GREATER_EQUAL:
+						return ">=";
+					default:
+						return nullptr;
+					}
+				}
+			} // namespace
+
+			Translator::Options::Options( ) : source( ), entry( ), optimize( true ), short_circuit( false ) {}
+
+			Translator::Translator( std::string const &program_text, Options const &options )
+			  : m_runtime( program_text, options.optimize, options.short_circuit )
+			  , m_program( m_runtime.m_basic.m_compiled )
+			  , m_labels( m_program.code.size( ) + 1, false )
+			  , m_returns( )
+			  , m_locals( m_runtime.m_basic.m_symbols.size( ), ValueType::EMPTY )
+			  , m_bodies( m_runtime.m_basic.m_symbols.size( ), 0 )
+			  , m_slots( )
+			  , m_integer_slots( 0 )
+			  , m_real_slots( 0 )
+			  , m_code( ) {}
+
+			void Translator::fail( size_t pc, std::string const &message ) const {
+				throw BasicException( "Cannot translate instruction " + std::to_string( pc ) + ": " + message,
+				                      ErrorTypes::FATAL );
+			}
+
+			//////////////////////////////////////////////////////////////////////////
+			/// summary: Find the labels, the places RETURN and NEXT continue at, the
+			/// variables kept in locals and how many unboxed values are needed
+			void Translator::analyze( ) {
+				using bytecode::OpCode;
+				auto const &code = m_program.code;
+				auto const &types = m_program.variable_types;
+				std::vector<size_t> loops( m_locals.size( ), 0 ); // FOR of each counter
+				auto const jumped_to = [&]( int32_t pc ) { m_labels[static_cast<size_t>( pc )] = true; };
+				auto const returned_to = [&]( size_t pc ) {
+					m_labels[pc] = true;
+					m_returns.push_back( pc );
+				};
+				auto const variable = [&]( int32_t symbol ) {
+					auto const index = static_cast<size_t>( symbol );
+					auto const type = index < types.size( ) ? types[index] : any_value_types;
+					if( value_types( ValueType::INTEGER ) == type ) {
+						m_locals[index] = ValueType::INTEGER;
+					} else if( value_types( ValueType::REAL ) == type ) {
+						m_locals[index] = ValueType::REAL;
+					}
+				};
+
+				for( size_t pc = 0; pc < code.size( ); ++pc ) {
+					auto const &instruction = code[pc];
+					switch( instruction.op ) {
+					case OpCode::JUMP:
+					case OpCode::JUMP_IF_FALSE:
+					case OpCode::SHORT_CIRCUIT:
+						jumped_to( instruction.a );
+						break;
+					case OpCode::COMPARE_AND_JUMP:
+						jumped_to( instruction.a );
+						break;
+					case OpCode::GOSUB:
+						jumped_to( instruction.a );
+						returned_to( pc + 1 );
+						break;
+					case OpCode::FOR_LOOP: {
+						jumped_to( instruction.b );
+						returned_to( pc + 1 );
+						variable( instruction.a );
+						auto &loop = loops[static_cast<size_t>( instruction.a )];
+						m_bodies[static_cast<size_t>( instruction.a )] = 0 == loop ? pc + 1 : 0;
+						loop = pc + 1;
+					} break;
+					case OpCode::LOAD_INTEGER:
+					case OpCode::LOAD_REAL:
+					case OpCode::STORE_INTEGER:
+					case OpCode::STORE_REAL:
+						jumped_to( instruction.b );
+						variable( instruction.a );
+						break;
+					case OpCode::INTEGER_OPERATOR:
+						jumped_to( instruction.b );
+						break;
+					case OpCode::BRANCH_UNBOXED:
+						jumped_to( instruction.a );
+						jumped_to( instruction.b );
+						break;
+					case OpCode::LOAD_VARIABLE:
+					case OpCode::STORE_VARIABLE:
+					case OpCode::INCREMENT_VARIABLE:
+					case OpCode::DECREMENT_VARIABLE:
+					case OpCode::NEXT_LOOP:
+					case OpCode::PRINT_VARIABLE:
+						variable( instruction.a );
+						break;
+					case OpCode::LOAD_ELEMENT:
+					case OpCode::STORE_ELEMENT:
+					case OpCode::LOAD_IN_BOUNDS:
+					case OpCode::STORE_IN_BOUNDS:
+						variable( instruction.b );
+						break;
+					case OpCode::GOTO:
+					case OpCode::TIERED_GOSUB:
+					case OpCode::TIERED_RETURN:
+					case OpCode::EXIT_TO_LINE:
+						fail( pc, "Only programs compiled for RUN can be translated" );
+					default:
+						break;
+					}
+					advance( pc );
+				}
+				if( !m_slots.empty( ) ) {
+					fail( code.size( ), "The program ends inside unboxed code" );
+				}
+			}
+
+			//////////////////////////////////////////////////////////////////////////
+			/// summary: Move m_slots past the instruction at pc.  Unboxed values are
+			/// locals named by their type and place on the unboxed stack, which is
+			/// known for each instruction as unboxed code has no jumps into it
+			void Translator::advance( size_t pc ) {
+				using bytecode::OpCode;
+				auto const &instruction = m_program.code[pc];
+				auto const push = [&]( ValueType type ) {
+					m_slots.push_back( type );
+					auto &count = ValueType::INTEGER == type ? m_integer_slots : m_real_slots;
+					count = std::max( count, m_slots.size( ) );
+				};
+				auto const pop = [&]( ValueType type ) {
+					if( m_slots.empty( ) || type != m_slots.back( ) ) {
+						fail( pc, "Unexpected value on the unboxed stack" );
+					}
+					m_slots.pop_back( );
+				};
+				switch( instruction.op ) {
+				case OpCode::LOAD_INTEGER:
+				case OpCode::PUSH_INTEGER:
+					push( ValueType::INTEGER );
+					break;
+				case OpCode::LOAD_REAL:
+				case OpCode::PUSH_REAL:
+					push( ValueType::REAL );
+					break;
+				case OpCode::DUPLICATE_UNBOXED:
+					if( m_slots.empty( ) ) {
+						fail( pc, "Unexpected value on the unboxed stack" );
+					}
+					push( m_slots.back( ) );
+					break;
+				case OpCode::INTEGER_OPERATOR:
+				case OpCode::REAL_OPERATOR: {
+					auto const oper = static_cast<Operator>( instruction.a );
+					auto const type = OpCode::INTEGER_OPERATOR == instruction.op ? ValueType::INTEGER : ValueType::REAL;
+					if( Operator::NEGATE != oper ) {
+						pop( type );
+					}
+					pop( type );
+					push( operators::is_comparison( oper ) ? ValueType::INTEGER : type );
+				} break;
+				case OpCode::STORE_INTEGER:
+				case OpCode::BRANCH_UNBOXED:
+					pop( ValueType::INTEGER );
+					break;
+				case OpCode::STORE_REAL:
+					pop( ValueType::REAL );
+					break;
+				default:
+					if( !m_slots.empty( ) ) {
+						fail( pc, "Tagged instruction inside unboxed code" );
+					}
+					break;
+				}
+			}
+
+			std::string Translator::slot( size_t index ) const {
+				return ( ValueType::INTEGER == m_slots[index] ? "i" : "r" ) + std::to_string( index );
+			}
+
+			//////////////////////////////////////////////////////////////////////////
+			/// summary: The local of symbol and its flag, as arguments of Runtime
+			std::string Translator::local( int32_t symbol ) const {
+				return "v" + std::to_string( symbol ) + ", s" + std::to_string( symbol );
+			}
+
+			//////////////////////////////////////////////////////////////////////////
+			/// summary: Keywords are run by the Basic and may use any variable, so
+			/// those in locals are stored there before and taken back after
+			std::string Translator::flush_locals( ) const {
+				std::string result;
+				for( size_t symbol = 0; symbol < m_locals.size( ); ++symbol ) {
+					if( ValueType::EMPTY != m_locals[symbol] ) {
+						auto const n = std::to_string( symbol );
+						result += "\t\tif( s" + n + " ) {\n\t\t\trt.store( " + n + ", BasicValue( v" + n + " ) );\n\t\t}\n";
+					}
+				}
+				return result;
+			}
+
+			std::string Translator::reload_locals( ) const {
+				std::string result;
+				for( size_t symbol = 0; symbol < m_locals.size( ); ++symbol ) {
+					if( ValueType::EMPTY != m_locals[symbol] ) {
+						auto const n = std::to_string( symbol );
+						result += "\t\ts" + n + " = rt.reload( " + n + ", v" + n + " );\n";
+					}
+				}
+				return result;
+			}
+
+			void Translator::translate_instruction( size_t pc ) {
+				using bytecode::OpCode;
+				auto const &instruction = m_program.code[pc];
+				auto const current = std::to_string( pc );
+				auto const a = std::to_string( instruction.a );
+				auto const b = std::to_string( instruction.b );
+				auto const emit = [&]( std::string const &line ) { m_code += "\t\t" + line + "\n"; };
+				auto const is_local = [&]( int32_t symbol ) {
+					return ValueType::EMPTY != m_locals[static_cast<size_t>( symbol )];
+				};
+				auto const depth = m_slots.size( );
+
+				switch( instruction.op ) {
+				case OpCode::LINE: {
+					auto const &line = m_runtime.m_basic.m_program[static_cast<size_t>( instruction.a )];
+					emit( "// " + std::to_string( line.number ) + " " + comment( line.text ) );
+					emit( "rt.line( " + a + " );" );
+				} break;
+				case OpCode::LOAD_VARIABLE:
+					emit( is_local( instruction.a ) ? "rt.load( " + current + ", " + local( instruction.a ) + " );"
+					                                : "rt.execute( " + current + " );" );
+					break;
+				case OpCode::STORE_VARIABLE:
+					emit( is_local( instruction.a ) ? "rt.store( " + current + ", " + local( instruction.a ) + " );"
+					                                : "rt.execute( " + current + " );" );
+					break;
+				case OpCode::INCREMENT_VARIABLE:
+				case OpCode::DECREMENT_VARIABLE:
+					emit( is_local( instruction.a ) ? "rt.increment( " + current + ", " + local( instruction.a ) + " );"
+					                                : "rt.execute( " + current + " );" );
+					break;
+				case OpCode::LOAD_ELEMENT:
+				case OpCode::LOAD_IN_BOUNDS:
+					emit( is_local( instruction.b ) ? "rt.load_element( " + current + ", " + local( instruction.b ) + " );"
+					                                : "rt.load_element( " + current + " );" );
+					break;
+				case OpCode::STORE_ELEMENT:
+				case OpCode::STORE_IN_BOUNDS:
+					emit( is_local( instruction.b ) ? "rt.store_element( " + current + ", " + local( instruction.b ) + " );"
+					                                : "rt.store_element( " + current + " );" );
+					break;
+				case OpCode::PRINT_VARIABLE:
+					emit( is_local( instruction.a ) ? "rt.print_variable( " + current + ", " + local( instruction.a ) + " );"
+					                                : "rt.print_variable( " + current + " );" );
+					break;
+				case OpCode::PUSH_CONSTANT:
+				case OpCode::LOAD_ARRAY:
+				case OpCode::STORE_ARRAY:
+				case OpCode::CALL_FUNCTION:
+				case OpCode::UNARY_OPERATOR:
+				case OpCode::BINARY_OPERATOR:
+				case OpCode::USER_OPERATOR:
+				case OpCode::DUPLICATE:
+				case OpCode::TO_BOOLEAN:
+					emit( "rt.execute( " + current + " );" );
+					break;
+				case OpCode::PRINT:
+					emit( "rt.print( );" );
+					break;
+				case OpCode::PRINT_NEWLINE:
+					emit( "rt.print_newline( );" );
+					break;
+				case OpCode::JUMP:
+					emit( "goto " + label( static_cast<size_t>( instruction.a ) ) + ";" );
+					break;
+				case OpCode::JUMP_IF_FALSE:
+					emit( "if( !rt.condition( ) ) {" );
+					emit( "\tgoto " + label( static_cast<size_t>( instruction.a ) ) + ";" );
+					emit( "}" );
+					break;
+				case OpCode::SHORT_CIRCUIT:
+					emit( "if( rt.short_circuit( " + current + " ) ) {" );
+					emit( "\tgoto " + label( static_cast<size_t>( instruction.a ) ) + ";" );
+					emit( "}" );
+					break;
+				case OpCode::COMPARE_AND_JUMP:
+					emit( "if( rt.compare( " + current + " ) ) {" );
+					emit( "\tgoto " + label( static_cast<size_t>( instruction.a ) ) + ";" );
+					emit( "}" );
+					break;
+				case OpCode::GOSUB:
+					emit( "return_stack.push_back( " + std::to_string( pc + 1 ) + " );" );
+					emit( "goto " + label( static_cast<size_t>( instruction.a ) ) + ";" );
+					break;
+				case OpCode::RETURN:
+					emit( "if( return_stack.empty( ) ) {" );
+					emit( "\trt.fail( \"Attempt to RETURN without a preceding GOSUB\" );" );
+					emit( "}" );
+					emit( "target = return_stack.back( );" );
+					emit( "return_stack.pop_back( );" );
+					emit( "goto dispatch;" );
+					break;
+				case OpCode::FOR_LOOP:
+					emit( is_local( instruction.a ) ? "if( !rt.enter_loop( " + current + ", " + local( instruction.a ) + " ) ) {"
+					                                : "if( !rt.enter_loop( " + current + " ) ) {" );
+					emit( "\tgoto " + label( static_cast<size_t>( instruction.b ) ) + ";" );
+					emit( "}" );
+					break;
+				case OpCode::NEXT_LOOP: {
+					emit( is_local( instruction.a ) ? "if( rt.next_loop( " + a + ", target, " + local( instruction.a ) + " ) ) {"
+					                                : "if( rt.next_loop( " + a + ", target ) ) {" );
+					// Only its one FOR starts loops of the counter
+					auto const body = m_bodies[static_cast<size_t>( instruction.a )];
+					if( 0 != body ) {
+						emit( "\tif( " + std::to_string( body ) + " == target ) {" );
+						emit( "\t\tgoto " + label( body ) + ";" );
+						emit( "\t}" );
+					}
+					emit( "\tgoto dispatch;" );
+					emit( "}" );
+				} break;
+				case OpCode::LOAD_INTEGER:
+				case OpCode::LOAD_REAL: {
+					auto const integer_load = OpCode::LOAD_INTEGER == instruction.op;
+					auto const value = ( integer_load ? "i" : "r" ) + std::to_string( depth );
+					auto const load =
+					  std::string( integer_load ? "rt.load_integer( " : "rt.load_real( " ) + a + ", " + value + " )";
+					auto const tagged = "\tgoto " + label( static_cast<size_t>( instruction.b ) ) + ";";
+					auto const type = m_locals[static_cast<size_t>( instruction.a )];
+					if( ( integer_load ? ValueType::INTEGER : ValueType::REAL ) == type ) {
+						emit( "if( s" + a + " ) {" );
+						emit( "\t" + value + " = v" + a + ";" );
+						emit( "} else if( !" + load + " ) {" );
+					} else if( ValueType::EMPTY != type ) {
+						emit( "if( s" + a + " || !" + load + " ) {" );
+					} else {
+						emit( "if( !" + load + " ) {" );
+					}
+					emit( tagged );
+					emit( "}" );
+				} break;
+				case OpCode::PUSH_INTEGER:
+					emit( "i" + std::to_string( depth ) + " = " + a + ";" );
+					break;
+				case OpCode::PUSH_REAL:
+					emit( "r" + std::to_string( depth ) + " = " +
+					      real_literal( m_program.constants[static_cast<size_t>( instruction.a )].real_value( ) ) + ";" );
+					break;
+				case OpCode::DUPLICATE_UNBOXED:
+					emit( ( ValueType::INTEGER == m_slots.back( ) ? "i" : "r" ) + std::to_string( depth ) + " = " +
+					      slot( depth - 1 ) + ";" );
+					break;
+				case OpCode::INTEGER_OPERATOR: {
+					auto const oper = static_cast<Operator>( instruction.a );
+					auto const tagged = "\tgoto " + label( static_cast<size_t>( instruction.b ) ) + ";";
+					auto const result = Operator::NEGATE == oper ? slot( depth - 1 ) : slot( depth - 2 );
+					auto const rhs = slot( depth - 1 );
+					auto checked = true;
+					switch( oper ) {
+					case Operator::NEGATE:
+						emit( result + " = -" + result + ";" );
+						break;
+					case Operator::POWER:
+						emit( "if( !Runtime::power( " + result + ", " + rhs + " ) ) {" );
+						emit( tagged );
+						emit( "}" );
+						checked = false;
+						break;
+					case Operator::DIVIDE:
+					case Operator::MODULO:
+						emit( "if( 0 == " + rhs + " ) {" );
+						emit( tagged );
+						emit( "}" );
+						emit( result + " " + operator_text( oper ) + "= " + rhs + ";" );
+						break;
+					case Operator::MULTIPLY:
+					case Operator::ADD:
+					case Operator::SUBTRACT:
+						emit( result + " " + operator_text( oper ) + "= " + rhs + ";" );
+						break;
+					case Operator::AND:
+					case Operator::OR:
+						emit( "goto " + label( static_cast<size_t>( instruction.b ) ) + ";" );
+						checked = false;
+						break;
+					default:
+						emit( result + " = " + result + " " + operator_text( oper ) + " " + rhs + ";" );
+						checked = false;
+						break;
+					}
+					if( checked ) {
+						emit( "if( !Runtime::fits( " + result + " ) ) {" );
+						emit( tagged );
+						emit( "}" );
+					}
+				} break;
+				case OpCode::REAL_OPERATOR: {
+					auto const oper = static_cast<Operator>( instruction.a );
+					auto const lhs = Operator::NEGATE == oper ? slot( depth - 1 ) : slot( depth - 2 );
+					auto const rhs = slot( depth - 1 );
+					auto const result = "i" + std::to_string( depth - 2 );
+					switch( oper ) {
+					case Operator::NEGATE:
+						emit( lhs + " = -" + lhs + ";" );
+						break;
+					case Operator::POWER:
+						emit( lhs + " = std::pow( " + lhs + ", " + rhs + " );" );
+						break;
+					case Operator::EQUAL:
+						emit( result + " = Runtime::equal( " + lhs + ", " + rhs + " );" );
+						break;
+					case Operator::MULTIPLY:
+					case Operator::DIVIDE:
+					case Operator::ADD:
+					case Operator::SUBTRACT:
+						emit( lhs + " " + operator_text( oper ) + "= " + rhs + ";" );
+						break;
+					case Operator::LESS:
+					case Operator::LESS_EQUAL:
+					case Operator::GREATER:
+					case Operator::GREATER_EQUAL:
+						emit( result + " = " + lhs + " " + operator_text( oper ) + " " + rhs + ";" );
+						break;
+					default:
+						fail( pc, "Operator cannot be applied to unboxed reals" );
+					}
+				} break;
+				case OpCode::STORE_INTEGER:
+				case OpCode::STORE_REAL: {
+					auto const integer_store = OpCode::STORE_INTEGER == instruction.op;
+					auto const value = integer_store ? "static_cast<integer>( " + slot( depth - 1 ) + " )" : slot( depth - 1 );
+					auto const type = m_locals[static_cast<size_t>( instruction.a )];
+					if( ( integer_store ? ValueType::INTEGER : ValueType::REAL ) == type ) {
+						emit( "v" + a + " = " + value + ";" );
+						emit( "s" + a + " = true;" );
+					} else {
+						emit( "rt.store( " + a + ", BasicValue( " + value + " ) );" );
+						if( ValueType::EMPTY != type ) {
+							emit( "s" + a + " = false;" );
+						}
+					}
+					emit( "goto " + label( static_cast<size_t>( instruction.b ) ) + ";" );
+				} break;
+				case OpCode::BRANCH_UNBOXED:
+					emit( "if( 0 != " + slot( depth - 1 ) + " ) {" );
+					emit( "\tgoto " + label( static_cast<size_t>( instruction.b ) ) + ";" );
+					emit( "}" );
+					emit( "goto " + label( static_cast<size_t>( instruction.a ) ) + ";" );
+					break;
+				case OpCode::KEYWORD:
+				case OpCode::USER_KEYWORD:
+					m_code += flush_locals( );
+					emit( "more = rt.keyword( " + current + ", result );" );
+					m_code += reload_locals( );
+					emit( "if( !more ) {" );
+					emit( "\treturn result;" );
+					emit( "}" );
+					break;
+				case OpCode::STOP:
+					emit( "rt.stop( );" );
+					emit( "return true;" );
+					break;
+				case OpCode::END:
+					emit( "return true;" );
+					break;
+				case OpCode::GOTO:
+				case OpCode::TIERED_GOSUB:
+				case OpCode::TIERED_RETURN:
+				case OpCode::EXIT_TO_LINE:
+					fail( pc, "Only programs compiled for RUN can be translated" );
+				}
+			}
+
+			std::string Translator::translate( std::string const &program_text, Options const &options ) {
+				using bytecode::OpCode;
+				Translator translator( program_text, options );
+				translator.analyze( );
+				auto const &code = translator.m_program.code;
+				auto const uses = [&code]( OpCode op ) {
+					return std::any_of( std::begin( code ), std::end( code ),
+					                    [op]( bytecode::Instruction const &instruction ) { return op == instruction.op; } );
+				};
+
+				translator.m_slots.clear( );
+				for( size_t pc = 0; pc < code.size( ); ++pc ) {
+					if( translator.m_labels[pc] ) {
+						translator.m_code += "\t" + label( pc ) + ":\n";
+					}
+					translator.translate_instruction( pc );
+					translator.advance( pc );
+				}
+				if( translator.m_labels[code.size( )] ) {
+					translator.m_code += "\t" + label( code.size( ) ) + ":\n";
+				} else if( !code.empty( ) && OpCode::END == code.back( ).op ) {
+					translator.m_code.erase( translator.m_code.size( ) - std::string( "\t\treturn true;\n" ).size( ) );
+				}
+				translator.m_code += "\t\treturn true;\n";
+
+				std::ostringstream result;
+				result << "// " << ( options.source.empty( ) ? std::string( "Program" ) : comment( options.source ) )
+				       << " translated by daw_basic_aot.  Compile it with the daw_basic headers\n"
+				       << "// and link it with daw_basic_lib\n\n"
+				       << "#include <cmath>\n#include <cstdint>\n#include <cstdlib>\n#include <limits>\n#include <vector>\n\n"
+				       << "#include \"basic_aot.h\"\n\n"
+				       << "namespace {\n"
+				       << "\tusing daw::basic::BasicValue;\n\tusing daw::basic::integer;\n\tusing daw::basic::real;\n"
+				       << "\tusing daw::basic::aot::Runtime;\n\n"
+				       << "\tchar const program_text[] =\n";
+				std::istringstream lines( program_text );
+				for( std::string line; std::getline( lines, line ); ) {
+					if( line.find_first_not_of( " \t\r" ) != std::string::npos ) {
+						result << "\t  " << quote( line ) << "\n";
+					}
+				}
+				result << "\t  \"\";\n\n"
+				       << "\tuint64_t const code_hash = " << translator.m_runtime.code_hash( ) << "ull;\n\n"
+				       << "\tbool run_program( Runtime &rt ) {\n";
+
+				// RETURN and NEXT continue at places only known while running
+				auto const dispatches = !translator.m_returns.empty( ) || uses( OpCode::RETURN );
+				if( uses( OpCode::GOSUB ) || uses( OpCode::RETURN ) ) {
+					result << "\t\tstd::vector<size_t> return_stack;\n";
+				}
+				if( dispatches ) {
+					result << "\t\tsize_t target = 0;\n";
+				}
+				if( uses( OpCode::KEYWORD ) || uses( OpCode::USER_KEYWORD ) ) {
+					result << "\t\tbool more = true;\n\t\tbool result = true;\n";
+				}
+				for( size_t n = 0; n < translator.m_integer_slots; ++n ) {
+					result << "\t\tint64_t i" << n << " = 0;\n";
+				}
+				for( size_t n = 0; n < translator.m_real_slots; ++n ) {
+					result << "\t\treal r" << n << " = 0.0;\n";
+				}
+				auto const &symbols = translator.m_runtime.m_basic.m_symbols;
+				for( size_t symbol = 0; symbol < translator.m_locals.size( ); ++symbol ) {
+					auto const type = translator.m_locals[symbol];
+					if( ValueType::EMPTY != type ) {
+						result << "\t\t" << ( ValueType::INTEGER == type ? "integer" : "real" ) << " v" << symbol << " = 0; // "
+						       << comment( symbols[symbol] ) << "\n\t\tbool s" << symbol << " = false;\n";
+					}
+				}
+				result << "\n" << translator.m_code;
+
+				if( dispatches ) {
+					result << "\tdispatch:\n\t\tswitch( target ) {\n";
+					for( auto const pc : translator.m_returns ) {
+						result << "\t\tcase " << pc << ":\n\t\t\tgoto " << label( pc ) << ";\n";
+					}
+					result << "\t\t}\n\t\trt.fail( \"Attempt to continue at a statement that was not compiled\" );\n";
+				}
+				result << "\t}\n} // namespace\n\n"
+				       << "int " << ( options.entry.empty( ) ? std::string( "main" ) : options.entry ) << "( ) {\n"
+				       << "\tRuntime rt( program_text, " << ( options.optimize ? "true" : "false" ) << ", "
+				       << ( options.short_circuit ? "true" : "false" ) << " );\n"
+				       << "\treturn rt.run( &run_program, code_hash );\n}\n";
+				return result.str( );
+			}
+		} // namespace aot
+	}   // namespace basic
+} // namespace daw
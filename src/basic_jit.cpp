@@ -0,0 +1,1292 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Translates hot loops of a compiled program into x86-64 machine code.  Each
+// instruction is replaced by a fixed template working on the same stack the
+// VM would use, kept in the frame of the machine code.  Types are guarded as
+// the values are read, a guard that fails returns to the VM at the start of
+// the statement it is in so that the VM runs the statement again and gives
+// its result or error.  Nothing in a statement changes a variable before its
+// last instruction so running it again is always safe
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "dawbasic.h"
+
+#if defined( DAW_BASIC_JIT ) && defined( __x86_64__ ) && defined( __linux__ )
+#define DAW_BASIC_HAS_JIT
+#include <sys/mman.h>
+#endif
+
+namespace daw {
+	namespace basic {
+		namespace jit {
+#if defined( DAW_BASIC_HAS_JIT )
+			bool supported( ) noexcept {
+				return true;
+			}
+
+			NativeCode::NativeCode( std::vector<uint8_t> const &code ) noexcept : m_memory( nullptr ), m_size( 0 ) {
+				auto const memory = mmap( nullptr, code.size( ), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+				if( MAP_FAILED == memory ) {
+					return;
+				}
+				std::memcpy( memory, code.data( ), code.size( ) );
+				if( 0 != mprotect( memory, code.size( ), PROT_READ | PROT_EXEC ) ) {
+					munmap( memory, code.size( ) );
+					return;
+				}
+				m_memory = memory;
+				m_size = code.size( );
+			}
+
+			NativeCode::~NativeCode( ) {
+				if( nullptr != m_memory ) {
+					munmap( m_memory, m_size );
+				}
+			}
+#else
+			bool supported( ) noexcept {
+				return false;
+			}
+
+			NativeCode::NativeCode( std::vector<uint8_t> const & ) noexcept : m_memory( nullptr ), m_size( 0 ) {}
+
+			NativeCode::~NativeCode( ) {}
+#endif
+
+			NativeCode::NativeCode( ) noexcept : m_memory( nullptr ), m_size( 0 ) {}
+
+			NativeCode::NativeCode( NativeCode &&other ) noexcept : m_memory( other.m_memory ), m_size( other.m_size ) {
+				other.m_memory = nullptr;
+				other.m_size = 0;
+			}
+
+			NativeCode &NativeCode::operator=( NativeCode &&other ) noexcept {
+				if( this != &other ) {
+					NativeCode old( std::move( *this ) );
+					m_memory = other.m_memory;
+					m_size = other.m_size;
+					other.m_memory = nullptr;
+					other.m_size = 0;
+				}
+				return *this;
+			}
+
+			void const *NativeCode::entry( ) const noexcept {
+				return m_memory;
+			}
+		} // namespace jit
+
+		namespace {
+			constexpr size_t npos = std::numeric_limits<size_t>::max( );
+			constexpr uint32_t max_deopts = 16;  // Of a trace before it is compiled again with the types of then
+			constexpr uint32_t max_compiles = 4; // Of a loop before it is left to the VM
+			constexpr size_t max_trace = 4096;   // Instructions in a trace
+
+			enum Register : uint8_t { RAX, RCX, RDX, RBX, RSP, RBP, RSI, RDI, R8, R9, R10, R11, R12, R13, R14, R15 };
+			enum Xmm : uint8_t { XMM0, XMM1 };
+
+			enum class Condition : uint8_t {
+				BELOW = 0x2,
+				ABOVE_EQUAL = 0x3,
+				EQUAL = 0x4,
+				NOT_EQUAL = 0x5,
+				ABOVE = 0x7,
+				LESS = 0xC,
+				GREATER_EQUAL = 0xD,
+				LESS_EQUAL = 0xE,
+				GREATER = 0xF
+			};
+
+			// Opcodes of op r/m64, r64
+			enum class Alu : uint8_t {
+				ADD = 0x01,
+				OR = 0x09,
+				AND = 0x21,
+				SUBTRACT = 0x29,
+				XOR = 0x31,
+				COMPARE = 0x39,
+				TEST = 0x85
+			};
+
+			// Opcodes of the scalar double instructions after F2 0F
+			enum class Sse : uint8_t { ADD = 0x58, MULTIPLY = 0x59, SUBTRACT = 0x5C, DIVIDE = 0x5E };
+
+			struct Memory {
+				Register base;
+				int32_t displacement;
+			};
+
+			//////////////////////////////////////////////////////////////////////////
+			/// summary: Encodes the few x86-64 instructions the templates need.
+			/// Memory operands always take a 32 bit displacement.  Jumps are to
+			/// labels and are resolved by finish
+			class Assembler {
+				std::vector<uint8_t> m_code;
+				std::vector<size_t> m_labels;
+				std::vector<std::pair<size_t, size_t>> m_fixups; // Position of a rel32 and its label
+
+				void byte( uint32_t value ) {
+					m_code.push_back( static_cast<uint8_t>( value ) );
+				}
+
+				void dword( uint32_t value ) {
+					for( uint32_t n = 0; n != 4; ++n ) {
+						byte( value >> ( 8 * n ) );
+					}
+				}
+
+				void qword( uint64_t value ) {
+					dword( static_cast<uint32_t>( value ) );
+					dword( static_cast<uint32_t>( value >> 32 ) );
+				}
+
+				// REX prefix for reg in ModRM.reg and base in ModRM.rm, when one is needed
+				void rex( bool wide, uint8_t reg, uint8_t base ) {
+					auto const value = 0x40u | ( wide ? 8u : 0u ) | ( ( reg & 8u ) >> 1 ) | ( ( base & 8u ) >> 3 );
+					if( 0x40u != value ) {
+						byte( value );
+					}
+				}
+
+				void operand( uint8_t reg, Memory memory ) {
+					byte( 0x80u | ( ( reg & 7u ) << 3 ) | ( memory.base & 7u ) );
+					if( 4 == ( memory.base & 7 ) ) {
+						byte( 0x24 ); // SIB of rsp and r12 as a base
+					}
+					dword( static_cast<uint32_t>( memory.displacement ) );
+				}
+
+				void operand( uint8_t reg, Register rm ) {
+					byte( 0xC0u | ( ( reg & 7u ) << 3 ) | ( rm & 7u ) );
+				}
+
+				void fixup( size_t label ) {
+					m_fixups.emplace_back( m_code.size( ), label );
+					dword( 0 );
+				}
+
+			public:
+				size_t new_label( ) {
+					m_labels.push_back( npos );
+					return m_labels.size( ) - 1;
+				}
+
+				void bind( size_t label ) {
+					m_labels[label] = m_code.size( );
+				}
+
+				void jump( size_t label ) {
+					byte( 0xE9 );
+					fixup( label );
+				}
+
+				void jump_if( Condition condition, size_t label ) {
+					byte( 0x0F );
+					byte( 0x80u | static_cast<uint8_t>( condition ) );
+					fixup( label );
+				}
+
+				void push( Register reg ) {
+					rex( false, 0, reg );
+					byte( 0x50u + ( reg & 7u ) );
+				}
+
+				void pop( Register reg ) {
+					rex( false, 0, reg );
+					byte( 0x58u + ( reg & 7u ) );
+				}
+
+				void ret( ) {
+					byte( 0xC3 );
+				}
+
+				void call( Register reg ) {
+					rex( false, 0, reg );
+					byte( 0xFF );
+					operand( 2, reg );
+				}
+
+				// sub rsp, imm32.  Returns where imm32 is so that it can be set later
+				size_t reserve_stack( ) {
+					rex( true, 0, RSP );
+					byte( 0x81 );
+					operand( 5, RSP );
+					dword( 0 );
+					return m_code.size( ) - 4;
+				}
+
+				void set_dword( size_t position, uint32_t value ) {
+					for( uint32_t n = 0; n != 4; ++n ) {
+						m_code[position + n] = static_cast<uint8_t>( value >> ( 8 * n ) );
+					}
+				}
+
+				void load_address( Register reg, Memory memory ) {
+					rex( true, reg, memory.base );
+					byte( 0x8D );
+					operand( reg, memory );
+				}
+
+				void move( Register destination, Register source ) {
+					rex( true, source, destination );
+					byte( 0x89 );
+					operand( source, destination );
+				}
+
+				void move( Register destination, int64_t value ) {
+					if( static_cast<int32_t>( value ) == value ) {
+						rex( true, 0, destination );
+						byte( 0xC7 );
+						operand( 0, destination );
+						dword( static_cast<uint32_t>( value ) );
+					} else {
+						rex( true, 0, destination );
+						byte( 0xB8u + ( destination & 7u ) );
+						qword( static_cast<uint64_t>( value ) );
+					}
+				}
+
+				void load( Register reg, Memory memory ) {
+					rex( true, reg, memory.base );
+					byte( 0x8B );
+					operand( reg, memory );
+				}
+
+				void load_int32( Register reg, Memory memory ) {
+					rex( true, reg, memory.base );
+					byte( 0x63 );
+					operand( reg, memory );
+				}
+
+				void load_uint8( Register reg, Memory memory ) {
+					rex( false, reg, memory.base );
+					byte( 0x0F );
+					byte( 0xB6 );
+					operand( reg, memory );
+				}
+
+				void store( Memory memory, Register reg ) {
+					rex( true, reg, memory.base );
+					byte( 0x89 );
+					operand( reg, memory );
+				}
+
+				void store_int32( Memory memory, Register reg ) {
+					rex( false, reg, memory.base );
+					byte( 0x89 );
+					operand( reg, memory );
+				}
+
+				// Only for RAX to RBX, the others need a REX prefix for their low byte
+				void store_uint8( Memory memory, Register reg ) {
+					rex( false, reg, memory.base );
+					byte( 0x88 );
+					operand( reg, memory );
+				}
+
+				void store_immediate8( Memory memory, uint8_t value ) {
+					rex( false, 0, memory.base );
+					byte( 0xC6 );
+					operand( 0, memory );
+					byte( value );
+				}
+
+				void store_immediate16( Memory memory, uint16_t value ) {
+					byte( 0x66 );
+					rex( false, 0, memory.base );
+					byte( 0xC7 );
+					operand( 0, memory );
+					byte( value );
+					byte( static_cast<uint32_t>( value ) >> 8 );
+				}
+
+				// mov qword [memory], imm32 sign extended
+				void store_immediate64( Memory memory, int32_t value ) {
+					rex( true, 0, memory.base );
+					byte( 0xC7 );
+					operand( 0, memory );
+					dword( static_cast<uint32_t>( value ) );
+				}
+
+				void compare_uint8( Memory memory, uint8_t value ) {
+					rex( false, 0, memory.base );
+					byte( 0x80 );
+					operand( 7, memory );
+					byte( value );
+				}
+
+				void compare( Register reg, int32_t value ) {
+					rex( true, 0, reg );
+					byte( 0x81 );
+					operand( 7, reg );
+					dword( static_cast<uint32_t>( value ) );
+				}
+
+				void add( Register reg, int32_t value ) {
+					rex( true, 0, reg );
+					byte( 0x81 );
+					operand( 0, reg );
+					dword( static_cast<uint32_t>( value ) );
+				}
+
+				void increment( Memory memory ) {
+					rex( true, 0, memory.base );
+					byte( 0xFF );
+					operand( 0, memory );
+				}
+
+				void arithmetic( Alu op, Register destination, Register source ) {
+					rex( true, source, destination );
+					byte( static_cast<uint8_t>( op ) );
+					operand( source, destination );
+				}
+
+				void multiply( Register destination, Register source ) {
+					rex( true, destination, source );
+					byte( 0x0F );
+					byte( 0xAF );
+					operand( destination, source );
+				}
+
+				// cqo then idiv.  Quotient in RAX, remainder in RDX
+				void divide_rax( Register divisor ) {
+					byte( 0x48 );
+					byte( 0x99 );
+					rex( true, 0, divisor );
+					byte( 0xF7 );
+					operand( 7, divisor );
+				}
+
+				void negate( Register reg ) {
+					rex( true, 0, reg );
+					byte( 0xF7 );
+					operand( 3, reg );
+				}
+
+				void sign_extend_int32( Register destination, Register source ) {
+					rex( true, destination, source );
+					byte( 0x63 );
+					operand( destination, source );
+				}
+
+				// setcc then movzx so that reg is 0 or 1.  Only for RAX to RBX
+				void set_if( Condition condition, Register reg ) {
+					byte( 0x0F );
+					byte( 0x90u | static_cast<uint8_t>( condition ) );
+					operand( 0, reg );
+					byte( 0x0F );
+					byte( 0xB6 );
+					operand( reg, reg );
+				}
+
+				void load( Xmm reg, Memory memory ) {
+					byte( 0xF2 );
+					rex( false, reg, memory.base );
+					byte( 0x0F );
+					byte( 0x10 );
+					operand( reg, memory );
+				}
+
+				void store( Memory memory, Xmm reg ) {
+					byte( 0xF2 );
+					rex( false, reg, memory.base );
+					byte( 0x0F );
+					byte( 0x11 );
+					operand( reg, memory );
+				}
+
+				void arithmetic( Sse op, Xmm reg, Memory memory ) {
+					byte( 0xF2 );
+					rex( false, reg, memory.base );
+					byte( 0x0F );
+					byte( static_cast<uint8_t>( op ) );
+					operand( reg, memory );
+				}
+
+				// ucomisd.  Unordered sets ZF, PF and CF so that ABOVE and ABOVE_EQUAL
+				// do not hold for NaN
+				void compare( Xmm reg, Memory memory ) {
+					byte( 0x66 );
+					rex( false, reg, memory.base );
+					byte( 0x0F );
+					byte( 0x2E );
+					operand( reg, memory );
+				}
+
+				std::vector<uint8_t> finish( ) {
+					for( auto const &fixup : m_fixups ) {
+						auto const target = static_cast<int64_t>( m_labels[fixup.second] );
+						set_dword( fixup.first, static_cast<uint32_t>( target - static_cast<int64_t>( fixup.first + 4 ) ) );
+					}
+					return std::move( m_code );
+				}
+			}; // class Assembler
+
+			template<typename Function>
+			int64_t address_of( Function *function ) {
+				return reinterpret_cast<int64_t>( function );
+			}
+
+			int64_t bits_of( real value ) {
+				int64_t result;
+				std::memcpy( &result, &value, sizeof( result ) );
+				return result;
+			}
+		} // namespace
+
+		//////////////////////////////////////////////////////////////////////////
+		/// summary: Translates the loop starting at a pc of m_compiled into
+		/// machine code.  Code is made for every instruction reachable from the
+		/// start with the stack it is reached with.  An instruction without a
+		/// template, or with operands whose types the templates do not take,
+		/// returns to the VM at the start of its statement instead
+		struct Basic::JitCompiler {
+			enum class Kind : uint8_t { INTEGER, REAL, BOOLEAN };
+
+			// The types on the stack and the pc the VM can run the current
+			// statement again from.  The stack is empty there
+			struct State {
+				std::vector<Kind> stack;
+				size_t safe;
+
+				bool operator==( State const &rhs ) const {
+					return safe == rhs.safe && stack == rhs.stack;
+				}
+			};
+
+			struct Block {
+				size_t label;
+				State state;
+			};
+
+			enum class Result { CONTINUE, STOP, UNSUPPORTED };
+
+			Basic &basic;
+			CompiledProgram const &program;
+			Assembler assembler;
+			std::unordered_map<size_t, Block> blocks; // By pc
+			std::vector<size_t> pending;              // pcs of blocks without code yet
+			std::map<std::pair<size_t, bool>, size_t> exits; // Label by pc and whether it is a deopt
+			std::unordered_map<size_t, size_t> loop_bodies;  // First pc of the body by pc of NEXT
+			State state;
+			size_t depth;      // Deepest the stack gets
+			size_t translated; // Instructions that did not go back to the VM
+			size_t done;       // Label of the epilogue.  RAX has the pc to continue from
+
+			JitCompiler( Basic &owner )
+			  : basic( owner ), program( owner.m_compiled ), state{{}, 0}, depth( 0 ), translated( 0 ), done( 0 ) {
+				for( size_t pc = 0; pc != program.code.size( ); ++pc ) {
+					auto const &instruction = program.code[pc];
+					if( bytecode::OpCode::FOR_LOOP == instruction.op && 0 < instruction.b ) {
+						loop_bodies[static_cast<size_t>( instruction.b ) - 1] = pc + 1;
+					}
+				}
+			}
+
+			static ValueType value_type( Kind kind ) {
+				switch( kind ) {
+				case Kind::INTEGER:
+					return ValueType::INTEGER;
+				case Kind::REAL:
+					return ValueType::REAL;
+				case Kind::BOOLEAN:
+					break;
+				}
+				return ValueType::BOOLEAN;
+			}
+
+			static bool kind_of( ValueType type, Kind &kind ) {
+				switch( type ) {
+				case ValueType::INTEGER:
+					kind = Kind::INTEGER;
+					return true;
+				case ValueType::REAL:
+					kind = Kind::REAL;
+					return true;
+				case ValueType::BOOLEAN:
+					kind = Kind::BOOLEAN;
+					return true;
+				default:
+					return false;
+				}
+			}
+
+			static size_t payload_offset( Kind kind ) {
+				switch( kind ) {
+				case Kind::INTEGER:
+					return BasicValue::integer_offset( );
+				case Kind::REAL:
+					return BasicValue::real_offset( );
+				case Kind::BOOLEAN:
+					break;
+				}
+				return BasicValue::boolean_offset( );
+			}
+
+			static Memory slot( size_t index ) {
+				// Below the saved RBX and R12
+				return Memory{RBP, -24 - 8 * static_cast<int32_t>( index )};
+			}
+
+			static Memory context( size_t offset ) {
+				return Memory{RBX, static_cast<int32_t>( offset )};
+			}
+
+			// A field of the variable symbol, offset from the start of the Variable
+			static Memory variable( int32_t symbol, size_t offset ) {
+				return Memory{R12, static_cast<int32_t>( static_cast<size_t>( symbol ) * sizeof( Variable ) + offset )};
+			}
+
+			static Memory value_of( int32_t symbol, size_t offset ) {
+				return variable( symbol, offsetof( Variable, value ) + offset );
+			}
+
+			Memory top( size_t from_top = 0 ) const {
+				return slot( state.stack.size( ) - 1 - from_top );
+			}
+
+			void push( Kind kind ) {
+				state.stack.push_back( kind );
+				depth = std::max( depth, state.stack.size( ) );
+			}
+
+			void pop( size_t count = 1 ) {
+				state.stack.resize( state.stack.size( ) - count );
+			}
+
+			size_t exit_to( size_t pc, bool deopt ) {
+				auto exit = exits.find( std::make_pair( pc, deopt ) );
+				if( std::end( exits ) == exit ) {
+					exit = exits.emplace( std::make_pair( pc, deopt ), assembler.new_label( ) ).first;
+				}
+				return exit->second;
+			}
+
+			// Where a failed guard goes
+			size_t deopt( ) {
+				return exit_to( state.safe, true );
+			}
+
+			// The label of the code for pc reached with state.  A pc already
+			// reached with another stack is left to the VM from this path
+			size_t label_for( size_t pc, State target ) {
+				if( target.stack.empty( ) ) {
+					target.safe = pc;
+				}
+				auto const block = blocks.find( pc );
+				if( std::end( blocks ) != block ) {
+					if( block->second.state == target ) {
+						return block->second.label;
+					}
+					return exit_to( target.safe, false );
+				}
+				auto const label = assembler.new_label( );
+				blocks.emplace( pc, Block{label, std::move( target )} );
+				pending.push_back( pc );
+				return label;
+			}
+
+			void guard_variable( int32_t symbol, ValueType type ) {
+				assembler.compare_uint8( variable( symbol, offsetof( Variable, is_set ) ), 0 );
+				assembler.jump_if( Condition::EQUAL, deopt( ) );
+				assembler.compare_uint8( value_of( symbol, BasicValue::type_offset( ) ),
+				                         static_cast<uint8_t>( type ) );
+				assembler.jump_if( Condition::NOT_EQUAL, deopt( ) );
+			}
+
+			// RAX = the number in the value at base + offset
+			void load_payload( Kind kind, Register base, size_t offset ) {
+				Memory const memory{base, static_cast<int32_t>( offset + payload_offset( kind ) )};
+				switch( kind ) {
+				case Kind::INTEGER:
+					assembler.load_int32( RAX, memory );
+					break;
+				case Kind::REAL:
+					assembler.load( RAX, memory );
+					break;
+				case Kind::BOOLEAN:
+					assembler.load_uint8( RAX, memory );
+					break;
+				}
+			}
+
+			// Replace the value at base + offset with the number in reg.  A string
+			// may own memory so the guard leaves replacing it to the VM
+			void store_payload( Kind kind, Register base, size_t offset, Register reg ) {
+				Memory const type{base, static_cast<int32_t>( offset + BasicValue::type_offset( ) )};
+				Memory const memory{base, static_cast<int32_t>( offset + payload_offset( kind ) )};
+				assembler.compare_uint8( type, static_cast<uint8_t>( ValueType::STRING ) );
+				assembler.jump_if( Condition::EQUAL, deopt( ) );
+				assembler.store_immediate16( type, static_cast<uint8_t>( value_type( kind ) ) );
+				switch( kind ) {
+				case Kind::INTEGER:
+					assembler.store_int32( memory, reg );
+					break;
+				case Kind::REAL:
+					assembler.store( memory, reg );
+					break;
+				case Kind::BOOLEAN:
+					assembler.store_uint8( memory, reg );
+					break;
+				}
+			}
+
+			void load_variable( int32_t symbol, Kind kind ) {
+				guard_variable( symbol, value_type( kind ) );
+				load_payload( kind, R12, static_cast<size_t>( symbol ) * sizeof( Variable ) + offsetof( Variable, value ) );
+				push( kind );
+				assembler.store( top( ), RAX );
+			}
+
+			void store_variable( int32_t symbol, Kind kind ) {
+				assembler.load( RAX, top( ) );
+				store_payload( kind, R12, static_cast<size_t>( symbol ) * sizeof( Variable ) + offsetof( Variable, value ),
+				               RAX );
+				assembler.store_immediate8( variable( symbol, offsetof( Variable, is_set ) ), 1 );
+				pop( );
+			}
+
+			// Leaves the result in RAX.  Deopts when it does not fit in integer
+			void check_integer( ) {
+				assembler.sign_extend_int32( RCX, RAX );
+				assembler.arithmetic( Alu::COMPARE, RCX, RAX );
+				assembler.jump_if( Condition::NOT_EQUAL, deopt( ) );
+			}
+
+			// Compare the two values on top of the stack and return the condition
+			// that holds when oper does.  The values stay on the stack
+			bool compare( Operator oper, Kind kind, Condition &condition ) {
+				if( Kind::INTEGER == kind ) {
+					switch( oper ) {
+					case Operator::EQUAL:
+						condition = Condition::EQUAL;
+						break;
+					case Operator::LESS:
+						condition = Condition::LESS;
+						break;
+					case Operator::LESS_EQUAL:
+						condition = Condition::LESS_EQUAL;
+						break;
+					case Operator::GREATER:
+						condition = Condition::GREATER;
+						break;
+					case Operator::GREATER_EQUAL:
+						condition = Condition::GREATER_EQUAL;
+						break;
+					default:
+						return false;
+					}
+					assembler.load( RAX, top( 1 ) );
+					assembler.load( RCX, top( ) );
+					assembler.arithmetic( Alu::COMPARE, RAX, RCX );
+					return true;
+				}
+				if( Kind::REAL != kind ) {
+					return false;
+				}
+				// Equal reals are only almost equal, which is left to the VM
+				switch( oper ) {
+				case Operator::LESS:
+				case Operator::LESS_EQUAL:
+					assembler.load( XMM1, top( ) );
+					assembler.compare( XMM1, top( 1 ) );
+					condition = Operator::LESS == oper ? Condition::ABOVE : Condition::ABOVE_EQUAL;
+					return true;
+				case Operator::GREATER:
+				case Operator::GREATER_EQUAL:
+					assembler.load( XMM0, top( 1 ) );
+					assembler.compare( XMM0, top( ) );
+					condition = Operator::GREATER == oper ? Condition::ABOVE : Condition::ABOVE_EQUAL;
+					return true;
+				default:
+					return false;
+				}
+			}
+
+			Result negate( Kind kind ) {
+				assembler.load( RAX, top( ) );
+				if( Kind::INTEGER == kind ) {
+					assembler.negate( RAX );
+					check_integer( );
+				} else if( Kind::REAL == kind ) {
+					assembler.move( RCX, std::numeric_limits<int64_t>::min( ) );
+					assembler.arithmetic( Alu::XOR, RAX, RCX );
+				} else {
+					return Result::UNSUPPORTED;
+				}
+				assembler.store( top( ), RAX );
+				return Result::CONTINUE;
+			}
+
+			Result binary( Operator oper, Kind kind ) {
+				Condition condition;
+				if( compare( oper, kind, condition ) ) {
+					assembler.set_if( condition, RAX );
+					pop( );
+					state.stack.back( ) = Kind::BOOLEAN;
+					assembler.store( top( ), RAX );
+					return Result::CONTINUE;
+				}
+				if( Kind::INTEGER == kind ) {
+					assembler.load( RAX, top( 1 ) );
+					assembler.load( RCX, top( ) );
+					switch( oper ) {
+					case Operator::ADD:
+						assembler.arithmetic( Alu::ADD, RAX, RCX );
+						break;
+					case Operator::SUBTRACT:
+						assembler.arithmetic( Alu::SUBTRACT, RAX, RCX );
+						break;
+					case Operator::MULTIPLY:
+						assembler.multiply( RAX, RCX );
+						break;
+					case Operator::DIVIDE:
+					case Operator::MODULO:
+						assembler.arithmetic( Alu::TEST, RCX, RCX );
+						assembler.jump_if( Condition::EQUAL, deopt( ) );
+						assembler.divide_rax( RCX );
+						if( Operator::MODULO == oper ) {
+							assembler.move( RAX, RDX );
+						}
+						break;
+					default:
+						return Result::UNSUPPORTED;
+					}
+					check_integer( );
+					pop( );
+					assembler.store( top( ), RAX );
+					return Result::CONTINUE;
+				}
+				if( Kind::REAL == kind ) {
+					if( Operator::POWER == oper ) {
+						assembler.load( XMM0, top( 1 ) );
+						assembler.load( XMM1, top( ) );
+						assembler.move( RAX, address_of( static_cast<real ( * )( real, real )>( &std::pow ) ) );
+						assembler.call( RAX );
+						pop( );
+						assembler.store( top( ), XMM0 );
+						return Result::CONTINUE;
+					}
+					Sse op;
+					switch( oper ) {
+					case Operator::ADD:
+						op = Sse::ADD;
+						break;
+					case Operator::SUBTRACT:
+						op = Sse::SUBTRACT;
+						break;
+					case Operator::MULTIPLY:
+						op = Sse::MULTIPLY;
+						break;
+					case Operator::DIVIDE:
+						op = Sse::DIVIDE;
+						break;
+					default:
+						return Result::UNSUPPORTED;
+					}
+					assembler.load( XMM0, top( 1 ) );
+					assembler.arithmetic( op, XMM0, top( ) );
+					pop( );
+					assembler.store( top( ), XMM0 );
+					return Result::CONTINUE;
+				}
+				if( Operator::AND != oper && Operator::OR != oper ) {
+					return Result::UNSUPPORTED;
+				}
+				assembler.load( RAX, top( 1 ) );
+				assembler.load( RCX, top( ) );
+				assembler.arithmetic( Operator::AND == oper ? Alu::AND : Alu::OR, RAX, RCX );
+				pop( );
+				assembler.store( top( ), RAX );
+				return Result::CONTINUE;
+			}
+
+			// The array name when it exists, is one dimensional and has an element
+			// that is not a string, nullptr otherwise
+			BasicArray *find_array( int32_t name ) {
+				auto const array = basic.m_arrays.find( program.names[static_cast<size_t>( name )] );
+				if( std::end( basic.m_arrays ) == array || nullptr == jit_element( &array->second, 0 ) ||
+				    BasicArray::ElementType::STRING == array->second.element_type( ) ) {
+					return nullptr;
+				}
+				return &array->second;
+			}
+
+			// The kind of the elements of an array of integers or reals
+			static bool typed_kind( BasicArray const &array, Kind &kind ) {
+				switch( array.element_type( ) ) {
+				case BasicArray::ElementType::INTEGER:
+					kind = Kind::INTEGER;
+					return true;
+				case BasicArray::ElementType::REAL:
+					kind = Kind::REAL;
+					return true;
+				case BasicArray::ElementType::ANY:
+				case BasicArray::ElementType::STRING:
+					break;
+				}
+				return false;
+			}
+
+			// RAX = the address of the element of array at the integer in the
+			// variable index
+			void load_element_address( BasicArray *array, int32_t index ) {
+				guard_variable( index, ValueType::INTEGER );
+				assembler.move( RDI, address_of( array ) );
+				assembler.load_int32( RSI, value_of( index, BasicValue::integer_offset( ) ) );
+				assembler.move( RAX, address_of( &Basic::jit_element ) );
+				assembler.call( RAX );
+				assembler.arithmetic( Alu::TEST, RAX, RAX );
+				assembler.jump_if( Condition::EQUAL, deopt( ) );
+			}
+
+			Result next_loop( size_t pc, int32_t symbol ) {
+				assembler.move( RDI, RBX );
+				assembler.move( RSI, symbol );
+				assembler.move( RAX, address_of( &Basic::jit_next_loop ) );
+				assembler.call( RAX );
+				assembler.compare( RAX, -1 );
+				assembler.jump_if( Condition::EQUAL, label_for( pc + 1, state ) );
+				assembler.compare( RAX, -2 );
+				assembler.jump_if( Condition::EQUAL, exit_to( pc, false ) );
+				auto const body = loop_bodies.find( pc );
+				if( std::end( loop_bodies ) != body ) {
+					assembler.compare( RAX, static_cast<int32_t>( body->second ) );
+					assembler.jump_if( Condition::EQUAL, label_for( body->second, state ) );
+				}
+				// A body elsewhere is continued by the VM
+				assembler.jump( done );
+				return Result::STOP;
+			}
+
+			// Values an instruction takes from the stack
+			static size_t operands( bytecode::Instruction instruction ) {
+				using bytecode::OpCode;
+				switch( instruction.op ) {
+				case OpCode::STORE_VARIABLE:
+				case OpCode::STORE_INTEGER:
+				case OpCode::STORE_REAL:
+				case OpCode::UNARY_OPERATOR:
+				case OpCode::DUPLICATE:
+				case OpCode::DUPLICATE_UNBOXED:
+				case OpCode::JUMP_IF_FALSE:
+				case OpCode::BRANCH_UNBOXED:
+				case OpCode::STORE_ELEMENT:
+				case OpCode::STORE_IN_BOUNDS:
+					return 1;
+				case OpCode::BINARY_OPERATOR:
+				case OpCode::INTEGER_OPERATOR:
+				case OpCode::REAL_OPERATOR:
+					return Operator::NEGATE == static_cast<Operator>( instruction.a ) ? 1 : 2;
+				case OpCode::COMPARE_AND_JUMP:
+					return 2;
+				default:
+					return 0;
+				}
+			}
+
+			Result translate( size_t pc, bytecode::Instruction instruction ) {
+				using bytecode::OpCode;
+				auto const size = state.stack.size( );
+				if( size < operands( instruction ) ) {
+					return Result::UNSUPPORTED;
+				}
+				switch( instruction.op ) {
+				case OpCode::LINE:
+					assembler.store_immediate64( context( offsetof( JitContext, line ) ), instruction.a );
+					return Result::CONTINUE;
+				case OpCode::PUSH_CONSTANT:
+				case OpCode::PUSH_REAL: {
+					auto const &constant = program.constants[static_cast<size_t>( instruction.a )];
+					Kind kind;
+					if( !kind_of( constant.type( ), kind ) ) {
+						return Result::UNSUPPORTED;
+					}
+					auto const value = Kind::INTEGER == kind
+					                     ? static_cast<int64_t>( constant.integer_value( ) )
+					                     : Kind::REAL == kind ? bits_of( constant.real_value( ) ) : constant.boolean_value( );
+					assembler.move( RAX, value );
+					push( kind );
+					assembler.store( top( ), RAX );
+				}
+					return Result::CONTINUE;
+				case OpCode::PUSH_INTEGER:
+					assembler.move( RAX, instruction.a );
+					push( Kind::INTEGER );
+					assembler.store( top( ), RAX );
+					return Result::CONTINUE;
+				case OpCode::LOAD_VARIABLE: {
+					auto const &variable = basic.m_variables[static_cast<size_t>( instruction.a )];
+					Kind kind;
+					if( !variable.is_set || !kind_of( variable.value.type( ), kind ) ) {
+						return Result::UNSUPPORTED;
+					}
+					load_variable( instruction.a, kind );
+				}
+					return Result::CONTINUE;
+				case OpCode::LOAD_INTEGER:
+				case OpCode::LOAD_REAL:
+					load_variable( instruction.a, OpCode::LOAD_INTEGER == instruction.op ? Kind::INTEGER : Kind::REAL );
+					return Result::CONTINUE;
+				case OpCode::STORE_VARIABLE:
+					store_variable( instruction.a, state.stack.back( ) );
+					return Result::CONTINUE;
+				case OpCode::STORE_INTEGER:
+				case OpCode::STORE_REAL: {
+					auto const kind = OpCode::STORE_INTEGER == instruction.op ? Kind::INTEGER : Kind::REAL;
+					if( kind != state.stack.back( ) ) {
+						return Result::UNSUPPORTED;
+					}
+					store_variable( instruction.a, kind );
+					assembler.jump( label_for( static_cast<size_t>( instruction.b ), state ) );
+				}
+					return Result::STOP;
+				case OpCode::UNARY_OPERATOR:
+					if( Operator::NEGATE != static_cast<Operator>( instruction.a ) ) {
+						return Result::UNSUPPORTED;
+					}
+					return negate( state.stack.back( ) );
+				case OpCode::BINARY_OPERATOR:
+				case OpCode::INTEGER_OPERATOR:
+				case OpCode::REAL_OPERATOR: {
+					auto const oper = static_cast<Operator>( instruction.a );
+					if( Operator::NEGATE == oper ) {
+						return negate( state.stack.back( ) );
+					}
+					auto const kind = state.stack[size - 2];
+					if( kind != state.stack.back( ) || ( OpCode::INTEGER_OPERATOR == instruction.op && Kind::INTEGER != kind ) ||
+					    ( OpCode::REAL_OPERATOR == instruction.op && Kind::REAL != kind ) ) {
+						return Result::UNSUPPORTED;
+					}
+					return binary( oper, kind );
+				}
+				case OpCode::DUPLICATE:
+				case OpCode::DUPLICATE_UNBOXED:
+					assembler.load( RAX, top( ) );
+					push( state.stack.back( ) );
+					assembler.store( top( ), RAX );
+					return Result::CONTINUE;
+				case OpCode::JUMP:
+					assembler.jump( label_for( static_cast<size_t>( instruction.a ), state ) );
+					return Result::STOP;
+				case OpCode::JUMP_IF_FALSE:
+					if( Kind::BOOLEAN != state.stack.back( ) ) {
+						return Result::UNSUPPORTED;
+					}
+					assembler.load( RAX, top( ) );
+					pop( );
+					assembler.arithmetic( Alu::TEST, RAX, RAX );
+					assembler.jump_if( Condition::EQUAL, label_for( static_cast<size_t>( instruction.a ), state ) );
+					return Result::CONTINUE;
+				case OpCode::BRANCH_UNBOXED:
+					if( Kind::REAL == state.stack.back( ) ) {
+						return Result::UNSUPPORTED;
+					}
+					assembler.load( RAX, top( ) );
+					pop( );
+					assembler.arithmetic( Alu::TEST, RAX, RAX );
+					assembler.jump_if( Condition::EQUAL, label_for( static_cast<size_t>( instruction.a ), state ) );
+					assembler.jump( label_for( static_cast<size_t>( instruction.b ), state ) );
+					return Result::STOP;
+				case OpCode::COMPARE_AND_JUMP: {
+					Condition condition;
+					auto const kind = state.stack.back( );
+					if( kind != state.stack[size - 2] || !compare( static_cast<Operator>( instruction.b ), kind, condition ) ) {
+						return Result::UNSUPPORTED;
+					}
+					pop( 2 );
+					assembler.jump_if( condition, label_for( static_cast<size_t>( instruction.a ), state ) );
+				}
+					return Result::CONTINUE;
+				case OpCode::INCREMENT_VARIABLE:
+				case OpCode::DECREMENT_VARIABLE: {
+					auto const &variable = basic.m_variables[static_cast<size_t>( instruction.a )];
+					if( !variable.is_set || ValueType::INTEGER != variable.value.type( ) ) {
+						return Result::UNSUPPORTED;
+					}
+					guard_variable( instruction.a, ValueType::INTEGER );
+					assembler.load_int32( RAX, value_of( instruction.a, BasicValue::integer_offset( ) ) );
+					assembler.add( RAX, OpCode::INCREMENT_VARIABLE == instruction.op ? instruction.b : -instruction.b );
+					check_integer( );
+					assembler.store_int32( value_of( instruction.a, BasicValue::integer_offset( ) ), RAX );
+				}
+					return Result::CONTINUE;
+				case OpCode::LOAD_ELEMENT:
+				case OpCode::LOAD_IN_BOUNDS: {
+					auto const array = find_array( instruction.a );
+					if( nullptr == array ) {
+						return Result::UNSUPPORTED;
+					}
+					Kind kind;
+					if( typed_kind( *array, kind ) ) {
+						// The element is the number itself
+						load_element_address( array, instruction.b );
+						if( Kind::INTEGER == kind ) {
+							assembler.load_int32( RAX, Memory{RAX, 0} );
+						} else {
+							assembler.load( RAX, Memory{RAX, 0} );
+						}
+						push( kind );
+						assembler.store( top( ), RAX );
+						return Result::CONTINUE;
+					}
+					// The element the index is at now has the type to expect
+					auto const &index = basic.m_variables[static_cast<size_t>( instruction.b )];
+					auto observed = index.is_set && ValueType::INTEGER == index.value.type( )
+					                  ? array->element( index.value.integer_value( ) )
+					                  : nullptr;
+					if( nullptr == observed ) {
+						observed = array->element( 0 );
+					}
+					if( !kind_of( observed->type( ), kind ) ) {
+						return Result::UNSUPPORTED;
+					}
+					load_element_address( array, instruction.b );
+					assembler.compare_uint8( Memory{RAX, static_cast<int32_t>( BasicValue::type_offset( ) )},
+					                         static_cast<uint8_t>( value_type( kind ) ) );
+					assembler.jump_if( Condition::NOT_EQUAL, deopt( ) );
+					load_payload( kind, RAX, 0 );
+					push( kind );
+					assembler.store( top( ), RAX );
+				}
+					return Result::CONTINUE;
+				case OpCode::STORE_ELEMENT:
+				case OpCode::STORE_IN_BOUNDS: {
+					auto const array = find_array( instruction.a );
+					if( nullptr == array ) {
+						return Result::UNSUPPORTED;
+					}
+					Kind kind;
+					if( typed_kind( *array, kind ) ) {
+						// Integers stored in arrays of reals are converted by the VM
+						if( kind != state.stack.back( ) ) {
+							return Result::UNSUPPORTED;
+						}
+						load_element_address( array, instruction.b );
+						assembler.load( RCX, top( ) );
+						if( Kind::INTEGER == kind ) {
+							assembler.store_int32( Memory{RAX, 0}, RCX );
+						} else {
+							assembler.store( Memory{RAX, 0}, RCX );
+						}
+						pop( );
+						return Result::CONTINUE;
+					}
+					load_element_address( array, instruction.b );
+					assembler.load( RCX, top( ) );
+					store_payload( state.stack.back( ), RAX, 0, RCX );
+					pop( );
+				}
+					return Result::CONTINUE;
+				case OpCode::NEXT_LOOP:
+					return next_loop( pc, instruction.a );
+				default:
+					return Result::UNSUPPORTED;
+				}
+			}
+
+			// Code for the block at pc and those it falls through to
+			void translate_block( size_t pc ) {
+				for( ;; ) {
+					auto const instruction = program.code[pc];
+					if( state.stack.empty( ) ) {
+						state.safe = pc;
+					}
+					auto const result = max_trace <= translated ? Result::UNSUPPORTED : translate( pc, instruction );
+					if( Result::UNSUPPORTED == result ) {
+						assembler.jump( exit_to( state.safe, false ) );
+						return;
+					}
+					if( bytecode::OpCode::LINE != instruction.op ) {
+						++translated;
+					}
+					if( Result::STOP == result ) {
+						return;
+					}
+					++pc;
+					auto const block = blocks.find( pc );
+					if( std::end( blocks ) != block ) {
+						assembler.jump( label_for( pc, state ) );
+						return;
+					}
+					auto state_at_pc = state;
+					if( state_at_pc.stack.empty( ) ) {
+						state_at_pc.safe = pc;
+					}
+					auto const label = assembler.new_label( );
+					assembler.bind( label );
+					blocks.emplace( pc, Block{label, std::move( state_at_pc )} );
+				}
+			}
+
+			// The machine code of the loop at entry, empty when it would go back to
+			// the VM before doing anything
+			std::vector<uint8_t> compile( size_t entry ) {
+				// The context stays in RBX and the variables in R12 for the whole trace
+				assembler.push( RBP );
+				assembler.move( RBP, RSP );
+				assembler.push( RBX );
+				assembler.push( R12 );
+				auto const frame = assembler.reserve_stack( );
+				assembler.move( RBX, RDI );
+				assembler.load( R12, context( offsetof( JitContext, variables ) ) );
+				done = assembler.new_label( );
+				label_for( entry, State{{}, entry} );
+				while( !pending.empty( ) ) {
+					auto const pc = pending.back( );
+					pending.pop_back( );
+					auto const &block = blocks[pc];
+					state = block.state;
+					assembler.bind( block.label );
+					translate_block( pc );
+				}
+				if( 0 == translated ) {
+					return {};
+				}
+				for( auto const &exit : exits ) {
+					assembler.bind( exit.second );
+					if( exit.first.second ) {
+						assembler.increment( context( offsetof( JitContext, deopts ) ) );
+					}
+					assembler.move( RAX, static_cast<int64_t>( exit.first.first ) );
+					assembler.jump( done );
+				}
+				assembler.bind( done );
+				assembler.load_address( RSP, Memory{RBP, -16} );
+				assembler.pop( R12 );
+				assembler.pop( RBX );
+				assembler.pop( RBP );
+				assembler.ret( );
+				// A multiple of 16 keeps RSP aligned for the calls
+				assembler.set_dword( frame, static_cast<uint32_t>( ( depth * 8 + 15 ) / 16 * 16 ) );
+				return assembler.finish( );
+			}
+		}; // struct Basic::JitCompiler
+
+		void Basic::JitState::clear( ) {
+			targets.clear( );
+			code.clear( );
+			statistics = JitStatistics{};
+		}
+
+		//////////////////////////////////////////////////////////////////////////
+		/// summary: Count a backward jump to pc and run the machine code of the
+		/// loop there once it is hot.  Returns the pc the VM continues from
+		size_t Basic::jit_enter( size_t pc ) {
+			if( m_jit.targets.size( ) <= pc ) {
+				m_jit.targets.resize( m_compiled.code.size( ), JitTarget{0, -1, 0, 0} );
+			}
+			auto &target = m_jit.targets[pc];
+			if( 0 > target.trace &&
+			    ( -1 != target.trace || ++target.count < m_jit.threshold || !jit_compile( pc ) ) ) {
+				return pc;
+			}
+			JitContext context{this, m_variables.data( ), std::distance( std::begin( m_program ), m_program_it ), 0};
+			auto const native =
+			  reinterpret_cast<size_t ( * )( JitContext * )>( m_jit.code[static_cast<size_t>( target.trace )].entry( ) );
+			auto const next = native( &context );
+			m_program_it = std::begin( m_program ) + context.line;
+			++m_jit.statistics.entries;
+			if( 0 != context.deopts ) {
+				m_jit.statistics.deopts += context.deopts;
+				// The types have changed since the trace was made
+				if( ++target.deopts > max_deopts ) {
+					target.trace = target.compiles < max_compiles ? -1 : -2;
+					target.count = 0;
+					target.deopts = 0;
+				}
+			}
+			return next;
+		}
+
+		//////////////////////////////////////////////////////////////////////////
+		/// summary: Translate the loop starting at pc with the types its
+		/// variables have now.  Returns false when it stays with the VM
+		bool Basic::jit_compile( size_t pc ) {
+			auto &target = m_jit.targets[pc];
+			++target.compiles;
+			target.trace = -2;
+			JitCompiler compiler( *this );
+			auto const machine_code = compiler.compile( pc );
+			if( machine_code.empty( ) ) {
+				return false;
+			}
+			jit::NativeCode native( machine_code );
+			if( nullptr == native.entry( ) ) {
+				return false;
+			}
+			target.trace = static_cast<int32_t>( m_jit.code.size( ) );
+			m_jit.code.push_back( std::move( native ) );
+			++m_jit.statistics.traces;
+			return true;
+		}
+
+		//////////////////////////////////////////////////////////////////////////
+		/// summary: NEXT for machine code.  Returns -1 when the loop is done, the
+		/// pc of the body while it runs and -2 when the VM has to run the NEXT,
+		/// which includes every case where it would throw
+		int64_t Basic::jit_next_loop( JitContext *context, uint32_t symbol ) noexcept {
+			auto &basic = *context->basic;
+			auto loop = basic.m_loop_stack.find( symbol );
+			if( nullptr == loop || 0 == loop->body_pc ) {
+				return -2;
+			}
+			auto const &counter = basic.m_variables[symbol];
+			auto const type = counter.value.type( );
+			if( !counter.is_set || ( ValueType::INTEGER != type && ValueType::REAL != type ) ) {
+				return -2;
+			}
+			if( !basic.next_iteration( *loop ) ) {
+				basic.m_loop_stack.pop( );
+				return -1;
+			}
+			return static_cast<int64_t>( loop->body_pc );
+		}
+
+		//////////////////////////////////////////////////////////////////////////
+		/// summary: The address of the element of a one dimensional array, a
+		/// BasicValue, integer or real by what the array holds.  nullptr when
+		/// index is out of bounds
+		void *Basic::jit_element( BasicArray *array, integer index ) noexcept {
+			switch( array->element_type( ) ) {
+			case BasicArray::ElementType::INTEGER:
+				return array->integer_element( index );
+			case BasicArray::ElementType::REAL:
+				return array->real_element( index );
+			case BasicArray::ElementType::ANY:
+			case BasicArray::ElementType::STRING:
+				break;
+			}
+			return array->element( index );
+		}
+	} // namespace basic
+} // namespace daw
@@ -0,0 +1,684 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+
+#include "basic_mat.h"
+
+#if defined( DAW_BASIC_SIMD ) && defined( __x86_64__ ) && defined( __GNUC__ )
+#define DAW_BASIC_HAS_SIMD
+#include <immintrin.h>
+#endif
+
+namespace daw {
+	namespace basic {
+		namespace mat {
+			namespace {
+				void add_scalar( real const *lhs, real const *rhs, real *result, size_t size ) noexcept {
+					for( size_t n = 0; n < size; ++n ) {
+						result[n] = lhs[n] + rhs[n];
+					}
+				}
+
+				void subtract_scalar( real const *lhs, real const *rhs, real *result, size_t size ) noexcept {
+					for( size_t n = 0; n < size; ++n ) {
+						result[n] = lhs[n] - rhs[n];
+					}
+				}
+
+				void scale_scalar( real factor, real const *values, real *result, size_t size ) noexcept {
+					for( size_t n = 0; n < size; ++n ) {
+						result[n] = factor * values[n];
+					}
+				}
+
+				// result += factor * values.  Multiplied then added, never fused, so
+				// that every kernel rounds the same way
+				void axpy_scalar( real factor, real const *values, real *result, size_t size ) noexcept {
+					for( size_t n = 0; n < size; ++n ) {
+						result[n] += factor * values[n];
+					}
+				}
+
+				// Reductions of reals.  The SIMD kernels keep the lanes in vectors and
+				// finish with these, from first, once they have been stored in lanes.
+				// Sixteen lanes give each kernel several independent additions to run
+				size_t const lane_count = 16;
+
+				// Halves the lanes until one is left, adding lane n + width to lane n
+				real combine_sum( real *lanes, real const *values, size_t first, size_t size ) noexcept {
+					for( auto width = lane_count / 2; 0 < width; width /= 2 ) {
+						for( size_t lane = 0; lane < width; ++lane ) {
+							lanes[lane] += lanes[lane + width];
+						}
+					}
+					auto result = lanes[0];
+					for( auto n = first; n < size; ++n ) {
+						result += values[n];
+					}
+					return result;
+				}
+
+				real sum_scalar( real const *values, size_t size ) noexcept {
+					real lanes[lane_count] = {};
+					size_t n = 0;
+					for( ; n + lane_count <= size; n += lane_count ) {
+						for( size_t lane = 0; lane < lane_count; ++lane ) {
+							lanes[lane] += values[n + lane];
+						}
+					}
+					return combine_sum( lanes, values, n, size );
+				}
+
+				// Adds value to sum, keeping what was rounded off in compensation
+				void kahan_add( real value, real &sum, real &compensation ) noexcept {
+					auto const corrected = value - compensation;
+					auto const total = sum + corrected;
+					compensation = ( total - sum ) - corrected;
+					sum = total;
+				}
+
+				real combine_compensated( real const *lanes, real const *compensations, real const *values, size_t first,
+				                          size_t size ) noexcept {
+					real result = 0.0;
+					real compensation = 0.0;
+					for( size_t lane = 0; lane < lane_count; ++lane ) {
+						kahan_add( lanes[lane], result, compensation );
+						kahan_add( -compensations[lane], result, compensation );
+					}
+					for( auto n = first; n < size; ++n ) {
+						kahan_add( values[n], result, compensation );
+					}
+					return result;
+				}
+
+				real compensated_sum_scalar( real const *values, size_t size ) noexcept {
+					real lanes[lane_count] = {};
+					real compensations[lane_count] = {};
+					size_t n = 0;
+					for( ; n + lane_count <= size; n += lane_count ) {
+						for( size_t lane = 0; lane < lane_count; ++lane ) {
+							kahan_add( values[n + lane], lanes[lane], compensations[lane] );
+						}
+					}
+					return combine_compensated( lanes, compensations, values, n, size );
+				}
+
+				// Written as value < lane ? value : lane to match MINPD, which keeps
+				// the lane when either is NaN
+				real smaller( real value, real lane ) noexcept {
+					return value < lane ? value : lane;
+				}
+
+				real larger( real value, real lane ) noexcept {
+					return value > lane ? value : lane;
+				}
+
+				template<typename Choose>
+				real combine_extreme( Choose choose, real const *lanes, real const *values, size_t first,
+				                      size_t size ) noexcept {
+					auto result = lanes[0];
+					for( size_t lane = 1; lane < lane_count; ++lane ) {
+						result = choose( lanes[lane], result );
+					}
+					for( auto n = first; n < size; ++n ) {
+						result = choose( values[n], result );
+					}
+					return result;
+				}
+
+				template<typename Choose>
+				real extreme_scalar( Choose choose, real const *values, size_t size ) noexcept {
+					real lanes[lane_count];
+					std::fill( lanes, lanes + lane_count, values[0] );
+					size_t n = 0;
+					for( ; n + lane_count <= size; n += lane_count ) {
+						for( size_t lane = 0; lane < lane_count; ++lane ) {
+							lanes[lane] = choose( values[n + lane], lanes[lane] );
+						}
+					}
+					return combine_extreme( choose, lanes, values, n, size );
+				}
+
+				real minimum_scalar( real const *values, size_t size ) noexcept {
+					return extreme_scalar( smaller, values, size );
+				}
+
+				real maximum_scalar( real const *values, size_t size ) noexcept {
+					return extreme_scalar( larger, values, size );
+				}
+
+				// Multiplied then added, like axpy
+				real combine_dot( real *lanes, real const *lhs, real const *rhs, size_t first, size_t size ) noexcept {
+					auto result = combine_sum( lanes, nullptr, 0, 0 );
+					for( auto n = first; n < size; ++n ) {
+						result += lhs[n] * rhs[n];
+					}
+					return result;
+				}
+
+				real dot_scalar( real const *lhs, real const *rhs, size_t size ) noexcept {
+					real lanes[lane_count] = {};
+					size_t n = 0;
+					for( ; n + lane_count <= size; n += lane_count ) {
+						for( size_t lane = 0; lane < lane_count; ++lane ) {
+							lanes[lane] += lhs[n + lane] * rhs[n + lane];
+						}
+					}
+					return combine_dot( lanes, lhs, rhs, n, size );
+				}
+
+				int64_t integer_sum_scalar( integer const *values, size_t size ) noexcept {
+					int64_t result = 0;
+					for( size_t n = 0; n < size; ++n ) {
+						result += values[n];
+					}
+					return result;
+				}
+
+				integer integer_minimum_scalar( integer const *values, size_t size ) noexcept {
+					return *std::min_element( values, values + size );
+				}
+
+				integer integer_maximum_scalar( integer const *values, size_t size ) noexcept {
+					return *std::max_element( values, values + size );
+				}
+
+#if defined( DAW_BASIC_HAS_SIMD )
+				void add_sse2( real const *lhs, real const *rhs, real *result, size_t size ) noexcept {
+					size_t n = 0;
+					for( ; n + 2 <= size; n += 2 ) {
+						_mm_storeu_pd( result + n, _mm_add_pd( _mm_loadu_pd( lhs + n ), _mm_loadu_pd( rhs + n ) ) );
+					}
+					add_scalar( lhs + n, rhs + n, result + n, size - n );
+				}
+
+				void subtract_sse2( real const *lhs, real const *rhs, real *result, size_t size ) noexcept {
+					size_t n = 0;
+					for( ; n + 2 <= size; n += 2 ) {
+						_mm_storeu_pd( result + n, _mm_sub_pd( _mm_loadu_pd( lhs + n ), _mm_loadu_pd( rhs + n ) ) );
+					}
+					subtract_scalar( lhs + n, rhs + n, result + n, size - n );
+				}
+
+				void scale_sse2( real factor, real const *values, real *result, size_t size ) noexcept {
+					auto const factors = _mm_set1_pd( factor );
+					size_t n = 0;
+					for( ; n + 2 <= size; n += 2 ) {
+						_mm_storeu_pd( result + n, _mm_mul_pd( factors, _mm_loadu_pd( values + n ) ) );
+					}
+					scale_scalar( factor, values + n, result + n, size - n );
+				}
+
+				void axpy_sse2( real factor, real const *values, real *result, size_t size ) noexcept {
+					auto const factors = _mm_set1_pd( factor );
+					size_t n = 0;
+					for( ; n + 2 <= size; n += 2 ) {
+						auto const product = _mm_mul_pd( factors, _mm_loadu_pd( values + n ) );
+						_mm_storeu_pd( result + n, _mm_add_pd( _mm_loadu_pd( result + n ), product ) );
+					}
+					axpy_scalar( factor, values + n, result + n, size - n );
+				}
+
+				// The lanes of the SSE2 reductions, two to a vector
+				size_t const sse2_vectors = lane_count / 2;
+
+				void store_lanes( __m128d const *vectors, real *lanes ) noexcept {
+					for( size_t vector = 0; vector < sse2_vectors; ++vector ) {
+						_mm_storeu_pd( lanes + 2 * vector, vectors[vector] );
+					}
+				}
+
+				real sum_sse2( real const *values, size_t size ) noexcept {
+					__m128d totals[sse2_vectors];
+					std::fill( totals, totals + sse2_vectors, _mm_setzero_pd( ) );
+					size_t n = 0;
+					for( ; n + lane_count <= size; n += lane_count ) {
+						for( size_t vector = 0; vector < sse2_vectors; ++vector ) {
+							totals[vector] = _mm_add_pd( totals[vector], _mm_loadu_pd( values + n + 2 * vector ) );
+						}
+					}
+					real lanes[lane_count];
+					store_lanes( totals, lanes );
+					return combine_sum( lanes, values, n, size );
+				}
+
+				real compensated_sum_sse2( real const *values, size_t size ) noexcept {
+					__m128d totals[sse2_vectors];
+					__m128d compensation[sse2_vectors];
+					std::fill( totals, totals + sse2_vectors, _mm_setzero_pd( ) );
+					std::fill( compensation, compensation + sse2_vectors, _mm_setzero_pd( ) );
+					size_t n = 0;
+					for( ; n + lane_count <= size; n += lane_count ) {
+						for( size_t vector = 0; vector < sse2_vectors; ++vector ) {
+							auto const corrected = _mm_sub_pd( _mm_loadu_pd( values + n + 2 * vector ), compensation[vector] );
+							auto const total = _mm_add_pd( totals[vector], corrected );
+							compensation[vector] = _mm_sub_pd( _mm_sub_pd( total, totals[vector] ), corrected );
+							totals[vector] = total;
+						}
+					}
+					real lanes[lane_count];
+					real compensations[lane_count];
+					store_lanes( totals, lanes );
+					store_lanes( compensation, compensations );
+					return combine_compensated( lanes, compensations, values, n, size );
+				}
+
+				real minimum_sse2( real const *values, size_t size ) noexcept {
+					__m128d results[sse2_vectors];
+					std::fill( results, results + sse2_vectors, _mm_set1_pd( values[0] ) );
+					size_t n = 0;
+					for( ; n + lane_count <= size; n += lane_count ) {
+						for( size_t vector = 0; vector < sse2_vectors; ++vector ) {
+							results[vector] = _mm_min_pd( _mm_loadu_pd( values + n + 2 * vector ), results[vector] );
+						}
+					}
+					real lanes[lane_count];
+					store_lanes( results, lanes );
+					return combine_extreme( smaller, lanes, values, n, size );
+				}
+
+				real maximum_sse2( real const *values, size_t size ) noexcept {
+					__m128d results[sse2_vectors];
+					std::fill( results, results + sse2_vectors, _mm_set1_pd( values[0] ) );
+					size_t n = 0;
+					for( ; n + lane_count <= size; n += lane_count ) {
+						for( size_t vector = 0; vector < sse2_vectors; ++vector ) {
+							results[vector] = _mm_max_pd( _mm_loadu_pd( values + n + 2 * vector ), results[vector] );
+						}
+					}
+					real lanes[lane_count];
+					store_lanes( results, lanes );
+					return combine_extreme( larger, lanes, values, n, size );
+				}
+
+				real dot_sse2( real const *lhs, real const *rhs, size_t size ) noexcept {
+					__m128d totals[sse2_vectors];
+					std::fill( totals, totals + sse2_vectors, _mm_setzero_pd( ) );
+					size_t n = 0;
+					for( ; n + lane_count <= size; n += lane_count ) {
+						for( size_t vector = 0; vector < sse2_vectors; ++vector ) {
+							auto const offset = n + 2 * vector;
+							auto const product = _mm_mul_pd( _mm_loadu_pd( lhs + offset ), _mm_loadu_pd( rhs + offset ) );
+							totals[vector] = _mm_add_pd( totals[vector], product );
+						}
+					}
+					real lanes[lane_count];
+					store_lanes( totals, lanes );
+					return combine_dot( lanes, lhs, rhs, n, size );
+				}
+
+				__attribute__( ( target( "avx2" ) ) ) void add_avx2( real const *lhs, real const *rhs, real *result,
+				                                                     size_t size ) noexcept {
+					size_t n = 0;
+					for( ; n + 4 <= size; n += 4 ) {
+						_mm256_storeu_pd( result + n, _mm256_add_pd( _mm256_loadu_pd( lhs + n ), _mm256_loadu_pd( rhs + n ) ) );
+					}
+					add_scalar( lhs + n, rhs + n, result + n, size - n );
+				}
+
+				__attribute__( ( target( "avx2" ) ) ) void subtract_avx2( real const *lhs, real const *rhs, real *result,
+				                                                          size_t size ) noexcept {
+					size_t n = 0;
+					for( ; n + 4 <= size; n += 4 ) {
+						_mm256_storeu_pd( result + n, _mm256_sub_pd( _mm256_loadu_pd( lhs + n ), _mm256_loadu_pd( rhs + n ) ) );
+					}
+					subtract_scalar( lhs + n, rhs + n, result + n, size - n );
+				}
+
+				__attribute__( ( target( "avx2" ) ) ) void scale_avx2( real factor, real const *values, real *result,
+				                                                       size_t size ) noexcept {
+					auto const factors = _mm256_set1_pd( factor );
+					size_t n = 0;
+					for( ; n + 4 <= size; n += 4 ) {
+						_mm256_storeu_pd( result + n, _mm256_mul_pd( factors, _mm256_loadu_pd( values + n ) ) );
+					}
+					scale_scalar( factor, values + n, result + n, size - n );
+				}
+
+				__attribute__( ( target( "avx2" ) ) ) void axpy_avx2( real factor, real const *values, real *result,
+				                                                      size_t size ) noexcept {
+					auto const factors = _mm256_set1_pd( factor );
+					size_t n = 0;
+					for( ; n + 4 <= size; n += 4 ) {
+						auto const product = _mm256_mul_pd( factors, _mm256_loadu_pd( values + n ) );
+						_mm256_storeu_pd( result + n, _mm256_add_pd( _mm256_loadu_pd( result + n ), product ) );
+					}
+					axpy_scalar( factor, values + n, result + n, size - n );
+				}
+				// The lanes of the AVX2 reductions, four to a vector
+				size_t const avx2_vectors = lane_count / 4;
+
+				__attribute__( ( target( "avx2" ) ) ) void store_lanes( __m256d const *vectors, real *lanes ) noexcept {
+					for( size_t vector = 0; vector < avx2_vectors; ++vector ) {
+						_mm256_storeu_pd( lanes + 4 * vector, vectors[vector] );
+					}
+				}
+
+				__attribute__( ( target( "avx2" ) ) ) real sum_avx2( real const *values, size_t size ) noexcept {
+					__m256d totals[avx2_vectors];
+					std::fill( totals, totals + avx2_vectors, _mm256_setzero_pd( ) );
+					size_t n = 0;
+					for( ; n + lane_count <= size; n += lane_count ) {
+						for( size_t vector = 0; vector < avx2_vectors; ++vector ) {
+							totals[vector] = _mm256_add_pd( totals[vector], _mm256_loadu_pd( values + n + 4 * vector ) );
+						}
+					}
+					real lanes[lane_count];
+					store_lanes( totals, lanes );
+					return combine_sum( lanes, values, n, size );
+				}
+
+				__attribute__( ( target( "avx2" ) ) ) real compensated_sum_avx2( real const *values, size_t size ) noexcept {
+					__m256d totals[avx2_vectors];
+					__m256d compensation[avx2_vectors];
+					std::fill( totals, totals + avx2_vectors, _mm256_setzero_pd( ) );
+					std::fill( compensation, compensation + avx2_vectors, _mm256_setzero_pd( ) );
+					size_t n = 0;
+					for( ; n + lane_count <= size; n += lane_count ) {
+						for( size_t vector = 0; vector < avx2_vectors; ++vector ) {
+							auto const corrected =
+							  _mm256_sub_pd( _mm256_loadu_pd( values + n + 4 * vector ), compensation[vector] );
+							auto const total = _mm256_add_pd( totals[vector], corrected );
+							compensation[vector] = _mm256_sub_pd( _mm256_sub_pd( total, totals[vector] ), corrected );
+							totals[vector] = total;
+						}
+					}
+					real lanes[lane_count];
+					real compensations[lane_count];
+					store_lanes( totals, lanes );
+					store_lanes( compensation, compensations );
+					return combine_compensated( lanes, compensations, values, n, size );
+				}
+
+				__attribute__( ( target( "avx2" ) ) ) real minimum_avx2( real const *values, size_t size ) noexcept {
+					__m256d results[avx2_vectors];
+					std::fill( results, results + avx2_vectors, _mm256_set1_pd( values[0] ) );
+					size_t n = 0;
+					for( ; n + lane_count <= size; n += lane_count ) {
+						for( size_t vector = 0; vector < avx2_vectors; ++vector ) {
+							results[vector] = _mm256_min_pd( _mm256_loadu_pd( values + n + 4 * vector ), results[vector] );
+						}
+					}
+					real lanes[lane_count];
+					store_lanes( results, lanes );
+					return combine_extreme( smaller, lanes, values, n, size );
+				}
+
+				__attribute__( ( target( "avx2" ) ) ) real maximum_avx2( real const *values, size_t size ) noexcept {
+					__m256d results[avx2_vectors];
+					std::fill( results, results + avx2_vectors, _mm256_set1_pd( values[0] ) );
+					size_t n = 0;
+					for( ; n + lane_count <= size; n += lane_count ) {
+						for( size_t vector = 0; vector < avx2_vectors; ++vector ) {
+							results[vector] = _mm256_max_pd( _mm256_loadu_pd( values + n + 4 * vector ), results[vector] );
+						}
+					}
+					real lanes[lane_count];
+					store_lanes( results, lanes );
+					return combine_extreme( larger, lanes, values, n, size );
+				}
+
+				__attribute__( ( target( "avx2" ) ) ) real dot_avx2( real const *lhs, real const *rhs, size_t size ) noexcept {
+					__m256d totals[avx2_vectors];
+					std::fill( totals, totals + avx2_vectors, _mm256_setzero_pd( ) );
+					size_t n = 0;
+					for( ; n + lane_count <= size; n += lane_count ) {
+						for( size_t vector = 0; vector < avx2_vectors; ++vector ) {
+							auto const offset = n + 4 * vector;
+							auto const product = _mm256_mul_pd( _mm256_loadu_pd( lhs + offset ), _mm256_loadu_pd( rhs + offset ) );
+							totals[vector] = _mm256_add_pd( totals[vector], product );
+						}
+					}
+					real lanes[lane_count];
+					store_lanes( totals, lanes );
+					return combine_dot( lanes, lhs, rhs, n, size );
+				}
+
+				// SSE2 has no 32 bit minimum or maximum, so integers are only widened to AVX2
+				__attribute__( ( target( "avx2" ) ) ) int64_t integer_sum_avx2( integer const *values, size_t size ) noexcept {
+					auto low = _mm256_setzero_si256( );
+					auto high = _mm256_setzero_si256( );
+					size_t n = 0;
+					for( ; n + 8 <= size; n += 8 ) {
+						auto const items = _mm256_loadu_si256( reinterpret_cast<__m256i const *>( values + n ) );
+						low = _mm256_add_epi64( low, _mm256_cvtepi32_epi64( _mm256_castsi256_si128( items ) ) );
+						high = _mm256_add_epi64( high, _mm256_cvtepi32_epi64( _mm256_extracti128_si256( items, 1 ) ) );
+					}
+					int64_t lanes[4];
+					_mm256_storeu_si256( reinterpret_cast<__m256i *>( lanes ), _mm256_add_epi64( low, high ) );
+					return lanes[0] + lanes[1] + lanes[2] + lanes[3] + integer_sum_scalar( values + n, size - n );
+				}
+
+				__attribute__( ( target( "avx2" ) ) ) integer integer_minimum_avx2( integer const *values,
+				                                                                   size_t size ) noexcept {
+					auto result = _mm256_set1_epi32( values[0] );
+					size_t n = 0;
+					for( ; n + 8 <= size; n += 8 ) {
+						result = _mm256_min_epi32( result, _mm256_loadu_si256( reinterpret_cast<__m256i const *>( values + n ) ) );
+					}
+					integer lanes[8];
+					_mm256_storeu_si256( reinterpret_cast<__m256i *>( lanes ), result );
+					auto result_lane = *std::min_element( lanes, lanes + 8 );
+					for( ; n < size; ++n ) {
+						result_lane = std::min( result_lane, values[n] );
+					}
+					return result_lane;
+				}
+
+				__attribute__( ( target( "avx2" ) ) ) integer integer_maximum_avx2( integer const *values,
+				                                                                   size_t size ) noexcept {
+					auto result = _mm256_set1_epi32( values[0] );
+					size_t n = 0;
+					for( ; n + 8 <= size; n += 8 ) {
+						result = _mm256_max_epi32( result, _mm256_loadu_si256( reinterpret_cast<__m256i const *>( values + n ) ) );
+					}
+					integer lanes[8];
+					_mm256_storeu_si256( reinterpret_cast<__m256i *>( lanes ), result );
+					auto result_lane = *std::max_element( lanes, lanes + 8 );
+					for( ; n < size; ++n ) {
+						result_lane = std::max( result_lane, values[n] );
+					}
+					return result_lane;
+				}
+#endif
+
+				struct Kernels {
+					void ( *add )( real const *, real const *, real *, size_t ) noexcept;
+					void ( *subtract )( real const *, real const *, real *, size_t ) noexcept;
+					void ( *scale )( real, real const *, real *, size_t ) noexcept;
+					void ( *axpy )( real, real const *, real *, size_t ) noexcept;
+					real ( *sum )( real const *, size_t ) noexcept;
+					real ( *compensated_sum )( real const *, size_t ) noexcept;
+					real ( *minimum )( real const *, size_t ) noexcept;
+					real ( *maximum )( real const *, size_t ) noexcept;
+					real ( *dot )( real const *, real const *, size_t ) noexcept;
+					int64_t ( *integer_sum )( integer const *, size_t ) noexcept;
+					integer ( *integer_minimum )( integer const *, size_t ) noexcept;
+					integer ( *integer_maximum )( integer const *, size_t ) noexcept;
+				};
+
+				// Unsupported kernels run as SCALAR
+				Kernels const &kernels( Kernel kernel ) noexcept {
+					static Kernels const scalar{add_scalar, subtract_scalar, scale_scalar, axpy_scalar, sum_scalar,
+					                            compensated_sum_scalar, minimum_scalar, maximum_scalar, dot_scalar,
+					                            integer_sum_scalar, integer_minimum_scalar, integer_maximum_scalar};
+#if defined( DAW_BASIC_HAS_SIMD )
+					static Kernels const sse2{add_sse2, subtract_sse2, scale_sse2, axpy_sse2, sum_sse2, compensated_sum_sse2,
+					                          minimum_sse2, maximum_sse2, dot_sse2, integer_sum_scalar, integer_minimum_scalar,
+					                          integer_maximum_scalar};
+					static Kernels const avx2{add_avx2, subtract_avx2, scale_avx2, axpy_avx2, sum_avx2, compensated_sum_avx2,
+					                          minimum_avx2, maximum_avx2, dot_avx2, integer_sum_avx2, integer_minimum_avx2,
+					                          integer_maximum_avx2};
+					if( supported( kernel ) ) {
+						switch( kernel ) {
+						case Kernel::SCALAR:
+							break;
+						case Kernel::SSE2:
+							return sse2;
+						case Kernel::AVX2:
+							return avx2;
+						}
+					}
+#else
+					(void)kernel;
+#endif
+					return scalar;
+				}
+			} // namespace
+
+			bool supported( Kernel kernel ) noexcept {
+				switch( kernel ) {
+				case Kernel::SCALAR:
+					return true;
+#if defined( DAW_BASIC_HAS_SIMD )
+				case Kernel::SSE2:
+					return true;
+				case Kernel::AVX2:
+					return 0 != __builtin_cpu_supports( "avx2" );
+#else
+				case Kernel::SSE2:
+				case Kernel::AVX2:
+					break;
+#endif
+				}
+				return false;
+			}
+
+			Kernel best_kernel( ) noexcept {
+				static Kernel const best = supported( Kernel::AVX2 )
+				                             ? Kernel::AVX2
+				                             : supported( Kernel::SSE2 ) ? Kernel::SSE2 : Kernel::SCALAR;
+				return best;
+			}
+
+			char const *kernel_name( Kernel kernel ) noexcept {
+				switch( kernel ) {
+				case Kernel::SCALAR:
+					return "scalar";
+				case Kernel::SSE2:
+					return "sse2";
+				case Kernel::AVX2:
+					return "avx2";
+				}
+				return "";
+			}
+
+			void add( Kernel kernel, real const *lhs, real const *rhs, real *result, size_t size ) noexcept {
+				kernels( kernel ).add( lhs, rhs, result, size );
+			}
+
+			void subtract( Kernel kernel, real const *lhs, real const *rhs, real *result, size_t size ) noexcept {
+				kernels( kernel ).subtract( lhs, rhs, result, size );
+			}
+
+			void scale( Kernel kernel, real factor, real const *values, real *result, size_t size ) noexcept {
+				kernels( kernel ).scale( factor, values, result, size );
+			}
+
+			//////////////////////////////////////////////////////////////////////////
+			/// summary: Each column of result is accumulated from the columns of lhs
+			/// scaled by an element of rhs.  lhs is taken in blocks of rows and
+			/// inner that stay in cache while every column of result is done
+			void multiply( Kernel kernel, real const *lhs, real const *rhs, real *result, size_t rows, size_t inner,
+			               size_t columns ) noexcept {
+				size_t const block_rows = 128;
+				size_t const block_inner = 64;
+				auto const axpy = kernels( kernel ).axpy;
+				std::fill( result, result + rows * columns, 0.0 );
+				for( size_t row = 0; row < rows; row += block_rows ) {
+					auto const height = std::min( block_rows, rows - row );
+					for( size_t first = 0; first < inner; first += block_inner ) {
+						auto const last = std::min( first + block_inner, inner );
+						for( size_t column = 0; column < columns; ++column ) {
+							auto const target = result + row + column * rows;
+							for( auto k = first; k < last; ++k ) {
+								axpy( rhs[k + column * inner], lhs + row + k * rows, target, height );
+							}
+						}
+					}
+				}
+			}
+
+			void transpose( real const *values, real *result, size_t rows, size_t columns ) noexcept {
+				size_t const block = 32;
+				for( size_t first_column = 0; first_column < columns; first_column += block ) {
+					auto const last_column = std::min( first_column + block, columns );
+					for( size_t first_row = 0; first_row < rows; first_row += block ) {
+						auto const last_row = std::min( first_row + block, rows );
+						for( auto column = first_column; column < last_column; ++column ) {
+							for( auto row = first_row; row < last_row; ++row ) {
+								result[column + row * columns] = values[row + column * rows];
+							}
+						}
+					}
+				}
+			}
+
+			real sum( Kernel kernel, Summation summation, real const *values, size_t size ) noexcept {
+				if( Summation::COMPENSATED == summation ) {
+					return kernels( kernel ).compensated_sum( values, size );
+				}
+				return kernels( kernel ).sum( values, size );
+			}
+
+			real minimum( Kernel kernel, real const *values, size_t size ) noexcept {
+				return kernels( kernel ).minimum( values, size );
+			}
+
+			real maximum( Kernel kernel, real const *values, size_t size ) noexcept {
+				return kernels( kernel ).maximum( values, size );
+			}
+
+			real dot( Kernel kernel, real const *lhs, real const *rhs, size_t size ) noexcept {
+				return kernels( kernel ).dot( lhs, rhs, size );
+			}
+
+			int64_t sum( Kernel kernel, integer const *values, size_t size ) noexcept {
+				return kernels( kernel ).integer_sum( values, size );
+			}
+
+			integer minimum( Kernel kernel, integer const *values, size_t size ) noexcept {
+				return kernels( kernel ).integer_minimum( values, size );
+			}
+
+			integer maximum( Kernel kernel, integer const *values, size_t size ) noexcept {
+				return kernels( kernel ).integer_maximum( values, size );
+			}
+
+			//////////////////////////////////////////////////////////////////////////
+			/// summary: Products of two integers are at most 2^62 in magnitude, so
+			/// adding one cannot overflow while the total is within 2^62 of zero
+			bool dot( integer const *lhs, integer const *rhs, size_t size, int64_t &result ) noexcept {
+				int64_t const limit = int64_t{1} << 62;
+				result = 0;
+				for( size_t n = 0; n < size; ++n ) {
+					if( result > limit || result < -limit ) {
+						return false;
+					}
+					result += static_cast<int64_t>( lhs[n] ) * rhs[n];
+				}
+				return true;
+			}
+		} // namespace mat
+	}   // namespace basic
+} // namespace daw
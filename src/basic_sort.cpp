@@ -0,0 +1,165 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <thread>
+#include <utility>
+
+#include "basic_sort.h"
+
+namespace daw {
+	namespace basic {
+		namespace parallel {
+			namespace {
+				// Elements a thread must have before starting it costs less than it saves
+				size_t const minimum_part = 1 << 15;
+
+				// Runs work( part ) for every part, each but the last on a thread of its own
+				template<typename Work>
+				void run_parts( size_t parts, Work const &work ) {
+					std::vector<std::thread> threads;
+					threads.reserve( parts );
+					try {
+						for( size_t part = 0; part + 1 < parts; ++part ) {
+							threads.emplace_back( work, part );
+						}
+					} catch( ... ) {
+						for( auto &thread : threads ) {
+							thread.join( );
+						}
+						throw;
+					}
+					work( parts - 1 );
+					for( auto &thread : threads ) {
+						thread.join( );
+					}
+				}
+
+				//////////////////////////////////////////////////////////////////////////
+				/// summary: Each thread sorts a part of values, then neighbouring parts
+				/// are merged in rounds, each merge of a round on its own thread, going
+				/// back and forth between values and a buffer.  Merging keeps equal
+				/// elements of the left part first so stable sorts stay stable
+				template<typename T, typename Less>
+				void parallel_sort( T *values, size_t size, Less less, bool stable ) {
+					auto const parts = std::max<size_t>( 1, std::min( thread_count( ), size / minimum_part ) );
+					std::vector<size_t> bounds;
+					for( size_t part = 0; part <= parts; ++part ) {
+						bounds.push_back( size * part / parts );
+					}
+					run_parts( parts, [&]( size_t part ) {
+						auto const first = values + bounds[part];
+						auto const last = values + bounds[part + 1];
+						if( stable ) {
+							std::stable_sort( first, last, less );
+						} else {
+							std::sort( first, last, less );
+						}
+					} );
+					if( 1 == parts ) {
+						return;
+					}
+					std::vector<T> buffer( size );
+					auto from = values;
+					auto to = buffer.data( );
+					while( 2 < bounds.size( ) ) {
+						auto const runs = bounds.size( ) - 1;
+						// The last run is copied as it is when there is an odd number
+						run_parts( ( runs + 1 ) / 2, [&]( size_t merge ) {
+							auto const first = bounds[2 * merge];
+							auto const middle = bounds[std::min( 2 * merge + 1, runs )];
+							auto const last = bounds[std::min( 2 * merge + 2, runs )];
+							std::merge( from + first, from + middle, from + middle, from + last, to + first, less );
+						} );
+						std::vector<size_t> merged;
+						for( size_t run = 0; run < runs; run += 2 ) {
+							merged.push_back( bounds[run] );
+						}
+						merged.push_back( size );
+						bounds = std::move( merged );
+						std::swap( from, to );
+					}
+					if( from != values ) {
+						std::copy( from, from + size, values );
+					}
+				}
+
+				// A total order so that sorting reals is well defined
+				struct LessReal {
+					bool operator( )( real lhs, real rhs ) const noexcept {
+						if( lhs < rhs ) {
+							return true;
+						} else if( lhs == rhs ) {
+							return 0.0 == lhs && std::signbit( lhs ) && !std::signbit( rhs );
+						}
+						return std::isnan( rhs ) && !std::isnan( lhs );
+					}
+				};
+
+				// Sorts each value with where it was, then keeps only the positions
+				template<typename T, typename Less>
+				std::vector<size_t> parallel_order( T const *values, size_t size, bool stable, Less less ) {
+					std::vector<std::pair<T, size_t>> items( size );
+					for( size_t n = 0; n < size; ++n ) {
+						items[n] = std::make_pair( values[n], n );
+					}
+					parallel_sort( items.data( ), size,
+					               [less]( std::pair<T, size_t> const &lhs, std::pair<T, size_t> const &rhs ) {
+						               return less( lhs.first, rhs.first );
+					               },
+					               stable );
+					std::vector<size_t> result( size );
+					for( size_t n = 0; n < size; ++n ) {
+						result[n] = items[n].second;
+					}
+					return result;
+				}
+			} // namespace
+
+			size_t thread_count( ) noexcept {
+				static size_t const count = std::max( 1u, std::thread::hardware_concurrency( ) );
+				return count;
+			}
+
+			void sort( integer *values, size_t size ) {
+				parallel_sort( values, size, std::less<integer>( ), false );
+			}
+
+			void sort( real *values, size_t size ) {
+				parallel_sort( values, size, LessReal( ), false );
+			}
+
+			std::vector<size_t> order( integer const *values, size_t size, bool stable ) {
+				return parallel_order( values, size, stable, std::less<integer>( ) );
+			}
+
+			std::vector<size_t> order( real const *values, size_t size, bool stable ) {
+				return parallel_order( values, size, stable, LessReal( ) );
+			}
+
+			std::vector<size_t> order( boost::string_ref const *values, size_t size, bool stable ) {
+				return parallel_order( values, size, stable, std::less<boost::string_ref>( ) );
+			}
+		} // namespace parallel
+	}   // namespace basic
+} // namespace daw
@@ -22,7 +22,6 @@
 
 #include <algorithm>
 #include <boost/algorithm/string.hpp>
-#include <boost/any.hpp>
 #include <boost/math/constants/constants.hpp>
 #include <boost/utility/string_ref.hpp>
 #include <cassert>
@@ -38,19 +37,16 @@
 #include <regex>
 #include <sstream>
 #include <string>
+#include <type_traits>
 #include <unordered_map>
 #include <vector>
 
+#include "basic_aot.h"
+#include "basic_mat.h"
+#include "basic_sort.h"
 #include "dawbasic.h"
 
 namespace {
-	std::string operator+( boost::string_ref lhs, boost::string_ref rhs ) {
-		std::string result( lhs.size( ) + rhs.size( ), '\0' );
-		auto out_it = std::copy( lhs.begin( ), lhs.end( ), result.begin( ) );
-		std::copy( rhs.begin( ), rhs.end( ), out_it );
-		return result;
-	}
-
 	template<typename Iterator, typename UnaryPredicate>
 	auto find_first_of( Iterator first, Iterator last, UnaryPredicate pred ) {
 		while( first != last ) {
@@ -93,7 +89,8 @@ namespace {
 
 	std::string to_upper( boost::string_ref str ) {
 		std::string result( str.size( ), '\0' );
-		std::transform( str.begin( ), str.end( ), result.begin( ), []( auto c ) { return c & 0b11011111; } );
+		std::transform( str.begin( ), str.end( ), result.begin( ),
+		                []( char c ) { return static_cast<char>( std::toupper( static_cast<unsigned char>( c ) ) ); } );
 		return result;
 	}
 
@@ -137,19 +134,29 @@ namespace daw {
 	namespace basic {
 		BasicException::~BasicException( ) {}
 
-		BasicException::BasicException( std::string const &msg, ErrorTypes errorType ) : runtime_error( msg ) {}
-		BasicException::BasicException( char const *msg, ErrorTypes errorType ) : runtime_error( msg ) {}
+		BasicException::BasicException( std::string const &msg, ErrorTypes errorType )
+		  : runtime_error( msg ), error_type( errorType ) {}
+		BasicException::BasicException( char const *msg, ErrorTypes errorType )
+		  : runtime_error( msg ), error_type( errorType ) {}
 
 		using std::placeholders::_1;
 
 		namespace {
+#if defined( DAW_BASIC_THREADED_DISPATCH )
+			constexpr DispatchMode default_dispatch_mode = DispatchMode::THREADED;
+#else
+			constexpr DispatchMode default_dispatch_mode = DispatchMode::SWITCH;
+#endif
+			constexpr size_t default_tier_threshold = 32; // Starts of a line before TIERED compiles it
+			constexpr size_t default_jit_threshold = 16;  // Backward jumps to a pc before the JIT compiles its loop
+			constexpr size_t npos = std::numeric_limits<size_t>::max( );
 
 			bool is_integer( BasicValue const &value ) {
-				return ValueType::INTEGER == value.first;
+				return ValueType::INTEGER == value.type( );
 			}
 
 			bool is_real( BasicValue const &value ) {
-				return ValueType::REAL == value.first;
+				return ValueType::REAL == value.type( );
 			}
 
 			bool is_numeric( BasicValue const &value ) {
@@ -168,36 +175,13 @@ namespace daw {
 				throw std::runtime_error( "Unknown error type tried to be thrown" );
 			}
 
-			integer operator_rank( boost::string_ref oper ) {
-				if( "NEG" == oper ) {
-					return 1;
-				} else if( "^" == oper ) {
-					return 2;
-				} else if( "*" == oper || "/" == oper ) {
-					return 3;
-				} else if( "+" == oper || "-" == oper || "%" == oper ) {
-					return 4;
-				} else if( ">>" == oper || "<<" == oper ) {
-					return 5;
-				} else if( ">" == oper || ">=" == oper || "<" == oper || "<=" == oper ) {
-					return 6;
-				} else if( "=" == oper ) {
-					return 7;
-				} else if( "AND" == oper ) {
-					return 8;
-				} else if( "OR" == oper ) {
-					return 9;
-				}
-				throw create_basic_exception( ErrorTypes::FATAL, "Unknown operator passed to operator_rank" );
-			}
-
 			BasicValue const &EMPTY_BASIC_VALUE( ) {
-				static BasicValue const result{ValueType::EMPTY, boost::any( )};
+				static BasicValue const result{};
 				return result;
 			}
 
-			ValueType get_value_type( BasicValue value ) {
-				return value.first;
+			ValueType get_value_type( BasicValue const &value ) {
+				return value.type( );
 			}
 
 			ValueType get_value_type( boost::string_ref value, std::string locale_str = "", bool trim_ws = true ) {
@@ -242,21 +226,11 @@ namespace daw {
 				return ValueType::INTEGER;
 			}
 
-			std::vector<boost::string_ref> split_in_two_on_char( boost::string_ref parse_string, char separator ) {
-				parse_string = trim( parse_string );
-				const auto pos = parse_string.find_first_of( separator );
-				std::vector<boost::string_ref> result;
-				if( boost::string_ref::npos != pos ) {
-					result.push_back( trim( parse_string.substr( 0, pos ) ) );
-					result.push_back( trim( parse_string.substr( pos + 1 ) ) );
-				} else {
-					result.push_back( parse_string );
+			integer to_integer( BasicValue const &value ) {
+				if( ValueType::INTEGER != value.type( ) ) {
+					throw create_basic_exception( ErrorTypes::FATAL, "Attempt to convert a non-integer to an integer" );
 				}
-				return result;
-			}
-
-			integer to_integer( BasicValue value ) {
-				return boost::any_cast<integer>( value.second );
+				return value.integer_value( );
 			}
 
 			integer to_integer( boost::string_ref value ) {
@@ -267,16 +241,19 @@ namespace daw {
 				return boost::lexical_cast<real>( value );
 			}
 
-			real to_real( BasicValue value ) {
-				return boost::any_cast<real>( value.second );
+			real to_real( BasicValue const &value ) {
+				if( ValueType::REAL != value.type( ) ) {
+					throw create_basic_exception( ErrorTypes::FATAL, "Attempt to convert a non-real to a real" );
+				}
+				return value.real_value( );
 			}
 
-			real to_numeric( BasicValue value ) {
-				switch( value.first ) {
+			real to_numeric( BasicValue const &value ) {
+				switch( value.type( ) ) {
 				case ValueType::INTEGER:
-					return static_cast<real>( to_integer( value ) );
+					return static_cast<real>( value.integer_value( ) );
 				case ValueType::REAL:
-					return boost::any_cast<real>( value.second );
+					return value.real_value( );
 				case ValueType::ARRAY:
 				case ValueType::BOOLEAN:
 				case ValueType::EMPTY:
@@ -287,53 +264,31 @@ namespace daw {
 				}
 			}
 
-			boolean to_boolean( BasicValue value ) {
-				if( ValueType::BOOLEAN == value.first ) {
-					return boost::any_cast<boolean>( value.second );
+			boolean to_boolean( BasicValue const &value ) {
+				if( ValueType::BOOLEAN == value.type( ) ) {
+					return value.boolean_value( );
 				}
 				throw create_basic_exception( ErrorTypes::FATAL, "Attempt to convert a non-boolean to a boolean" );
 			}
 
 			BasicValue basic_value_integer( integer value ) {
-				return BasicValue{ValueType::INTEGER, boost::any( std::move( value ) )};
-			}
-
-			BasicValue basic_value_integer( boost::string_ref value ) {
-				return basic_value_integer( to_integer( value ) );
+				return BasicValue( value );
 			}
 
 			BasicValue basic_value_real( real value ) {
-				return BasicValue{ValueType::REAL, boost::any( std::move( value ) )};
+				return BasicValue( value );
 			}
 
 			BasicValue basic_value_real( boost::string_ref value ) {
 				return basic_value_real( to_real( value ) );
 			}
 
-			BasicValue basic_value_numeric( boost::string_ref value ) {
-				auto value_type = get_value_type( value );
-				switch( value_type ) {
-				case ValueType::INTEGER:
-					return basic_value_integer( value );
-				case ValueType::REAL:
-					return basic_value_real( value );
-				case ValueType::ARRAY:
-				case ValueType::BOOLEAN:
-				case ValueType::EMPTY:
-				case ValueType::STRING:
-					throw create_basic_exception( ErrorTypes::FATAL,
-					                              "Attempt to create a numeric BasicValue from a non-numeric string" );
-				default:
-					throw std::exception{};
-				}
-			}
-
 			BasicValue basic_value_boolean( boolean value ) {
-				return BasicValue{ValueType::BOOLEAN, boost::any( std::move( value ) )};
+				return BasicValue( value );
 			}
 
 			BasicValue basic_value_string( boost::string_ref value ) {
-				return BasicValue{ValueType::STRING, boost::any( value.to_string( ) )};
+				return BasicValue( value );
 			}
 
 			/*
@@ -344,20 +299,18 @@ namespace daw {
 			}
 			*/
 
-			std::string to_string( BasicValue value ) {
+			std::string to_string( BasicValue const &value ) {
 				std::stringstream ss;
-				switch( value.first ) {
+				switch( value.type( ) ) {
 				case ValueType::EMPTY:
 					break;
 				case ValueType::INTEGER:
-					ss << to_integer( std::move( value ) );
-					break;
+					return std::to_string( value.integer_value( ) );
 				case ValueType::REAL:
-					ss << std::setprecision( std::numeric_limits<real>::digits10 ) << to_real( std::move( value ) );
+					ss << std::setprecision( std::numeric_limits<real>::digits10 ) << value.real_value( );
 					break;
 				case ValueType::STRING:
-					ss << boost::any_cast<std::string>( value.second );
-					break;
+					return value.string_value( ).to_string( );
 				case ValueType::BOOLEAN:
 					if( to_boolean( value ) ) {
 						ss << "TRUE";
@@ -373,6 +326,16 @@ namespace daw {
 				return ss.str( );
 			}
 
+			//////////////////////////////////////////////////////////////////////////
+			/// summary: Compare two values as strings.  Only converts values that
+			/// are not strings already
+			int compare_as_strings( BasicValue const &lhs, BasicValue const &rhs ) {
+				if( ValueType::STRING == lhs.type( ) && ValueType::STRING == rhs.type( ) ) {
+					return lhs.string_value( ).compare( rhs.string_value( ) );
+				}
+				return to_string( lhs ).compare( to_string( rhs ) );
+			}
+
 			template<typename M>
 			auto get_keys( const M &m ) -> std::vector<typename M::key_type> {
 				std::vector<typename M::key_type> result( m.size( ) );
@@ -402,8 +365,8 @@ namespace daw {
 				throw create_basic_exception( ErrorTypes::FATAL, "Unknown ValueType" );
 			}
 
-			std::string value_type_to_string( BasicValue value ) {
-				return value_type_to_string( std::move( value.first ) );
+			std::string value_type_to_string( BasicValue const &value ) {
+				return value_type_to_string( value.type( ) );
 			}
 
 			ValueType determine_result_type( ValueType lhs_type, ValueType rhs_type ) {
@@ -483,6 +446,13 @@ namespace daw {
 				return result;
 			}
 
+			std::vector<BasicValue> pop_values( std::vector<BasicValue> &stack, int32_t count ) {
+				std::vector<BasicValue> result( std::make_move_iterator( std::end( stack ) - count ),
+				                                std::make_move_iterator( std::end( stack ) ) );
+				stack.erase( std::end( stack ) - count, std::end( stack ) );
+				return result;
+			}
+
 			//////////////////////////////////////////////////////////////////////////
 			/// summary: Makes a value from a single token
 			//////////////////////////////////////////////////////////////////////////
@@ -526,68 +496,6 @@ namespace daw {
 				throw create_basic_exception( ErrorTypes::SYNTAX, "Could not find end of quoted string, not closing quotes" );
 			}
 
-			size_t find_end_of_bracket( boost::string_ref value ) {
-				intmax_t bracket_count = 1;
-				size_t pos = 0;
-				if( ')' == value[pos] ) {
-					return pos;
-				}
-				++pos;
-				for( ; pos < value.size( ); ++pos ) {
-					if( '(' == value[pos] ) {
-						++bracket_count;
-					} else if( ')' == value[pos] ) {
-						--bracket_count;
-						if( 0 == bracket_count ) {
-							return pos;
-						}
-					}
-				}
-				throw create_basic_exception( ErrorTypes::SYNTAX, "Unclosed bracket found" );
-			}
-
-			size_t find_end_of_operand( boost::string_ref value ) {
-				assert( value.size( ) > 0 );
-
-				const static std::vector<char> end_chars{' ', '	', '^', '*', '/', '+', '-', '=', '<', '>', '%'};
-				intmax_t bracket_count = 0;
-
-				auto has_brackets = false;
-				for( size_t pos = 0; pos < value.size( ); ++pos ) {
-					auto const &current_char = value[pos];
-					if( 0 >= bracket_count ) {
-						if( '"' == current_char ) {
-							throw create_basic_exception( ErrorTypes::SYNTAX,
-							                              "Unexpected quote \" character at position " + std::to_string( pos ) );
-						}
-						if( ')' == current_char ) {
-							throw create_basic_exception( ErrorTypes::SYNTAX, "Unexpected close bracket ) character at position " +
-							                                                    std::to_string( pos ) );
-						}
-						if( std::end( end_chars ) != std::find( std::begin( end_chars ), std::end( end_chars ), current_char ) ) {
-							return pos - 1;
-						} else if( '(' == current_char ) {
-							if( has_brackets ) {
-								throw create_basic_exception( ErrorTypes::SYNTAX,
-								                              "Unexpected opening bracket after brackets have closed at position " +
-								                                std::to_string( pos ) );
-							}
-							++bracket_count;
-							has_brackets = true;
-						}
-					} else {
-						if( '"' == current_char ) {
-							pos += find_end_of_string( value.substr( pos ) );
-						} else if( ')' == current_char ) {
-							--bracket_count;
-						} else if( '(' == current_char ) {
-							++bracket_count;
-						}
-					}
-				}
-				return value.size( ) - 1;
-			}
-
 			auto remove_outer_characters( boost::string_ref value, char lhs, char rhs ) {
 				if( !value.empty( ) && 2 <= value.size( ) ) {
 					if( lhs == value[0] && rhs == value[value.size( ) - 1] ) {
@@ -601,10 +509,6 @@ namespace daw {
 				return remove_outer_characters( value, '"', '"' );
 			}
 
-			auto remove_outer_bracket( boost::string_ref value ) {
-				return remove_outer_characters( value, '(', ')' );
-			}
-
 			void replace_all( std::string &str, std::string const &from, std::string const &to ) {
 				if( from.empty( ) ) {
 					return;
@@ -622,15 +526,6 @@ namespace daw {
 				return result;
 			};
 
-			size_t multiply_list( std::vector<size_t> const &dimensions ) {
-				size_t result = 1;
-				for( const auto &dimension : dimensions ) {
-					result *= dimension;
-				}
-
-				return result;
-			}
-
 			std::vector<size_t> convert_dimensions( std::vector<BasicValue> dimensions ) {
 				std::vector<size_t> index;
 				for( const auto &value : dimensions ) {
@@ -641,1938 +536,5568 @@ namespace daw {
 				return index;
 			}
 
-		} // namespace
-
-		//////////////////////////////////////////////////////////////////////////
-		// Basic::BasicArray
-		//////////////////////////////////////////////////////////////////////////
-		Basic::BasicArray::BasicArray( ) : m_dimensions( ), m_values( ) {}
+			bool is_digit( char c ) {
+				return 0 != std::isdigit( static_cast<unsigned char>( c ) );
+			}
 
-		Basic::BasicArray::BasicArray( std::vector<size_t> dimensions )
-		  : m_dimensions( dimensions ), m_values( multiply_list( dimensions ) ) {}
+			bool is_identifier_start( char c ) {
+				return 0 != std::isalpha( static_cast<unsigned char>( c ) ) || '_' == c;
+			}
 
-		Basic::BasicArray::BasicArray( BasicArray const &other )
-		  : m_dimensions( other.m_dimensions ), m_values( other.m_values ) {}
+			bool is_identifier_char( char c ) {
+				return 0 != std::isalnum( static_cast<unsigned char>( c ) ) || '_' == c || '$' == c;
+			}
 
-		Basic::BasicArray::BasicArray( BasicArray &&other )
-		  : m_dimensions( std::move( other.m_dimensions ) ), m_values( std::move( other.m_values ) ) {}
+			size_t find_end_of_identifier( boost::string_ref value ) {
+				size_t pos = 0;
+				if( value.empty( ) || !is_identifier_start( value[0] ) ) {
+					return pos;
+				}
+				while( pos < value.size( ) && is_identifier_char( value[pos] ) ) {
+					++pos;
+				}
+				// Names of arrays of reals end with #.  The % of an array of integers
+				// is crunched as MODULO and joined to the name where it is used, as
+				// A%( is A MOD ( unless there is an array A%
+				if( pos < value.size( ) && '#' == value[pos] ) {
+					++pos;
+				}
+				return pos;
+			}
 
-		Basic::BasicArray &Basic::BasicArray::operator=( BasicArray other ) {
-			m_dimensions = std::move( other.m_dimensions );
-			m_values = std::move( other.m_values );
-			return *this;
-		}
+			//////////////////////////////////////////////////////////////////////////
+			/// summary: Integer results that do not fit in integer become reals
+			/// instead of wrapping
+			BasicValue checked_integer( int64_t value ) {
+				if( can_fit<integer>( value ) ) {
+					return basic_value_integer( static_cast<integer>( value ) );
+				}
+				return basic_value_real( static_cast<real>( value ) );
+			}
 
-		namespace {
-			template<typename Iter1, typename Iter2, typename Predicate>
-			bool are_equal( Iter1 it_start1, Iter1 it_end1, Iter2 it_start2, Iter2 it_end2, Predicate pred ) {
-				while( it_start1 != it_end1 && it_start2 != it_end2 ) {
-					if( !pred( *it_start1, *it_start2 ) ) {
-						return false;
-					}
-					++it_start1;
-					++it_start2;
+			BasicValue checked_integer( real value ) {
+				if( static_cast<real>( std::numeric_limits<integer>::min( ) ) <= value &&
+				    value <= static_cast<real>( std::numeric_limits<integer>::max( ) ) ) {
+					return basic_value_integer( static_cast<integer>( value ) );
 				}
-				return it_start1 == it_end1 && it_start2 == it_end2;
+				return basic_value_real( value );
 			}
 
-			template<typename Iter1, typename Iter2>
-			bool are_equal( Iter1 it_start1, Iter1 it_end1, Iter2 it_start2, Iter2 it_end2 ) {
-				using ValueType = decltype( *it_start1 );
-				auto eq_compare = []( const ValueType &v1, const ValueType &v2 ) { return v1 == v2; };
-				return are_equal( it_start1, it_end1, it_start2, it_end2, eq_compare );
+			//////////////////////////////////////////////////////////////////////////
+			/// summary: Kernels for two integers.  They work in 64 bits so that a
+			/// result that overflows is detected and promoted to a real
+			BasicValue add_integers( integer lhs, integer rhs ) {
+				return checked_integer( static_cast<int64_t>( lhs ) + rhs );
 			}
 
-			template<typename ContainerType, typename Predicate>
-			bool are_equal( const ContainerType &c1, const ContainerType &c2, Predicate pred ) {
-				bool result = c1.size( ) == c2.size( );
-				if( result ) {
-					using std::begin;
-					using std::end;
-					result = are_equal( begin( c1 ), end( c1 ), begin( c2 ), end( c2 ), pred );
-				}
-				return result;
+			BasicValue subtract_integers( integer lhs, integer rhs ) {
+				return checked_integer( static_cast<int64_t>( lhs ) - rhs );
 			}
 
-			template<typename ContainerType>
-			bool are_equal( ContainerType const &c1, ContainerType const &c2 ) {
-				using ValueType = typename ContainerType::value_type;
-				auto eq_compare = []( const ValueType &v1, const ValueType &v2 ) { return v1 == v2; };
-				return are_equal( c1, c2, eq_compare );
+			BasicValue multiply_integers( integer lhs, integer rhs ) {
+				return checked_integer( static_cast<int64_t>( lhs ) * rhs );
 			}
-		} // namespace
 
-		bool Basic::BasicArray::operator==( BasicArray const &rhs ) const {
-			auto compare_function = []( basic::BasicValue const &v1, basic::BasicValue const &v2 ) {
-				bool result = v1.first == v2.first;
-				if( result ) {
-					switch( v1.first ) {
-					case ValueType::EMPTY:
-						result &= true;
-						break;
-					case ValueType::BOOLEAN:
-						result &= to_boolean( v1 ) == to_boolean( v2 );
-						break;
-					case ValueType::INTEGER:
-						result &= to_integer( v1 ) == to_integer( v2 );
-						break;
-					case ValueType::REAL:
-						result &= almost_equal( to_real( v1 ), to_real( v2 ) );
-						break;
-					case ValueType::STRING:
-						result &= to_string( v1 ) == to_string( v2 );
-						break;
-					case ValueType::ARRAY:
-						throw std::runtime_error( "Unimplemented feature" );
-					default:
-						throw std::exception{};
-					}
+			BasicValue divide_integers( integer lhs, integer rhs ) {
+				if( 0 == rhs ) {
+					throw create_basic_exception( ErrorTypes::SYNTAX, "Division by zero" );
 				}
-				return result;
-			};
+				return checked_integer( static_cast<int64_t>( lhs ) / rhs );
+			}
 
-			return are_equal( m_dimensions, rhs.m_dimensions ) && are_equal( m_values, rhs.m_values, compare_function );
-		}
+			BasicValue modulo_integers( integer lhs, integer rhs ) {
+				if( 0 == rhs ) {
+					throw create_basic_exception( ErrorTypes::SYNTAX, "Division by zero" );
+				}
+				return checked_integer( static_cast<int64_t>( lhs ) % rhs );
+			}
 
-		BasicValue &Basic::BasicArray::operator( )( std::vector<size_t> dimensions ) {
-			if( m_dimensions.size( ) != dimensions.size( ) ) {
-				std::stringstream ss;
-				ss << "Must supply " << m_dimensions.size( ) << " indexes to address array";
-				throw ::daw::basic::create_basic_exception( ErrorTypes::SYNTAX, ss.str( ) );
+			BasicValue power_integers( integer lhs, integer rhs ) {
+				return checked_integer( pow( static_cast<real>( lhs ), static_cast<real>( rhs ) ) );
 			}
-			try {
-				size_t multiplier = 1;
-				size_t pos = 0;
-				for( size_t n = 0; n < m_dimensions.size( ); ++n ) {
-					pos += dimensions[n] * multiplier;
-					multiplier *= m_dimensions[n];
-				}
-				return m_values.at( pos );
-			} catch( std::out_of_range ex ) {
-				std::stringstream ss;
-				ss << "Array out of bounds.  Max is ( ";
-				bool is_first = true;
-				for( auto &dim : m_dimensions ) {
-					if( !is_first ) {
-						ss << ", ";
-					} else {
-						is_first = false;
-					}
-					ss << dim;
+
+			//////////////////////////////////////////////////////////////////////////
+			/// summary: Kernels of the built in operators for any operands.  Operands
+			/// are borrowed from the stack and the result is built in place so
+			/// applying an operator only allocates when it makes a long string
+			BasicValue multiply_values( BasicValue const &lhs, BasicValue const &rhs ) {
+				switch( determine_result_type( lhs.type( ), rhs.type( ) ) ) {
+				case ValueType::INTEGER:
+					return multiply_integers( lhs.integer_value( ), rhs.integer_value( ) );
+				case ValueType::REAL:
+					return basic_value_real( to_numeric( lhs ) * to_numeric( rhs ) );
+				case ValueType::ARRAY:
+				case ValueType::BOOLEAN:
+				case ValueType::EMPTY:
+				case ValueType::STRING:
+					break;
 				}
-				ss << " ) you requested ( ";
-				for( auto &dim : dimensions ) {
-					if( !is_first ) {
-						ss << ", ";
-					} else {
-						is_first = false;
-					}
-					ss << dim;
+				throw create_basic_exception( ErrorTypes::SYNTAX, "Attempt to multiply non-numeric types" );
+			}
+
+			BasicValue divide_values( BasicValue const &lhs, BasicValue const &rhs ) {
+				switch( determine_result_type( lhs.type( ), rhs.type( ) ) ) {
+				case ValueType::INTEGER:
+					return divide_integers( lhs.integer_value( ), rhs.integer_value( ) );
+				case ValueType::REAL:
+					return basic_value_real( to_numeric( lhs ) / to_numeric( rhs ) );
+				case ValueType::ARRAY:
+				case ValueType::BOOLEAN:
+				case ValueType::EMPTY:
+				case ValueType::STRING:
+					break;
 				}
-				ss << ")";
-				throw ::daw::basic::create_basic_exception( ErrorTypes::SYNTAX, ss.str( ) );
+				throw create_basic_exception( ErrorTypes::SYNTAX, "Attempt to divide non-numeric types" );
 			}
-		}
 
-		BasicValue const &Basic::BasicArray::operator( )( std::vector<size_t> dimensions ) const {
-			if( m_dimensions.size( ) != dimensions.size( ) ) {
-				std::stringstream ss;
-				ss << "Must supply " << m_dimensions.size( ) << " indexes to address array";
-				throw ::daw::basic::create_basic_exception( ErrorTypes::SYNTAX, ss.str( ) );
+			BasicValue modulo_values( BasicValue const &lhs, BasicValue const &rhs ) {
+				if( ValueType::INTEGER == determine_result_type( lhs.type( ), rhs.type( ) ) ) {
+					return modulo_integers( lhs.integer_value( ), rhs.integer_value( ) );
+				}
+				throw create_basic_exception( ErrorTypes::SYNTAX, "Attempt to do modular arithmetic with non-integers" );
 			}
-			try {
-				size_t multiplier = 1;
-				size_t pos = 0;
-				for( size_t n = 0; n < m_dimensions.size( ); ++n ) {
-					pos += dimensions[n] * multiplier;
-					multiplier *= m_dimensions[n];
+
+			BasicValue add_values( BasicValue const &lhs, BasicValue const &rhs ) {
+				switch( determine_result_type( lhs.type( ), rhs.type( ) ) ) {
+				case ValueType::INTEGER:
+					return add_integers( lhs.integer_value( ), rhs.integer_value( ) );
+				case ValueType::REAL:
+					return basic_value_real( to_numeric( lhs ) + to_numeric( rhs ) );
+				case ValueType::STRING: { // Append
+					auto result = to_string( lhs );
+					result += to_string( rhs );
+					return basic_value_string( result );
 				}
-				return m_values.at( pos );
-			} catch( std::out_of_range ex ) {
-				std::stringstream ss;
-				ss << "Array out of bounds.  Max is less than ( ";
-				bool is_first = true;
-				for( auto &dim : m_dimensions ) {
-					if( !is_first ) {
-						ss << ", ";
-					} else {
-						is_first = false;
-					}
-					ss << dim;
+				case ValueType::ARRAY:
+				case ValueType::BOOLEAN:
+				case ValueType::EMPTY:
+					break;
 				}
-				is_first = true;
-				ss << " ) you requested ( ";
-				for( auto &dim : dimensions ) {
-					if( !is_first ) {
-						ss << ", ";
-					} else {
-						is_first = false;
-					}
-					ss << dim;
+				throw create_basic_exception( ErrorTypes::SYNTAX, "Attempt to add non-numeric types" );
+			}
+
+			BasicValue subtract_values( BasicValue const &lhs, BasicValue const &rhs ) {
+				switch( determine_result_type( lhs.type( ), rhs.type( ) ) ) {
+				case ValueType::INTEGER:
+					return subtract_integers( lhs.integer_value( ), rhs.integer_value( ) );
+				case ValueType::REAL:
+					return basic_value_real( to_numeric( lhs ) - to_numeric( rhs ) );
+				case ValueType::ARRAY:
+				case ValueType::BOOLEAN:
+				case ValueType::EMPTY:
+				case ValueType::STRING:
+					break;
 				}
-				ss << ")";
-				throw ::daw::basic::create_basic_exception( ErrorTypes::SYNTAX, ss.str( ) );
+				throw create_basic_exception( ErrorTypes::SYNTAX, "Attempt to subtract non-numeric types" );
 			}
-		}
 
-		std::vector<size_t> Basic::BasicArray::dimensions( ) const {
-			return m_dimensions;
-		}
+			BasicValue power_values( BasicValue const &lhs, BasicValue const &rhs ) {
+				if( ValueType::INTEGER == determine_result_type( lhs.type( ), rhs.type( ) ) ) {
+					return power_integers( lhs.integer_value( ), rhs.integer_value( ) );
+				}
+				return basic_value_real( pow( to_numeric( lhs ), to_numeric( rhs ) ) );
+			}
 
-		//////////////////////////////////////////////////////////////////////////
-		// Basic
-		/////////////////////////////////////////////////////////////////////////
+			BasicValue negate_value( BasicValue const &value ) {
+				if( ValueType::INTEGER == value.type( ) ) {
+					return checked_integer( -static_cast<int64_t>( value.integer_value( ) ) );
+				} else if( ValueType::REAL == value.type( ) ) {
+					return basic_value_real( -value.real_value( ) );
+				}
+				throw create_basic_exception( ErrorTypes::SYNTAX, "Attempt to apply a negative sign to a non-number" );
+			}
 
-		//////////////////////////////////////////////////////////////////////////
-		/// summary: Evaluate a string and solve all functions/variables
-		BasicValue Basic::evaluate( boost::string_ref value ) {
-			size_t current_position = 0;
-			std::vector<BasicValue> operand_stack;
-			std::vector<std::string> operator_stack;
+			struct EqualTo {
+				template<typename T>
+				bool operator( )( T const &lhs, T const &rhs ) const {
+					return lhs == rhs;
+				}
 
-			auto is_higher_precedence = [&operator_stack]( boost::string_ref oper ) {
-				if( operator_stack.empty( ) ) {
-					return true;
+				bool operator( )( real lhs, real rhs ) const {
+					return almost_equal( lhs, rhs );
 				}
-				auto from_stack = *( operator_stack.rbegin( ) );
-				return operator_rank( oper ) < operator_rank( from_stack );
 			};
 
-			auto is_logical_and = []( boost::string_ref val, size_t pos, size_t end ) {
-				std::string const check_text{"AND"};
-				if( pos + check_text.size( ) <= end ) {
-					auto const txt_window = to_upper( val.substr( pos, check_text.size( ) ) );
-					if( check_text == txt_window ) {
-						auto ws_check = val[pos + check_text.size( )];
-						return ' ' == ws_check || '	' == ws_check;
+			//////////////////////////////////////////////////////////////////////////
+			/// summary: Compare values of the same kind.  Strings are compared by
+			/// the sign of their comparison, empty values are equal to each other
+			template<typename Compare>
+			BasicValue compare_values( BasicValue const &lhs, BasicValue const &rhs, Compare compare ) {
+				switch( determine_result_type( lhs.type( ), rhs.type( ) ) ) {
+				case ValueType::BOOLEAN:
+					return basic_value_boolean( compare( lhs.boolean_value( ), rhs.boolean_value( ) ) );
+				case ValueType::EMPTY:
+					if( lhs.type( ) != rhs.type( ) ) {
+						throw create_basic_exception( ErrorTypes::SYNTAX, "Attempt to compare different types " +
+						                                                    value_type_to_string( lhs ) + " and " +
+						                                                    value_type_to_string( rhs ) );
 					}
+					return basic_value_boolean( compare( 0, 0 ) );
+				case ValueType::INTEGER:
+					return basic_value_boolean( compare( lhs.integer_value( ), rhs.integer_value( ) ) );
+				case ValueType::REAL:
+					return basic_value_boolean( compare( to_numeric( lhs ), to_numeric( rhs ) ) );
+				case ValueType::STRING:
+					return basic_value_boolean( compare( compare_as_strings( lhs, rhs ), 0 ) );
+				case ValueType::ARRAY:
+					break;
 				}
-				return false;
-			};
+				throw create_basic_exception( ErrorTypes::FATAL, "Unknown ValueType" );
+			}
 
-			auto is_logical_or = []( boost::string_ref val, size_t pos, size_t end ) {
-				std::string const check_text{"OR"};
-				if( pos + check_text.size( ) <= end ) {
-					auto txt_window = to_upper( val.substr( pos, check_text.size( ) ) );
-					if( check_text == txt_window ) {
-						auto ws_check = val[pos + check_text.size( )];
-						return ' ' == ws_check || '	' == ws_check;
-					}
+			//////////////////////////////////////////////////////////////////////////
+			/// summary: Apply oper to two integers.  AND and OR need booleans
+			BasicValue apply_integer_operator( Operator oper, integer lhs, integer rhs ) {
+				switch( oper ) {
+				case Operator::POWER:
+					return power_integers( lhs, rhs );
+				case Operator::MULTIPLY:
+					return multiply_integers( lhs, rhs );
+				case Operator::DIVIDE:
+					return divide_integers( lhs, rhs );
+				case Operator::MODULO:
+					return modulo_integers( lhs, rhs );
+				case Operator::ADD:
+					return add_integers( lhs, rhs );
+				case Operator::SUBTRACT:
+					return subtract_integers( lhs, rhs );
+				case Operator::EQUAL:
+					return basic_value_boolean( lhs == rhs );
+				case Operator::LESS:
+					return basic_value_boolean( lhs < rhs );
+				case Operator::LESS_EQUAL:
+					return basic_value_boolean( lhs <= rhs );
+				case Operator::GREATER:
+					return basic_value_boolean( lhs > rhs );
+				case Operator::GREATER_EQUAL:
+					return basic_value_boolean( lhs >= rhs );
+				case Operator::AND:
+				case Operator::OR:
+					throw create_basic_exception( ErrorTypes::FATAL, "Attempt to convert a non-boolean to a boolean" );
+				case Operator::NEGATE:
+					break;
 				}
-				return false;
-			};
+				throw create_basic_exception( ErrorTypes::FATAL, "Unknown binary operator" );
+			}
 
-			auto const end = value.size( ) - 1;
-
-			while( current_position <= end ) {
-				auto current_char = value[current_position];
-				if( 'a' == current_char ) {
-					current_char = 'A';
-				} else if( 'o' == current_char ) {
-					current_char = 'O';
-				}
-				switch( current_char ) {
-				case '"': { // String boundary
-					auto current_operand = value.substr( current_position ).to_string( );
-					auto end_of_string = find_end_of_string( current_operand );
-					current_operand = current_operand.substr( 0, end_of_string + 1 );
-					current_operand = remove_outer_quotes( current_operand ).to_string( );
-					replace_all( current_operand, "\\\"", "\"" );
-					operand_stack.push_back( basic_value_string( remove_outer_quotes( current_operand ) ) );
-					current_position += end_of_string;
-				} break;
-				case '(': // Bracket boundary
-				{
-					auto text_in_bracket = value.substr( current_position + 1 );
-					auto end_of_bracket = find_end_of_bracket( text_in_bracket );
-					text_in_bracket = text_in_bracket.substr( 0, end_of_bracket );
-					auto evaluated_bracket = evaluate( std::move( text_in_bracket ) );
-					operand_stack.push_back( evaluated_bracket );
-					current_position += end_of_bracket + 1;
-				} break;
-				case ' ':
-				case '	':
-					while( ' ' == value[current_position + 1] || '	' == value[current_position + 1] ) {
-						++current_position;
-					}
+			//////////////////////////////////////////////////////////////////////////
+			/// summary: Apply oper to two reals.  % and AND and OR do not take reals
+			BasicValue apply_real_operator( Operator oper, real lhs, real rhs ) {
+				switch( oper ) {
+				case Operator::POWER:
+					return basic_value_real( pow( lhs, rhs ) );
+				case Operator::MULTIPLY:
+					return basic_value_real( lhs * rhs );
+				case Operator::DIVIDE:
+					return basic_value_real( lhs / rhs );
+				case Operator::ADD:
+					return basic_value_real( lhs + rhs );
+				case Operator::SUBTRACT:
+					return basic_value_real( lhs - rhs );
+				case Operator::EQUAL:
+					return basic_value_boolean( almost_equal( lhs, rhs ) );
+				case Operator::LESS:
+					return basic_value_boolean( lhs < rhs );
+				case Operator::LESS_EQUAL:
+					return basic_value_boolean( lhs <= rhs );
+				case Operator::GREATER:
+					return basic_value_boolean( lhs > rhs );
+				case Operator::GREATER_EQUAL:
+					return basic_value_boolean( lhs >= rhs );
+				case Operator::MODULO:
+					throw create_basic_exception( ErrorTypes::SYNTAX, "Attempt to do modular arithmetic with non-integers" );
+				case Operator::AND:
+				case Operator::OR:
+					throw create_basic_exception( ErrorTypes::FATAL, "Attempt to convert a non-boolean to a boolean" );
+				case Operator::NEGATE:
 					break;
-				case 'A':
-					if( is_logical_and( value, current_position, end ) ) {
-						goto explicit_operator;
-					} else {
-						goto explicit_default;
-					}
-				case 'O':
-					if( is_logical_or( value, current_position, end ) ) {
-						goto explicit_operator;
-					} else {
-						goto explicit_default;
-					}
-				case '%':
-				case '^':
-				case '*':
-				case '/':
-				case '+':
-				case '-':
-				case '<':
-				case '>':
-				case '=': {
-				explicit_operator:
-					std::string current_operator = char_to_string( current_char );
-					// Negation of numbers
-					if( '-' == current_char ) {
-						// Check for unary negation.
-						if( operator_stack.empty( ) && operand_stack.empty( ) ) {
-							current_operator = "NEG";
-						} else if( !operator_stack.empty( ) && ( 1 == operand_stack.size( ) % 2 ) ) {
-							current_operator = "NEG";
-						}
-					}
-					if( '>' == current_char || '<' == current_char ) {
-						if( current_position >= end ) {
-							throw create_basic_exception( ErrorTypes::SYNTAX, "Binary operator with only left hand side, not right" );
-						}
-						if( '=' == value[current_position + 1] ) {
-							current_operator += value[++current_position];
-						}
-					} else if( 'A' == current_char ) {
-						current_operator = "AND";
-						current_position += 2;
-					} else if( 'O' == current_char ) {
-						current_operator = "OR";
-						current_position += 1;
-					}
-					// Used to be an if, changed to a while
-					while( !is_higher_precedence( current_operator ) ) {
-						// Pop from operand stack and do operators and push value back to stack
-						BasicValue rhs( pop( operand_stack ) );
-						auto prev_operator( pop( operator_stack ) );
-						BasicValue result( EMPTY_BASIC_VALUE( ) );
-						if( is_unary_operator( prev_operator ) ) {
-							result = m_unary_operators[prev_operator]( std::move( rhs ) );
-						} else if( is_binary_operator( prev_operator ) ) {
-							result = m_binary_operators[prev_operator]( pop( operand_stack ), std::move( rhs ) );
-						} else {
-							throw create_basic_exception( ErrorTypes::SYNTAX,
-							                              "Unknown operator " +
-							                                prev_operator ); // Probably should never happen...but you know
-						}
-						operand_stack.push_back( result );
-					}
-					operator_stack.push_back( current_operator );
-				} break;
-				default: {
-				explicit_default:
-					auto current_operand = value.substr( current_position );
-					auto end_of_operand = find_end_of_operand( current_operand );
-					current_operand = current_operand.substr( 0, end_of_operand + 1 );
-
-					auto split_operand = split_arrayfunction_from_string( current_operand, false );
-
-					if( 0 < split_operand.second.size( ) ) { // We are a function, find parameters and push value to stack
-						if( is_function( split_operand.first ) ) {
-							operand_stack.push_back( exec_function( split_operand.first, split_operand.second ) );
-						} else if( is_array( split_operand.first ) ) {
-							operand_stack.emplace_back( get_array_variable( split_operand.first, split_operand.second ) );
-						} else {
-							throw create_basic_exception( ErrorTypes::SYNTAX, "Unknown symbol name '" + split_operand.first + "'" );
-						}
-					} else {
-						if( is_variable( split_operand.first ) ) {
-							// We are a variable, push value onto stack
-							operand_stack.emplace_back( get_variable_constant( split_operand.first ) );
-						} else {
-							// We must be a number
-							auto value_type = get_value_type( current_operand.to_string( ) );
-							switch( value_type ) {
-							case ValueType::INTEGER:
-								operand_stack.push_back( basic_value_integer( std::move( current_operand ) ) );
-								break;
-							case ValueType::REAL:
-								operand_stack.push_back( basic_value_real( std::move( current_operand ) ) );
-								break;
-							case ValueType::EMPTY:
-							case ValueType::STRING:
-							case ValueType::BOOLEAN:
-							case ValueType::ARRAY:
-								throw create_basic_exception( ErrorTypes::SYNTAX,
-								                              "Unknown symbol '" + current_operand.to_string( ) + "'" );
-							default:
-								throw std::exception{};
-							}
-						}
-					}
-					current_position += end_of_operand;
-				}
-				} // switch
-				++current_position;
-			} // while
-			  // finish stacks
-			while( !operator_stack.empty( ) ) {
-				auto current_operator = pop( operator_stack );
-				auto rhs = pop( operand_stack );
-				BasicValue result = EMPTY_BASIC_VALUE( );
-				if( is_unary_operator( current_operator ) ) {
-					result = m_unary_operators[current_operator]( std::move( rhs ) );
-				} else if( is_binary_operator( current_operator ) ) {
-					result = m_binary_operators[current_operator]( pop( operand_stack ), std::move( rhs ) );
-				} else {
-					throw create_basic_exception(
-					  ErrorTypes::SYNTAX, "Unknown operator " + current_operator ); // Probably should never happen...but you know
 				}
-				operand_stack.push_back( result );
+				throw create_basic_exception( ErrorTypes::FATAL, "Unknown binary operator" );
 			}
-			if( operand_stack.empty( ) ) {
-				return EMPTY_BASIC_VALUE( );
+
+			//////////////////////////////////////////////////////////////////////////
+			/// summary: Apply a built in binary operator.  When both operands are
+			/// integers or both are reals the kernel is picked from the operator
+			/// alone, other pairings go through determine_result_type
+			BasicValue apply_operator( Operator oper, BasicValue const &lhs, BasicValue const &rhs ) {
+				if( ValueType::INTEGER == lhs.type( ) && ValueType::INTEGER == rhs.type( ) ) {
+					return apply_integer_operator( oper, lhs.integer_value( ), rhs.integer_value( ) );
+				} else if( ValueType::REAL == lhs.type( ) && ValueType::REAL == rhs.type( ) ) {
+					return apply_real_operator( oper, lhs.real_value( ), rhs.real_value( ) );
+				}
+				switch( oper ) {
+				case Operator::POWER:
+					return power_values( lhs, rhs );
+				case Operator::MULTIPLY:
+					return multiply_values( lhs, rhs );
+				case Operator::DIVIDE:
+					return divide_values( lhs, rhs );
+				case Operator::MODULO:
+					return modulo_values( lhs, rhs );
+				case Operator::ADD:
+					return add_values( lhs, rhs );
+				case Operator::SUBTRACT:
+					return subtract_values( lhs, rhs );
+				case Operator::EQUAL:
+					return compare_values( lhs, rhs, EqualTo{} );
+				case Operator::LESS:
+					return compare_values( lhs, rhs, std::less<>{} );
+				case Operator::LESS_EQUAL:
+					return compare_values( lhs, rhs, std::less_equal<>{} );
+				case Operator::GREATER:
+					return compare_values( lhs, rhs, std::greater<>{} );
+				case Operator::GREATER_EQUAL:
+					return compare_values( lhs, rhs, std::greater_equal<>{} );
+				case Operator::AND:
+					return basic_value_boolean( to_boolean( lhs ) && to_boolean( rhs ) );
+				case Operator::OR:
+					return basic_value_boolean( to_boolean( lhs ) || to_boolean( rhs ) );
+				case Operator::NEGATE:
+					break;
+				}
+				throw create_basic_exception( ErrorTypes::FATAL, "Unknown binary operator" );
 			}
-			auto current_operand = pop( operand_stack );
-			if( !operand_stack.empty( ) ) {
-				throw create_basic_exception( ErrorTypes::SYNTAX,
-				                              "Unknown error while parsing line.  Not value left at end of evaluation" );
+
+			BasicValue apply_operator( Operator oper, BasicValue const &value ) {
+				if( Operator::NEGATE == oper ) {
+					return negate_value( value );
+				}
+				throw create_basic_exception( ErrorTypes::FATAL, "Unknown unary operator" );
 			}
-			return current_operand;
-		}
 
-		size_t Basic::BasicArray::total_items( ) const {
-			return m_values.size( );
-		}
+			//////////////////////////////////////////////////////////////////////////
+			/// summary: Whether the comparison oper holds for lhs and rhs.  Integers
+			/// are compared directly, anything else as apply_operator does
+			bool comparison_holds( Operator oper, BasicValue const &lhs, BasicValue const &rhs ) {
+				if( ValueType::INTEGER == lhs.type( ) && ValueType::INTEGER == rhs.type( ) ) {
+					auto const left = lhs.integer_value( );
+					auto const right = rhs.integer_value( );
+					switch( oper ) {
+					case Operator::EQUAL:
+						return left == right;
+					case Operator::LESS:
+						return left < right;
+					case Operator::LESS_EQUAL:
+						return left <= right;
+					case Operator::GREATER:
+						return left > right;
+					case Operator::GREATER_EQUAL:
+						return left >= right;
+					default:
+						break;
+					}
+				}
+				return to_boolean( apply_operator( oper, lhs, rhs ) );
+			}
 
-		bool Basic::is_unary_operator( boost::string_ref oper ) {
-			return key_exists( m_unary_operators, oper );
-		}
+			//////////////////////////////////////////////////////////////////////////
+			/// summary: Pop the left operand of the SHORT_CIRCUIT oper.  When it
+			/// decides the result, false for AND and true for OR, that is pushed
+			/// instead and true is returned so that the right operand is skipped
+			bool short_circuits( Operator oper, std::vector<BasicValue> &stack ) {
+				auto const lhs = to_boolean( stack.back( ) );
+				stack.pop_back( );
+				if( ( Operator::OR == oper ) != lhs ) {
+					return false;
+				}
+				stack.push_back( basic_value_boolean( lhs ) );
+				return true;
+			}
 
-		bool Basic::is_binary_operator( boost::string_ref oper ) {
-			return key_exists( m_binary_operators, oper );
-		}
+			//////////////////////////////////////////////////////////////////////////
+			/// summary: A value on the stack of the unboxed instructions.  Integers
+			/// are kept in 64 bits until they are checked, comparisons leave 0 or 1
+			/// in i
+			union UnboxedValue {
+				int64_t i;
+				real r;
+			};
 
-		std::vector<BasicValue> Basic::evaluate_parameters( boost::string_ref value ) {
-			value = remove_outer_bracket( value );
-			// value = boost::algorithm::trim_copy( value );
-			// Parameters are separated by comma's.  Comma's should only exist within quotes and between parameters
-			std::vector<BasicValue> result;
-			if( value.empty( ) ) {
-				return result;
+			//////////////////////////////////////////////////////////////////////////
+			/// summary: Apply oper to unboxed integers.  Returns false when the
+			/// tagged kernel would not give an integer, on overflow or division by
+			/// zero, so that the tagged code can run instead
+			bool apply_unboxed_operator( Operator oper, int64_t lhs, int64_t rhs, int64_t &result ) {
+				switch( oper ) {
+				case Operator::POWER: {
+					auto const value = pow( static_cast<real>( lhs ), static_cast<real>( rhs ) );
+					if( !( static_cast<real>( std::numeric_limits<integer>::min( ) ) <= value &&
+					       value <= static_cast<real>( std::numeric_limits<integer>::max( ) ) ) ) {
+						return false;
+					}
+					result = static_cast<integer>( value );
+				} break;
+				case Operator::MULTIPLY:
+					result = lhs * rhs;
+					break;
+				case Operator::DIVIDE:
+					if( 0 == rhs ) {
+						return false;
+					}
+					result = lhs / rhs;
+					break;
+				case Operator::MODULO:
+					if( 0 == rhs ) {
+						return false;
+					}
+					result = lhs % rhs;
+					break;
+				case Operator::ADD:
+					result = lhs + rhs;
+					break;
+				case Operator::SUBTRACT:
+					result = lhs - rhs;
+					break;
+				case Operator::EQUAL:
+					result = lhs == rhs;
+					break;
+				case Operator::LESS:
+					result = lhs < rhs;
+					break;
+				case Operator::LESS_EQUAL:
+					result = lhs <= rhs;
+					break;
+				case Operator::GREATER:
+					result = lhs > rhs;
+					break;
+				case Operator::GREATER_EQUAL:
+					result = lhs >= rhs;
+					break;
+				case Operator::NEGATE:
+					result = -lhs;
+					break;
+				case Operator::AND:
+				case Operator::OR:
+					return false;
+				}
+				return can_fit<integer>( result );
 			}
-			std::vector<size_t> comma_pos;
 
-			auto const end = value.size( ) - 1;
-			for( size_t pos = 0; pos <= end; ++pos ) {
-				auto const &current_char = value[pos];
-				switch( current_char ) {
-				case '"':
-					pos += find_end_of_string( value.substr( pos ) );
+			//////////////////////////////////////////////////////////////////////////
+			/// summary: Apply oper to unboxed reals.  The compiler does not unbox %,
+			/// AND or OR on reals
+			UnboxedValue apply_unboxed_operator( Operator oper, real lhs, real rhs ) {
+				UnboxedValue result{};
+				switch( oper ) {
+				case Operator::POWER:
+					result.r = pow( lhs, rhs );
+					break;
+				case Operator::MULTIPLY:
+					result.r = lhs * rhs;
+					break;
+				case Operator::DIVIDE:
+					result.r = lhs / rhs;
+					break;
+				case Operator::ADD:
+					result.r = lhs + rhs;
 					break;
-				case ',':
-					comma_pos.push_back( pos );
+				case Operator::SUBTRACT:
+					result.r = lhs - rhs;
 					break;
+				case Operator::EQUAL:
+					result.i = almost_equal( lhs, rhs );
+					break;
+				case Operator::LESS:
+					result.i = lhs < rhs;
+					break;
+				case Operator::LESS_EQUAL:
+					result.i = lhs <= rhs;
+					break;
+				case Operator::GREATER:
+					result.i = lhs > rhs;
+					break;
+				case Operator::GREATER_EQUAL:
+					result.i = lhs >= rhs;
+					break;
+				case Operator::NEGATE:
+					result.r = -lhs;
+					break;
+				case Operator::MODULO:
+				case Operator::AND:
+				case Operator::OR:
+					throw create_basic_exception( ErrorTypes::FATAL, "Operator cannot be applied to unboxed reals" );
 				}
+				return result;
 			}
-			comma_pos.push_back( value.size( ) );
-			size_t start = 0;
-			for( auto current_end : comma_pos ) {
-				auto current_param = value.substr( start, current_end - start );
-				auto eval = evaluate( std::move( current_param ) );
-				result.push_back( eval );
-				start = current_end + 1;
-			}
-			return result;
-		}
 
-		BasicValue &Basic::get_variable_constant( boost::string_ref name ) {
-			if( is_constant( name ) ) {
-				return m_constants[name.to_string( )].value;
-			} else if( is_variable( name ) ) {
-				return get_variable( name );
+			//////////////////////////////////////////////////////////////////////////
+			/// summary: The types oper may give for operands of the types in lhs and
+			/// rhs.  Integer arithmetic is taken to give an integer, the unboxed code
+			/// checks for the overflow that would make it a real
+			ValueTypes result_types( Operator oper, ValueTypes lhs, ValueTypes rhs ) {
+				if( operators::is_comparison( oper ) || Operator::AND == oper || Operator::OR == oper ) {
+					return value_types( ValueType::BOOLEAN );
+				}
+				ValueTypes result = 0;
+				for( uint8_t l = 0; l <= static_cast<uint8_t>( ValueType::ARRAY ); ++l ) {
+					if( 0 == ( lhs & value_types( static_cast<ValueType>( l ) ) ) ) {
+						continue;
+					}
+					for( uint8_t r = 0; r <= static_cast<uint8_t>( ValueType::ARRAY ); ++r ) {
+						if( 0 == ( rhs & value_types( static_cast<ValueType>( r ) ) ) ) {
+							continue;
+						}
+						auto const type = determine_result_type( static_cast<ValueType>( l ), static_cast<ValueType>( r ) );
+						switch( type ) {
+						case ValueType::INTEGER:
+						case ValueType::REAL:
+							result |= value_types( type );
+							break;
+						case ValueType::STRING:
+							if( Operator::ADD == oper ) {
+								result |= value_types( type );
+							}
+							break;
+						case ValueType::ARRAY:
+						case ValueType::BOOLEAN:
+						case ValueType::EMPTY:
+							break;
+						}
+					}
+				}
+				return result;
 			}
-			throw create_basic_exception( ErrorTypes::FATAL, "Undefined variable or constant" );
-		}
 
-		void Basic::add_variable( boost::string_ref name, BasicValue value ) {
-			if( is_constant( name ) ) {
-				throw create_basic_exception( ErrorTypes::SYNTAX, "Cannot create a variable that is a system constant" );
-			} else if( is_function( name ) | is_keyword( name ) ) {
-				throw create_basic_exception( ErrorTypes::SYNTAX,
-				                              "Cannot create a variable with the same name as a system function/keyword" );
+			//////////////////////////////////////////////////////////////////////////
+			/// summary: Index of the colon ending the statement that starts at first
+			/// or the number of tokens when it is the last statement of the line
+			size_t find_end_of_statement( ProgramLine const &line, size_t first ) {
+				while( first < line.tokens.size( ) && TokenType::COLON != line.tokens[first].type ) {
+					++first;
+				}
+				return first;
 			}
-			m_variables[name.to_string( )] = std::move( value );
-		}
 
-		void Basic::add_array_variable( boost::string_ref name, std::vector<BasicValue> dimensions ) {
-			if( is_constant( name ) ) {
-				throw create_basic_exception( ErrorTypes::SYNTAX, "Cannot create a variable that is a system constant" );
-			} else if( is_function( name ) | is_keyword( name ) ) {
-				throw create_basic_exception( ErrorTypes::SYNTAX,
-				                              "Cannot create a variable with the same name as a system function/keyword" );
+			bool is_keyword_token( Token const &token, Keyword keyword ) {
+				return TokenType::KEYWORD == token.type && static_cast<uint32_t>( keyword ) == token.value;
 			}
-			m_arrays[name.to_string( )] = BasicArray{convert_dimensions( std::move( dimensions ) )};
-		}
 
-		void Basic::add_constant( boost::string_ref name, std::string description, BasicValue value ) {
-			if( is_function( name ) | is_keyword( name ) ) {
-				throw create_basic_exception( ErrorTypes::SYNTAX,
-				                              "Cannot create a constant with the same name as a system function/keyword" );
+			bool is_operator_token( Token const &token, Operator oper ) {
+				return TokenType::OPERATOR == token.type && static_cast<uint32_t>( oper ) == token.value;
 			}
-			if( key_exists( m_variables, name ) ) {
-				remove_variable( name );
-			}
-			m_constants[name.to_string( )] = ConstantType{std::move( description ), std::move( value )};
-		}
 
-		bool Basic::is_variable( boost::string_ref name ) {
-			return key_exists( m_variables, name ) || is_constant( name );
-		}
+			//////////////////////////////////////////////////////////////////////////
+			/// summary: Position of the THEN or GOTO that ends the condition of an
+			/// IF, or the size of params when there is none
+			size_t find_if_clause( StatementTokens const &params ) {
+				size_t clause = 0;
+				while( clause < params.size( ) && !is_keyword_token( params[clause], Keyword::THEN ) &&
+				       !is_keyword_token( params[clause], Keyword::GOTO ) ) {
+					++clause;
+				}
+				return clause;
+			}
 
-		bool Basic::is_constant( boost::string_ref name ) {
-			return key_exists( m_constants, name );
-		}
+			bool is_loop_statement( StatementTokens const &statement ) {
+				return !statement.empty( ) && ( is_keyword_token( statement[0], Keyword::FOR ) ||
+				                                is_keyword_token( statement[0], Keyword::NEXT ) );
+			}
 
-		bool Basic::is_array( boost::string_ref name ) {
-			return key_exists( m_arrays, name );
-		}
+			struct ForLoopParts {
+				uint32_t variable;
+				StatementTokens start;
+				StatementTokens limit;
+				StatementTokens step; // Empty when there is no STEP
+			};
 
-		void Basic::remove_variable( boost::string_ref name, bool throw_on_nonexist ) {
-			auto pos = m_variables.find( to_upper( name ) );
-			if( m_variables.end( ) == pos && throw_on_nonexist ) {
-				throw create_basic_exception( ErrorTypes::SYNTAX, "Attempt to delete unknown variable" );
+			//////////////////////////////////////////////////////////////////////////
+			/// summary: Split the parameters of a FOR.
+			/// FOR <variable> = <start> TO <limit> [STEP <step>]
+			ForLoopParts parse_for_loop( StatementTokens const &params ) {
+				if( 2 > params.size( ) || TokenType::IDENTIFIER != params[0].type ||
+				    TokenType::OPERATOR != params[1].type || static_cast<uint32_t>( Operator::EQUAL ) != params[1].value ) {
+					throw create_basic_exception( ErrorTypes::SYNTAX, "FOR requires a counter variable followed by =" );
+				}
+				size_t to = 2;
+				while( to < params.size( ) && !is_keyword_token( params[to], Keyword::TO ) ) {
+					++to;
+				}
+				size_t step = to;
+				while( step < params.size( ) && !is_keyword_token( params[step], Keyword::STEP ) ) {
+					++step;
+				}
+				ForLoopParts result{params[0].value, params.sub_range( 2, to - 2 ), params.sub_range( to + 1, step - to - 1 ),
+				                    params.sub_range( step + 1 )};
+				if( params.size( ) == to || result.start.empty( ) || result.limit.empty( ) ||
+				    ( step < params.size( ) && result.step.empty( ) ) ) {
+					throw create_basic_exception( ErrorTypes::SYNTAX, "FOR requires a start and a limit separated by TO" );
+				}
+				return result;
 			}
-			m_variables.erase( pos );
-		}
 
-		void Basic::remove_constant( boost::string_ref name, bool throw_on_nonexist ) {
-			auto pos = m_constants.find( to_upper( name ) );
-			if( m_constants.end( ) == pos && throw_on_nonexist ) {
-				throw create_basic_exception( ErrorTypes::SYNTAX, "Attempt to delete unknown constant" );
+			//////////////////////////////////////////////////////////////////////////
+			/// summary: Source text of a token for error messages
+			std::string token_text( StatementTokens const &tokens, size_t pos ) {
+				auto const &line = *tokens.line;
+				auto const index = tokens.first + pos;
+				auto const start = line.tokens[index].position;
+				auto const end = index + 1 < line.tokens.size( ) ? line.tokens[index + 1].position : line.text.size( );
+				return trim( boost::string_ref( line.text ).substr( start, end - start ) ).to_string( );
 			}
-			m_constants.erase( pos );
-		}
 
-		void Basic::add_function( boost::string_ref name, std::string description, BasicFunction func ) {
-			if( "SIN" == name ) {
-				std::cout << "";
+			//////////////////////////////////////////////////////////////////////////
+			/// summary: Entries of both maps sorted by name.  Those in added win
+			template<typename T>
+			std::map<std::string, T const *> merge_entries( std::unordered_map<std::string, T> const &builtin,
+			                                                 std::unordered_map<std::string, T> const &added ) {
+				std::map<std::string, T const *> result;
+				for( auto const &entry : builtin ) {
+					result[entry.first] = &entry.second;
+				}
+				for( auto const &entry : added ) {
+					result[entry.first] = &entry.second;
+				}
+				return result;
 			}
-			if( is_keyword( name ) ) {
-				throw create_basic_exception( ErrorTypes::FATAL,
-				                              "Cannot create a function with the same name as a system keyword" );
+
+			template<typename T>
+			int32_t add_handler( std::vector<T const *> &handlers, T const *handler ) {
+				auto pos = std::find( std::begin( handlers ), std::end( handlers ), handler );
+				if( std::end( handlers ) == pos ) {
+					handlers.push_back( handler );
+					return static_cast<int32_t>( handlers.size( ) - 1 );
+				}
+				return static_cast<int32_t>( std::distance( std::begin( handlers ), pos ) );
 			}
-			m_functions[name.to_string( )] = FunctionType( std::move( description ), std::move( func ) );
-		}
+		} // namespace
 
-		ProgramType::iterator Basic::find_line( integer line_number ) {
-			auto result =
-			  std::find_if( std::begin( m_program ), std::end( m_program ),
-			                [&line_number]( ProgramLine current_line ) { return current_line.first == line_number; } );
-			return result;
+		BasicValue evaluate_operator( Operator oper, BasicValue const &lhs, BasicValue const &rhs ) {
+			return apply_operator( oper, lhs, rhs );
 		}
 
-		void Basic::add_line( integer line_number, boost::string_ref line ) {
-			auto pos = find_line( line_number );
-			if( std::end( m_program ) == pos ) {
-				m_program.push_back( make_pair( line_number, line ) );
-			} else {
-				pos->second = line;
+		//////////////////////////////////////////////////////////////////////////
+		// Basic::BasicArray
+		//////////////////////////////////////////////////////////////////////////
+		constexpr size_t Basic::BasicArray::max_dimensions;
+
+		Basic::BasicArray::BasicArray( )
+		  : m_dimensions( ), m_strides( ), m_type( ElementType::ANY ), m_values( ), m_integers( ), m_reals( ) {}
+
+		Basic::BasicArray::BasicArray( std::vector<size_t> dimensions, ElementType type )
+		  : m_dimensions( std::move( dimensions ) ), m_strides( ), m_type( type ), m_values( ), m_integers( ), m_reals( ) {
+			assert( m_dimensions.size( ) <= max_dimensions );
+			// The first index varies fastest, A( I, J ) is at I + J * first dimension
+			size_t size = 1;
+			for( auto const dimension : m_dimensions ) {
+				m_strides.push_back( size );
+				size *= dimension;
 			}
-		}
-
-		void Basic::remove_line( integer line_number ) {
-			auto pos = find_line( line_number );
-			if( m_program.end( ) != pos ) {
-				m_program.erase( pos );
+			switch( type ) {
+			case ElementType::ANY:
+				m_values.resize( size );
+				break;
+			case ElementType::INTEGER:
+				m_integers.resize( size, 0 );
+				break;
+			case ElementType::REAL:
+				m_reals.resize( size, 0.0 );
+				break;
+			case ElementType::STRING:
+				m_values.resize( size, BasicValue( boost::string_ref( ) ) );
+				break;
 			}
 		}
 
-		bool Basic::is_keyword( boost::string_ref name ) {
-			return key_exists( m_keywords, name );
-		}
+		Basic::BasicArray::BasicArray( BasicArray const &other )
+		  : m_dimensions( other.m_dimensions )
+		  , m_strides( other.m_strides )
+		  , m_type( other.m_type )
+		  , m_values( other.m_values )
+		  , m_integers( other.m_integers )
+		  , m_reals( other.m_reals ) {}
 
-		bool Basic::is_function( boost::string_ref name ) {
-			return key_exists( m_functions, name );
-		}
+		Basic::BasicArray::BasicArray( BasicArray &&other )
+		  : m_dimensions( std::move( other.m_dimensions ) )
+		  , m_strides( std::move( other.m_strides ) )
+		  , m_type( other.m_type )
+		  , m_values( std::move( other.m_values ) )
+		  , m_integers( std::move( other.m_integers ) )
+		  , m_reals( std::move( other.m_reals ) ) {}
 
-		BasicValue &Basic::get_array_variable( boost::string_ref name, std::vector<BasicValue> params ) {
-			auto &current_array( retrieve_value( m_arrays, name ) );
-			return current_array( convert_dimensions( std::move( params ) ) );
+		Basic::BasicArray &Basic::BasicArray::operator=( BasicArray other ) {
+			m_dimensions = std::move( other.m_dimensions );
+			m_strides = std::move( other.m_strides );
+			m_type = other.m_type;
+			m_values = std::move( other.m_values );
+			m_integers = std::move( other.m_integers );
+			m_reals = std::move( other.m_reals );
+			return *this;
 		}
 
-		std::pair<boost::string_ref, std::vector<BasicValue>>
-		Basic::split_arrayfunction_from_string( boost::string_ref name, bool throw_on_missing_bracket ) {
-			auto bracket_pos = name.find( '(' );
-			if( std::string::npos == bracket_pos ) {
-				if( !throw_on_missing_bracket ) {
-					return std::make_pair( name, std::vector<BasicValue>( ) );
-				} else {
-					throw create_basic_exception( ErrorTypes::FATAL, "Expected to find start bracket but none found." );
+		namespace {
+			template<typename Iter1, typename Iter2, typename Predicate>
+			bool are_equal( Iter1 it_start1, Iter1 it_end1, Iter2 it_start2, Iter2 it_end2, Predicate pred ) {
+				while( it_start1 != it_end1 && it_start2 != it_end2 ) {
+					if( !pred( *it_start1, *it_start2 ) ) {
+						return false;
+					}
+					++it_start1;
+					++it_start2;
+				}
+				return it_start1 == it_end1 && it_start2 == it_end2;
+			}
+
+			template<typename Iter1, typename Iter2>
+			bool are_equal( Iter1 it_start1, Iter1 it_end1, Iter2 it_start2, Iter2 it_end2 ) {
+				using ValueType = decltype( *it_start1 );
+				auto eq_compare = []( const ValueType &v1, const ValueType &v2 ) { return v1 == v2; };
+				return are_equal( it_start1, it_end1, it_start2, it_end2, eq_compare );
+			}
+
+			template<typename ContainerType, typename Predicate>
+			bool are_equal( const ContainerType &c1, const ContainerType &c2, Predicate pred ) {
+				bool result = c1.size( ) == c2.size( );
+				if( result ) {
+					using std::begin;
+					using std::end;
+					result = are_equal( begin( c1 ), end( c1 ), begin( c2 ), end( c2 ), pred );
 				}
+				return result;
 			}
-			auto lb_count = std::count( std::begin( name ), std::end( name ), '(' );
-			auto rb_count = std::count( std::begin( name ), std::end( name ), ')' );
-			if( lb_count != rb_count ) {
-				throw create_basic_exception( ErrorTypes::SYNTAX, "Unclosed bracket on function '" + name.to_string( ) + "'" );
+
+			template<typename ContainerType>
+			bool are_equal( ContainerType const &c1, ContainerType const &c2 ) {
+				using ValueType = typename ContainerType::value_type;
+				auto eq_compare = []( const ValueType &v1, const ValueType &v2 ) { return v1 == v2; };
+				return are_equal( c1, c2, eq_compare );
 			}
-			auto array_name = name.substr( 0, bracket_pos );
-			auto bracket_end = name.find_last_of( ')' );
+		} // namespace
 
-			auto param_str = name.substr( bracket_pos + 1, bracket_end - bracket_pos - 1 );
-			auto param_values = evaluate_parameters( param_str );
-			return {array_name, std::move( param_values )};
-		}
+		bool Basic::BasicArray::operator==( BasicArray const &rhs ) const {
+			auto compare_function = []( basic::BasicValue const &v1, basic::BasicValue const &v2 ) {
+				bool result = v1.type( ) == v2.type( );
+				if( result ) {
+					switch( v1.type( ) ) {
+					case ValueType::EMPTY:
+						result &= true;
+						break;
+					case ValueType::BOOLEAN:
+						result &= to_boolean( v1 ) == to_boolean( v2 );
+						break;
+					case ValueType::INTEGER:
+						result &= to_integer( v1 ) == to_integer( v2 );
+						break;
+					case ValueType::REAL:
+						result &= almost_equal( to_real( v1 ), to_real( v2 ) );
+						break;
+					case ValueType::STRING:
+						result &= v1.string_value( ) == v2.string_value( );
+						break;
+					case ValueType::ARRAY:
+						throw std::runtime_error( "Unimplemented feature" );
+					default:
+						throw std::exception{};
+					}
+				}
+				return result;
+			};
 
-		BasicValue &Basic::get_array_variable( boost::string_ref name ) {
-			auto nameparam = split_arrayfunction_from_string( name );
-			return get_array_variable( nameparam.first, std::move( nameparam.second ) );
+			return m_type == rhs.m_type && are_equal( m_dimensions, rhs.m_dimensions ) &&
+			       are_equal( m_values, rhs.m_values, compare_function ) && are_equal( m_integers, rhs.m_integers ) &&
+			       are_equal( m_reals, rhs.m_reals, almost_equal<real> );
 		}
 
-		BasicValue &Basic::get_variable( boost::string_ref name ) {
-			// Parse brackets and return individual variable
-			auto is_array_value = false;
-			size_t brackets_start = 0;
-			size_t brackets_end = 0;
-			for( size_t pos = 0; pos < name.size( ); ++pos ) {
-				if( '(' == name[pos] ) {
-					brackets_start = pos;
-					brackets_end = find_end_of_bracket( name.substr( pos ) );
-					is_array_value = std::string::npos != brackets_end;
-					break;
-				}
-			}
-			if( is_array_value ) {
-				auto array_name = name.substr( 0, brackets_start );
-				auto params_str = name.substr( brackets_start + 1, brackets_end - 1 );
-				auto params = evaluate_parameters( std::move( params_str ) );
-				return get_array_variable( array_name, std::move( params ) );
-			} else {
-				return retrieve_value( m_variables, name );
+		//////////////////////////////////////////////////////////////////////////
+		/// summary: The suffix of name, % for integers, # for reals and $ for
+		/// strings, chooses what an array of that name holds
+		Basic::BasicArray::ElementType Basic::BasicArray::element_type( boost::string_ref name ) {
+			switch( name.empty( ) ? '\0' : name.back( ) ) {
+			case '%':
+				return ElementType::INTEGER;
+			case '#':
+				return ElementType::REAL;
+			case '$':
+				return ElementType::STRING;
+			default:
+				return ElementType::ANY;
 			}
 		}
 
-		void Basic::clear_program( ) {
-			m_program.clear( );
-			m_program.emplace_back( -1, "" );
+		Basic::BasicArray::ElementType Basic::BasicArray::element_type( ) const {
+			return m_type;
 		}
 
-		void Basic::clear_variables( ) {
-			m_variables.clear( );
+		//////////////////////////////////////////////////////////////////////////
+		/// summary: The indexes held by count values, one for each dimension
+		Basic::BasicArray::Indexes Basic::BasicArray::indexes( BasicValue const *values, size_t count ) const {
+			if( m_dimensions.size( ) != count ) {
+				std::stringstream ss;
+				ss << "Must supply " << m_dimensions.size( ) << " indexes to address array";
+				throw ::daw::basic::create_basic_exception( ErrorTypes::SYNTAX, ss.str( ) );
+			}
+			Indexes result;
+			result.size = count;
+			for( size_t n = 0; n < count; ++n ) {
+				result.values[n] = to_integer( values[n] );
+			}
+			return result;
 		}
 
-		void Basic::reset( ) {
-			m_basic.reset( new Basic( ) );
-			clear_program( );
-			clear_variables( );
+		//////////////////////////////////////////////////////////////////////////
+		/// summary: Find the element at indexes from the strides, checking each
+		/// index against its dimension
+		bool Basic::BasicArray::offset( Indexes const &indexes, size_t &pos ) const noexcept {
+			if( m_dimensions.size( ) != indexes.size ) {
+				return false;
+			}
+			pos = 0;
+			for( size_t n = 0; n < indexes.size; ++n ) {
+				auto const index = indexes.values[n];
+				if( 0 > index || m_dimensions[n] <= static_cast<size_t>( index ) ) {
+					return false;
+				}
+				pos += static_cast<size_t>( index ) * m_strides[n];
+			}
+			return true;
 		}
 
-		std::string Basic::list_functions( ) {
+		size_t Basic::BasicArray::position( Indexes const &indexes ) const {
+			size_t pos = 0;
+			if( offset( indexes, pos ) ) {
+				return pos;
+			}
 			std::stringstream ss;
-			auto keys = get_keys( m_functions );
-			std::sort( std::begin( keys ), std::end( keys ) );
-			for( auto &current_function_name : keys ) {
-				const auto &current_function = m_functions[current_function_name];
-				ss << current_function_name << ": " << current_function.description << "\n";
+			ss << "Array out of bounds.  Max is less than ( ";
+			bool is_first = true;
+			for( auto &dim : m_dimensions ) {
+				if( !is_first ) {
+					ss << ", ";
+				} else {
+					is_first = false;
+				}
+				ss << dim;
 			}
-			return ss.str( );
+			ss << " ) you requested ( ";
+			for( size_t n = 0; n < indexes.size; ++n ) {
+				if( 0 != n ) {
+					ss << ", ";
+				}
+				ss << indexes.values[n];
+			}
+			ss << ")";
+			throw ::daw::basic::create_basic_exception( ErrorTypes::SYNTAX, ss.str( ) );
 		}
 
-		std::string Basic::list_constants( ) {
-			std::stringstream ss;
-			auto keys = get_keys( m_constants );
-			std::sort( std::begin( keys ), std::end( keys ) );
-			for( auto &current_constant_name : keys ) {
-				const auto &current_constant = m_constants[current_constant_name];
-				ss << current_constant_name << ": " << value_type_to_string( current_constant.value ) << " = "
-				   << to_string( current_constant.value ) << ": " << current_constant.description << "\n";
+		//////////////////////////////////////////////////////////////////////////
+		/// summary: Whether value can be stored in the array.  Integers are
+		/// stored in arrays of reals as reals
+		bool Basic::BasicArray::fits( BasicValue const &value ) const {
+			switch( m_type ) {
+			case ElementType::ANY:
+				return true;
+			case ElementType::INTEGER:
+				return ValueType::INTEGER == value.type( );
+			case ElementType::REAL:
+				return ValueType::INTEGER == value.type( ) || ValueType::REAL == value.type( );
+			case ElementType::STRING:
+				return ValueType::STRING == value.type( );
 			}
-			return ss.str( );
+			return false;
 		}
 
-		std::string Basic::list_keywords( ) {
-			std::stringstream ss;
-			auto keys = get_keys( m_keywords );
-			std::sort( std::begin( keys ), std::end( keys ) );
-			for( auto &current_keyword_name : keys ) {
-				ss << current_keyword_name << "\n"; // ": " << m_keywords[current_keyword_name].description << "\n";
+		//////////////////////////////////////////////////////////////////////////
+		/// summary: The error for storing value where it does not fit.  It is a
+		/// mistake in the program so the session goes on
+		BasicException Basic::BasicArray::type_mismatch( std::string const &value ) const {
+			static char const *const kinds[] = {"any value", "integers", "reals", "strings"};
+			return ::daw::basic::create_basic_exception( ErrorTypes::SYNTAX, "Type mismatch, cannot store " + value +
+			                                                                   " in an array of " +
+			                                                                   kinds[static_cast<size_t>( m_type )] );
+		}
+
+		BasicValue Basic::BasicArray::get( Indexes const &indexes ) const {
+			return at( position( indexes ) );
+		}
+
+		void Basic::BasicArray::set( Indexes const &indexes, BasicValue value ) {
+			auto const pos = position( indexes );
+			if( !fits( value ) ) {
+				throw type_mismatch( "a value of type " + value_type_to_string( value ) );
+			}
+			switch( m_type ) {
+			case ElementType::ANY:
+			case ElementType::STRING:
+				m_values[pos] = std::move( value );
+				return;
+			case ElementType::INTEGER:
+				m_integers[pos] = value.integer_value( );
+				return;
+			case ElementType::REAL:
+				m_reals[pos] = to_numeric( value );
+				return;
 			}
-			return ss.str( );
 		}
 
-		std::string Basic::list_variables( ) {
-			std::stringstream ss;
-			{
-				auto keys = get_keys( m_variables );
-				std::sort( std::begin( keys ), std::end( keys ) );
-				for( auto &current_variable_name : keys ) {
-					const auto &current_variable = get_variable( current_variable_name );
-					auto value_type = get_value_type( current_variable );
-					ss << current_variable_name << ": " << value_type_to_string( value_type ) << " = "
-					   << to_string( current_variable ) << "\n";
+		BasicValue Basic::BasicArray::at( size_t pos ) const {
+			switch( m_type ) {
+			case ElementType::INTEGER:
+				return basic_value_integer( m_integers[pos] );
+			case ElementType::REAL:
+				return basic_value_real( m_reals[pos] );
+			case ElementType::ANY:
+			case ElementType::STRING:
+				break;
+			}
+			return m_values[pos];
+		}
+
+		bool Basic::BasicArray::store( size_t pos, BasicValue &value ) {
+			if( !fits( value ) ) {
+				return false;
+			}
+			switch( m_type ) {
+			case ElementType::INTEGER:
+				m_integers[pos] = value.integer_value( );
+				break;
+			case ElementType::REAL:
+				m_reals[pos] = to_numeric( value );
+				break;
+			case ElementType::ANY:
+			case ElementType::STRING:
+				m_values[pos] = std::move( value );
+				break;
+			}
+			return true;
+		}
+
+		bool Basic::BasicArray::get( integer index, BasicValue &value ) const {
+			if( 1 != m_dimensions.size( ) || 0 > index || total_items( ) <= static_cast<size_t>( index ) ) {
+				return false;
+			}
+			value = at( static_cast<size_t>( index ) );
+			return true;
+		}
+
+		bool Basic::BasicArray::set( integer index, BasicValue &value ) {
+			if( 1 != m_dimensions.size( ) || 0 > index || total_items( ) <= static_cast<size_t>( index ) ) {
+				return false;
+			}
+			return store( static_cast<size_t>( index ), value );
+		}
+
+		std::vector<size_t> Basic::BasicArray::dimensions( ) const {
+			return m_dimensions;
+		}
+
+		//////////////////////////////////////////////////////////////////////////
+		// ProgramLine
+		//////////////////////////////////////////////////////////////////////////
+		ProgramLine::ProgramLine( ) : number( -1 ), text( ), tokens( ), literals( ) {}
+
+		ProgramLine::ProgramLine( integer line_number, std::string line_text )
+		  : number( line_number ), text( std::move( line_text ) ), tokens( ), literals( ) {}
+
+		//////////////////////////////////////////////////////////////////////////
+		// StatementTokens
+		//////////////////////////////////////////////////////////////////////////
+		bool StatementTokens::empty( ) const {
+			return first >= last;
+		}
+
+		size_t StatementTokens::size( ) const {
+			return empty( ) ? 0 : last - first;
+		}
+
+		Token const &StatementTokens::operator[]( size_t pos ) const {
+			return line->tokens[first + pos];
+		}
+
+		StatementTokens StatementTokens::sub_range( size_t pos, size_t count ) const {
+			auto const start = std::min( first + pos, last );
+			return StatementTokens{line, start, start + std::min( count, last - start )};
+		}
+
+		boost::string_ref StatementTokens::text( ) const {
+			if( empty( ) ) {
+				return boost::string_ref( );
+			}
+			auto const start = line->tokens[first].position;
+			auto const end = last < line->tokens.size( ) ? line->tokens[last].position : line->text.size( );
+			return trim( boost::string_ref( line->text ).substr( start, end - start ) );
+		}
+
+		//////////////////////////////////////////////////////////////////////////
+		// Basic
+		/////////////////////////////////////////////////////////////////////////
+
+		//////////////////////////////////////////////////////////////////////////
+		/// summary: Evaluate a string and solve all functions/variables
+		BasicValue Basic::evaluate( boost::string_ref value ) {
+			auto const line = crunch( -1, value );
+			return evaluate( StatementTokens{&line, 0, line.tokens.size( )} );
+		}
+
+		size_t Basic::BasicArray::total_items( ) const {
+			switch( m_type ) {
+			case ElementType::INTEGER:
+				return m_integers.size( );
+			case ElementType::REAL:
+				return m_reals.size( );
+			case ElementType::ANY:
+			case ElementType::STRING:
+				break;
+			}
+			return m_values.size( );
+		}
+
+		BasicValue *Basic::BasicArray::element( integer index ) {
+			if( ElementType::ANY != m_type || 1 != m_dimensions.size( ) || 0 > index ||
+			    m_values.size( ) <= static_cast<size_t>( index ) ) {
+				return nullptr;
+			}
+			return &m_values[static_cast<size_t>( index )];
+		}
+
+		integer *Basic::BasicArray::integer_element( integer index ) {
+			if( ElementType::INTEGER != m_type || 1 != m_dimensions.size( ) || 0 > index ||
+			    m_integers.size( ) <= static_cast<size_t>( index ) ) {
+				return nullptr;
+			}
+			return &m_integers[static_cast<size_t>( index )];
+		}
+
+		real *Basic::BasicArray::real_element( integer index ) {
+			if( ElementType::REAL != m_type || 1 != m_dimensions.size( ) || 0 > index ||
+			    m_reals.size( ) <= static_cast<size_t>( index ) ) {
+				return nullptr;
+			}
+			return &m_reals[static_cast<size_t>( index )];
+		}
+
+		real *Basic::BasicArray::reals( ) {
+			return ElementType::REAL == m_type ? m_reals.data( ) : nullptr;
+		}
+
+		real const *Basic::BasicArray::reals( ) const {
+			return ElementType::REAL == m_type ? m_reals.data( ) : nullptr;
+		}
+
+		integer const *Basic::BasicArray::integers( ) const {
+			return ElementType::INTEGER == m_type ? m_integers.data( ) : nullptr;
+		}
+
+		std::vector<real> Basic::BasicArray::to_reals( ) const {
+			switch( m_type ) {
+			case ElementType::INTEGER:
+				return std::vector<real>( std::begin( m_integers ), std::end( m_integers ) );
+			case ElementType::REAL:
+				return m_reals;
+			case ElementType::ANY:
+			case ElementType::STRING:
+				break;
+			}
+			// Elements never set are 0 as in the zero filled arrays of Dartmouth BASIC
+			std::vector<real> result;
+			result.reserve( m_values.size( ) );
+			for( auto const &value : m_values ) {
+				switch( value.type( ) ) {
+				case ValueType::EMPTY:
+					result.push_back( 0.0 );
+					break;
+				case ValueType::INTEGER:
+				case ValueType::REAL:
+					result.push_back( to_numeric( value ) );
+					break;
+				default:
+					throw ::daw::basic::create_basic_exception( ErrorTypes::SYNTAX,
+					                                            "Attempt to use an array holding non-numbers as numbers" );
+				}
+			}
+			return result;
+		}
+
+		//////////////////////////////////////////////////////////////////////////
+		/// summary: Store a number in every element.  Whole numbers that fit are
+		/// stored as integers in arrays of any value, like arithmetic on
+		/// integers gives them
+		void Basic::BasicArray::assign( std::vector<real> const &values ) {
+			assert( values.size( ) == total_items( ) );
+			auto const whole = []( real value ) {
+				return value == std::trunc( value ) && std::numeric_limits<integer>::min( ) <= value &&
+				       std::numeric_limits<integer>::max( ) >= value;
+			};
+			switch( m_type ) {
+			case ElementType::REAL:
+				std::copy( std::begin( values ), std::end( values ), std::begin( m_reals ) );
+				return;
+			case ElementType::INTEGER:
+				// Every value is checked first so that a failed MAT leaves the array as it was
+				if( !std::all_of( std::begin( values ), std::end( values ), whole ) ) {
+					throw type_mismatch( "a number that is not a whole integer" );
+				}
+				std::transform( std::begin( values ), std::end( values ), std::begin( m_integers ),
+				                []( real value ) { return static_cast<integer>( value ); } );
+				return;
+			case ElementType::ANY:
+				for( size_t n = 0; n < values.size( ); ++n ) {
+					m_values[n] = whole( values[n] ) ? basic_value_integer( static_cast<integer>( values[n] ) )
+					                                 : basic_value_real( values[n] );
+				}
+				return;
+			case ElementType::STRING:
+				throw type_mismatch( "numbers" );
+			}
+		}
+
+		//////////////////////////////////////////////////////////////////////////
+		/// summary: Put the elements in ascending order.  Numbers are sorted in
+		/// place unless their order is wanted.  Other elements are moved to
+		/// where their order says, so arrays of any value must hold only numbers
+		/// or only strings besides elements never set
+		std::vector<size_t> Basic::BasicArray::sort( bool stable, bool keep_order ) {
+			auto const size = total_items( );
+			std::vector<size_t> order;
+			switch( m_type ) {
+			case ElementType::INTEGER:
+				if( !keep_order ) {
+					parallel::sort( m_integers.data( ), size );
+					return order;
+				}
+				order = parallel::order( m_integers.data( ), size, stable );
+				break;
+			case ElementType::REAL:
+				if( !keep_order ) {
+					parallel::sort( m_reals.data( ), size );
+					return order;
+				}
+				order = parallel::order( m_reals.data( ), size, stable );
+				break;
+			case ElementType::ANY:
+			case ElementType::STRING: {
+				// Unset elements sort as "" among strings and as 0 among numbers
+				auto const is_empty = []( BasicValue const &value ) { return ValueType::EMPTY == value.type( ); };
+				auto const is_string = []( BasicValue const &value ) { return ValueType::STRING == value.type( ); };
+				auto const is_number = []( BasicValue const &value ) {
+					return ValueType::INTEGER == value.type( ) || ValueType::REAL == value.type( );
+				};
+				auto const all_are = [&]( auto const &is_kind ) {
+					return std::all_of( std::begin( m_values ), std::end( m_values ),
+					                    [&]( BasicValue const &value ) { return is_empty( value ) || is_kind( value ); } );
+				};
+				if( std::any_of( std::begin( m_values ), std::end( m_values ), is_string ) && all_are( is_string ) ) {
+					std::vector<boost::string_ref> keys;
+					keys.reserve( size );
+					for( auto const &value : m_values ) {
+						keys.push_back( is_empty( value ) ? boost::string_ref( ) : value.string_value( ) );
+					}
+					order = parallel::order( keys.data( ), size, stable );
+				} else if( all_are( is_number ) ) {
+					std::vector<real> keys;
+					keys.reserve( size );
+					for( auto const &value : m_values ) {
+						keys.push_back( is_empty( value ) ? 0.0 : to_numeric( value ) );
+					}
+					order = parallel::order( keys.data( ), size, stable );
+				} else {
+					throw ::daw::basic::create_basic_exception( ErrorTypes::SYNTAX,
+					                                            "SORT requires an array of only numbers or only strings" );
+				}
+			} break;
+			}
+			permute( order );
+			return order;
+		}
+
+		void Basic::BasicArray::permute( std::vector<size_t> const &order ) {
+			assert( order.size( ) == total_items( ) );
+			auto const gather = [&order]( auto &values ) {
+				std::remove_reference_t<decltype( values )> result;
+				result.reserve( values.size( ) );
+				for( auto const from : order ) {
+					result.push_back( std::move( values[from] ) );
+				}
+				values = std::move( result );
+			};
+			switch( m_type ) {
+			case ElementType::INTEGER:
+				gather( m_integers );
+				break;
+			case ElementType::REAL:
+				gather( m_reals );
+				break;
+			case ElementType::ANY:
+			case ElementType::STRING:
+				gather( m_values );
+				break;
+			}
+		}
+
+		BasicValue &Basic::get_variable_constant( boost::string_ref name ) {
+			if( auto constant = find_constant( name ) ) {
+				// Built in constants are shared so callers get a copy of their own
+				auto upper_name = to_upper( name );
+				if( constant != &m_constants[upper_name] ) {
+					m_constants[upper_name] = *constant;
+				}
+				return m_constants[upper_name].value;
+			} else if( is_variable( name ) ) {
+				return get_variable( name );
+			}
+			throw create_basic_exception( ErrorTypes::FATAL, "Undefined variable or constant" );
+		}
+
+		void Basic::add_variable( boost::string_ref name, BasicValue value ) {
+			if( is_constant( name ) ) {
+				throw create_basic_exception( ErrorTypes::SYNTAX, "Cannot create a variable that is a system constant" );
+			} else if( is_function( name ) | is_keyword( name ) ) {
+				throw create_basic_exception( ErrorTypes::SYNTAX,
+				                              "Cannot create a variable with the same name as a system function/keyword" );
+			}
+			auto &variable = m_variables[intern( name )];
+			variable.value = std::move( value );
+			variable.is_set = true;
+		}
+
+		void Basic::add_array_variable( boost::string_ref name, std::vector<BasicValue> dimensions ) {
+			if( is_constant( name ) ) {
+				throw create_basic_exception( ErrorTypes::SYNTAX, "Cannot create a variable that is a system constant" );
+			} else if( is_function( name ) | is_keyword( name ) ) {
+				throw create_basic_exception( ErrorTypes::SYNTAX,
+				                              "Cannot create a variable with the same name as a system function/keyword" );
+			}
+			if( BasicArray::max_dimensions < dimensions.size( ) ) {
+				throw create_basic_exception( ErrorTypes::SYNTAX, "Too many dimensions for an array" );
+			}
+			m_arrays[name.to_string( )] =
+			  BasicArray{convert_dimensions( std::move( dimensions ) ), BasicArray::element_type( name )};
+		}
+
+		void Basic::add_constant( boost::string_ref name, std::string description, BasicValue value ) {
+			if( is_function( name ) | is_keyword( name ) ) {
+				throw create_basic_exception( ErrorTypes::SYNTAX,
+				                              "Cannot create a constant with the same name as a system function/keyword" );
+			}
+			if( nullptr != find_variable( name ) ) {
+				remove_variable( name );
+			}
+			m_constants[to_upper( name )] = ConstantType{std::move( description ), std::move( value )};
+			invalidate_expressions( );
+		}
+
+		bool Basic::is_variable( boost::string_ref name ) {
+			return nullptr != find_variable( name ) || is_constant( name );
+		}
+
+		//////////////////////////////////////////////////////////////////////////
+		/// summary: The variable called name or nullptr when it is not set
+		Basic::Variable *Basic::find_variable( boost::string_ref name ) {
+			auto symbol = m_symbol_ids.find( to_upper( name ) );
+			if( std::end( m_symbol_ids ) == symbol || !m_variables[symbol->second].is_set ) {
+				return nullptr;
+			}
+			return &m_variables[symbol->second];
+		}
+
+		bool Basic::is_constant( boost::string_ref name ) {
+			return nullptr != find_constant( name );
+		}
+
+		//////////////////////////////////////////////////////////////////////////
+		/// summary: The constant called name.  Constants added to this Basic hide
+		/// built in ones of the same name
+		Basic::ConstantType const *Basic::find_constant( boost::string_ref name ) const {
+			auto upper_name = to_upper( name );
+			auto added = m_constants.find( upper_name );
+			if( std::end( m_constants ) != added ) {
+				return &added->second;
+			}
+			auto built_in = builtins( ).constants.find( upper_name );
+			if( std::end( builtins( ).constants ) != built_in ) {
+				return &built_in->second;
+			}
+			return nullptr;
+		}
+
+		//////////////////////////////////////////////////////////////////////////
+		/// summary: The function called name.  Functions added to this Basic hide
+		/// built in ones of the same name
+		Basic::FunctionType const *Basic::find_function( boost::string_ref name ) const {
+			auto upper_name = to_upper( name );
+			auto added = m_functions.find( upper_name );
+			if( std::end( m_functions ) != added ) {
+				return &added->second;
+			}
+			auto built_in = builtins( ).functions.find( upper_name );
+			if( std::end( builtins( ).functions ) != built_in ) {
+				return &built_in->second;
+			}
+			return nullptr;
+		}
+
+		bool Basic::is_array( boost::string_ref name ) {
+			return key_exists( m_arrays, name );
+		}
+
+		void Basic::remove_variable( boost::string_ref name, bool throw_on_nonexist ) {
+			auto variable = find_variable( name );
+			if( nullptr == variable ) {
+				if( throw_on_nonexist ) {
+					throw create_basic_exception( ErrorTypes::SYNTAX, "Attempt to delete unknown variable" );
+				}
+				return;
+			}
+			*variable = Variable{};
+		}
+
+		void Basic::remove_constant( boost::string_ref name, bool throw_on_nonexist ) {
+			auto pos = m_constants.find( to_upper( name ) );
+			if( m_constants.end( ) == pos ) {
+				if( is_constant( name ) ) {
+					throw create_basic_exception( ErrorTypes::SYNTAX, "Cannot delete a built in constant" );
+				} else if( throw_on_nonexist ) {
+					throw create_basic_exception( ErrorTypes::SYNTAX, "Attempt to delete unknown constant" );
+				}
+				return;
+			}
+			m_constants.erase( pos );
+			invalidate_expressions( );
+		}
+
+		//////////////////////////////////////////////////////////////////////////
+		/// summary: Add a function.  result is every type it may return and lets
+		/// RUN unbox variables that are assigned from it
+		void Basic::add_function( boost::string_ref name, std::string description, BasicFunction func,
+		                          ValueTypes result ) {
+			if( is_keyword( name ) ) {
+				throw create_basic_exception( ErrorTypes::FATAL,
+				                              "Cannot create a function with the same name as a system keyword" );
+			}
+			m_functions[to_upper( name )] = FunctionType( std::move( description ), std::move( func ), result );
+			invalidate_expressions( );
+		}
+
+		//////////////////////////////////////////////////////////////////////////
+		/// summary: Add a keyword that runs through std::function.  Lines entered
+		/// before it was added keep treating its name as an identifier
+		void Basic::add_keyword( boost::string_ref name, BasicKeyword keyword ) {
+			auto upper_name = to_upper( name );
+			Keyword built_in = Keyword::REM;
+			if( keywords::find( upper_name.data( ), upper_name.size( ), built_in ) ) {
+				throw create_basic_exception( ErrorTypes::FATAL, "Cannot replace a built in keyword" );
+			} else if( is_function( name ) || is_constant( name ) ) {
+				throw create_basic_exception( ErrorTypes::FATAL,
+				                              "Cannot create a keyword with the same name as a system function/constant" );
+			}
+			m_keywords[std::move( upper_name )] = std::move( keyword );
+		}
+
+		//////////////////////////////////////////////////////////////////////////
+		/// summary: Add a binary operator named by a word that runs through
+		/// std::function.  precedence is on the scale of the built in operators,
+		/// from 2 for ^ to 9 for OR.  Lines entered before it was added keep
+		/// treating its name as an identifier
+		void Basic::add_binary_operator( boost::string_ref name, uint8_t precedence, BasicBinaryOperand oper ) {
+			if( name.empty( ) || find_end_of_identifier( name ) != name.size( ) ) {
+				throw create_basic_exception( ErrorTypes::FATAL, "Operators added must be named by a word" );
+			} else if( "AND" == to_upper( name ) || "OR" == to_upper( name ) ) {
+				throw create_basic_exception( ErrorTypes::FATAL, "Cannot replace a built in operator" );
+			} else if( is_keyword( name ) || is_function( name ) || is_constant( name ) ) {
+				throw create_basic_exception(
+				  ErrorTypes::FATAL, "Cannot create an operator with the same name as a system keyword/function/constant" );
+			} else if( precedence <= operators::unary_precedence || operators::lowest_precedence < precedence ) {
+				throw create_basic_exception( ErrorTypes::FATAL, "Operator precedence must be from 2 to 9" );
+			}
+			m_binary_operators[to_upper( name )] = BinaryOperatorType{precedence, std::move( oper )};
+		}
+
+		//////////////////////////////////////////////////////////////////////////
+		/// summary: Position of line_number, or where it belongs, in the program.
+		/// m_program is kept sorted by add_line so this is a binary search
+		ProgramType::iterator Basic::lower_bound_line( integer line_number ) {
+			return std::lower_bound(
+			  std::begin( m_program ), std::end( m_program ), line_number,
+			  []( ProgramLine const &current_line, integer number ) { return current_line.number < number; } );
+		}
+
+		ProgramType::iterator Basic::find_line( integer line_number ) {
+			auto result = lower_bound_line( line_number );
+			if( std::end( m_program ) != result && line_number == result->number ) {
+				return result;
+			}
+			return std::end( m_program );
+		}
+
+		//////////////////////////////////////////////////////////////////////////
+		/// summary: Add or replace a line.  A line that makes an array of integers
+		/// changes whether A%( is MODULO on the other lines
+		void Basic::add_line( integer line_number, boost::string_ref line ) {
+			auto pos = lower_bound_line( line_number );
+			auto dims = false;
+			if( std::end( m_program ) != pos && line_number == pos->number ) {
+				dims = dims_integer_array( *pos, boost::string_ref( ) );
+				*pos = crunch( line_number, line );
+			} else {
+				pos = m_program.insert( pos, crunch( line_number, line ) );
+			}
+			if( dims || dims_integer_array( *pos, boost::string_ref( ) ) ) {
+				invalidate_expressions( );
+			} else {
+				invalidate_expressions( line_number );
+			}
+		}
+
+		void Basic::remove_line( integer line_number ) {
+			auto pos = find_line( line_number );
+			if( m_program.end( ) != pos ) {
+				auto const dims = dims_integer_array( *pos, boost::string_ref( ) );
+				m_program.erase( pos );
+				if( dims ) {
+					invalidate_expressions( );
+					return;
+				}
+			}
+			invalidate_expressions( line_number );
+		}
+
+		bool Basic::is_keyword( boost::string_ref name ) {
+			auto const upper_name = to_upper( name );
+			Keyword keyword = Keyword::REM;
+			return keywords::find( upper_name.data( ), upper_name.size( ), keyword ) || key_exists( m_keywords, name );
+		}
+
+		bool Basic::is_function( boost::string_ref name ) {
+			return nullptr != find_function( name );
+		}
+
+		//////////////////////////////////////////////////////////////////////////
+		/// summary: The array name, in upper case, without making a key to look
+		/// it up
+		Basic::BasicArray &Basic::find_array( std::string const &name ) {
+			auto array = m_arrays.find( name );
+			if( std::end( m_arrays ) == array ) {
+				throw create_basic_exception( ErrorTypes::SYNTAX, "Unknown symbol name '" + name + "'" );
+			}
+			return array->second;
+		}
+
+		//////////////////////////////////////////////////////////////////////////
+		/// summary: The name of the array at pos in params, moving pos past it.
+		/// % right after the name is part of it as in DIM.  Empty when there is
+		/// no name at pos
+		std::string Basic::array_name( StatementTokens params, size_t &pos ) const {
+			if( params.size( ) <= pos || TokenType::IDENTIFIER != params[pos].type ) {
+				return std::string( );
+			}
+			auto name = m_symbols[params[pos].value];
+			auto const end = params[pos].position + name.size( );
+			++pos;
+			if( pos < params.size( ) && is_operator_token( params[pos], Operator::MODULO ) && end == params[pos].position ) {
+				name += '%';
+				++pos;
+			}
+			return name;
+		}
+
+		//////////////////////////////////////////////////////////////////////////
+		/// summary: Whether line has a DIM of name, or of any array of integers
+		/// when name is empty
+		bool Basic::dims_integer_array( ProgramLine const &line, boost::string_ref name ) const {
+			for( size_t token = 0; token < line.tokens.size( ); ++token ) {
+				if( TokenType::KEYWORD != line.tokens[token].type ||
+				    static_cast<uint32_t>( Keyword::DIM ) != line.tokens[token].value ) {
+					continue;
+				}
+				size_t pos = 0;
+				auto const dimmed = array_name( StatementTokens{&line, token + 1, line.tokens.size( )}, pos );
+				if( !dimmed.empty( ) && '%' == dimmed.back( ) && ( name.empty( ) || name == dimmed ) ) {
+					return true;
+				}
+			}
+			return false;
+		}
+
+		//////////////////////////////////////////////////////////////////////////
+		/// summary: Whether name( in an expression, with name ending in %, indexes
+		/// an array rather than being MODULO.  It does when the array exists or a
+		/// line of the program makes it
+		bool Basic::may_be_integer_array( std::string const &name ) const {
+			return 0 != m_arrays.count( name ) ||
+			       std::any_of( std::begin( m_program ), std::end( m_program ),
+			                    [&]( ProgramLine const &line ) { return dims_integer_array( line, name ); } );
+		}
+
+		//////////////////////////////////////////////////////////////////////////
+		/// summary: The element of the array name at the count indexes in params
+		BasicValue Basic::get_array_variable( std::string const &name, BasicValue const *params, size_t count ) {
+			auto const &current_array = find_array( name );
+			return current_array.get( current_array.indexes( params, count ) );
+		}
+
+		void Basic::set_array_variable( std::string const &name, BasicValue const *params, size_t count,
+		                                BasicValue value ) {
+			auto &current_array = find_array( name );
+			current_array.set( current_array.indexes( params, count ), std::move( value ) );
+		}
+
+		//////////////////////////////////////////////////////////////////////////
+		/// summary: The element of the array name, in upper case, at the integer
+		/// held by the variable index_symbol.  Anything else, including every
+		/// error, goes through get_array_variable
+		BasicValue Basic::get_array_element( std::string const &name, uint32_t index_symbol ) {
+			auto const &index = m_variables[index_symbol];
+			if( !index.is_set ) {
+				throw create_basic_exception( ErrorTypes::SYNTAX, "Unknown symbol '" + m_symbols[index_symbol] + "'" );
+			}
+			auto array = m_arrays.find( name );
+			BasicValue value;
+			if( std::end( m_arrays ) != array && ValueType::INTEGER == index.value.type( ) &&
+			    array->second.get( index.value.integer_value( ), value ) ) {
+				return value;
+			}
+			return get_array_variable( name, &index.value, 1 );
+		}
+
+		//////////////////////////////////////////////////////////////////////////
+		/// summary: Store value like get_array_element finds an element
+		void Basic::set_array_element( std::string const &name, uint32_t index_symbol, BasicValue value ) {
+			auto const &index = m_variables[index_symbol];
+			if( !index.is_set ) {
+				throw create_basic_exception( ErrorTypes::SYNTAX, "Unknown symbol '" + m_symbols[index_symbol] + "'" );
+			}
+			auto array = m_arrays.find( name );
+			if( std::end( m_arrays ) != array && ValueType::INTEGER == index.value.type( ) &&
+			    array->second.set( index.value.integer_value( ), value ) ) {
+				return;
+			}
+			set_array_variable( name, &index.value, 1, std::move( value ) );
+		}
+
+		BasicValue &Basic::get_variable( boost::string_ref name ) {
+			auto &variable = m_variables[intern( name )];
+			variable.is_set = true;
+			return variable.value;
+		}
+
+		void Basic::clear_program( ) {
+			m_program.clear( );
+			m_program.emplace_back( -1, "" );
+			invalidate_expressions( );
+		}
+
+		void Basic::clear_variables( ) {
+			std::fill( std::begin( m_variables ), std::end( m_variables ), Variable{} );
+		}
+
+		void Basic::reset( ) {
+			m_basic.reset( new Basic( ) );
+			clear_program( );
+			clear_variables( );
+		}
+
+		std::string Basic::list_functions( ) {
+			std::stringstream ss;
+			for( auto const &current_function : merge_entries( builtins( ).functions, m_functions ) ) {
+				ss << current_function.first << ": " << current_function.second->description << "\n";
+			}
+			return ss.str( );
+		}
+
+		std::string Basic::list_constants( ) {
+			std::stringstream ss;
+			for( auto const &constant : merge_entries( builtins( ).constants, m_constants ) ) {
+				auto const &current_constant = *constant.second;
+				ss << constant.first << ": " << value_type_to_string( current_constant.value ) << " = "
+				   << to_string( current_constant.value ) << ": " << current_constant.description << "\n";
+			}
+			return ss.str( );
+		}
+
+		std::string Basic::list_keywords( ) {
+			std::stringstream ss;
+			auto keys = get_keys( m_keywords );
+			keys.insert( std::end( keys ), std::begin( keywords::names ), std::end( keywords::names ) );
+			std::sort( std::begin( keys ), std::end( keys ) );
+			for( auto &current_keyword_name : keys ) {
+				ss << current_keyword_name << "\n"; // ": " << m_keywords[current_keyword_name].description << "\n";
+			}
+			return ss.str( );
+		}
+
+		std::string Basic::list_variables( ) {
+			std::stringstream ss;
+			{
+				std::vector<uint32_t> ids;
+				for( uint32_t id = 0; id < m_variables.size( ); ++id ) {
+					if( m_variables[id].is_set ) {
+						ids.push_back( id );
+					}
+				}
+				std::sort( std::begin( ids ), std::end( ids ),
+				           [&]( uint32_t a, uint32_t b ) { return m_symbols[a] < m_symbols[b]; } );
+				for( auto id : ids ) {
+					auto const &current_variable = m_variables[id].value;
+					ss << m_symbols[id] << ": " << value_type_to_string( current_variable ) << " = "
+					   << to_string( current_variable ) << "\n";
+				}
+			}
+			{
+				auto keys = get_keys( m_arrays );
+				std::sort( std::begin( keys ), std::end( keys ) );
+				for( auto &current_array_name : keys ) {
+					const auto &array_value = m_arrays[current_array_name];
+					auto dimensions = array_value.dimensions( );
+					ss << current_array_name << "( ";
+					for( size_t n = 0; n < dimensions.size( ); ++n ) {
+						if( 0 < n ) {
+							ss << ", ";
+						}
+						ss << dimensions[n];
+					}
+					ss << " )\n";
+				}
+			}
+			return ss.str( );
+		}
+
+		BasicValue Basic::exec_function( boost::string_ref name, std::vector<BasicValue> arguments ) {
+			auto function = find_function( name );
+			if( nullptr == function ) {
+				throw create_basic_exception( ErrorTypes::FATAL,
+				                              "Expected function '" + name.to_string( ) + "' to exist.  Could not find it" );
+			}
+			return function->func( std::move( arguments ) );
+		}
+
+		namespace {
+			//////////////////////////////////////////////////////////////////////////
+			/// summary: Register the built in functions and constants.  They must not
+			/// refer to a Basic as they are shared by all of them.  Functions are
+			/// pure unless registered otherwise so constant arguments are folded
+			template<typename AddFunction, typename AddConstant>
+			void add_builtins( AddFunction add_function, AddConstant add_constant ) {
+				//////////////////////////////////////////////////////////////////////////
+				// Functions
+				//////////////////////////////////////////////////////////////////////////
+				// Mathematical
+				//////////////////////////////////////////////////////////////////////////
+
+				add_function( "COS", "COS( Angle ) -> Returns the cosine of angle in radians",
+				              []( std::vector<BasicValue> value ) {
+					              if( 1 != value.size( ) ) {
+						              throw create_basic_exception( ErrorTypes::SYNTAX, "COS requires 1 parameter" );
+					              }
+					              return basic_value_real( cos( to_numeric( value[0] ) ) );
+				              }, value_types( ValueType::REAL ) );
+
+				add_function( "SIN", "SIN( Angle ) -> Returns the sine of angle in radians",
+				              []( std::vector<BasicValue> value ) {
+					              if( 1 != value.size( ) ) {
+						              throw create_basic_exception( ErrorTypes::SYNTAX, "SIN requires 1 parameter" );
+					              }
+					              auto dbl_param = to_numeric( value[0] );
+					              auto result = sin( dbl_param );
+					              return basic_value_real( std::move( result ) );
+				              }, value_types( ValueType::REAL ) );
+
+				add_function( "TAN", "TAN( Angle ) -> Returns the tangent of angle in radians",
+				              []( std::vector<BasicValue> value ) {
+					              if( 1 != value.size( ) ) {
+						              throw create_basic_exception( ErrorTypes::SYNTAX, "TAN requires 1 parameter" );
+					              }
+					              auto dbl_param = to_numeric( value[0] );
+					              auto result = tan( dbl_param );
+					              return basic_value_real( std::move( result ) );
+				              }, value_types( ValueType::REAL ) );
+
+				add_function( "ATN", "ATN( Angle ) -> Returns the arctangent of angle in radians",
+				              []( std::vector<BasicValue> value ) {
+					              if( 1 != value.size( ) ) {
+						              throw create_basic_exception( ErrorTypes::SYNTAX, "ATN requires 1 parameter" );
+					              }
+					              auto dbl_param = to_numeric( value[0] );
+					              auto result = atan( dbl_param );
+					              return basic_value_real( std::move( result ) );
+				              }, value_types( ValueType::REAL ) );
+
+				add_function( "EXP", "EXP( Exponent ) -> Resturn e raised to the power of exponent. Where e = 2.71828183...",
+				              []( std::vector<BasicValue> value ) {
+					              if( 1 != value.size( ) ) {
+						              throw create_basic_exception( ErrorTypes::SYNTAX, "EXP requires 1 parameter" );
+					              }
+					              auto dbl_param = to_numeric( value[0] );
+					              auto result = exp( dbl_param );
+					              return basic_value_real( std::move( result ) );
+				              }, value_types( ValueType::REAL ) );
+
+				add_function( "LOG", "LOG( x ) -> Returns the natural logarithm of x", []( std::vector<BasicValue> value ) {
+					if( 1 != value.size( ) ) {
+						throw create_basic_exception( ErrorTypes::SYNTAX, "LOG requires 1 parameter" );
+					}
+					auto dbl_param = to_numeric( value[0] );
+					auto result = log( dbl_param );
+					return basic_value_real( std::move( result ) );
+				}, value_types( ValueType::REAL ) );
+
+				add_function( "SQR", "SQR( x ) -> Returns the square root of x", []( std::vector<BasicValue> value ) {
+					if( 1 != value.size( ) ) {
+						throw create_basic_exception( ErrorTypes::SYNTAX, "SQRT requires 1 parameter" );
+					}
+					auto dbl_param = to_numeric( value[0] );
+					auto result = sqrt( dbl_param );
+					return basic_value_real( std::move( result ) );
+				}, value_types( ValueType::REAL ) );
+
+				add_function( "SQUARE", "SQUARE( x ) -> Returns x squared", []( std::vector<BasicValue> value ) {
+					if( 1 != value.size( ) ) {
+						throw create_basic_exception( ErrorTypes::SYNTAX, "SQR requires 1 parameter" );
+					}
+					if( ValueType::INTEGER == value[0].type( ) ) {
+						auto int_param = to_integer( value[0] );
+						int_param *= int_param;
+						return basic_value_integer( std::move( int_param ) );
+					} else {
+						auto dbl_param = to_numeric( value[0] );
+						dbl_param *= dbl_param;
+						return basic_value_real( std::move( dbl_param ) );
+					}
+				}, numeric_value_types );
+
+				add_function( "ABS", "ABS( x ) -> Returns the absolute value of x", []( std::vector<BasicValue> value ) {
+					if( 1 != value.size( ) ) {
+						throw create_basic_exception( ErrorTypes::SYNTAX, "SIN requires 1 parameter" );
+					}
+					if( ValueType::INTEGER == value[0].type( ) ) {
+						auto int_param = to_integer( value[0] );
+						if( 0 > int_param ) {
+							int_param = -int_param;
+						}
+						return basic_value_integer( std::move( int_param ) );
+					} else {
+						auto dbl_param = to_numeric( value[0] );
+						auto result = fabs( dbl_param );
+						return basic_value_real( std::move( result ) );
+					}
+				}, numeric_value_types );
+
+				add_function( "SGN", "SGN( x ) -> Returns the sign of x ( -1 for negative, 0 for 0, and 1 for positive)",
+				              []( std::vector<BasicValue> value ) {
+					              if( 1 != value.size( ) ) {
+						              throw create_basic_exception( ErrorTypes::SYNTAX, "SGN requires 1 parameter" );
+					              }
+					              auto result = to_numeric( value[0] );
+					              if( 0 < result ) {
+						              result = 1;
+					              } else if( 0 > result ) {
+						              result = -1;
+					              } else {
+						              result = 0;
+					              }
+					              if( ValueType::INTEGER == value[0].type( ) ) {
+						              return basic_value_integer( static_cast<integer>( result ) );
+					              }
+					              return basic_value_real( result );
+				              }, numeric_value_types );
+
+				add_function( "INT", "INT( x ) -> Returns x truncated to the greatest integer less or equal",
+				              []( std::vector<BasicValue> value ) {
+					              if( 1 != value.size( ) ) {
+						              throw create_basic_exception( ErrorTypes::SYNTAX, "INT requires 1 parameter" );
+					              }
+					              if( ValueType::INTEGER == value[0].type( ) ) {
+						              return value[0];
+					              }
+
+					              auto result = to_real( value[0] );
+					              result = round( result - 0.5 );
+					              return basic_value_integer( static_cast<integer>( result ) );
+				              }, value_types( ValueType::INTEGER ) );
+
+				add_function( "RND",
+				              "RND( [s] ) -> Returns a random number between 0.0 and 1.0.  An optional seed can be specified",
+				              []( std::vector<BasicValue> value ) -> BasicValue {
+					              if( 1 >= value.size( ) ) {
+						              throw create_basic_exception( ErrorTypes::SYNTAX, "INT requires 1 or 0 parameters" );
+					              }
+					              throw create_basic_exception( ErrorTypes::SYNTAX, "Not implemented" );
+					              // 				if( ValueType::INTEGER == value[0].type( ) ) {
+					              // 					return value[0];
+					              // 				}
+					              //
+					              // 				auto result = to_real( value[0] );
+					              // 				result = round( result - 0.5 );
+					              // 				return basic_value_integer( static_cast<integer>(result) );
+				              }, value_types( ValueType::REAL ), false );
+
+				add_function( "NEG", "NEG( x ) -> Returns the negated number", []( std::vector<BasicValue> values ) {
+					if( 1 != values.size( ) ) {
+						throw create_basic_exception( ErrorTypes::SYNTAX, "NEG requires 1 parameter" );
+					}
+					return negate_value( values[0] );
+				}, numeric_value_types );
+
+				add_function( "POW", "POW( base, exponent ) -> Returns base raised to the power exponent",
+				              []( std::vector<BasicValue> value ) {
+					              if( 2 != value.size( ) ) {
+						              throw create_basic_exception( ErrorTypes::SYNTAX, "POW requires 2 parameters" );
+					              }
+					              return power_values( value[0], value[1] );
+				              }, numeric_value_types );
+				//////////////////////////////////////////////////////////////////////////
+				// Logical
+				//////////////////////////////////////////////////////////////////////////
+
+				add_function( "NOT", "Boolean negation", []( std::vector<BasicValue> value ) {
+					if( 1 != value.size( ) ) {
+						throw create_basic_exception( ErrorTypes::SYNTAX, "NOT requires 1 parameter" );
+					}
+					return basic_value_boolean( !to_boolean( value[0] ) );
+				}, value_types( ValueType::BOOLEAN ) );
+
+				//////////////////////////////////////////////////////////////////////////
+				// Character and String Processing
+				//////////////////////////////////////////////////////////////////////////
+
+				add_function( "LEN", "LEN( s ) -> Returns the length of string s", []( std::vector<BasicValue> value ) {
+					if( 1 != value.size( ) ) {
+						throw create_basic_exception( ErrorTypes::SYNTAX, "LEN requires 1 parameter" );
+					} else if( ValueType::STRING != get_value_type( value[0] ) ) {
+						throw create_basic_exception( ErrorTypes::SYNTAX, "LEN only works on string data" );
+					}
+					auto str_value = to_string( value[0] );
+					assert( can_fit<daw::basic::integer>( str_value.size( ) ) );
+					return basic_value_integer( static_cast<daw::basic::integer>( str_value.size( ) ) );
+				}, value_types( ValueType::INTEGER ) );
+
+				add_function(
+				  "LEFT$", "LEFT$( string, len ) -> Returns the left side of the string up to len characters long",
+				  []( std::vector<BasicValue> value ) {
+					  if( 2 != value.size( ) ) {
+						  throw create_basic_exception( ErrorTypes::SYNTAX, "LEFT$ requires 2 parameters" );
+					  } else if( ValueType::STRING != get_value_type( value[0] ) ) {
+						  throw create_basic_exception( ErrorTypes::SYNTAX, "The first parameter of LEFT$ must be a string" );
+					  } else if( ValueType::INTEGER != get_value_type( value[1] ) ) {
+						  throw create_basic_exception( ErrorTypes::SYNTAX, "The second parameter of LEFT$ must be an integer" );
+					  }
+					  auto len = [&]( ) {
+						  auto result = to_integer( value[1] );
+						  if( 0 > result ) {
+							  throw create_basic_exception( ErrorTypes::SYNTAX, "The len parameter of LEFT$ must be positive" );
+						  }
+						  assert( can_fit<size_t>( result ) );
+						  return static_cast<size_t>( result );
+					  }( );
+					  return basic_value_string( to_string( value[0] ).substr( 0, std::move( len ) ) );
+				  }, value_types( ValueType::STRING ) );
+
+				add_function(
+				  "RIGHT$", "RIGHT$( string, len ) -> Returns the right side of the string up to len characters long",
+				  []( std::vector<BasicValue> value ) {
+					  if( 2 != value.size( ) ) {
+						  throw create_basic_exception( ErrorTypes::SYNTAX, "RIGHT$ requires 2 parameters" );
+					  } else if( ValueType::STRING != get_value_type( value[0] ) ) {
+						  throw create_basic_exception( ErrorTypes::SYNTAX, "The first parameter of RIGHT$ must be a string" );
+					  } else if( ValueType::INTEGER != get_value_type( value[1] ) ) {
+						  throw create_basic_exception( ErrorTypes::SYNTAX, "The second parameter of RIGHT$ must be an integer" );
+					  }
+					  auto str_value = to_string( value[0] );
+					  auto start = [&]( ) {
+						  auto result = to_integer( value[1] );
+						  if( 0 > result ) {
+							  throw create_basic_exception( ErrorTypes::SYNTAX, "The len parameter of RIGHT$ must be positive" );
+						  }
+						  assert( can_fit<size_t>( result ) );
+						  return static_cast<size_t>( result );
+					  }( );
+					  start = str_value.size( ) - start;
+					  return basic_value_string( str_value.substr( start ) );
+				  }, value_types( ValueType::STRING ) );
+
+				add_function(
+				  "MID$", "MID$( string, start, len ) -> Returns the middle of the string from start up to len characters long",
+				  []( std::vector<BasicValue> value ) {
+					  if( 3 != value.size( ) ) {
+						  throw create_basic_exception( ErrorTypes::SYNTAX, "MID$ requires 3 parameters" );
+					  } else if( ValueType::STRING != get_value_type( value[0] ) ) {
+						  throw create_basic_exception( ErrorTypes::SYNTAX, "The first parameter of MID$ must be a string" );
+					  } else if( ValueType::INTEGER != get_value_type( value[1] ) ||
+					             ValueType::INTEGER != get_value_type( value[2] ) ) {
+						  throw create_basic_exception( ErrorTypes::SYNTAX,
+						                                "The parameters start and len of MID$ must be an integer" );
+					  }
+
+					  auto start = [&]( ) {
+						  auto result = to_integer( std::move( value[1] ) );
+						  if( 0 > result ) {
+							  throw create_basic_exception( ErrorTypes::SYNTAX,
+							                                "The start parameter of MID$ must be greater than zero" );
+						  }
+						  --result; // BASIC arrays start at 1
+						  assert( can_fit<size_t>( result ) );
+						  return static_cast<size_t>( result );
+					  }( );
+
+					  auto len = [&]( ) {
+						  auto result = to_integer( std::move( value[2] ) );
+						  if( 0 > result ) {
+							  throw create_basic_exception( ErrorTypes::SYNTAX, "The len parameter of MID$ must be positive" );
+						  }
+						  assert( can_fit<size_t>( result ) );
+						  return static_cast<size_t>( result );
+					  }( );
+					  return basic_value_string( to_string( std::move( value[0] ) ).substr( start, len ) );
+				  }, value_types( ValueType::STRING ) );
+
+				add_function( "STR$", "STR$( x ) -> Converts a number to a string", []( std::vector<BasicValue> value ) {
+					if( 1 != value.size( ) ) {
+						throw create_basic_exception( ErrorTypes::SYNTAX, "STR$ requires 1 parameter" );
+					} else if( ValueType::INTEGER != get_value_type( value[0] ) && ValueType::REAL != get_value_type( value[0] ) ) {
+						throw create_basic_exception( ErrorTypes::SYNTAX, "STR$ only works on numeric data" );
+					}
+					return basic_value_string( to_string( std::move( value[0] ) ) );
+				}, value_types( ValueType::STRING ) );
+
+				add_function( "VAL", "VAL( s ) -> Converts a string to a number", []( std::vector<BasicValue> value ) {
+					if( 1 != value.size( ) ) {
+						throw create_basic_exception( ErrorTypes::SYNTAX, "VAL requires 1 parameter" );
+					} else if( ValueType::STRING != get_value_type( value[0] ) ) {
+						throw create_basic_exception( ErrorTypes::SYNTAX, "VAL only works on string data" );
+					}
+					auto str_value = to_string( value[0] );
+					switch( get_value_type( str_value ) ) {
+					case ValueType::INTEGER:
+						return basic_value_integer( to_integer( std::move( str_value ) ) );
+					case ValueType::REAL:
+						return basic_value_real( to_real( std::move( str_value ) ) );
+					case ValueType::ARRAY:
+					case ValueType::BOOLEAN:
+					case ValueType::EMPTY:
+					case ValueType::STRING:
+						throw create_basic_exception( ErrorTypes::SYNTAX, "Attempt to convert a string of non-numbers to a number" );
+					default:
+						throw std::exception{};
+					}
+				}, numeric_value_types );
+
+				add_function( "ASC", "ASC( s ) -> Returns the ASCII code of the first character of a string",
+				              []( std::vector<BasicValue> value ) {
+					              if( 1 != value.size( ) ) {
+						              throw create_basic_exception( ErrorTypes::SYNTAX, "ASC requires 1 parameter" );
+					              } else if( ValueType::STRING != get_value_type( value[0] ) ) {
+						              throw create_basic_exception( ErrorTypes::SYNTAX, "ASC only works on string data" );
+					              }
+					              auto chr_value = to_string( value[0] )[0];
+					              assert( can_fit<integer>( chr_value ) );
+					              return basic_value_integer( static_cast<integer>( chr_value ) );
+				              }, value_types( ValueType::INTEGER ) );
+
+				add_function( "CHR$", "CHR$( x ) -> Returns a string with the character of the specified ASCII code",
+				              []( std::vector<BasicValue> value ) {
+					              if( 1 != value.size( ) ) {
+						              throw create_basic_exception( ErrorTypes::SYNTAX, "CHR$ requires 1 parameter" );
+					              } else if( ValueType::INTEGER != get_value_type( value[0] ) ) {
+						              throw create_basic_exception( ErrorTypes::SYNTAX, "CHR$ only works on integer data" );
+					              }
+					              auto ascii_code = to_integer( value[0] );
+					              if( 0 > ascii_code || 255 < ascii_code ) {
+						              throw create_basic_exception( ErrorTypes::SYNTAX,
+						                                            "Specified ASCII code must be between 0 and 255 inclusive" );
+					              }
+					              assert( can_fit<char>( ascii_code ) );
+					              return basic_value_string( char_to_string( static_cast<char>( ascii_code ) ) );
+				              }, value_types( ValueType::STRING ) );
+
+				// 			add_function( "SPLIT$", "SPLIT$( string, delimiter ) -> Returns an array of strings from the original string
+				// delimited by delimiter", []( std::vector<BasicValue> value ) { 				if( 2 != value.size( ) ) {
+				// 					throw CreateError( ErrorTypes::SYNTAX, "SPLIT$ requires 2 parameters" );
+				// 				} else if( ValueType::STRING != get_value_type( value[0] ) || ValueType::STRING != get_value_type( value[1]
+				// ) ) { 					throw CreateError( ErrorTypes::SYNTAX, "SPLIT$ requires string parameters" );
+				// 				}
+				// 				auto str_string = to_string( value[0] );
+				// 				auto str_delim = to_string( value[1] );
+				// 				auto result = split( std::move( str_string ), std::move( str_delim ) );
+				// 				return basic_value_array( std::move( result ) );
+				// 			} );
+
+				//////////////////////////////////////////////////////////////////////////
+				// Constants
+				//////////////////////////////////////////////////////////////////////////
+
+				add_constant( "TRUE", "", basic_value_boolean( true ) );
+				add_constant( "FALSE", "", basic_value_boolean( false ) );
+				add_constant( "PI", "Trigometric Pi value", basic_value_real( boost::math::constants::pi<real>( ) ) );
+			}
+		} // namespace
+
+		//////////////////////////////////////////////////////////////////////////
+		/// summary: The built in functions and constants.  Built on first use and
+		/// never changed after so every Basic shares them without locking
+		Basic::Builtins const &Basic::builtins( ) {
+			static Builtins const result = []( ) {
+				Builtins registry;
+				add_builtins(
+				  [&registry]( std::string name, std::string description, BasicFunction func, ValueTypes result,
+				               bool pure = true ) {
+					  registry.functions[std::move( name )] =
+					    FunctionType( std::move( description ), std::move( func ), result, pure );
+				  },
+				  [&registry]( std::string name, std::string description, BasicValue value ) {
+					  registry.constants[std::move( name )] = ConstantType( std::move( description ), std::move( value ) );
+				  } );
+				add_array_functions( registry );
+				return registry;
+			}( );
+			return result;
+		}
+
+		//////////////////////////////////////////////////////////////////////////
+		/// summary: The builtins that reduce whole arrays, like SUM( A ).  The
+		/// compiler passes the names of arrays among their arguments as
+		/// references.  Arrays of numbers are reduced by the kernels of MAT,
+		/// other arrays one element at a time with the operators of Basic.
+		/// Results depend on the arrays so they are never folded
+		void Basic::add_array_functions( Builtins &registry ) {
+			auto const add_function = [&registry]( std::string name, std::string description, BasicFunction func,
+			                                       ValueTypes result ) {
+				auto &function = registry.functions[std::move( name )];
+				function = FunctionType( std::move( description ), std::move( func ), result );
+				function.arrays = true;
+			};
+			auto const check_arguments = []( std::vector<BasicValue> const &values, size_t arrays, size_t optional,
+			                                 char const *name ) {
+				if( values.size( ) < arrays || arrays + optional < values.size( ) ) {
+					throw ::daw::basic::create_basic_exception( ErrorTypes::SYNTAX,
+					                                            std::string( name ) + " requires " + std::to_string( arrays ) +
+					                                              " array" + ( 1 < arrays ? "s" : "" ) );
+				}
+				for( size_t n = 0; n < arrays; ++n ) {
+					if( ValueType::ARRAY != values[n].type( ) ) {
+						throw ::daw::basic::create_basic_exception( ErrorTypes::SYNTAX,
+						                                            std::string( name ) + " requires the name of an array" );
+					}
+				}
+			};
+			auto const array_at = []( std::vector<BasicValue> const &values, size_t pos ) -> BasicArray const & {
+				return *static_cast<BasicArray const *>( values[pos].array_value( ) );
+			};
+			// Optional last argument of SUM and MEAN
+			auto const summation = []( std::vector<BasicValue> const &values, size_t pos ) {
+				return pos < values.size( ) && to_boolean( values[pos] ) ? mat::Summation::COMPENSATED
+				                                                         : mat::Summation::FAST;
+			};
+			// An empty array sums to 0
+			auto const sum = []( BasicArray const &array, mat::Summation how ) {
+				auto const size = array.total_items( );
+				switch( array.element_type( ) ) {
+				case BasicArray::ElementType::REAL:
+					return basic_value_real( 0 == size ? 0.0 : mat::sum( mat::best_kernel( ), how, array.reals( ), size ) );
+				case BasicArray::ElementType::INTEGER:
+					return 0 == size ? basic_value_integer( 0 )
+					                 : checked_integer( mat::sum( mat::best_kernel( ), array.integers( ), size ) );
+				case BasicArray::ElementType::ANY:
+				case BasicArray::ElementType::STRING:
+					break;
+				}
+				if( 0 == size ) {
+					return basic_value_integer( 0 );
+				}
+				auto result = array.at( 0 );
+				for( size_t n = 1; n < size; ++n ) {
+					result = apply_operator( Operator::ADD, result, array.at( n ) );
+				}
+				return result;
+			};
+			// oper is LESS for the minimum and GREATER for the maximum
+			auto const extreme = []( BasicArray const &array, Operator oper, char const *name ) {
+				auto const size = array.total_items( );
+				if( 0 == size ) {
+					throw ::daw::basic::create_basic_exception( ErrorTypes::SYNTAX,
+					                                            std::string( name ) + " requires an array with elements" );
+				}
+				auto const is_minimum = Operator::LESS == oper;
+				switch( array.element_type( ) ) {
+				case BasicArray::ElementType::REAL:
+					return basic_value_real( is_minimum ? mat::minimum( mat::best_kernel( ), array.reals( ), size )
+					                                    : mat::maximum( mat::best_kernel( ), array.reals( ), size ) );
+				case BasicArray::ElementType::INTEGER:
+					return basic_value_integer( is_minimum ? mat::minimum( mat::best_kernel( ), array.integers( ), size )
+					                                       : mat::maximum( mat::best_kernel( ), array.integers( ), size ) );
+				case BasicArray::ElementType::ANY:
+				case BasicArray::ElementType::STRING:
+					break;
+				}
+				auto result = array.at( 0 );
+				for( size_t n = 1; n < size; ++n ) {
+					auto value = array.at( n );
+					if( to_boolean( apply_operator( oper, value, result ) ) ) {
+						result = std::move( value );
+					}
+				}
+				return result;
+			};
+
+			add_function( "SUM", "SUM( a[, compensated] ) -> Returns the sum of the elements of array a.  Reals are "
+			                     "summed with Kahan compensation when compensated is true",
+			              [check_arguments, array_at, summation, sum]( std::vector<BasicValue> value ) {
+				              check_arguments( value, 1, 1, "SUM" );
+				              return sum( array_at( value, 0 ), summation( value, 1 ) );
+			              }, any_value_types );
+
+			add_function( "MIN", "MIN( a ) -> Returns the smallest element of array a",
+			              [check_arguments, array_at, extreme]( std::vector<BasicValue> value ) {
+				              check_arguments( value, 1, 0, "MIN" );
+				              return extreme( array_at( value, 0 ), Operator::LESS, "MIN" );
+			              }, any_value_types );
+
+			add_function( "MAX", "MAX( a ) -> Returns the largest element of array a",
+			              [check_arguments, array_at, extreme]( std::vector<BasicValue> value ) {
+				              check_arguments( value, 1, 0, "MAX" );
+				              return extreme( array_at( value, 0 ), Operator::GREATER, "MAX" );
+			              }, any_value_types );
+
+			add_function( "MEAN", "MEAN( a[, compensated] ) -> Returns the mean of the elements of array a, summed "
+			                      "like SUM",
+			              [check_arguments, array_at, summation, sum]( std::vector<BasicValue> value ) {
+				              check_arguments( value, 1, 1, "MEAN" );
+				              auto const &array = array_at( value, 0 );
+				              if( 0 == array.total_items( ) ) {
+					              throw ::daw::basic::create_basic_exception( ErrorTypes::SYNTAX,
+					                                                          "MEAN requires an array with elements" );
+				              }
+				              auto const total = to_numeric( sum( array, summation( value, 1 ) ) );
+				              return basic_value_real( total / static_cast<real>( array.total_items( ) ) );
+			              }, value_types( ValueType::REAL ) );
+
+			add_function( "DOT", "DOT( a, b ) -> Returns the sum of the products of the elements of arrays a and b.  "
+			                     "Integer unless either holds other values",
+			              [check_arguments, array_at]( std::vector<BasicValue> value ) {
+				              check_arguments( value, 2, 0, "DOT" );
+				              auto const &lhs = array_at( value, 0 );
+				              auto const &rhs = array_at( value, 1 );
+				              auto const size = lhs.total_items( );
+				              if( size != rhs.total_items( ) ) {
+					              throw ::daw::basic::create_basic_exception(
+					                ErrorTypes::SYNTAX, "DOT requires arrays with the same number of elements" );
+				              }
+				              if( 0 == size ) {
+					              return basic_value_integer( 0 );
+				              }
+				              auto const is = [&lhs, &rhs]( BasicArray::ElementType type ) {
+					              return type == lhs.element_type( ) && type == rhs.element_type( );
+				              };
+				              int64_t integer_result = 0;
+				              if( is( BasicArray::ElementType::INTEGER ) &&
+				                  mat::dot( lhs.integers( ), rhs.integers( ), size, integer_result ) ) {
+					              return checked_integer( integer_result );
+				              }
+				              if( is( BasicArray::ElementType::REAL ) ) {
+					              return basic_value_real( mat::dot( mat::best_kernel( ), lhs.reals( ), rhs.reals( ), size ) );
+				              }
+				              auto const lhs_copy = lhs.to_reals( );
+				              auto const rhs_copy = rhs.to_reals( );
+				              return basic_value_real(
+				                mat::dot( mat::best_kernel( ), lhs_copy.data( ), rhs_copy.data( ), size ) );
+			              }, numeric_value_types );
+		}
+
+		void Basic::init( ) {
+			builtins( );
+			clear_program( );
+		}
+
+		//////////////////////////////////////////////////////////////////////////
+		// Keywords
+		//////////////////////////////////////////////////////////////////////////
+		bool Basic::keyword_new( StatementTokens ) {
+			reset( );
+			return true;
+		}
+
+		bool Basic::keyword_clr( StatementTokens params ) {
+			if( params.empty( ) ) {
+				clear_variables( );
+			} else if( 1 == params.size( ) && TokenType::IDENTIFIER == params[0].type ) {
+				remove_variable( m_symbols[params[0].value] );
+			} else {
+				throw create_basic_exception( ErrorTypes::SYNTAX, "CLR takes an optional variable name" );
+			}
+			return true;
+		}
+
+		bool Basic::keyword_delete( StatementTokens params ) {
+			if( 1 != params.size( ) || TokenType::INTEGER != params[0].type ) {
+				throw create_basic_exception( ErrorTypes::SYNTAX,
+				                              "DELETE requires an INTEGER parameter for the line number to delete" );
+			}
+			remove_line( static_cast<integer>( params[0].value ) );
+			return true;
+		}
+
+		bool Basic::keyword_dim( StatementTokens params ) {
+			size_t pos = 0;
+			auto const var_name = array_name( params, pos );
+			if( var_name.empty( ) || params.size( ) < pos + 2 || TokenType::OPEN_BRACKET != params[pos].type ||
+			    TokenType::CLOSE_BRACKET != params[params.size( ) - 1].type ) {
+				throw create_basic_exception( ErrorTypes::SYNTAX, "Could not find parameters surrounded by ( )" );
+			}
+
+			auto params_values = evaluate_parameters( params.sub_range( pos + 1, params.size( ) - pos - 2 ) );
+			if( 2 < params_values.size( ) || 1 > params_values.size( ) ) {
+				throw create_basic_exception( ErrorTypes::SYNTAX,
+				                              "Must specify at least 1 size parameter to DIM and optionally 2" );
+			}
+
+			if( is_keyword( var_name ) || is_function( var_name ) || is_constant( var_name ) ) {
+				throw create_basic_exception( ErrorTypes::SYNTAX,
+				                              "Cannot create an array with the same name as a keyword or function" );
+			}
+			if( is_variable( var_name ) ) {
+				// Do error or erase.  check in spec but for now erase
+				remove_variable( var_name );
+			} else if( is_array( var_name ) ) {
+				throw create_basic_exception( ErrorTypes::SYNTAX, "Attempt to Re-DIM an existing array" );
+			}
+			add_array_variable( var_name, params_values );
+
+			return true;
+		}
+
+		//////////////////////////////////////////////////////////////////////////
+		/// summary: Work on whole arrays made by DIM, taking every element as a
+		/// number.
+		/// MAT <array> = <array> [+|-|* <array>]
+		/// MAT <array> = ( <factor> ) * <array>
+		/// MAT <array> = TRN( <array> ) | ZER | CON | IDN
+		/// * is the matrix product, where an array of one dimension is a single
+		/// column.  The array assigned must already have the dimensions of the
+		/// result.  An integer array is named without a space before its %
+		bool Basic::keyword_mat( StatementTokens params ) {
+			size_t pos = 0;
+			auto const syntax_error = [&]( ) {
+				return create_basic_exception( ErrorTypes::SYNTAX, "MAT requires <array> = <array> [+|-|* <array>], "
+				                                                   "( <factor> ) * <array>, TRN( <array> ), ZER, CON or IDN" );
+			};
+			auto const next_name = [&]( ) {
+				auto name = array_name( params, pos );
+				if( name.empty( ) ) {
+					throw syntax_error( );
+				}
+				return name;
+			};
+			auto const next_array = [&]( ) -> BasicArray & { return find_array( next_name( ) ); };
+			auto const expect = [&]( bool found ) {
+				if( !found ) {
+					throw syntax_error( );
+				}
+				++pos;
+			};
+			// Rows and columns of a matrix
+			auto const shape = [&]( BasicArray const &array ) {
+				auto dimensions = array.dimensions( );
+				if( 2 < dimensions.size( ) ) {
+					throw create_basic_exception( ErrorTypes::SYNTAX, "MAT requires arrays of one or two dimensions" );
+				}
+				dimensions.resize( 2, 1 );
+				return dimensions;
+			};
+			auto const mismatch = [&]( ) {
+				return create_basic_exception( ErrorTypes::SYNTAX, "Array dimensions do not match in MAT" );
+			};
+			// Arrays of reals are used in place, others are copied as reals
+			auto const numbers = []( BasicArray const &array, std::vector<real> &copy ) -> real const * {
+				if( auto const values = array.reals( ) ) {
+					return values;
+				}
+				copy = array.to_reals( );
+				return copy.data( );
+			};
+
+			auto &target = next_array( );
+			expect( pos < params.size( ) && is_operator_token( params[pos], Operator::EQUAL ) );
+			auto const size = target.total_items( );
+			auto const kernel = mat::best_kernel( );
+			std::vector<real> result;
+			std::vector<real> lhs_copy;
+			std::vector<real> rhs_copy;
+			// Element wise results go straight into an array of reals
+			auto const element_wise = [&]( BasicArray const &source ) {
+				if( source.dimensions( ) != target.dimensions( ) ) {
+					throw mismatch( );
+				}
+				if( auto const values = target.reals( ) ) {
+					return values;
+				}
+				result.resize( size );
+				return result.data( );
+			};
+
+			if( pos < params.size( ) && TokenType::OPEN_BRACKET == params[pos].type ) {
+				auto const first = pos + 1;
+				for( size_t depth = 0; pos < params.size( ); ++pos ) {
+					if( TokenType::OPEN_BRACKET == params[pos].type ) {
+						++depth;
+					} else if( TokenType::CLOSE_BRACKET == params[pos].type && 0 == --depth ) {
+						break;
+					}
+				}
+				expect( pos < params.size( ) && first < pos );
+				auto const factor = to_numeric( evaluate( params.sub_range( first, pos - 1 - first ) ) );
+				expect( pos < params.size( ) && is_operator_token( params[pos], Operator::MULTIPLY ) );
+				auto const &source = next_array( );
+				auto const values = element_wise( source );
+				mat::scale( kernel, factor, numbers( source, lhs_copy ), values, size );
+			} else {
+				auto const function = pos < params.size( ) && TokenType::IDENTIFIER == params[pos].type
+				                        ? to_upper( m_symbols[params[pos].value] )
+				                        : std::string( );
+				if( "TRN" == function ) {
+					++pos;
+					expect( pos < params.size( ) && TokenType::OPEN_BRACKET == params[pos].type );
+					auto const &source = next_array( );
+					expect( pos < params.size( ) && TokenType::CLOSE_BRACKET == params[pos].type );
+					auto const from = shape( source );
+					auto const to = shape( target );
+					if( 2 != source.dimensions( ).size( ) || from[0] != to[1] || from[1] != to[0] ) {
+						throw mismatch( );
+					}
+					result.resize( size );
+					mat::transpose( numbers( source, lhs_copy ), result.data( ), from[0], from[1] );
+				} else if( "ZER" == function || "CON" == function || "IDN" == function ) {
+					++pos;
+					result.assign( size, "CON" == function ? 1.0 : 0.0 );
+					if( "IDN" == function ) {
+						auto const dimensions = target.dimensions( );
+						if( 2 != dimensions.size( ) || dimensions[0] != dimensions[1] ) {
+							throw create_basic_exception( ErrorTypes::SYNTAX, "IDN requires a square array" );
+						}
+						for( size_t n = 0; n < dimensions[0]; ++n ) {
+							result[n + n * dimensions[0]] = 1.0;
+						}
+					}
+				} else {
+					auto const &lhs = next_array( );
+					if( params.size( ) == pos ) {
+						auto const values = element_wise( lhs );
+						auto const source = numbers( lhs, lhs_copy );
+						if( values != source ) {
+							std::copy( source, source + size, values );
+						}
+					} else if( is_operator_token( params[pos], Operator::MULTIPLY ) ) {
+						++pos;
+						auto const &rhs = next_array( );
+						auto const rows = shape( lhs );
+						auto const columns = shape( rhs );
+						auto const to = shape( target );
+						if( rows[1] != columns[0] || rows[0] != to[0] || columns[1] != to[1] ) {
+							throw mismatch( );
+						}
+						// The product is made apart from target, which may be lhs or rhs
+						result.resize( size );
+						mat::multiply( kernel, numbers( lhs, lhs_copy ), numbers( rhs, rhs_copy ), result.data( ), rows[0],
+						               rows[1], columns[1] );
+					} else {
+						auto const subtract = is_operator_token( params[pos], Operator::SUBTRACT );
+						expect( subtract || is_operator_token( params[pos], Operator::ADD ) );
+						auto const &rhs = next_array( );
+						if( lhs.dimensions( ) != rhs.dimensions( ) ) {
+							throw mismatch( );
+						}
+						auto const values = element_wise( lhs );
+						auto const lhs_values = numbers( lhs, lhs_copy );
+						auto const rhs_values = numbers( rhs, rhs_copy );
+						if( subtract ) {
+							mat::subtract( kernel, lhs_values, rhs_values, values, size );
+						} else {
+							mat::add( kernel, lhs_values, rhs_values, values, size );
+						}
+					}
+				}
+			}
+			if( params.size( ) != pos ) {
+				throw syntax_error( );
+			}
+			if( !result.empty( ) ) {
+				target.assign( result );
+			}
+			return true;
+		}
+
+		//////////////////////////////////////////////////////////////////////////
+		/// summary: Sort whole arrays made by DIM in ascending order, taking the
+		/// elements in the order they are stored.
+		/// SORT <array>[, <array>...] [STABLE]
+		/// The arrays after the first are reordered like it and must have as
+		/// many elements.  STABLE keeps equal elements of the first array in the
+		/// order they were in.  Large arrays are sorted across every core
+		bool Basic::keyword_sort( StatementTokens params ) {
+			auto const syntax_error = [&]( ) {
+				return create_basic_exception( ErrorTypes::SYNTAX, "SORT requires <array>[, <array>...] [STABLE]" );
+			};
+			std::vector<BasicArray *> arrays;
+			auto stable = false;
+			size_t pos = 0;
+			while( true ) {
+				auto const name = array_name( params, pos );
+				if( name.empty( ) ) {
+					throw syntax_error( );
+				}
+				auto &array = find_array( name );
+				if( std::end( arrays ) == std::find( std::begin( arrays ), std::end( arrays ), &array ) ) {
+					arrays.push_back( &array );
+				}
+				if( params.size( ) == pos ) {
+					break;
+				} else if( TokenType::COMMA == params[pos].type ) {
+					++pos;
+				} else if( pos + 1 == params.size( ) && TokenType::IDENTIFIER == params[pos].type &&
+				           "STABLE" == m_symbols[params[pos].value] ) {
+					stable = true;
+					break;
+				} else {
+					throw syntax_error( );
+				}
+			}
+			auto &keys = *arrays.front( );
+			for( auto const array : arrays ) {
+				if( array->total_items( ) != keys.total_items( ) ) {
+					throw create_basic_exception( ErrorTypes::SYNTAX, "Arrays must have the same number of elements to SORT" );
+				}
+			}
+			auto const order = keys.sort( stable, 1 < arrays.size( ) );
+			for( size_t n = 1; n < arrays.size( ); ++n ) {
+				arrays[n]->permute( order );
+			}
+			return true;
+		}
+
+		bool Basic::keyword_let( StatementTokens params ) {
+			return let_helper( params );
+		}
+
+		bool Basic::keyword_stop( StatementTokens ) {
+			if( RunMode::IMMEDIATE == m_run_mode ) {
+				throw create_basic_exception( ErrorTypes::SYNTAX, "Attempt to STOP from outside a program" );
+			}
+			std::cout << "BREAK IN " << m_program_it->number << std::endl;
+			m_exiting = true;
+			return true;
+		}
+
+		bool Basic::keyword_cont( StatementTokens ) {
+			if( RunMode::DEFERRED == m_run_mode ) {
+				throw create_basic_exception( ErrorTypes::SYNTAX, "Attempt to CONT from inside a program" );
+			}
+			m_basic->m_run_mode = RunMode::DEFERRED;
+			return m_basic->continue_run( );
+		}
+
+		bool Basic::keyword_goto( StatementTokens params ) {
+			if( RunMode::IMMEDIATE == m_run_mode ) {
+				throw create_basic_exception( ErrorTypes::SYNTAX, "Attempt to GOTO from outside a program" );
+			}
+			if( 1 != params.size( ) || TokenType::INTEGER != params[0].type ) {
+				throw create_basic_exception( ErrorTypes::SYNTAX, "Can only GOTO line numbers" );
+			}
+			set_program_it( static_cast<integer>( params[0].value ), -1 );
+			return true;
+		}
+
+		bool Basic::keyword_gosub( StatementTokens params ) {
+			// Store program line on stack and then call goto
+			if( RunMode::IMMEDIATE == m_run_mode ) {
+				throw create_basic_exception( ErrorTypes::SYNTAX, "Attempt to GOSUB from outside a program" );
+			}
+			m_program_stack.emplace_back( m_program_it, params.last + 1 );
+			return keyword_goto( params );
+		}
+
+		bool Basic::keyword_return( StatementTokens ) {
+			// Pop program line from stack and then run GOTO
+			if( RunMode::IMMEDIATE == m_run_mode ) {
+				throw create_basic_exception( ErrorTypes::SYNTAX, "Attempt to RETURN from outside a program" );
+			} else if( m_program_stack.empty( ) ) {
+				throw create_basic_exception( ErrorTypes::SYNTAX, "Attempt to RETURN without a preceding GOSUB" );
+			}
+
+			// Continue with the statement after the GOSUB
+			auto const caller = pop( m_program_stack );
+			if( caller.second < caller.first->tokens.size( ) ) {
+				m_program_it = caller.first - 1;
+				m_resume_token = caller.second;
+			} else {
+				m_program_it = caller.first;
+			}
+			m_jumped = true;
+			return true;
+		}
+
+		bool Basic::keyword_print( StatementTokens params ) {
+			if( params.empty( ) ) {
+				std::cout << std::endl;
+				return true;
+			}
+
+			std::string evaluated_value = to_string( evaluate( params ) );
+			std::cout << evaluated_value << "\n";
+			return true;
+		}
+
+		bool Basic::keyword_quit( StatementTokens ) {
+			std::cout << "Good bye\n" << std::endl;
+			m_exiting = true;
+			return true;
+		}
+
+		bool Basic::keyword_exit( StatementTokens ) {
+			m_exiting = true;
+			return true;
+		}
+
+		bool Basic::keyword_end( StatementTokens ) {
+			if( RunMode::IMMEDIATE == m_run_mode ) {
+				throw create_basic_exception( ErrorTypes::SYNTAX, "Attempt to END from outside a program" );
+			}
+			m_exiting = true;
+			return true;
+		}
+
+		bool Basic::keyword_rem( StatementTokens ) {
+			// truly do nothing
+			return true;
+		}
+
+		bool Basic::keyword_list( StatementTokens ) {
+			for( auto const &current_line : m_program ) {
+				if( 0 <= current_line.number ) {
+					std::cout << current_line.number << "	" << current_line.text << "\n";
+				}
+			}
+			std::cout << std::endl;
+			return true;
+		}
+
+		bool Basic::keyword_run( StatementTokens params ) {
+			integer line_number = -1;
+			if( 1 == params.size( ) && TokenType::INTEGER == params[0].type ) {
+				line_number = static_cast<integer>( params[0].value );
+			}
+			if( !m_basic || 0 <= line_number ) {
+				m_basic.reset( new Basic( ) );
+			}
+			m_basic->m_run_mode = RunMode::DEFERRED;
+			m_basic->m_execution_mode = m_execution_mode;
+			m_basic->m_dispatch_mode = m_dispatch_mode;
+			m_basic->m_optimize = m_optimize;
+			m_basic->m_short_circuit = m_short_circuit;
+			m_basic->m_tier.threshold = m_tier.threshold;
+			m_basic->m_jit.enabled = m_jit.enabled;
+			m_basic->m_jit.threshold = m_jit.threshold;
+			m_basic->m_symbols = m_symbols;
+			m_basic->m_symbol_ids = m_symbol_ids;
+			m_basic->m_keywords = m_keywords; // Crunched lines refer to what was added
+			m_basic->m_binary_operators = m_binary_operators;
+			m_basic->m_functions = m_functions;
+			m_basic->m_constants = m_constants;
+			m_basic->m_variables.resize( m_symbols.size( ) );
+			m_basic->m_program = m_program;
+			m_basic->invalidate_expressions( );
+			return m_basic->run( line_number );
+		}
+
+		bool Basic::keyword_vars( StatementTokens ) {
+			std::cout << "Constants:\n" << list_constants( ) << "\n";
+			std::cout << "\nVariables:\n" << list_variables( ) << "\n";
+			return true;
+		}
+
+		bool Basic::keyword_functions( StatementTokens ) {
+			std::cout << list_functions( ) << std::endl;
+			return true;
+		}
+
+		bool Basic::keyword_keywords( StatementTokens ) {
+			std::cout << list_keywords( ) << std::endl;
+			return true;
+		}
+
+		bool Basic::keyword_then( StatementTokens ) {
+			throw create_basic_exception( ErrorTypes::SYNTAX, "THEN is invalid without a preceeding IF and condition" );
+		}
+
+		bool Basic::keyword_if( StatementTokens params ) {
+			// IF <CONDITION> THEN <statement>
+			// IF <CONDITION> THEN <line_number>
+			// IF <CONDITION> GOTO <line_number>
+
+			auto const clause = find_if_clause( params );
+			if( params.size( ) == clause ) {
+				throw create_basic_exception( ErrorTypes::SYNTAX, "Unable to find end of condition in IF keyword" );
+			}
+			auto action = params.sub_range( clause + 1 );
+			if( is_loop_statement( action ) ) {
+				throw create_basic_exception( ErrorTypes::SYNTAX, "FOR and NEXT cannot follow THEN" );
+			}
+			if( to_boolean( evaluate( params.sub_range( 0, clause ) ) ) ) {
+				if( is_keyword_token( params[clause], Keyword::GOTO ) ||
+				    ( 1 == action.size( ) && TokenType::INTEGER == action[0].type ) ) {
+					return keyword_goto( action );
+				}
+				return execute_statement( action );
+			}
+			// Do nothing
+			return true;
+		}
+
+		bool Basic::keyword_for( StatementTokens params ) {
+			if( RunMode::IMMEDIATE == m_run_mode ) {
+				throw create_basic_exception( ErrorTypes::SYNTAX, "Attempt to FOR from outside a program" );
+			}
+			auto const parts = parse_for_loop( params );
+			auto const start = evaluate( parts.start );
+			auto const limit = evaluate( parts.limit );
+			auto const step = parts.step.empty( ) ? basic_value_integer( 1 ) : evaluate( parts.step );
+
+			LoopStackType::ForLoop loop{};
+			loop.variable = parts.variable;
+			if( params.last + 1 < params.line->tokens.size( ) ) {
+				loop.body_line = m_program_it;
+				loop.body_token = params.last + 1;
+			} else {
+				loop.body_line = m_program_it + 1;
+				loop.body_token = 0;
+			}
+			if( !enter_loop( loop, start, limit, step ) ) {
+				auto const line = static_cast<size_t>( std::distance( std::begin( m_program ), m_program_it ) );
+				auto const &exit = m_loop_stack.exit( LoopStackType::key( line, params.first - 1 ) );
+				m_program_it = std::begin( m_program ) + static_cast<std::ptrdiff_t>( exit.line ) - 1;
+				m_resume_token = exit.token;
+				m_jumped = true;
+			}
+			return true;
+		}
+
+		bool Basic::keyword_next( StatementTokens params ) {
+			if( RunMode::IMMEDIATE == m_run_mode ) {
+				throw create_basic_exception( ErrorTypes::SYNTAX, "Attempt to NEXT from outside a program" );
+			}
+			auto loop = params.empty( ) ? m_loop_stack.peek( ) : m_loop_stack.find( params[0].value );
+			// A loop started by compiled code has no line to continue from
+			if( nullptr == loop || std::end( m_program ) == loop->body_line ) {
+				throw create_basic_exception( ErrorTypes::SYNTAX, "NEXT without FOR" );
+			}
+			if( !next_iteration( *loop ) ) {
+				m_loop_stack.pop( );
+				return true;
+			}
+			m_program_it = loop->body_line - 1;
+			m_resume_token = loop->body_token;
+			m_jumped = true;
+			return true;
+		}
+
+		bool Basic::keyword_step( StatementTokens ) {
+			throw create_basic_exception( ErrorTypes::SYNTAX, "STEP is invalid outside of a FOR" );
+		}
+
+		bool Basic::keyword_to( StatementTokens ) {
+			throw create_basic_exception( ErrorTypes::SYNTAX, "TO is invalid outside of a FOR" );
+		}
+
+		//////////////////////////////////////////////////////////////////////////
+		/// summary: Start a FOR loop by storing start in its counter.  Returns
+		/// false, without pushing the loop, when the body should not run at all
+		bool Basic::enter_loop( LoopStackType::ForLoop loop, BasicValue const &start, BasicValue const &limit,
+		                        BasicValue const &step ) {
+			if( !is_numeric( start ) || !is_numeric( limit ) || !is_numeric( step ) ) {
+				throw create_basic_exception( ErrorTypes::SYNTAX, "The start, limit and step of FOR must be numbers" );
+			}
+			auto &counter = m_variables[loop.variable];
+			loop.is_integer = is_integer( start ) && is_integer( limit ) && is_integer( step );
+			loop.real_limit = to_numeric( limit );
+			loop.real_step = to_numeric( step );
+			bool runs = false;
+			if( loop.is_integer ) {
+				loop.integer_limit = limit.integer_value( );
+				loop.integer_step = step.integer_value( );
+				counter.value = start;
+				runs = 0 <= loop.integer_step ? start.integer_value( ) <= loop.integer_limit
+				                              : start.integer_value( ) >= loop.integer_limit;
+			} else {
+				auto const value = to_numeric( start );
+				counter.value = basic_value_real( value );
+				runs = 0 <= loop.real_step ? value <= loop.real_limit : value >= loop.real_limit;
+			}
+			counter.is_set = true;
+			if( runs ) {
+				m_loop_stack.push( loop );
+			}
+			return runs;
+		}
+
+		//////////////////////////////////////////////////////////////////////////
+		/// summary: Step the counter of loop.  Returns true while the body should
+		/// run again.  A counter the body made real is stepped as a real
+		bool Basic::next_iteration( LoopStackType::ForLoop const &loop ) {
+			auto &counter = m_variables[loop.variable];
+			if( !counter.is_set ) {
+				throw create_basic_exception( ErrorTypes::SYNTAX,
+				                              "Counter '" + m_symbols[loop.variable] + "' of FOR was cleared" );
+			}
+			if( loop.is_integer && ValueType::INTEGER == counter.value.type( ) ) {
+				auto const value = static_cast<int64_t>( counter.value.integer_value( ) ) + loop.integer_step;
+				if( can_fit<integer>( value ) ) {
+					counter.value = basic_value_integer( static_cast<integer>( value ) );
+				} else {
+					counter.value = basic_value_real( static_cast<real>( value ) );
+				}
+				return 0 <= loop.integer_step ? value <= loop.integer_limit : value >= loop.integer_limit;
+			}
+			auto const value = to_numeric( counter.value ) + loop.real_step;
+			counter.value = basic_value_real( value );
+			return 0 <= loop.real_step ? value <= loop.real_limit : value >= loop.real_limit;
+		}
+
+		//////////////////////////////////////////////////////////////////////////
+		/// summary: Match every FOR of the program with its NEXT and remember
+		/// where to continue when the loop does not run.  Loops nest by position
+		/// in the program, a NEXT closes the innermost FOR that is still open
+		void Basic::resolve_loops( ) {
+			struct OpenLoop {
+				uint32_t variable;
+				uint64_t key;
+				ProgramType::iterator line;
+			};
+			std::vector<OpenLoop> open_loops;
+			m_loop_stack.clear( );
+			m_tier.loops.clear( );
+			for( auto it = first_line( ); it != std::end( m_program ); ++it ) {
+				if( 0 > it->number ) {
+					continue;
+				}
+				m_program_it = it;
+				auto const line = static_cast<size_t>( std::distance( std::begin( m_program ), it ) );
+				for( size_t first = 0; first < it->tokens.size( ); ) {
+					auto const last = find_end_of_statement( *it, first );
+					StatementTokens const statement{&*it, first, last};
+					if( is_keyword_token( statement[0], Keyword::FOR ) ) {
+						open_loops.push_back( {parse_for_loop( statement.sub_range( 1 ) ).variable,
+						                       LoopStackType::key( line, first ), it} );
+					} else if( is_keyword_token( statement[0], Keyword::NEXT ) ) {
+						if( open_loops.empty( ) ) {
+							throw create_basic_exception( ErrorTypes::SYNTAX, "NEXT without FOR" );
+						}
+						auto const loop = pop( open_loops );
+						if( 1 < statement.size( ) &&
+						    ( 2 < statement.size( ) || TokenType::IDENTIFIER != statement[1].type ||
+						      loop.variable != statement[1].value ) ) {
+							throw create_basic_exception( ErrorTypes::SYNTAX, "NEXT does not match FOR " +
+							                                                    m_symbols[loop.variable] + " on line " +
+							                                                    std::to_string( loop.line->number ) );
+						}
+						m_tier.loops.emplace_back( static_cast<size_t>( std::distance( std::begin( m_program ), loop.line ) ),
+						                           line );
+						if( last + 1 < it->tokens.size( ) ) {
+							m_loop_stack.add_exit( loop.key, {line, last + 1} );
+						} else {
+							m_loop_stack.add_exit( loop.key, {line + 1, 0} );
+						}
+					}
+					first = last + 1;
+				}
+			}
+			if( !open_loops.empty( ) ) {
+				m_program_it = open_loops.back( ).line;
+				throw create_basic_exception( ErrorTypes::SYNTAX, "FOR without NEXT" );
+			}
+			m_program_it = std::end( m_program );
+		}
+
+		//////////////////////////////////////////////////////////////////////////
+		/// summary: Run a built in keyword.  The switch compiles to a jump table
+		/// so dispatch does not hash or go through std::function
+		bool Basic::execute_keyword( Keyword keyword, StatementTokens params ) {
+			switch( keyword ) {
+			case Keyword::CLR:
+				return keyword_clr( params );
+			case Keyword::CONT:
+				return keyword_cont( params );
+			case Keyword::DELETE:
+				return keyword_delete( params );
+			case Keyword::DIM:
+				return keyword_dim( params );
+			case Keyword::END:
+				return keyword_end( params );
+			case Keyword::EXIT:
+				return keyword_exit( params );
+			case Keyword::FOR:
+				return keyword_for( params );
+			case Keyword::FUNCTIONS:
+				return keyword_functions( params );
+			case Keyword::GOSUB:
+				return keyword_gosub( params );
+			case Keyword::GOTO:
+				return keyword_goto( params );
+			case Keyword::IF:
+				return keyword_if( params );
+			case Keyword::KEYWORDS:
+				return keyword_keywords( params );
+			case Keyword::LET:
+				return keyword_let( params );
+			case Keyword::LIST:
+				return keyword_list( params );
+			case Keyword::MAT:
+				return keyword_mat( params );
+			case Keyword::NEW:
+				return keyword_new( params );
+			case Keyword::NEXT:
+				return keyword_next( params );
+			case Keyword::PRINT:
+				return keyword_print( params );
+			case Keyword::QUIT:
+				return keyword_quit( params );
+			case Keyword::REM:
+				return keyword_rem( params );
+			case Keyword::RETURN:
+				return keyword_return( params );
+			case Keyword::RUN:
+				return keyword_run( params );
+			case Keyword::SORT:
+				return keyword_sort( params );
+			case Keyword::STEP:
+				return keyword_step( params );
+			case Keyword::STOP:
+				return keyword_stop( params );
+			case Keyword::THEN:
+				return keyword_then( params );
+			case Keyword::TO:
+				return keyword_to( params );
+			case Keyword::VARS:
+				return keyword_vars( params );
+			}
+			throw create_basic_exception( ErrorTypes::FATAL, "Unknown keyword" );
+		}
+
+		void Basic::set_program_it( integer line_number, integer offset ) {
+			auto line_it = find_line( line_number );
+			if( std::end( m_program ) == line_it ) {
+				throw create_basic_exception( ErrorTypes::SYNTAX, "Attempt to jump to an invalid line" );
+			}
+			m_program_it = line_it + offset;
+			m_jumped = true;
+		}
+
+		bool Basic::continue_run( ) {
+			auto next_line = m_program_it + 1;
+			if( std::end( m_program ) == next_line ) {
+				throw create_basic_exception( ErrorTypes::SYNTAX, "Cannot continue.  End of program reached" );
+			}
+			return run( next_line->number );
+		}
+
+		ProgramType::iterator Basic::first_line( ) {
+			return std::begin( m_program ) + 1;
+		}
+
+		bool Basic::run( integer line_number ) {
+			m_has_syntax_error = false;
+			if( ExecutionMode::COMPILED == m_execution_mode ) {
+				return run_compiled( line_number );
+			}
+			try {
+				resolve_loops( );
+			} catch( BasicException const &se ) {
+				std::cerr << std::endl << se.what( ) << std::endl;
+				if( ErrorTypes::FATAL == se.error_type ) {
+					return false;
+				}
+				if( std::end( m_program ) != m_program_it ) {
+					std::cerr << "Error was on line " << m_program_it->number << std::endl;
+				}
+				return true;
+			}
+			if( 0 <= line_number ) {
+				set_program_it( line_number );
+			} else {
+				m_program_it = first_line( );
+			}
+			m_resume_token = 0;
+			auto const tiered = ExecutionMode::TIERED == m_execution_mode;
+			if( tiered ) {
+				m_compiled.clear( );
+				m_jit.clear( );
+				m_tier.counts.assign( m_program.size( ), 0 );
+				m_tier.failed.assign( m_program.size( ), false );
+				m_tier.transitions.clear( );
+				m_tier.exited = false;
+			}
+			while( m_program_it != std::end( m_program ) ) {
+				if( 0 <= m_program_it->number ) {
+					// Compiled expressions already know their line so this must not
+					// invalidate them like add_constant does.  Only the value is
+					// assigned so that running a line does not allocate
+					auto &current_line = m_constants["CURRENT_LINE"];
+					if( current_line.description.empty( ) ) {
+						current_line.description = "Current Line of program execution";
+					}
+					current_line.value = basic_value_integer( m_program_it->number );
+					auto const first_token = m_resume_token;
+					m_resume_token = 0;
+					auto const pc = tiered ? tier_up( first_token ) : npos;
+					if( npos != pc ) {
+						// Compiled code either finishes the program or leaves m_program_it
+						// at the statement the interpreter continues from
+						bool result = true;
+						try {
+							result = execute( pc );
+						} catch( ... ) {
+							return report_run_error( );
+						}
+						if( !result || !m_tier.exited ) {
+							return result;
+						}
+						m_tier.exited = false;
+						continue;
+					}
+					if( !execute_line( *m_program_it, true, first_token ) ) {
+						return false;
+					}
+					if( m_has_syntax_error ) {
+						std::cerr << "Error was on line " << m_program_it->number << std::endl;
+						m_has_syntax_error = false;
+						break;
+					}
+					if( m_exiting ) {
+						m_exiting = false;
+						break;
+					}
+				}
+				++m_program_it;
+			}
+			return true;
+		}
+
+		Basic::Basic( )
+		  : m_basic{nullptr}
+		  , m_execution_mode( ExecutionMode::COMPILED )
+		  , m_dispatch_mode( default_dispatch_mode )
+		  , m_optimize( true )
+		  , m_short_circuit( false )
+		  , m_tier{default_tier_threshold, {}, {}, {}, {}, false}
+		  , m_jit{false, default_jit_threshold, {}, {}, {}}
+		  , m_program_it( std::end( m_program ) )
+		  , m_run_mode( RunMode::IMMEDIATE )
+		  , m_exiting( false )
+		  , m_jumped( false )
+		  , m_has_syntax_error( false )
+		  , m_resume_token( 0 ) {
+			init( );
+		}
+
+		std::vector<std::string> Basic::split( std::string text, char delimiter ) {
+			std::string str_delimeter( " " );
+			str_delimeter[0] = delimiter;
+			return split( text, str_delimeter );
+		}
+
+		std::vector<std::string> Basic::split( std::string text, std::string delimiter ) {
+			std::vector<std::string> tokens;
+			size_t pos = 0;
+			std::string token;
+
+			while( std::string::npos != ( pos = text.find( delimiter ) ) ) {
+				token = text.substr( 0, pos );
+				tokens.push_back( token );
+				text.erase( 0, pos + delimiter.length( ) );
+			}
+			tokens.push_back( text );
+
+			return tokens;
+		}
+
+		Basic::Basic( std::string program_code )
+		  : m_basic( nullptr )
+		  , m_execution_mode( ExecutionMode::COMPILED )
+		  , m_dispatch_mode( default_dispatch_mode )
+		  , m_optimize( true )
+		  , m_short_circuit( false )
+		  , m_tier{default_tier_threshold, {}, {}, {}, {}, false}
+		  , m_jit{false, default_jit_threshold, {}, {}, {}}
+		  , m_program_it( std::end( m_program ) )
+		  , m_run_mode( RunMode::IMMEDIATE )
+		  , m_exiting( false )
+		  , m_jumped( false )
+		  , m_has_syntax_error( false )
+		  , m_resume_token( 0 ) {
+			init( );
+			for( auto current_line : split( program_code, '\n' ) ) {
+				parse_line( current_line );
+			}
+		}
+
+		BasicException Basic::create_basic_exception( ErrorTypes error_type, std::string msg ) {
+			switch( error_type ) {
+			case ErrorTypes::SYNTAX:
+				msg = "SYNTAX ERROR: " + msg;
+				if( RunMode::DEFERRED == m_run_mode && std::end( m_program ) != m_program_it ) {
+					msg += "\nError on line " + std::to_string( m_program_it->number );
+				}
+				return BasicException( std::move( msg ), std::move( error_type ) );
+			case ErrorTypes::FATAL:
+				msg = "FATAL ERROR: " + msg;
+				if( RunMode::DEFERRED == m_run_mode && std::end( m_program ) != m_program_it ) {
+					msg += "\nError on line " + std::to_string( m_program_it->number );
+				}
+				return BasicException( std::move( msg ), std::move( error_type ) );
+			}
+			throw std::runtime_error( "Unknown error type tried to be thrown" );
+		}
+
+		bool Basic::parse_line( boost::string_ref parse_string, bool show_ready ) {
+			m_exiting = false;
+			parse_string = trim( parse_string );
+			if( parse_string.empty( ) ) {
+				return true;
+			}
+			ProgramLine line;
+			try {
+				auto const number_end = static_cast<size_t>(
+				  std::distance( parse_string.begin( ), std::find_if_not( parse_string.begin( ), parse_string.end( ), is_digit ) ) );
+				if( 0 < number_end ) {
+					auto const line_number = to_integer( parse_string.substr( 0, number_end ) );
+					auto const line_text = trim( parse_string.substr( number_end ) );
+					if( !line_text.empty( ) ) {
+						add_line( line_number, line_text );
+					} else {
+						remove_line( line_number );
+					}
+					return true;
+				}
+				line = crunch( -1, parse_string );
+			} catch( BasicException const &se ) {
+				std::cerr << std::endl << se.what( ) << std::endl;
+				if( show_ready ) {
+					std::cout << "\nREADY" << std::endl;
+				}
+				return ErrorTypes::FATAL != se.error_type;
+			} catch( boost::bad_lexical_cast const & ) {
+				std::cerr << std::endl << "SYNTAX ERROR: Line number is out of range" << std::endl;
+				return true;
+			}
+			return execute_line( line, show_ready );
+		}
+
+		bool Basic::execute_line( ProgramLine const &line, bool show_ready, size_t first_token ) {
+			m_jumped = false;
+			try {
+				size_t first = first_token;
+				while( first < line.tokens.size( ) ) {
+					auto const last = find_end_of_statement( line, first );
+					auto const result = execute_statement( StatementTokens{&line, first, last} );
+					if( m_exiting ) {
+						return m_run_mode != RunMode::IMMEDIATE;
+					}
+					if( !result ) {
+						return result;
+					}
+					if( m_jumped ) {
+						// Rest of line is skipped when control moved to another line
+						break;
+					}
+					first = last + 1;
+				}
+				if( show_ready && RunMode::IMMEDIATE == m_run_mode ) {
+					std::cout << "\nREADY" << std::endl;
+				}
+			} catch( BasicException const &se ) {
+				std::cerr << std::endl << se.what( ) << std::endl;
+				switch( se.error_type ) {
+				case ErrorTypes::SYNTAX: {
+					if( show_ready ) {
+						std::cout << "\nREADY" << std::endl;
+					}
+					m_has_syntax_error = true;
+				}
+					return true;
+				case ErrorTypes::FATAL:
+					return false;
+				}
+			} catch( std::exception const &ex ) {
+				std::cerr << std::endl << "UNKNOWN ERROR: while parsing: " << ex.what( ) << std::endl;
+				if( RunMode::DEFERRED == m_run_mode ) {
+					std::cerr << "ERROR on line " << m_program_it->number << std::endl;
+				}
+				return false;
+			}
+			return true;
+		}
+
+		bool Basic::execute_statement( StatementTokens statement ) {
+			if( statement.empty( ) ) {
+				return true;
+			}
+			switch( statement[0].type ) {
+			case TokenType::KEYWORD:
+				return execute_keyword( static_cast<Keyword>( statement[0].value ), statement.sub_range( 1 ) );
+			case TokenType::USER_KEYWORD:
+				return m_keywords[m_symbols[statement[0].value]]( statement.sub_range( 1 ) );
+			default:
+				// Try assignment if there is no keyword
+				return let_helper( statement );
+			}
+		}
+
+		uint32_t Basic::intern( boost::string_ref name ) {
+			auto key = to_upper( name );
+			auto pos = m_symbol_ids.find( key );
+			if( std::end( m_symbol_ids ) != pos ) {
+				return pos->second;
+			}
+			auto const id = static_cast<uint32_t>( m_symbols.size( ) );
+			m_symbols.push_back( key );
+			m_symbol_ids.emplace( std::move( key ), id );
+			m_variables.resize( m_symbols.size( ) );
+			return id;
+		}
+
+		//////////////////////////////////////////////////////////////////////////
+		/// summary: Tokenize a line the way classic BASICs crunched lines.  Names
+		/// are interned and numbers parsed so nothing rescans the text when the
+		/// line runs.  REM ends tokenizing as the rest of the line is a remark
+		ProgramLine Basic::crunch( integer line_number, boost::string_ref text ) {
+			ProgramLine result( line_number, trim( text ).to_string( ) );
+			boost::string_ref const value( result.text );
+			if( std::numeric_limits<uint16_t>::max( ) < value.size( ) ) {
+				throw create_basic_exception( ErrorTypes::SYNTAX, "Line is too long" );
+			}
+			auto add_literal = [&result]( BasicValue literal ) {
+				result.literals.push_back( std::move( literal ) );
+				return static_cast<uint32_t>( result.literals.size( ) - 1 );
+			};
+
+			size_t pos = 0;
+			while( true ) {
+				while( pos < value.size( ) && std::isspace( static_cast<unsigned char>( value[pos] ) ) ) {
+					++pos;
+				}
+				if( pos >= value.size( ) ) {
+					break;
+				}
+				auto const current_char = value[pos];
+				Token token{TokenType::OPERATOR, static_cast<uint16_t>( pos ), 0};
+				size_t len = 1;
+				if( '"' == current_char ) {
+					len = find_end_of_string( value.substr( pos ) ) + 1;
+					auto str = remove_outer_quotes( value.substr( pos, len ) ).to_string( );
+					replace_all( str, "\\\"", "\"" );
+					token.type = TokenType::LITERAL;
+					token.value = add_literal( basic_value_string( str ) );
+				} else if( is_digit( current_char ) ||
+				           ( '.' == current_char && pos + 1 < value.size( ) && is_digit( value[pos + 1] ) ) ) {
+					while( pos + len < value.size( ) && ( is_digit( value[pos + len] ) || '.' == value[pos + len] ) ) {
+						++len;
+					}
+					auto const number = value.substr( pos, len );
+					switch( get_value_type( number ) ) {
+					case ValueType::INTEGER:
+						try {
+							token.type = TokenType::INTEGER;
+							token.value = static_cast<uint32_t>( to_integer( number ) );
+						} catch( boost::bad_lexical_cast const & ) {
+							// Too large for an integer
+							token.type = TokenType::LITERAL;
+							token.value = add_literal( basic_value_real( number ) );
+						}
+						break;
+					case ValueType::REAL:
+						token.type = TokenType::LITERAL;
+						token.value = add_literal( basic_value_real( number ) );
+						break;
+					case ValueType::ARRAY:
+					case ValueType::BOOLEAN:
+					case ValueType::EMPTY:
+					case ValueType::STRING:
+						throw create_basic_exception( ErrorTypes::SYNTAX, "Unknown symbol '" + number.to_string( ) + "'" );
+					default:
+						throw std::exception{};
+					}
+				} else if( is_identifier_start( current_char ) ) {
+					len = find_end_of_identifier( value.substr( pos ) );
+					auto const name = to_upper( value.substr( pos, len ) );
+					Keyword keyword = Keyword::REM;
+					if( "AND" == name ) {
+						token.value = static_cast<uint32_t>( Operator::AND );
+					} else if( "OR" == name ) {
+						token.value = static_cast<uint32_t>( Operator::OR );
+					} else if( keywords::find( name.data( ), name.size( ), keyword ) ) {
+						token.type = TokenType::KEYWORD;
+						token.value = static_cast<uint32_t>( keyword );
+						if( Keyword::REM == keyword ) {
+							result.tokens.push_back( token );
+							break;
+						}
+					} else if( key_exists( m_keywords, name ) ) {
+						token.type = TokenType::USER_KEYWORD;
+						token.value = intern( name );
+					} else if( key_exists( m_binary_operators, name ) ) {
+						token.type = TokenType::USER_OPERATOR;
+						token.value = intern( name );
+					} else {
+						token.type = TokenType::IDENTIFIER;
+						token.value = intern( name );
+					}
+				} else {
+					auto const next_char = pos + 1 < value.size( ) ? value[pos + 1] : '\0';
+					switch( current_char ) {
+					case '(':
+						token.type = TokenType::OPEN_BRACKET;
+						break;
+					case ')':
+						token.type = TokenType::CLOSE_BRACKET;
+						break;
+					case ',':
+						token.type = TokenType::COMMA;
+						break;
+					case ':':
+						token.type = TokenType::COLON;
+						break;
+					case '^':
+						token.value = static_cast<uint32_t>( Operator::POWER );
+						break;
+					case '*':
+						token.value = static_cast<uint32_t>( Operator::MULTIPLY );
+						break;
+					case '/':
+						token.value = static_cast<uint32_t>( Operator::DIVIDE );
+						break;
+					case '%':
+						token.value = static_cast<uint32_t>( Operator::MODULO );
+						break;
+					case '+':
+						token.value = static_cast<uint32_t>( Operator::ADD );
+						break;
+					case '-':
+						token.value = static_cast<uint32_t>( Operator::SUBTRACT );
+						break;
+					case '=':
+						token.value = static_cast<uint32_t>( Operator::EQUAL );
+						break;
+					case '<':
+						if( '=' == next_char ) {
+							len = 2;
+							token.value = static_cast<uint32_t>( Operator::LESS_EQUAL );
+						} else {
+							token.value = static_cast<uint32_t>( Operator::LESS );
+						}
+						break;
+					case '>':
+						if( '=' == next_char ) {
+							len = 2;
+							token.value = static_cast<uint32_t>( Operator::GREATER_EQUAL );
+						} else {
+							token.value = static_cast<uint32_t>( Operator::GREATER );
+						}
+						break;
+					default:
+						throw create_basic_exception( ErrorTypes::SYNTAX,
+						                              "Unexpected character '" + char_to_string( current_char ) + "'" );
+					}
+				}
+				result.tokens.push_back( token );
+				pos += len;
+			}
+			return result;
+		}
+
+		//////////////////////////////////////////////////////////////////////////
+		// Basic::Compiler
+		//////////////////////////////////////////////////////////////////////////
+		void Basic::CompiledProgram::clear( ) {
+			code.clear( );
+			constants.clear( );
+			names.clear( );
+			functions.clear( );
+			binary_operators.clear( );
+			keywords.clear( );
+			parameters.clear( );
+			line_starts.clear( );
+			statement_starts.clear( );
+			exit_stubs.clear( );
+			open_loops.clear( );
+			variable_types.clear( );
+			hoisted.clear( );
+		}
+
+		int32_t Basic::CompiledProgram::add_constant( BasicValue value ) {
+			constants.push_back( std::move( value ) );
+			return static_cast<int32_t>( constants.size( ) - 1 );
+		}
+
+		int32_t Basic::CompiledProgram::add_name( std::string name ) {
+			auto pos = std::find( std::begin( names ), std::end( names ), name );
+			if( std::end( names ) == pos ) {
+				names.push_back( std::move( name ) );
+				return static_cast<int32_t>( names.size( ) - 1 );
+			}
+			return static_cast<int32_t>( std::distance( std::begin( names ), pos ) );
+		}
+
+		void Basic::CompiledProgram::emit( bytecode::OpCode op, int32_t a, int32_t b ) {
+			code.push_back( bytecode::Instruction{op, a, b} );
+		}
+
+		//////////////////////////////////////////////////////////////////////////
+		/// summary: Compiles one statement of a program line into program.
+		/// Expressions are compiled by precedence climbing.  Operators with a
+		/// lower rank bind tighter
+		struct Basic::Compiler {
+			Basic &basic;
+			CompiledProgram &program;
+			integer line_number;
+			StatementTokens tokens;
+			size_t pos;
+
+			Compiler( Basic &b, CompiledProgram &target, integer current_line )
+			  : basic( b ), program( target ), line_number( current_line ), tokens{nullptr, 0, 0}, pos( 0 ) {}
+
+			BasicException syntax_error( std::string msg ) {
+				return basic.create_basic_exception( ErrorTypes::SYNTAX, std::move( msg ) );
+			}
+
+			void reset( StatementTokens statement ) {
+				tokens = statement;
+				pos = 0;
+			}
+
+			bool at_end( ) const {
+				return pos >= tokens.size( );
+			}
+
+			bool is_type( TokenType type ) const {
+				return !at_end( ) && type == tokens[pos].type;
+			}
+
+			bool is_operator( Operator oper ) const {
+				return is_type( TokenType::OPERATOR ) && static_cast<uint32_t>( oper ) == tokens[pos].value;
+			}
+
+			void expect( TokenType type, char const *what ) {
+				if( !is_type( type ) ) {
+					throw syntax_error( std::string( "Expected " ) + what );
+				}
+				++pos;
+			}
+
+			void expect_end( ) {
+				if( !at_end( ) ) {
+					throw syntax_error( "Unexpected '" + token_text( tokens, pos ) + "'" );
+				}
+			}
+
+			void emit( bytecode::OpCode op, int32_t a = 0, int32_t b = 0 ) {
+				program.emit( op, a, b );
+			}
+
+			BinaryOperatorType const &user_operator( Token const &token ) const {
+				auto oper = basic.m_binary_operators.find( basic.m_symbols[token.value] );
+				if( std::end( basic.m_binary_operators ) == oper ) {
+					throw basic.create_basic_exception( ErrorTypes::FATAL,
+					                                    "Unknown operator " + basic.m_symbols[token.value] );
+				}
+				return oper->second;
+			}
+
+			// 0 when there is no binary operator at pos
+			int binary_precedence( ) const {
+				if( is_type( TokenType::OPERATOR ) ) {
+					return operators::info( static_cast<Operator>( tokens[pos].value ) ).precedence;
+				} else if( is_type( TokenType::USER_OPERATOR ) ) {
+					return user_operator( tokens[pos] ).precedence;
+				}
+				return 0;
+			}
+
+			void emit_binary_operator( Token const &token ) {
+				if( TokenType::USER_OPERATOR == token.type ) {
+					emit( bytecode::OpCode::USER_OPERATOR,
+					      add_handler( program.binary_operators, &user_operator( token ).func ) );
+					return;
+				}
+				auto const oper = static_cast<Operator>( token.value );
+				if( !basic.m_optimize ||
+				    !fold( 2, [oper]( std::vector<BasicValue> operands ) {
+					    return apply_operator( oper, operands[0], operands[1] );
+				    } ) ) {
+					emit( bytecode::OpCode::BINARY_OPERATOR, static_cast<int32_t>( oper ) );
+				}
+			}
+
+			void emit_unary_operator( Operator oper ) {
+				if( !basic.m_optimize ||
+				    !fold( 1, [oper]( std::vector<BasicValue> operands ) { return apply_operator( oper, operands[0] ); } ) ) {
+					emit( bytecode::OpCode::UNARY_OPERATOR, static_cast<int32_t>( oper ) );
+				}
+			}
+
+			void emit_call( FunctionType const *function, int32_t count ) {
+				if( !basic.m_optimize || !function->pure || !fold( count, function->func ) ) {
+					emit( bytecode::OpCode::CALL_FUNCTION, add_handler( program.functions, function ), count );
+				}
+			}
+
+			//////////////////////////////////////////////////////////////////////////
+			/// Optimizing.  Operands that are constants are the last instructions
+			/// emitted, one PUSH_CONSTANT each, as anything else ends with the
+			/// instruction that computes it
+
+			// The constant pushed by code[pc], nullptr when it pushes something else
+			BasicValue const *constant_at( size_t pc ) const {
+				auto const &instruction = program.code[pc];
+				if( bytecode::OpCode::PUSH_CONSTANT != instruction.op ) {
+					return nullptr;
+				}
+				return &program.constants[static_cast<size_t>( instruction.a )];
+			}
+
+			// Replace the last count constants with what apply gives for them.  Returns
+			// false, leaving the code alone, when an operand is not constant or apply
+			// fails so that the error is raised when the program runs
+			template<typename Apply>
+			bool fold( int32_t count, Apply apply ) {
+				auto &code = program.code;
+				auto const operands = static_cast<size_t>( count );
+				if( code.size( ) < operands ) {
+					return false;
+				}
+				std::vector<BasicValue> values;
+				for( auto pc = code.size( ) - operands; pc != code.size( ); ++pc ) {
+					auto const constant = constant_at( pc );
+					if( nullptr == constant ) {
+						return false;
+					}
+					values.push_back( *constant );
+				}
+				BasicValue result;
+				try {
+					result = apply( std::move( values ) );
+				} catch( std::exception const & ) {
+					return false;
+				}
+				code.erase( std::end( code ) - count, std::end( code ) );
+				emit( bytecode::OpCode::PUSH_CONSTANT, program.add_constant( std::move( result ) ) );
+				return true;
+			}
+
+			// AND and OR skip their right operand in short circuit mode
+			bool is_short_circuit( Token const &token ) const {
+				return basic.m_short_circuit && TokenType::OPERATOR == token.type &&
+				       ( static_cast<uint32_t>( Operator::AND ) == token.value ||
+				         static_cast<uint32_t>( Operator::OR ) == token.value );
+			}
+
+			void expression( int precedence = operators::lowest_precedence ) {
+				if( operators::unary_precedence == precedence ) {
+					unary( );
+					return;
+				}
+				expression( precedence - 1 );
+				while( precedence == binary_precedence( ) ) {
+					auto const &token = tokens[pos++];
+					if( is_short_circuit( token ) ) {
+						auto const jump = program.code.size( );
+						emit( bytecode::OpCode::SHORT_CIRCUIT, 0, static_cast<int32_t>( token.value ) );
+						expression( precedence - 1 );
+						emit( bytecode::OpCode::TO_BOOLEAN );
+						program.code[jump].a = static_cast<int32_t>( program.code.size( ) );
+						continue;
+					}
+					if( TokenType::OPERATOR == token.type &&
+					    Associativity::RIGHT == operators::info( static_cast<Operator>( token.value ) ).associativity ) {
+						expression( precedence );
+					} else {
+						expression( precedence - 1 );
+					}
+					emit_binary_operator( token );
+				}
+			}
+
+			void unary( ) {
+				if( is_operator( Operator::SUBTRACT ) ) {
+					++pos;
+					unary( );
+					emit_unary_operator( Operator::NEGATE );
+					return;
+				}
+				primary( );
+			}
+
+			// When arrays is set, names alone are passed as references to arrays
+			int32_t arguments( bool arrays = false ) {
+				int32_t count = 0;
+				if( is_type( TokenType::CLOSE_BRACKET ) ) {
+					++pos;
+					return count;
+				}
+				while( true ) {
+					if( !arrays || !array_argument( ) ) {
+						expression( );
+					}
+					++count;
+					if( !is_type( TokenType::COMMA ) ) {
+						break;
+					}
+					++pos;
+				}
+				expect( TokenType::CLOSE_BRACKET, "closing bracket )" );
+				return count;
+			}
+
+			// A name other than a constant followed by , or ), like A in SUM( A ).
+			// % right after the name is part of it as in DIM
+			bool array_argument( ) {
+				if( !is_type( TokenType::IDENTIFIER ) ) {
+					return false;
+				}
+				auto const &token = tokens[pos];
+				auto name = basic.m_symbols[token.value];
+				if( nullptr != basic.find_constant( name ) ) {
+					return false;
+				}
+				auto next = pos + 1;
+				if( next < tokens.size( ) && is_operator_token( tokens[next], Operator::MODULO ) &&
+				    token.position + name.size( ) == tokens[next].position ) {
+					name += '%';
+					++next;
+				}
+				if( next >= tokens.size( ) ||
+				    ( TokenType::COMMA != tokens[next].type && TokenType::CLOSE_BRACKET != tokens[next].type ) ) {
+					return false;
+				}
+				emit( bytecode::OpCode::LOAD_ARRAY, program.add_name( std::move( name ) ), 0 );
+				pos = next;
+				return true;
+			}
+
+			void primary( ) {
+				if( at_end( ) ) {
+					throw syntax_error( "Expected a value" );
+				}
+				auto const &token = tokens[pos++];
+				switch( token.type ) {
+				case TokenType::INTEGER:
+					emit( bytecode::OpCode::PUSH_CONSTANT,
+					      program.add_constant( basic_value_integer( static_cast<integer>( token.value ) ) ) );
+					break;
+				case TokenType::LITERAL:
+					emit( bytecode::OpCode::PUSH_CONSTANT, program.add_constant( tokens.line->literals[token.value] ) );
+					break;
+				case TokenType::OPEN_BRACKET:
+					expression( );
+					expect( TokenType::CLOSE_BRACKET, "closing bracket )" );
+					break;
+				case TokenType::IDENTIFIER:
+					identifier( token.value );
+					break;
+				case TokenType::KEYWORD:
+				case TokenType::USER_KEYWORD:
+				case TokenType::OPERATOR:
+				case TokenType::USER_OPERATOR:
+				case TokenType::CLOSE_BRACKET:
+				case TokenType::COMMA:
+				case TokenType::COLON:
+					throw syntax_error( "Unexpected '" + token_text( tokens, pos - 1 ) + "'" );
+				}
+			}
+
+			// A % right after the name at pos - 1 and right before a (, as in A%( 1 )
+			bool integer_array_suffix( ) const {
+				return is_operator( Operator::MODULO ) && pos + 1 < tokens.size( ) &&
+				       TokenType::OPEN_BRACKET == tokens[pos + 1].type &&
+				       tokens[pos - 1].position + basic.m_symbols[tokens[pos - 1].value].size( ) == tokens[pos].position &&
+				       tokens[pos].position + 1u == tokens[pos + 1].position;
+			}
+
+			void identifier( uint32_t symbol ) {
+				auto name = basic.m_symbols[symbol];
+				if( integer_array_suffix( ) && basic.may_be_integer_array( name + '%' ) ) {
+					name += '%';
+					++pos;
+				}
+				if( is_type( TokenType::OPEN_BRACKET ) ) {
+					++pos;
+					auto const function = basic.find_function( name );
+					auto const count = arguments( nullptr != function && function->arrays );
+					if( nullptr != function ) {
+						emit_call( function, count );
+					} else {
+						auto const index = take_variable_index( count );
+						if( 0 <= index ) {
+							emit( bytecode::OpCode::LOAD_ELEMENT, program.add_name( name ), index );
+						} else {
+							emit( bytecode::OpCode::LOAD_ARRAY, program.add_name( name ), count );
+						}
+					}
+				} else if( "CURRENT_LINE" == name && 0 <= line_number ) {
+					emit( bytecode::OpCode::PUSH_CONSTANT, program.add_constant( basic_value_integer( line_number ) ) );
+				} else if( auto constant = basic.find_constant( name ) ) {
+					emit( bytecode::OpCode::PUSH_CONSTANT, program.add_constant( constant->value ) );
+				} else {
+					emit( bytecode::OpCode::LOAD_VARIABLE, static_cast<int32_t>( symbol ) );
+				}
+			}
+
+			//////////////////////////////////////////////////////////////////////////
+			/// Superinstructions.  Common statement shapes are fused into one
+			/// instruction so that running them is a single dispatch
+
+			// When the count indexes just emitted are one variable, remove its
+			// LOAD_VARIABLE and return its symbol.  Otherwise -1
+			int32_t take_variable_index( int32_t count ) {
+				auto &code = program.code;
+				if( !basic.m_optimize || 1 != count || bytecode::OpCode::LOAD_VARIABLE != code.back( ).op ) {
+					return -1;
+				}
+				return pop( code ).a;
+			}
+
+			// code[first] to the end is X = X + c or X = X - c, with c an integer
+			// constant, storing to symbol.  Replaces it with the fused instruction
+			bool fuse_increment( size_t first, uint32_t symbol ) {
+				using bytecode::OpCode;
+				auto &code = program.code;
+				if( !basic.m_optimize || 4 != code.size( ) - first ) {
+					return false;
+				}
+				auto const &load = code[first];
+				auto const amount = constant_at( first + 1 );
+				auto const &oper = code[first + 2];
+				if( OpCode::LOAD_VARIABLE != load.op || static_cast<int32_t>( symbol ) != load.a || nullptr == amount ||
+				    ValueType::INTEGER != amount->type( ) || OpCode::BINARY_OPERATOR != oper.op ) {
+					return false;
+				}
+				OpCode op;
+				switch( static_cast<Operator>( oper.a ) ) {
+				case Operator::ADD:
+					op = OpCode::INCREMENT_VARIABLE;
+					break;
+				case Operator::SUBTRACT:
+					op = OpCode::DECREMENT_VARIABLE;
+					break;
+				default:
+					return false;
+				}
+				auto const value = amount->integer_value( );
+				code.erase( std::begin( code ) + static_cast<std::ptrdiff_t>( first ), std::end( code ) );
+				emit( op, static_cast<int32_t>( symbol ), value );
+				return true;
+			}
+
+			// code[first] to the end is a condition ending with a comparison.
+			// Replaces the comparison with a jump to line_number_of_jump when it
+			// holds.  An unboxed condition is left alone as it runs faster
+			bool fuse_compare_and_jump( size_t first, integer line_number_of_jump ) {
+				auto &last = program.code.back( );
+				if( !basic.m_optimize || bytecode::OpCode::BINARY_OPERATOR != last.op ||
+				    !operators::is_comparison( static_cast<Operator>( last.a ) ) ) {
+					return false;
+				}
+				std::vector<bytecode::Instruction> unboxed;
+				if( !program.variable_types.empty( ) && ValueType::EMPTY != unbox( first, program.code.size( ), unboxed ) ) {
+					return false;
+				}
+				last = bytecode::Instruction{bytecode::OpCode::COMPARE_AND_JUMP, line_number_of_jump, last.a};
+				return true;
+			}
+
+			//////////////////////////////////////////////////////////////////////////
+			/// Unboxing.  An expression of variables inferred to always be INTEGER
+			/// or always be REAL gets an unboxed copy in front of its tagged code.
+			/// The guards of the copy jump to the tagged code when a variable holds
+			/// something else at run time or an integer would overflow
+			struct UnboxedOperand {
+				ValueType type; // INTEGER, REAL or BOOLEAN from a comparison
+				size_t push;    // Instruction pushing it when an integer constant, otherwise npos
+			};
+
+			// The type left by an unboxed copy of code[first, last), EMPTY when it has none
+			ValueType unbox( size_t first, size_t last, std::vector<bytecode::Instruction> &unboxed ) {
+				using bytecode::OpCode;
+				auto const none = std::numeric_limits<size_t>::max( );
+				auto const unboxed_type = [&]( int32_t symbol ) {
+					auto const types = program.variable_types[static_cast<size_t>( symbol )];
+					if( value_types( ValueType::INTEGER ) == types ) {
+						return ValueType::INTEGER;
+					} else if( value_types( ValueType::REAL ) == types ) {
+						return ValueType::REAL;
+					}
+					return ValueType::EMPTY;
+				};
+				std::vector<UnboxedOperand> operands;
+				for( auto pc = first; pc != last; ++pc ) {
+					auto const instruction = program.code[pc];
+					switch( instruction.op ) {
+					case OpCode::PUSH_CONSTANT: {
+						auto const &constant = program.constants[static_cast<size_t>( instruction.a )];
+						if( ValueType::INTEGER == constant.type( ) ) {
+							operands.push_back( UnboxedOperand{ValueType::INTEGER, unboxed.size( )} );
+							unboxed.push_back( {OpCode::PUSH_INTEGER, constant.integer_value( ), 0} );
+						} else if( ValueType::REAL == constant.type( ) ) {
+							operands.push_back( UnboxedOperand{ValueType::REAL, none} );
+							unboxed.push_back( {OpCode::PUSH_REAL, instruction.a, 0} );
+						} else {
+							return ValueType::EMPTY;
+						}
+					} break;
+					case OpCode::LOAD_VARIABLE: {
+						auto const type = unboxed_type( instruction.a );
+						if( ValueType::EMPTY == type ) {
+							return ValueType::EMPTY;
+						}
+						operands.push_back( UnboxedOperand{type, none} );
+						unboxed.push_back(
+						  {ValueType::INTEGER == type ? OpCode::LOAD_INTEGER : OpCode::LOAD_REAL, instruction.a, 0} );
+					} break;
+					case OpCode::UNARY_OPERATOR: {
+						auto &operand = operands.back( );
+						if( ValueType::BOOLEAN == operand.type ) {
+							return ValueType::EMPTY;
+						}
+						operand.push = none;
+						unboxed.push_back( {ValueType::INTEGER == operand.type ? OpCode::INTEGER_OPERATOR : OpCode::REAL_OPERATOR,
+						                    instruction.a, 0} );
+					} break;
+					case OpCode::DUPLICATE:
+						operands.push_back( UnboxedOperand{operands.back( ).type, none} );
+						unboxed.push_back( {OpCode::DUPLICATE_UNBOXED, 0, 0} );
+						break;
+					case OpCode::BINARY_OPERATOR: {
+						auto const oper = static_cast<Operator>( instruction.a );
+						auto const rhs = pop( operands );
+						auto &lhs = operands.back( );
+						if( ValueType::BOOLEAN == lhs.type || ValueType::BOOLEAN == rhs.type || Operator::AND == oper ||
+						    Operator::OR == oper ) {
+							return ValueType::EMPTY;
+						}
+						if( lhs.type != rhs.type ) {
+							// An integer constant used with a real is the same as a real constant
+							auto const push = ValueType::INTEGER == lhs.type ? lhs.push : rhs.push;
+							if( none == push ) {
+								return ValueType::EMPTY;
+							}
+							unboxed[push] = {OpCode::PUSH_REAL, program.add_constant( basic_value_real( unboxed[push].a ) ), 0};
+							lhs.type = ValueType::REAL;
+						}
+						if( ValueType::REAL == lhs.type && Operator::MODULO == oper ) {
+							return ValueType::EMPTY;
+						}
+						unboxed.push_back( {ValueType::INTEGER == lhs.type ? OpCode::INTEGER_OPERATOR : OpCode::REAL_OPERATOR,
+						                    static_cast<int32_t>( reduce( oper, unboxed ) ), 0} );
+						lhs.push = none;
+						if( operators::is_comparison( oper ) ) {
+							lhs.type = ValueType::BOOLEAN;
+						}
+					} break;
+					default:
+						return ValueType::EMPTY;
+					}
+				}
+				// A lone value is no cheaper unboxed
+				if( 1 != operands.size( ) || 2 > unboxed.size( ) ) {
+					return ValueType::EMPTY;
 				}
+				return operands.back( ).type;
 			}
-			{
-				auto keys = get_keys( m_arrays );
-				std::sort( std::begin( keys ), std::end( keys ) );
-				for( auto &current_array_name : keys ) {
-					const auto &array_value = m_arrays[current_array_name];
-					auto dimensions = array_value.dimensions( );
-					ss << current_array_name << "( ";
-					for( size_t n = 0; n < dimensions.size( ); ++n ) {
-						if( 0 < n ) {
-							ss << ", ";
+
+			// Rewrite the unboxed operands of oper, the last pushed by unboxed.back( ),
+			// to those of a cheaper operator giving the same result.  Returns the
+			// operator to use.  Only unboxed code is rewritten as there both operands
+			// are numbers, the tagged operators raise their own errors for the rest
+			Operator reduce( Operator oper, std::vector<bytecode::Instruction> &unboxed ) {
+				using bytecode::OpCode;
+				auto &rhs = unboxed.back( );
+				auto const is_real = OpCode::PUSH_REAL == rhs.op;
+				if( !basic.m_optimize || ( !is_real && OpCode::PUSH_INTEGER != rhs.op ) ) {
+					return oper;
+				}
+				auto const value = is_real ? program.constants[static_cast<size_t>( rhs.a )].real_value( )
+				                           : static_cast<real>( rhs.a );
+				switch( oper ) {
+				case Operator::POWER:
+					// x ^ 2 is x * x
+					if( 2.0 == value ) {
+						rhs = bytecode::Instruction{OpCode::DUPLICATE_UNBOXED, 0, 0};
+						return Operator::MULTIPLY;
+					}
+					break;
+				case Operator::DIVIDE:
+					// Dividing by a real power of 2 is multiplying by its exact reciprocal
+					if( is_real ) {
+						int exponent = 0;
+						auto const reciprocal = 1.0 / value;
+						if( 0.5 == std::frexp( value, &exponent ) && std::isnormal( reciprocal ) ) {
+							rhs.a = program.add_constant( basic_value_real( reciprocal ) );
+							return Operator::MULTIPLY;
 						}
-						ss << dimensions[n];
 					}
-					ss << " )\n";
+					break;
+				default:
+					break;
 				}
+				return oper;
 			}
-			return ss.str( );
-		}
 
-		BasicValue Basic::exec_function( boost::string_ref name, std::vector<BasicValue> arguments ) {
-			const auto &func = m_functions[to_upper( name )].func;
-			if( !func ) {
-				throw create_basic_exception( ErrorTypes::FATAL,
-				                              "Expected function '" + name.to_string( ) + "' to exist.  Could not find it" );
+			// Put unboxed in front of code[first] with its guards going to the tagged code after it
+			void insert_unboxed( size_t first, std::vector<bytecode::Instruction> unboxed ) {
+				using bytecode::OpCode;
+				auto const tagged = static_cast<int32_t>( first + unboxed.size( ) );
+				for( auto &instruction : unboxed ) {
+					switch( instruction.op ) {
+					case OpCode::LOAD_INTEGER:
+					case OpCode::LOAD_REAL:
+					case OpCode::INTEGER_OPERATOR:
+						instruction.b = tagged;
+						break;
+					default:
+						break;
+					}
+				}
+				auto &code = program.code;
+				code.insert( std::begin( code ) + static_cast<std::ptrdiff_t>( first ), std::begin( unboxed ),
+				             std::end( unboxed ) );
 			}
-			return func( std::move( arguments ) );
-		}
 
-		bool Basic::let_helper( boost::string_ref parse_string, bool show_error ) {
-			auto parsed_string = split_in_two_on_char( parse_string, '=' );
-			if( 2 != parsed_string.size( ) ) {
-				if( show_error ) {
-					throw create_basic_exception( ErrorTypes::SYNTAX, "LET requires a variable and an assignment" );
-				} else {
-					return false;
+			// code[first] to the end is an expression and the STORE_VARIABLE of symbol
+			void unbox_assignment( size_t first, uint32_t symbol ) {
+				if( program.variable_types.empty( ) ) {
+					return;
+				}
+				std::vector<bytecode::Instruction> unboxed;
+				auto const store = program.code.size( ) - 1;
+				switch( unbox( first, store, unboxed ) ) {
+				case ValueType::INTEGER:
+					unboxed.push_back( {bytecode::OpCode::STORE_INTEGER, static_cast<int32_t>( symbol ), 0} );
+					break;
+				case ValueType::REAL:
+					unboxed.push_back( {bytecode::OpCode::STORE_REAL, static_cast<int32_t>( symbol ), 0} );
+					break;
+				default:
+					return;
+				}
+				unboxed.back( ).b = static_cast<int32_t>( program.code.size( ) + unboxed.size( ) );
+				insert_unboxed( first, std::move( unboxed ) );
+			}
+
+			// code[first] to the end is a condition and its JUMP_IF_FALSE.  Returns the
+			// position of the JUMP_IF_FALSE and of the unboxed branch when there is one
+			std::pair<size_t, size_t> unbox_condition( size_t first ) {
+				auto const jump = program.code.size( ) - 1;
+				auto const none = std::numeric_limits<size_t>::max( );
+				std::vector<bytecode::Instruction> unboxed;
+				if( program.variable_types.empty( ) || ValueType::BOOLEAN != unbox( first, jump, unboxed ) ) {
+					return {jump, none};
+				}
+				unboxed.push_back( {bytecode::OpCode::BRANCH_UNBOXED, 0, 0} );
+				unboxed.back( ).b = static_cast<int32_t>( program.code.size( ) + unboxed.size( ) );
+				auto const branch = first + unboxed.size( ) - 1;
+				auto const moved = unboxed.size( );
+				insert_unboxed( first, std::move( unboxed ) );
+				return {jump + moved, branch};
+			}
+
+			integer line_number_operand( StatementTokens params, char const *keyword ) {
+				if( 1 != params.size( ) || TokenType::INTEGER != params[0].type ) {
+					throw syntax_error( std::string( "Can only " ) + keyword + " line numbers" );
 				}
+				return static_cast<integer>( params[0].value );
 			}
-			if( is_function( parsed_string[0] ) || is_keyword( parsed_string[0] ) || is_constant( parsed_string[0] ) ) {
-				if( show_error ) {
-					throw create_basic_exception( ErrorTypes::SYNTAX, "Attempt to set variable with name of built-in symbol" );
+
+			void assignment( StatementTokens statement ) {
+				reset( statement );
+				if( !is_type( TokenType::IDENTIFIER ) ) {
+					throw syntax_error( "Invalid keyword '" + token_text( statement, 0 ) + "'" );
+				}
+				auto const symbol = tokens[pos++].value;
+				auto name = basic.m_symbols[symbol];
+				if( basic.is_function( name ) || basic.is_constant( name ) ) {
+					throw syntax_error( "Attempt to set variable with name of built-in symbol" );
+				}
+				// Only an element can be assigned so A%( is always the array A%
+				if( integer_array_suffix( ) ) {
+					name += '%';
+					++pos;
+				}
+				int32_t count = -1;
+				int32_t index = -1;
+				if( is_type( TokenType::OPEN_BRACKET ) ) {
+					++pos;
+					count = arguments( );
+					index = take_variable_index( count );
+				}
+				if( !is_operator( Operator::EQUAL ) ) {
+					throw syntax_error( "Invalid keyword '" + token_text( statement, 0 ) + "'" );
+				}
+				++pos;
+				auto const first = program.code.size( );
+				expression( );
+				expect_end( );
+				if( 0 <= index ) {
+					emit( bytecode::OpCode::STORE_ELEMENT, program.add_name( name ), index );
+				} else if( 0 <= count ) {
+					emit( bytecode::OpCode::STORE_ARRAY, program.add_name( name ), count );
 				} else {
-					return false;
+					emit( bytecode::OpCode::STORE_VARIABLE, static_cast<int32_t>( symbol ) );
+					if( !fuse_increment( first, symbol ) ) {
+						unbox_assignment( first, symbol );
+					}
 				}
 			}
-			auto &var = get_variable( parsed_string[0] );
 
-			var = evaluate( parsed_string[1] );
+			void value( StatementTokens tokens_of_value ) {
+				reset( tokens_of_value );
+				expression( );
+				expect_end( );
+			}
 
-			return true;
-		}
+			void list( StatementTokens expressions ) {
+				// Trailing comma's are allowed
+				reset( expressions );
+				while( !at_end( ) ) {
+					expression( );
+					if( !at_end( ) ) {
+						expect( TokenType::COMMA, "comma , between parameters" );
+					}
+				}
+			}
 
-		void Basic::init( ) {
-			//////////////////////////////////////////////////////////////////////////
-			// Binary Operators
-			//////////////////////////////////////////////////////////////////////////
-			m_binary_operators["*"] = [&]( BasicValue lhs, BasicValue rhs ) {
-				auto result_type = determine_result_type( lhs.first, rhs.first );
-				switch( result_type ) {
-				case ValueType::INTEGER:
-					return basic_value_integer( to_integer( std::move( lhs ) ) * to_integer( std::move( rhs ) ) );
-				case ValueType::REAL:
-					return basic_value_real( to_numeric( std::move( lhs ) ) * to_numeric( std::move( rhs ) ) );
-				case ValueType::ARRAY:
-				case ValueType::BOOLEAN:
-				case ValueType::EMPTY:
-				case ValueType::STRING:
-					throw create_basic_exception( ErrorTypes::SYNTAX, "Attempt to multiply non-numeric types" );
-				default:
-					throw std::exception{};
+			void compile( StatementTokens source, ExpressionKind kind ) {
+				switch( kind ) {
+				case ExpressionKind::VALUE:
+					value( source );
+					break;
+				case ExpressionKind::LIST:
+					list( source );
+					break;
+				case ExpressionKind::ASSIGNMENT:
+					assignment( source );
+					break;
 				}
-			};
+			}
 
-			m_binary_operators["/"] = [&]( BasicValue lhs, BasicValue rhs ) {
-				auto result_type = determine_result_type( lhs.first, rhs.first );
-				switch( result_type ) {
-				case ValueType::INTEGER:
-					return basic_value_integer( to_integer( std::move( lhs ) ) / to_integer( std::move( rhs ) ) );
-				case ValueType::REAL:
-					return basic_value_real( to_numeric( std::move( lhs ) ) / to_numeric( std::move( rhs ) ) );
-				case ValueType::ARRAY:
-				case ValueType::BOOLEAN:
-				case ValueType::EMPTY:
-				case ValueType::STRING:
-					throw create_basic_exception( ErrorTypes::SYNTAX, "Attempt to multiply non-numeric types" );
-				default:
-					throw std::exception{};
+			void print( StatementTokens params ) {
+				if( params.empty( ) ) {
+					emit( bytecode::OpCode::PRINT_NEWLINE );
+					return;
 				}
-			};
+				reset( params );
+				expression( );
+				expect_end( );
+				auto &last = program.code.back( );
+				if( basic.m_optimize && bytecode::OpCode::LOAD_VARIABLE == last.op ) {
+					last.op = bytecode::OpCode::PRINT_VARIABLE;
+				} else {
+					emit( bytecode::OpCode::PRINT );
+				}
+			}
 
-			m_binary_operators["+"] = [&]( BasicValue lhs, BasicValue rhs ) {
-				auto result_type = determine_result_type( lhs.first, rhs.first );
-				switch( result_type ) {
-				case ValueType::INTEGER:
-					return basic_value_integer( to_integer( std::move( lhs ) ) + to_integer( std::move( rhs ) ) );
-				case ValueType::REAL:
-					return basic_value_real( to_numeric( std::move( lhs ) ) + to_numeric( std::move( rhs ) ) );
-				case ValueType::STRING: { // Append
-					auto lhs_str = remove_outer_quotes( to_string( std::move( lhs ) ) );
-					auto rhs_str = remove_outer_quotes( to_string( std::move( rhs ) ) );
-					return basic_value_string( lhs_str + rhs_str );
+			void if_statement( StatementTokens params ) {
+				// IF <CONDITION> THEN <statement>
+				// IF <CONDITION> THEN <line_number>
+				// IF <CONDITION> GOTO <line_number>
+				auto const clause = find_if_clause( params );
+				if( params.size( ) == clause ) {
+					throw syntax_error( "Unable to find end of condition in IF keyword" );
 				}
-				case ValueType::ARRAY:
-				case ValueType::BOOLEAN:
-				case ValueType::EMPTY:
-					throw create_basic_exception( ErrorTypes::SYNTAX, "Attempt to add non-numeric types" );
-				default:
-					throw std::exception{};
+				if( is_loop_statement( params.sub_range( clause + 1 ) ) ) {
+					throw syntax_error( "FOR and NEXT cannot follow THEN" );
 				}
-			};
+				auto const action = params.sub_range( clause + 1 );
+				auto const is_goto = is_keyword_token( params[clause], Keyword::GOTO ) ||
+				                     ( 1 == action.size( ) && TokenType::INTEGER == action[0].type );
+				reset( params.sub_range( 0, clause ) );
+				std::vector<size_t> exits;
+				auto const first = conditions( exits );
+				expect_end( );
+				if( !is_goto || !fuse_compare_and_jump( first, line_number_operand( action, "GOTO" ) ) ) {
+					emit( bytecode::OpCode::JUMP_IF_FALSE );
+					auto const jumps = unbox_condition( first );
+					exits.push_back( jumps.first );
+					exits.push_back( jumps.second );
+					if( is_goto ) {
+						emit( bytecode::OpCode::GOTO, line_number_operand( action, "GOTO" ) );
+					} else {
+						statement( action );
+					}
+				}
+				for( auto const exit : exits ) {
+					if( exit < program.code.size( ) ) {
+						program.code[exit].a = static_cast<int32_t>( program.code.size( ) );
+					}
+				}
+			}
 
-			m_binary_operators["-"] = [&]( BasicValue lhs, BasicValue rhs ) {
-				auto result_type = determine_result_type( lhs.first, rhs.first );
-				switch( result_type ) {
-				case ValueType::INTEGER:
-					return basic_value_integer( to_integer( std::move( lhs ) ) - to_integer( std::move( rhs ) ) );
-				case ValueType::REAL:
-					return basic_value_real( to_numeric( std::move( lhs ) ) - to_numeric( std::move( rhs ) ) );
-				case ValueType::ARRAY:
-				case ValueType::BOOLEAN:
-				case ValueType::EMPTY:
-				case ValueType::STRING:
-					throw create_basic_exception( ErrorTypes::SYNTAX, "Attempt to subtract non-numeric types" );
-				default:
-					throw std::exception{};
+			// The condition of an IF.  In short circuit mode A AND B AND C is a
+			// JUMP_IF_FALSE, added to exits, after each but the last so that only
+			// a jump is left of the AND's.  Returns the start of the code left to
+			// jump on
+			size_t conditions( std::vector<size_t> &exits ) {
+				auto const and_precedence = operators::info( Operator::AND ).precedence;
+				auto const start = pos;
+				auto const first = program.code.size( );
+				if( !basic.m_short_circuit ) {
+					expression( );
+					return first;
 				}
-			};
+				auto condition = first;
+				expression( and_precedence - 1 );
+				while( is_operator( Operator::AND ) ) {
+					++pos;
+					emit( bytecode::OpCode::JUMP_IF_FALSE );
+					auto const jumps = unbox_condition( condition );
+					exits.push_back( jumps.first );
+					exits.push_back( jumps.second );
+					condition = program.code.size( );
+					expression( and_precedence - 1 );
+				}
+				if( !at_end( ) ) {
+					// An OR, or an operator as loose, has the AND's as operand
+					program.code.erase( std::begin( program.code ) + static_cast<std::ptrdiff_t>( first ),
+					                    std::end( program.code ) );
+					exits.clear( );
+					pos = start;
+					expression( );
+					return first;
+				}
+				return condition;
+			}
 
-			m_binary_operators["^"] = [&]( BasicValue lhs, BasicValue rhs ) {
-				return exec_function( "POW", {std::move( lhs ), std::move( rhs )} );
-			};
+			void for_statement( StatementTokens params ) {
+				auto const parts = parse_for_loop( params );
+				value( parts.start );
+				value( parts.limit );
+				if( parts.step.empty( ) ) {
+					emit( bytecode::OpCode::PUSH_CONSTANT, program.add_constant( basic_value_integer( 1 ) ) );
+				} else {
+					value( parts.step );
+				}
+				program.open_loops.emplace_back( program.code.size( ), line_number );
+				emit( bytecode::OpCode::FOR_LOOP, static_cast<int32_t>( parts.variable ) );
+			}
 
-			m_binary_operators["%"] = [&]( BasicValue lhs, BasicValue rhs ) {
-				auto result_type = determine_result_type( lhs.first, rhs.first );
-				switch( result_type ) {
-				case ValueType::INTEGER:
-					return basic_value_integer( to_integer( std::move( lhs ) ) % to_integer( std::move( rhs ) ) );
-				case ValueType::ARRAY:
-				case ValueType::BOOLEAN:
-				case ValueType::EMPTY:
-				case ValueType::STRING:
-				case ValueType::REAL:
-					throw create_basic_exception( ErrorTypes::SYNTAX, "Attempt to do modular arithmetic with non-integers" );
-				default:
-					throw std::exception{};
+			void next_statement( StatementTokens params ) {
+				if( program.open_loops.empty( ) ) {
+					throw syntax_error( "NEXT without FOR" );
 				}
-			};
+				auto const loop = pop( program.open_loops );
+				auto &for_loop = program.code[loop.first];
+				if( !params.empty( ) &&
+				    ( 1 < params.size( ) || TokenType::IDENTIFIER != params[0].type ||
+				      static_cast<uint32_t>( for_loop.a ) != params[0].value ) ) {
+					throw syntax_error( "NEXT does not match FOR " + basic.m_symbols[static_cast<size_t>( for_loop.a )] +
+					                    " on line " + std::to_string( loop.second ) );
+				}
+				emit( bytecode::OpCode::NEXT_LOOP, for_loop.a );
+				for_loop.b = static_cast<int32_t>( program.code.size( ) );
+			}
 
-			m_binary_operators["="] = [&]( BasicValue lhs, BasicValue rhs ) {
-				auto result_type = determine_result_type( lhs.first, rhs.first );
-				boolean result = false;
-				switch( result_type ) {
-				case ValueType::BOOLEAN:
-					result = to_boolean( lhs ) == to_boolean( rhs );
+			void statement( StatementTokens current_statement ) {
+				if( current_statement.empty( ) ) {
+					return;
+				}
+				auto const params = current_statement.sub_range( 1 );
+				auto const parameters_index = [&]( ) {
+					program.parameters.push_back( params );
+					return static_cast<int32_t>( program.parameters.size( ) - 1 );
+				};
+				switch( current_statement[0].type ) {
+				case TokenType::KEYWORD:
 					break;
-				case ValueType::EMPTY:
-					if( lhs.first == rhs.first ) {
-						result = true;
-					} else {
-						throw create_basic_exception( ErrorTypes::SYNTAX, "Attempt to compare different types " +
-						                                                    value_type_to_string( lhs ) + " and " +
-						                                                    value_type_to_string( rhs ) );
-					}
+				case TokenType::USER_KEYWORD: {
+					auto const &name = basic.m_symbols[current_statement[0].value];
+					emit( bytecode::OpCode::USER_KEYWORD, add_handler( program.keywords, &basic.m_keywords[name] ),
+					      parameters_index( ) );
+				}
+					return;
+				default:
+					assignment( current_statement );
+					return;
+				}
+				auto const keyword = static_cast<Keyword>( current_statement[0].value );
+				switch( keyword ) {
+				case Keyword::REM:
 					break;
-				case ValueType::INTEGER:
-					result = to_integer( lhs ) == to_integer( rhs );
+				case Keyword::LET:
+					assignment( params );
 					break;
-				case ValueType::REAL:
-					result = almost_equal( to_numeric( lhs ), to_numeric( rhs ) );
+				case Keyword::PRINT:
+					print( params );
 					break;
-				case ValueType::STRING:
-					result = 0 == to_string( lhs ).compare( to_string( rhs ) );
+				case Keyword::IF:
+					if_statement( params );
 					break;
-				case ValueType::ARRAY:
-					throw create_basic_exception( ErrorTypes::FATAL, "Unknown ValueType" );
-				default:
-					throw std::exception{};
-				}
-				return basic_value_boolean( result );
-			};
-
-			m_binary_operators["<"] = [&]( BasicValue lhs, BasicValue rhs ) {
-				auto result_type = determine_result_type( lhs.first, rhs.first );
-				boolean result = false;
-				switch( result_type ) {
-				case ValueType::BOOLEAN:
-					result = to_boolean( lhs ) < to_boolean( rhs );
+				case Keyword::GOTO:
+					emit( bytecode::OpCode::GOTO, line_number_operand( params, "GOTO" ) );
 					break;
-				case ValueType::EMPTY:
-					if( lhs.first == rhs.first ) {
-						result = false;
+				case Keyword::GOSUB:
+					// TIERED mode shares the GOSUB stack with the interpreter
+					if( ExecutionMode::TIERED == basic.m_execution_mode ) {
+						emit( bytecode::OpCode::TIERED_GOSUB, line_number_operand( params, "GOSUB" ), parameters_index( ) );
 					} else {
-						throw create_basic_exception( ErrorTypes::SYNTAX, "Attempt to compare different types " +
-						                                                    value_type_to_string( lhs ) + " and " +
-						                                                    value_type_to_string( rhs ) );
+						emit( bytecode::OpCode::GOSUB, line_number_operand( params, "GOSUB" ) );
 					}
 					break;
-				case ValueType::INTEGER:
-					result = to_integer( lhs ) < to_integer( rhs );
+				case Keyword::RETURN:
+					emit( ExecutionMode::TIERED == basic.m_execution_mode ? bytecode::OpCode::TIERED_RETURN
+					                                                      : bytecode::OpCode::RETURN );
 					break;
-				case ValueType::REAL:
-					result = to_numeric( lhs ) < to_numeric( rhs );
+				case Keyword::STOP:
+					emit( bytecode::OpCode::STOP );
 					break;
-				case ValueType::STRING:
-					result = 0 < to_string( lhs ).compare( to_string( rhs ) );
+				case Keyword::END:
+				case Keyword::EXIT:
+					emit( bytecode::OpCode::END );
 					break;
-				case ValueType::ARRAY:
-					throw create_basic_exception( ErrorTypes::FATAL, "Unknown ValueType" );
+				case Keyword::FOR:
+					for_statement( params );
+					break;
+				case Keyword::NEXT:
+					next_statement( params );
+					break;
+				case Keyword::THEN:
+					throw syntax_error( "THEN is invalid without a preceeding IF and condition" );
+				case Keyword::TO:
+				case Keyword::STEP:
+					throw syntax_error( "TO and STEP are invalid outside of a FOR" );
 				default:
-					throw std::exception{};
+					emit( bytecode::OpCode::KEYWORD, static_cast<int32_t>( keyword ), parameters_index( ) );
+					break;
 				}
-				return basic_value_boolean( result );
-			};
+			}
+		}; // struct Basic::Compiler
 
-			m_binary_operators["<="] = [&]( BasicValue lhs, BasicValue rhs ) {
-				auto result_type = determine_result_type( lhs.first, rhs.first );
-				boolean result = false;
-				switch( result_type ) {
-				case ValueType::BOOLEAN:
-					result = to_boolean( lhs ) <= to_boolean( rhs );
-					break;
-				case ValueType::EMPTY:
-					if( lhs.first == rhs.first ) {
-						result = true;
-					} else {
-						throw create_basic_exception( ErrorTypes::SYNTAX, "Attempt to compare different types " +
-						                                                    value_type_to_string( lhs ) + " and " +
-						                                                    value_type_to_string( rhs ) );
+		//////////////////////////////////////////////////////////////////////////
+		/// summary: Compile the whole program.  The program lines must outlive
+		/// m_compiled as keywords that are not compiled refer to their tokens.
+		/// When some variables are found to hold one numeric type the program is
+		/// compiled again with unboxed code for the expressions using them
+		void Basic::compile( ) {
+			m_compiled.clear( );
+			m_jit.clear( );
+			compile_lines( m_compiled, first_line( ), std::end( m_program ) );
+			m_compiled.variable_types.assign( m_symbols.size( ), 0 );
+			if( infer_types( m_compiled ) ) {
+				auto variable_types = std::move( m_compiled.variable_types );
+				m_compiled.clear( );
+				m_compiled.variable_types = std::move( variable_types );
+				compile_lines( m_compiled, first_line( ), std::end( m_program ) );
+			}
+		}
+
+		//////////////////////////////////////////////////////////////////////////
+		/// summary: Compile the lines [first, last) into program, skipping those
+		/// already in m_compiled.  A line followed by one that is not compiled
+		/// right after it goes on through a GOTO, or END after the last line
+		void Basic::compile_lines( CompiledProgram &program, ProgramType::iterator first,
+		                           ProgramType::iterator last ) {
+			auto const tiered = ExecutionMode::TIERED == m_execution_mode;
+			for( auto it = first; it != last; ++it ) {
+				if( 0 > it->number || 0 != m_compiled.line_starts.count( it->number ) ) {
+					continue;
+				}
+				m_program_it = it;
+				auto const line = static_cast<size_t>( std::distance( std::begin( m_program ), it ) );
+				program.line_starts[it->number] = program.code.size( );
+				if( tiered ) {
+					program.statement_starts[LoopStackType::key( line, 0 )] = program.code.size( );
+				}
+				program.emit( bytecode::OpCode::LINE, static_cast<int32_t>( line ) );
+				for( size_t token = 0; token < it->tokens.size( ); ) {
+					auto const end_of_statement = find_end_of_statement( *it, token );
+					if( tiered && 0 != token ) {
+						program.statement_starts[LoopStackType::key( line, token )] = program.code.size( );
 					}
-					break;
-				case ValueType::INTEGER:
-					result = to_integer( lhs ) <= to_integer( rhs );
-					break;
-				case ValueType::REAL:
-					result = to_numeric( lhs ) <= to_numeric( rhs );
-					break;
-				case ValueType::STRING:
-					result = 0 <= to_string( lhs ).compare( to_string( rhs ) );
-					break;
-				case ValueType::ARRAY:
-					throw create_basic_exception( ErrorTypes::FATAL, "Unknown ValueType" );
-				default:
-					throw std::exception{};
+					Compiler( *this, program, it->number ).statement( StatementTokens{&*it, token, end_of_statement} );
+					token = end_of_statement + 1;
 				}
-				return basic_value_boolean( result );
+				auto const next = it + 1;
+				if( std::end( m_program ) == next ) {
+					program.emit( bytecode::OpCode::END );
+				} else if( last == next || 0 != m_compiled.line_starts.count( next->number ) ) {
+					program.emit( bytecode::OpCode::GOTO, next->number );
+				}
+			}
+			if( !program.open_loops.empty( ) ) {
+				m_program_it = find_line( program.open_loops.back( ).second );
+				throw create_basic_exception( ErrorTypes::SYNTAX, "FOR without NEXT" );
+			}
+		}
+
+		//////////////////////////////////////////////////////////////////////////
+		/// summary: Find the types each variable may hold from the literals,
+		/// operators and function results stored in it.  Every store is taken no
+		/// matter where it is so the types hold at any point of the program.
+		/// Returns true when a variable always holds an integer or always holds
+		/// a real.  Variables changed from outside the program are caught by the
+		/// guards of the unboxed code.  The types program.variable_types starts
+		/// with are kept
+		bool Basic::infer_types( CompiledProgram &program ) {
+			using bytecode::OpCode;
+			auto &types = program.variable_types;
+			types.resize( m_symbols.size( ) );
+			std::vector<ValueTypes> stack;
+			auto const pop_types = [&stack]( int32_t count ) {
+				stack.erase( std::end( stack ) - count, std::end( stack ) );
+			};
+			auto const store = [&types]( int32_t symbol, ValueTypes value ) {
+				auto &current = types[static_cast<size_t>( symbol )];
+				auto const joined = static_cast<ValueTypes>( current | value );
+				auto const changed = joined != current;
+				current = joined;
+				return changed;
 			};
 
-			m_binary_operators[">"] = [&]( BasicValue lhs, BasicValue rhs ) {
-				auto result_type = determine_result_type( lhs.first, rhs.first );
-				boolean result = false;
-				switch( result_type ) {
-				case ValueType::BOOLEAN:
-					result = to_boolean( lhs ) >= to_boolean( rhs );
-					break;
-				case ValueType::EMPTY:
-					if( lhs.first == rhs.first ) {
-						result = false;
-					} else {
-						throw create_basic_exception( ErrorTypes::SYNTAX, "Attempt to compare different types " +
-						                                                    value_type_to_string( lhs ) + " and " +
-						                                                    value_type_to_string( rhs ) );
+			// Types only grow so this ends once no store adds one
+			for( bool changed = true; changed; ) {
+				changed = false;
+				stack.clear( );
+				for( auto const &instruction : program.code ) {
+					switch( instruction.op ) {
+					case OpCode::PUSH_CONSTANT:
+						stack.push_back( value_types( program.constants[static_cast<size_t>( instruction.a )].type( ) ) );
+						break;
+					case OpCode::LOAD_VARIABLE:
+						stack.push_back( types[static_cast<size_t>( instruction.a )] );
+						break;
+					case OpCode::LOAD_ARRAY:
+						pop_types( instruction.b );
+						stack.push_back( any_value_types );
+						break;
+					case OpCode::STORE_VARIABLE:
+						changed = store( instruction.a, pop( stack ) ) || changed;
+						break;
+					case OpCode::STORE_ARRAY:
+						pop_types( instruction.b + 1 );
+						break;
+					case OpCode::CALL_FUNCTION:
+						pop_types( instruction.b );
+						stack.push_back( program.functions[static_cast<size_t>( instruction.a )]->result );
+						break;
+					case OpCode::UNARY_OPERATOR:
+						stack.back( ) &= numeric_value_types;
+						break;
+					case OpCode::BINARY_OPERATOR: {
+						auto const rhs = pop( stack );
+						stack.back( ) = result_types( static_cast<Operator>( instruction.a ), stack.back( ), rhs );
+					} break;
+					case OpCode::USER_OPERATOR:
+						pop_types( 1 );
+						stack.back( ) = any_value_types;
+						break;
+					case OpCode::DUPLICATE:
+						stack.push_back( stack.back( ) );
+						break;
+					case OpCode::PRINT:
+					case OpCode::JUMP_IF_FALSE:
+					case OpCode::SHORT_CIRCUIT:
+					case OpCode::STORE_ELEMENT:
+					case OpCode::STORE_IN_BOUNDS:
+						pop_types( 1 );
+						break;
+					case OpCode::TO_BOOLEAN:
+						stack.back( ) = value_types( ValueType::BOOLEAN );
+						break;
+					case OpCode::COMPARE_AND_JUMP:
+						pop_types( 2 );
+						break;
+					case OpCode::LOAD_ELEMENT:
+					case OpCode::LOAD_IN_BOUNDS:
+						stack.push_back( any_value_types );
+						break;
+					case OpCode::INCREMENT_VARIABLE:
+					case OpCode::DECREMENT_VARIABLE: {
+						auto const oper = OpCode::INCREMENT_VARIABLE == instruction.op ? Operator::ADD : Operator::SUBTRACT;
+						auto const value =
+						  result_types( oper, types[static_cast<size_t>( instruction.a )], value_types( ValueType::INTEGER ) );
+						changed = store( instruction.a, value ) || changed;
+					} break;
+					case OpCode::FOR_LOOP: {
+						auto const step = pop( stack );
+						auto const limit = pop( stack );
+						auto const start = pop( stack );
+						// The counter is an integer only when start, limit and step all are
+						auto counter = static_cast<ValueTypes>( start & limit & step & value_types( ValueType::INTEGER ) );
+						if( 0 != ( ( start | limit | step ) & value_types( ValueType::REAL ) ) ) {
+							counter |= value_types( ValueType::REAL );
+						}
+						changed = store( instruction.a, counter ) || changed;
+					} break;
+					default:
+						break;
 					}
-					break;
-				case ValueType::INTEGER:
-					result = to_integer( lhs ) > to_integer( rhs );
-					break;
-				case ValueType::REAL:
-					result = to_numeric( lhs ) > to_numeric( rhs );
-					break;
-				case ValueType::STRING:
-					result = 0 > to_string( lhs ).compare( to_string( rhs ) );
-					break;
-				case ValueType::ARRAY:
-					throw create_basic_exception( ErrorTypes::FATAL, "Unknown ValueType" );
-				default:
-					throw std::exception{};
 				}
-				return basic_value_boolean( result );
-			};
+			}
+			return std::any_of( std::begin( types ), std::end( types ), []( ValueTypes type ) {
+				return value_types( ValueType::INTEGER ) == type || value_types( ValueType::REAL ) == type;
+			} );
+		}
 
-			m_binary_operators[">="] = [&]( BasicValue lhs, BasicValue rhs ) {
-				auto result_type = determine_result_type( lhs.first, rhs.first );
-				boolean result = false;
-				switch( result_type ) {
-				case ValueType::BOOLEAN:
-					result = to_boolean( lhs ) >= to_boolean( rhs );
+		//////////////////////////////////////////////////////////////////////////
+		/// summary: Resolve the line numbers jumped to from code[first] on to the
+		/// program counter of their line so that jumping needs no lookup.  Every
+		/// missing line is reported before anything runs.  In TIERED mode lines
+		/// not compiled yet are jumped to through an exit stub instead
+		void Basic::link( size_t first ) {
+			using bytecode::OpCode;
+			std::stringstream unresolved;
+			integer line_number = -1;
+			auto const tiered = ExecutionMode::TIERED == m_execution_mode;
+			// Exit stubs are added after the code being linked
+			for( auto pc = first, last = m_compiled.code.size( ); pc != last; ++pc ) {
+				auto &instruction = m_compiled.code[pc];
+				switch( instruction.op ) {
+				case OpCode::LINE:
+					line_number = m_program[static_cast<size_t>( instruction.a )].number;
 					break;
-				case ValueType::EMPTY:
-					if( lhs.first == rhs.first ) {
-						result = true;
+				case OpCode::GOTO:
+				case OpCode::GOSUB:
+				case OpCode::TIERED_GOSUB:
+				case OpCode::COMPARE_AND_JUMP: {
+					auto line_start = m_compiled.line_starts.find( instruction.a );
+					int32_t target = 0;
+					if( std::end( m_compiled.line_starts ) != line_start ) {
+						target = static_cast<int32_t>( line_start->second );
+					} else if( tiered ) {
+						target = exit_stub( instruction.a );
 					} else {
-						throw create_basic_exception( ErrorTypes::SYNTAX, "Attempt to compare different types " +
-						                                                    value_type_to_string( lhs ) + " and " +
-						                                                    value_type_to_string( rhs ) );
+						unresolved << "\nUndefined line " << instruction.a << " on line " << line_number;
+						break;
 					}
+					auto &resolved = m_compiled.code[pc];
+					resolved.a = target;
+					if( OpCode::GOTO == resolved.op ) {
+						resolved.op = OpCode::JUMP;
+					}
+				} break;
+				default:
 					break;
-				case ValueType::INTEGER:
-					result = to_integer( lhs ) >= to_integer( rhs );
+				}
+			}
+			if( !unresolved.str( ).empty( ) ) {
+				m_program_it = std::end( m_program );
+				throw create_basic_exception( ErrorTypes::SYNTAX, "Attempt to jump to an invalid line" + unresolved.str( ) );
+			}
+		}
+
+		//////////////////////////////////////////////////////////////////////////
+		/// summary: The program counter of an EXIT_TO_LINE for a line that is not
+		/// compiled.  Jumps to the line share it so that compiling the line only
+		/// has to replace the stub
+		int32_t Basic::exit_stub( integer line_number ) {
+			auto stub = m_compiled.exit_stubs.find( line_number );
+			if( std::end( m_compiled.exit_stubs ) == stub ) {
+				stub = m_compiled.exit_stubs.emplace( line_number, m_compiled.code.size( ) ).first;
+				m_compiled.emit( bytecode::OpCode::EXIT_TO_LINE, line_number );
+			}
+			return static_cast<int32_t>( stub->second );
+		}
+
+		//////////////////////////////////////////////////////////////////////////
+		/// summary: Find the elements a FOR loop indexes with its counter so that
+		/// FOR can check their bounds once for every iteration.  The body must
+		/// not change the counter, run keywords or GOSUB and is only entered by
+		/// its FOR and NEXT.  Runs on linked code
+		void Basic::hoist_bounds_checks( ) {
+			using bytecode::OpCode;
+			auto &code = m_compiled.code;
+			m_hoisted.assign( code.size( ), nullptr );
+			if( !m_optimize ) {
+				return;
+			}
+			std::vector<std::pair<size_t, size_t>> jumps; // Target and program counter of every jump
+			for( size_t pc = 0; pc < code.size( ); ++pc ) {
+				auto const &instruction = code[pc];
+				auto const jump = [&]( int32_t target ) { jumps.emplace_back( static_cast<size_t>( target ), pc ); };
+				switch( instruction.op ) {
+				case OpCode::JUMP:
+				case OpCode::JUMP_IF_FALSE:
+				case OpCode::SHORT_CIRCUIT:
+				case OpCode::COMPARE_AND_JUMP:
+				case OpCode::GOSUB:
+					jump( instruction.a );
 					break;
-				case ValueType::REAL:
-					result = to_numeric( lhs ) >= to_numeric( rhs );
+				case OpCode::BRANCH_UNBOXED:
+					jump( instruction.a );
+					jump( instruction.b );
 					break;
-				case ValueType::STRING:
-					result = 0 >= to_string( lhs ).compare( to_string( rhs ) );
+				case OpCode::LOAD_INTEGER:
+				case OpCode::LOAD_REAL:
+				case OpCode::INTEGER_OPERATOR:
+				case OpCode::STORE_INTEGER:
+				case OpCode::STORE_REAL:
+				case OpCode::FOR_LOOP:
+					jump( instruction.b );
 					break;
-				case ValueType::ARRAY:
-					throw create_basic_exception( ErrorTypes::FATAL, "Unknown ValueType" );
 				default:
-					throw std::exception{};
+					break;
 				}
-				return basic_value_boolean( result );
-			};
-
-			m_binary_operators["AND"] = [&]( BasicValue lhs, BasicValue rhs ) {
-				return basic_value_boolean( to_boolean( lhs ) && to_boolean( rhs ) );
-			};
-
-			m_binary_operators["OR"] = [&]( BasicValue lhs, BasicValue rhs ) {
-				return basic_value_boolean( to_boolean( lhs ) || to_boolean( rhs ) );
-			};
-
-			//////////////////////////////////////////////////////////////////////////
-			// Unary Operators
-			//////////////////////////////////////////////////////////////////////////
-
-			m_unary_operators["NEG"] = [&]( BasicValue lhs ) {
-				if( ValueType::INTEGER == lhs.first ) {
-					return basic_value_integer( -to_integer( lhs ) );
-				} else if( ValueType::REAL == lhs.first ) {
-					return basic_value_real( -to_real( lhs ) );
+			}
+			for( size_t for_pc = 0; for_pc < code.size( ); ++for_pc ) {
+				if( OpCode::FOR_LOOP != code[for_pc].op ) {
+					continue;
 				}
-				throw create_basic_exception( ErrorTypes::SYNTAX, "Attempt to apply a negative sign to a non-number" );
-			};
-
-			//////////////////////////////////////////////////////////////////////////
-			// Functions
-			//////////////////////////////////////////////////////////////////////////
-			// Mathematical
-			//////////////////////////////////////////////////////////////////////////
-
-			add_function( "COS", "COS( Angle ) -> Returns the cosine of angle in radians",
-			              [&]( std::vector<BasicValue> value ) {
-				              if( 1 != value.size( ) ) {
-					              throw create_basic_exception( ErrorTypes::SYNTAX, "COS requires 1 parameter" );
-				              }
-				              return basic_value_real( cos( to_numeric( value[0] ) ) );
-			              } );
-
-			add_function( "SIN", "SIN( Angle ) -> Returns the sine of angle in radians",
-			              [&]( std::vector<BasicValue> value ) {
-				              if( 1 != value.size( ) ) {
-					              throw create_basic_exception( ErrorTypes::SYNTAX, "SIN requires 1 parameter" );
-				              }
-				              auto dbl_param = to_numeric( value[0] );
-				              auto result = sin( dbl_param );
-				              return basic_value_real( std::move( result ) );
-			              } );
-
-			add_function( "TAN", "TAN( Angle ) -> Returns the tangent of angle in radians",
-			              [&]( std::vector<BasicValue> value ) {
-				              if( 1 != value.size( ) ) {
-					              throw create_basic_exception( ErrorTypes::SYNTAX, "TAN requires 1 parameter" );
-				              }
-				              auto dbl_param = to_numeric( value[0] );
-				              auto result = tan( dbl_param );
-				              return basic_value_real( std::move( result ) );
-			              } );
-
-			add_function( "ATN", "ATN( Angle ) -> Returns the arctangent of angle in radians",
-			              [&]( std::vector<BasicValue> value ) {
-				              if( 1 != value.size( ) ) {
-					              throw create_basic_exception( ErrorTypes::SYNTAX, "ATN requires 1 parameter" );
-				              }
-				              auto dbl_param = to_numeric( value[0] );
-				              auto result = atan( dbl_param );
-				              return basic_value_real( std::move( result ) );
-			              } );
-
-			add_function( "EXP", "EXP( Exponent ) -> Resturn e raised to the power of exponent. Where e = 2.71828183...",
-			              [&]( std::vector<BasicValue> value ) {
-				              if( 1 != value.size( ) ) {
-					              throw create_basic_exception( ErrorTypes::SYNTAX, "EXP requires 1 parameter" );
-				              }
-				              auto dbl_param = to_numeric( value[0] );
-				              auto result = exp( dbl_param );
-				              return basic_value_real( std::move( result ) );
-			              } );
-
-			add_function( "LOG", "LOG( x ) -> Returns the natural logarithm of x", [&]( std::vector<BasicValue> value ) {
-				if( 1 != value.size( ) ) {
-					throw create_basic_exception( ErrorTypes::SYNTAX, "LOG requires 1 parameter" );
-				}
-				auto dbl_param = to_numeric( value[0] );
-				auto result = log( dbl_param );
-				return basic_value_real( std::move( result ) );
-			} );
+				auto const counter = code[for_pc].a;
+				auto const next_pc = static_cast<size_t>( code[for_pc].b ) - 1;
+				auto const inside = [&]( size_t pc ) { return for_pc < pc && pc <= next_pc; };
+				auto hoistable = std::none_of( std::begin( jumps ), std::end( jumps ), [&]( auto const &jump ) {
+					return inside( jump.first ) && !inside( jump.second );
+				} );
+				// A NEXT elsewhere would find this loop by its counter and continue the body
+				for( size_t pc = 0; hoistable && pc < code.size( ); ++pc ) {
+					hoistable = OpCode::NEXT_LOOP != code[pc].op || counter != code[pc].a || pc == next_pc;
+				}
+				std::vector<size_t> accesses;
+				for( auto pc = for_pc + 1; hoistable && pc < next_pc; ++pc ) {
+					auto const &instruction = code[pc];
+					switch( instruction.op ) {
+					case OpCode::STORE_VARIABLE:
+					case OpCode::STORE_INTEGER:
+					case OpCode::STORE_REAL:
+					case OpCode::INCREMENT_VARIABLE:
+					case OpCode::DECREMENT_VARIABLE:
+					case OpCode::FOR_LOOP:
+						hoistable = counter != instruction.a;
+						break;
+					case OpCode::GOSUB:
+					case OpCode::KEYWORD:
+					case OpCode::USER_KEYWORD:
+						hoistable = false;
+						break;
+					case OpCode::LOAD_ELEMENT:
+					case OpCode::STORE_ELEMENT:
+						if( counter == instruction.b ) {
+							accesses.push_back( pc );
+						}
+						break;
+					default:
+						break;
+					}
+				}
+				if( !hoistable || accesses.empty( ) ) {
+					continue;
+				}
+				for( auto const pc : accesses ) {
+					auto &op = code[pc].op;
+					op = OpCode::LOAD_ELEMENT == op ? OpCode::LOAD_IN_BOUNDS : OpCode::STORE_IN_BOUNDS;
+				}
+				m_compiled.hoisted[for_pc] = std::move( accesses );
+			}
+		}
 
-			add_function( "SQR", "SQR( x ) -> Returns the square root of x", [&]( std::vector<BasicValue> value ) {
-				if( 1 != value.size( ) ) {
-					throw create_basic_exception( ErrorTypes::SYNTAX, "SQRT requires 1 parameter" );
+		//////////////////////////////////////////////////////////////////////////
+		/// summary: Before the FOR at for_pc pops its start, limit and step from
+		/// stack, find the arrays its counter stays in the bounds of.  The
+		/// elements of the others, or of a counter that is not an integer, are
+		/// checked like LOAD_ELEMENT and STORE_ELEMENT do
+		void Basic::check_hoisted_bounds( size_t for_pc, std::vector<BasicValue> const &stack ) {
+			auto const hoisted = m_compiled.hoisted.find( for_pc );
+			if( std::end( m_compiled.hoisted ) == hoisted ) {
+				return;
+			}
+			auto const &start = stack[stack.size( ) - 3];
+			auto const &limit = stack[stack.size( ) - 2];
+			auto const &step = stack.back( );
+			auto const integers = ValueType::INTEGER == start.type( ) && ValueType::INTEGER == limit.type( ) &&
+			                      ValueType::INTEGER == step.type( );
+			for( auto const pc : hoisted->second ) {
+				BasicArray *checked = nullptr;
+				auto const array = m_arrays.find( m_compiled.names[static_cast<size_t>( m_compiled.code[pc].a )] );
+				if( integers && std::end( m_arrays ) != array ) {
+					BasicArray::Indexes const lowest{{{std::min( start.integer_value( ), limit.integer_value( ) )}}, 1};
+					BasicArray::Indexes const highest{{{std::max( start.integer_value( ), limit.integer_value( ) )}}, 1};
+					size_t pos = 0;
+					if( array->second.offset( lowest, pos ) && array->second.offset( highest, pos ) ) {
+						checked = &array->second;
+					}
 				}
-				auto dbl_param = to_numeric( value[0] );
-				auto result = sqrt( dbl_param );
-				return basic_value_real( std::move( result ) );
-			} );
+				m_hoisted[pc] = checked;
+			}
+		}
 
-			add_function( "SQUARE", "SQUARE( x ) -> Returns x squared", [&]( std::vector<BasicValue> value ) {
-				if( 1 != value.size( ) ) {
-					throw create_basic_exception( ErrorTypes::SYNTAX, "SQR requires 1 parameter" );
+		//////////////////////////////////////////////////////////////////////////
+		/// summary: Run an instruction that only works on the value stack
+		void Basic::execute_instruction( CompiledProgram const &program, bytecode::Instruction instruction,
+		                                 std::vector<BasicValue> &stack ) {
+			using bytecode::OpCode;
+			switch( instruction.op ) {
+			case OpCode::PUSH_CONSTANT:
+				stack.push_back( program.constants[static_cast<size_t>( instruction.a )] );
+				break;
+			case OpCode::LOAD_VARIABLE: {
+				auto const &variable = m_variables[static_cast<size_t>( instruction.a )];
+				if( !variable.is_set ) {
+					throw create_basic_exception( ErrorTypes::SYNTAX,
+					                              "Unknown symbol '" + m_symbols[static_cast<size_t>( instruction.a )] + "'" );
 				}
-				if( ValueType::INTEGER == value[0].first ) {
-					auto int_param = to_integer( value[0] );
-					int_param *= int_param;
-					return basic_value_integer( std::move( int_param ) );
-				} else {
-					auto dbl_param = to_numeric( value[0] );
-					dbl_param *= dbl_param;
-					return basic_value_real( std::move( dbl_param ) );
+				stack.push_back( variable.value );
+			} break;
+			case OpCode::LOAD_ARRAY: {
+				auto const count = static_cast<size_t>( instruction.b );
+				if( 0 == count ) {
+					// The argument of a function taking arrays
+					auto const &array = find_array( program.names[static_cast<size_t>( instruction.a )] );
+					stack.push_back( BasicValue::array_reference( &array ) );
+					break;
 				}
-			} );
-
-			add_function( "ABS", "ABS( x ) -> Returns the absolute value of x", [&]( std::vector<BasicValue> value ) {
-				if( 1 != value.size( ) ) {
-					throw create_basic_exception( ErrorTypes::SYNTAX, "SIN requires 1 parameter" );
+				// The indexes are read in place on the stack, then replaced by the element
+				auto const first = stack.size( ) - count;
+				auto value =
+				  get_array_variable( program.names[static_cast<size_t>( instruction.a )], stack.data( ) + first, count );
+				stack.resize( first );
+				stack.push_back( std::move( value ) );
+			} break;
+			case OpCode::STORE_VARIABLE: {
+				auto &variable = m_variables[static_cast<size_t>( instruction.a )];
+				variable.value = pop( stack );
+				variable.is_set = true;
+			} break;
+			case OpCode::STORE_ARRAY: {
+				auto value = pop( stack );
+				auto const count = static_cast<size_t>( instruction.b );
+				auto const first = stack.size( ) - count;
+				set_array_variable( program.names[static_cast<size_t>( instruction.a )], stack.data( ) + first, count,
+				                    std::move( value ) );
+				stack.resize( first );
+			} break;
+			case OpCode::LOAD_ELEMENT:
+			case OpCode::LOAD_IN_BOUNDS: {
+				auto const &name = program.names[static_cast<size_t>( instruction.a )];
+				auto value = get_array_element( name, static_cast<uint32_t>( instruction.b ) );
+				stack.push_back( std::move( value ) );
+			} break;
+			case OpCode::STORE_ELEMENT:
+			case OpCode::STORE_IN_BOUNDS: {
+				auto const &name = program.names[static_cast<size_t>( instruction.a )];
+				set_array_element( name, static_cast<uint32_t>( instruction.b ), pop( stack ) );
+			} break;
+			case OpCode::INCREMENT_VARIABLE:
+			case OpCode::DECREMENT_VARIABLE: {
+				auto &variable = m_variables[static_cast<size_t>( instruction.a )];
+				if( !variable.is_set ) {
+					throw create_basic_exception( ErrorTypes::SYNTAX,
+					                              "Unknown symbol '" + m_symbols[static_cast<size_t>( instruction.a )] + "'" );
 				}
-				if( ValueType::INTEGER == value[0].first ) {
-					auto int_param = to_integer( value[0] );
-					if( 0 > int_param ) {
-						int_param = -int_param;
-					}
-					return basic_value_integer( std::move( int_param ) );
+				auto const oper = OpCode::INCREMENT_VARIABLE == instruction.op ? Operator::ADD : Operator::SUBTRACT;
+				if( ValueType::INTEGER == variable.value.type( ) ) {
+					variable.value = apply_integer_operator( oper, variable.value.integer_value( ), instruction.b );
 				} else {
-					auto dbl_param = to_numeric( value[0] );
-					auto result = fabs( dbl_param );
-					return basic_value_real( std::move( result ) );
+					variable.value = apply_operator( oper, variable.value, basic_value_integer( instruction.b ) );
 				}
-			} );
-
-			add_function( "SGN", "SGN( x ) -> Returns the sign of x ( -1 for negative, 0 for 0, and 1 for positive)",
-			              [&]( std::vector<BasicValue> value ) {
-				              if( 1 != value.size( ) ) {
-					              throw create_basic_exception( ErrorTypes::SYNTAX, "SGN requires 1 parameter" );
-				              }
-				              auto result = to_numeric( value[0] );
-				              if( 0 < result ) {
-					              result = 1;
-				              } else if( 0 > result ) {
-					              result = -1;
-				              } else {
-					              result = 0;
-				              }
-				              if( ValueType::INTEGER == value[0].first ) {
-					              return basic_value_integer( static_cast<integer>( result ) );
-				              }
-				              return basic_value_real( result );
-			              } );
-
-			add_function( "INT", "INT( x ) -> Returns x truncated to the greatest integer less or equal",
-			              [&]( std::vector<BasicValue> value ) {
-				              if( 1 != value.size( ) ) {
-					              throw create_basic_exception( ErrorTypes::SYNTAX, "INT requires 1 parameter" );
-				              }
-				              if( ValueType::INTEGER == value[0].first ) {
-					              return value[0];
-				              }
+			} break;
+			case OpCode::CALL_FUNCTION: {
+				auto const &function = *program.functions[static_cast<size_t>( instruction.a )];
+				auto result = function.func( pop_values( stack, instruction.b ) );
+				stack.push_back( std::move( result ) );
+			} break;
+			case OpCode::UNARY_OPERATOR:
+				stack.back( ) = apply_operator( static_cast<Operator>( instruction.a ), stack.back( ) );
+				break;
+			case OpCode::BINARY_OPERATOR: {
+				auto &lhs = stack[stack.size( ) - 2];
+				lhs = apply_operator( static_cast<Operator>( instruction.a ), lhs, stack.back( ) );
+				stack.pop_back( );
+			} break;
+			case OpCode::DUPLICATE: {
+				auto value = stack.back( );
+				stack.push_back( std::move( value ) );
+			} break;
+			case OpCode::TO_BOOLEAN:
+				stack.back( ) = basic_value_boolean( to_boolean( stack.back( ) ) );
+				break;
+			case OpCode::USER_OPERATOR: {
+				auto const &oper = *program.binary_operators[static_cast<size_t>( instruction.a )];
+				auto rhs = pop( stack );
+				auto result = oper( std::move( stack.back( ) ), std::move( rhs ) );
+				stack.back( ) = std::move( result );
+			} break;
+			default:
+				throw create_basic_exception( ErrorTypes::FATAL, "Unexpected instruction in expression" );
+			}
+		}
 
-				              auto result = to_real( value[0] );
-				              result = round( result - 0.5 );
-				              return basic_value_integer( static_cast<integer>( result ) );
-			              } );
+		//////////////////////////////////////////////////////////////////////////
+		/// summary: Run the code of an expression.  Its only jumps are those of
+		/// SHORT_CIRCUIT, which stay inside it
+		void Basic::execute_expression( CompiledProgram const &program, size_t first, size_t last ) {
+			for( auto pc = first; pc != last; ++pc ) {
+				auto const &instruction = program.code[pc];
+				if( bytecode::OpCode::SHORT_CIRCUIT != instruction.op ) {
+					execute_instruction( program, instruction, m_evaluation_stack );
+				} else if( short_circuits( static_cast<Operator>( instruction.b ), m_evaluation_stack ) ) {
+					pc = static_cast<size_t>( instruction.a ) - 1;
+				}
+			}
+		}
 
-			add_function( "RND",
-			              "RND( [s] ) -> Returns a random number between 0.0 and 1.0.  An optional seed can be specified",
-			              [&]( std::vector<BasicValue> value ) -> BasicValue {
-				              if( 1 >= value.size( ) ) {
-					              throw create_basic_exception( ErrorTypes::SYNTAX, "INT requires 1 or 0 parameters" );
-				              }
-				              throw create_basic_exception( ErrorTypes::SYNTAX, "Not implemented" );
-				              // 				if( ValueType::INTEGER == value[0].first ) {
-				              // 					return value[0];
-				              // 				}
-				              //
-				              // 				auto result = to_real( value[0] );
-				              // 				result = round( result - 0.5 );
-				              // 				return basic_value_integer( static_cast<integer>(result) );
-			              } );
-
-			add_function( "NEG", "NEG( x ) -> Returns the negated number", [&]( std::vector<BasicValue> values ) {
-				if( 1 != values.size( ) ) {
-					throw create_basic_exception( ErrorTypes::SYNTAX, "NEG requires 1 parameter" );
-				}
-				const BasicValue zero = basic_value_integer( 0 );
-				return m_binary_operators["-"]( zero, values[0] );
-			} );
+		//////////////////////////////////////////////////////////////////////////
+		/// summary: Evaluate tokens onto m_evaluation_stack and return the number
+		/// of values left there.  Tokens of program lines are compiled once and
+		/// kept in m_expressions until their line changes, others are compiled
+		/// each time
+		size_t Basic::evaluate_compiled( StatementTokens tokens, ExpressionKind kind ) {
+			auto const stack_size = m_evaluation_stack.size( );
+			try {
+				auto const line_number = tokens.line->number;
+				if( 0 > line_number ) {
+					CompiledProgram program;
+					Compiler( *this, program, line_number ).compile( tokens, kind );
+					execute_expression( program, 0, program.code.size( ) );
+					return m_evaluation_stack.size( ) - stack_size;
+				}
+				auto &entries = m_expressions.lines[line_number];
+				auto entry = std::find_if( std::begin( entries ), std::end( entries ), [&]( ExpressionCache::Entry const &e ) {
+					return e.first_token == tokens.first && e.last_token == tokens.last && e.kind == kind;
+				} );
+				ExpressionCache::Entry current;
+				if( std::end( entries ) != entry ) {
+					current = *entry;
+				} else {
+					auto &code = m_expressions.program.code;
+					current = ExpressionCache::Entry{tokens.first, tokens.last, kind, code.size( ), code.size( )};
+					try {
+						Compiler( *this, m_expressions.program, line_number ).compile( tokens, kind );
+					} catch( ... ) {
+						code.erase( std::begin( code ) + static_cast<std::ptrdiff_t>( current.first_pc ), std::end( code ) );
+						throw;
+					}
+					current.last_pc = code.size( );
+					entries.push_back( current );
+				}
+				execute_expression( m_expressions.program, current.first_pc, current.last_pc );
+			} catch( ... ) {
+				m_evaluation_stack.erase( std::begin( m_evaluation_stack ) + static_cast<std::ptrdiff_t>( stack_size ),
+				                          std::end( m_evaluation_stack ) );
+				throw;
+			}
+			return m_evaluation_stack.size( ) - stack_size;
+		}
 
-			add_function( "POW", "POW( base, exponent ) -> Returns base raised to the power exponent",
-			              [&]( std::vector<BasicValue> value ) {
-				              if( 2 != value.size( ) ) {
-					              throw create_basic_exception( ErrorTypes::SYNTAX, "POW requires 2 parameters" );
-				              }
-				              if( ValueType::INTEGER == determine_result_type( value[0].first, value[1].first ) ) {
-					              auto int_param1 = to_integer( value[0] );
-					              auto int_param2 = to_integer( value[1] );
-					              auto result = static_cast<integer>( pow( std::move( int_param1 ), std::move( int_param2 ) ) );
-					              return basic_value_integer( std::move( result ) );
-				              } else {
-					              auto result = pow( to_numeric( value[0] ), to_numeric( value[1] ) );
-					              return basic_value_real( std::move( result ) );
-				              }
-			              } );
-			//////////////////////////////////////////////////////////////////////////
-			// Logical
-			//////////////////////////////////////////////////////////////////////////
+		BasicValue Basic::evaluate( StatementTokens expression ) {
+			if( expression.empty( ) ) {
+				return EMPTY_BASIC_VALUE( );
+			}
+			evaluate_compiled( expression, ExpressionKind::VALUE );
+			return pop( m_evaluation_stack );
+		}
 
-			add_function( "NOT", "Boolean negation", [&]( std::vector<BasicValue> value ) {
-				if( 1 != value.size( ) ) {
-					throw create_basic_exception( ErrorTypes::SYNTAX, "NOT requires 1 parameter" );
-				}
-				return basic_value_boolean( !to_boolean( value[0] ) );
-			} );
+		std::vector<BasicValue> Basic::evaluate_parameters( StatementTokens parameters ) {
+			// Parameters are separated by comma's
+			auto const count = evaluate_compiled( parameters, ExpressionKind::LIST );
+			return pop_values( m_evaluation_stack, static_cast<int32_t>( count ) );
+		}
 
-			//////////////////////////////////////////////////////////////////////////
-			// Character and String Processing
-			//////////////////////////////////////////////////////////////////////////
+		bool Basic::let_helper( StatementTokens statement ) {
+			evaluate_compiled( statement, ExpressionKind::ASSIGNMENT );
+			return true;
+		}
 
-			add_function( "LEN", "LEN( s ) -> Returns the length of string s", [&]( std::vector<BasicValue> value ) {
-				if( 1 != value.size( ) ) {
-					throw create_basic_exception( ErrorTypes::SYNTAX, "LEN requires 1 parameter" );
-				} else if( ValueType::STRING != get_value_type( value[0] ) ) {
-					throw create_basic_exception( ErrorTypes::SYNTAX, "LEN only works on string data" );
-				}
-				auto str_value = to_string( value[0] );
-				assert( can_fit<daw::basic::integer>( str_value.size( ) ) );
-				return basic_value_integer( static_cast<daw::basic::integer>( str_value.size( ) ) );
-			} );
+		void Basic::ExpressionCache::clear( ) {
+			program.clear( );
+			lines.clear( );
+		}
 
-			add_function(
-			  "LEFT$", "LEFT$( string, len ) -> Returns the left side of the string up to len characters long",
-			  [&]( std::vector<BasicValue> value ) {
-				  if( 2 != value.size( ) ) {
-					  throw create_basic_exception( ErrorTypes::SYNTAX, "LEFT$ requires 2 parameters" );
-				  } else if( ValueType::STRING != get_value_type( value[0] ) ) {
-					  throw create_basic_exception( ErrorTypes::SYNTAX, "The first parameter of LEFT$ must be a string" );
-				  } else if( ValueType::INTEGER != get_value_type( value[1] ) ) {
-					  throw create_basic_exception( ErrorTypes::SYNTAX, "The second parameter of LEFT$ must be an integer" );
-				  }
-				  auto len = [&]( ) {
-					  auto result = to_integer( value[1] );
-					  if( 0 > result ) {
-						  throw create_basic_exception( ErrorTypes::SYNTAX, "The len parameter of LEFT$ must be positive" );
-					  }
-					  assert( can_fit<size_t>( result ) );
-					  return static_cast<size_t>( result );
-				  }( );
-				  return basic_value_string( to_string( value[0] ).substr( 0, std::move( len ) ) );
-			  } );
-
-			add_function(
-			  "RIGHT$", "RIGHT$( string, len ) -> Returns the right side of the string up to len characters long",
-			  [&]( std::vector<BasicValue> value ) {
-				  if( 2 != value.size( ) ) {
-					  throw create_basic_exception( ErrorTypes::SYNTAX, "RIGHT$ requires 2 parameters" );
-				  } else if( ValueType::STRING != get_value_type( value[0] ) ) {
-					  throw create_basic_exception( ErrorTypes::SYNTAX, "The first parameter of RIGHT$ must be a string" );
-				  } else if( ValueType::INTEGER != get_value_type( value[1] ) ) {
-					  throw create_basic_exception( ErrorTypes::SYNTAX, "The second parameter of RIGHT$ must be an integer" );
-				  }
-				  auto str_value = to_string( value[0] );
-				  auto start = [&]( ) {
-					  auto result = to_integer( value[1] );
-					  if( 0 > result ) {
-						  throw create_basic_exception( ErrorTypes::SYNTAX, "The len parameter of RIGHT$ must be positive" );
-					  }
-					  assert( can_fit<size_t>( result ) );
-					  return static_cast<size_t>( result );
-				  }( );
-				  start = str_value.size( ) - start;
-				  return basic_value_string( str_value.substr( start ) );
-			  } );
-
-			add_function(
-			  "MID$", "MID$( string, start, len ) -> Returns the middle of the string from start up to len characters long",
-			  [&]( std::vector<BasicValue> value ) {
-				  if( 3 != value.size( ) ) {
-					  throw create_basic_exception( ErrorTypes::SYNTAX, "MID$ requires 3 parameters" );
-				  } else if( ValueType::STRING != get_value_type( value[0] ) ) {
-					  throw create_basic_exception( ErrorTypes::SYNTAX, "The first parameter of MID$ must be a string" );
-				  } else if( ValueType::INTEGER != get_value_type( value[1] ) ||
-				             ValueType::INTEGER != get_value_type( value[2] ) ) {
-					  throw create_basic_exception( ErrorTypes::SYNTAX,
-					                                "The parameters start and len of MID$ must be an integer" );
-				  }
-
-				  auto start = [&]( ) {
-					  auto result = to_integer( std::move( value[1] ) );
-					  if( 0 > result ) {
-						  throw create_basic_exception( ErrorTypes::SYNTAX,
-						                                "The start parameter of MID$ must be greater than zero" );
-					  }
-					  --result; // BASIC arrays start at 1
-					  assert( can_fit<size_t>( result ) );
-					  return static_cast<size_t>( result );
-				  }( );
-
-				  auto len = [&]( ) {
-					  auto result = to_integer( std::move( value[2] ) );
-					  if( 0 > result ) {
-						  throw create_basic_exception( ErrorTypes::SYNTAX, "The len parameter of MID$ must be positive" );
-					  }
-					  assert( can_fit<size_t>( result ) );
-					  return static_cast<size_t>( result );
-				  }( );
-				  return basic_value_string( to_string( std::move( value[0] ) ).substr( start, len ) );
-			  } );
-
-			add_function( "STR$", "STR$( x ) -> Converts a number to a string", [&]( std::vector<BasicValue> value ) {
-				if( 1 != value.size( ) ) {
-					throw create_basic_exception( ErrorTypes::SYNTAX, "STR$ requires 1 parameter" );
-				} else if( ValueType::INTEGER != get_value_type( value[0] ) && ValueType::REAL != get_value_type( value[0] ) ) {
-					throw create_basic_exception( ErrorTypes::SYNTAX, "STR$ only works on numeric data" );
-				}
-				return basic_value_string( to_string( std::move( value[0] ) ) );
-			} );
+		void Basic::ExpressionCache::invalidate( integer line_number ) {
+			lines.erase( line_number );
+			if( lines.empty( ) ) {
+				program.clear( );
+			}
+		}
 
-			add_function( "VAL", "VAL( s ) -> Converts a string to a number", [&]( std::vector<BasicValue> value ) {
-				if( 1 != value.size( ) ) {
-					throw create_basic_exception( ErrorTypes::SYNTAX, "VAL requires 1 parameter" );
-				} else if( ValueType::STRING != get_value_type( value[0] ) ) {
-					throw create_basic_exception( ErrorTypes::SYNTAX, "VAL only works on string data" );
-				}
-				auto str_value = to_string( value[0] );
-				switch( get_value_type( str_value ) ) {
-				case ValueType::INTEGER:
-					return basic_value_integer( to_integer( std::move( str_value ) ) );
-				case ValueType::REAL:
-					return basic_value_real( to_real( std::move( str_value ) ) );
-				case ValueType::ARRAY:
-				case ValueType::BOOLEAN:
-				case ValueType::EMPTY:
-				case ValueType::STRING:
-					throw create_basic_exception( ErrorTypes::SYNTAX, "Attempt to convert a string of non-numbers to a number" );
-				default:
-					throw std::exception{};
-				}
-			} );
+		//////////////////////////////////////////////////////////////////////////
+		/// summary: Forget the compiled expressions of every line.  Needed when
+		/// a function or constant that they may have resolved changes
+		void Basic::invalidate_expressions( ) {
+			m_expressions.clear( );
+		}
 
-			add_function( "ASC", "ASC( s ) -> Returns the ASCII code of the first character of a string",
-			              [&]( std::vector<BasicValue> value ) {
-				              if( 1 != value.size( ) ) {
-					              throw create_basic_exception( ErrorTypes::SYNTAX, "ASC requires 1 parameter" );
-				              } else if( ValueType::STRING != get_value_type( value[0] ) ) {
-					              throw create_basic_exception( ErrorTypes::SYNTAX, "ASC only works on string data" );
-				              }
-				              auto chr_value = to_string( value[0] )[0];
-				              assert( can_fit<integer>( chr_value ) );
-				              return basic_value_integer( static_cast<integer>( chr_value ) );
-			              } );
-
-			add_function( "CHR$", "CHR$( x ) -> Returns a string with the character of the specified ASCII code",
-			              [&]( std::vector<BasicValue> value ) {
-				              if( 1 != value.size( ) ) {
-					              throw create_basic_exception( ErrorTypes::SYNTAX, "CHR$ requires 1 parameter" );
-				              } else if( ValueType::INTEGER != get_value_type( value[0] ) ) {
-					              throw create_basic_exception( ErrorTypes::SYNTAX, "CHR$ only works on integer data" );
-				              }
-				              auto ascii_code = to_integer( value[0] );
-				              if( 0 > ascii_code || 255 < ascii_code ) {
-					              throw create_basic_exception( ErrorTypes::SYNTAX,
-					                                            "Specified ASCII code must be between 0 and 255 inclusive" );
-				              }
-				              assert( can_fit<char>( ascii_code ) );
-				              return basic_value_string( char_to_string( static_cast<char>( ascii_code ) ) );
-			              } );
-
-			// 			add_function( "SPLIT$", "SPLIT$( string, delimiter ) -> Returns an array of strings from the original string
-			// delimited by delimiter", [&]( std::vector<BasicValue> value ) { 				if( 2 != value.size( ) ) {
-			// 					throw CreateError( ErrorTypes::SYNTAX, "SPLIT$ requires 2 parameters" );
-			// 				} else if( ValueType::STRING != get_value_type( value[0] ) || ValueType::STRING != get_value_type( value[1]
-			// ) ) { 					throw CreateError( ErrorTypes::SYNTAX, "SPLIT$ requires string parameters" );
-			// 				}
-			// 				auto str_string = to_string( value[0] );
-			// 				auto str_delim = to_string( value[1] );
-			// 				auto result = split( std::move( str_string ), std::move( str_delim ) );
-			// 				return basic_value_array( std::move( result ) );
-			// 			} );
+		//////////////////////////////////////////////////////////////////////////
+		/// summary: Forget the compiled expressions of a line that was edited
+		void Basic::invalidate_expressions( integer line_number ) {
+			m_expressions.invalidate( line_number );
+		}
 
-			//////////////////////////////////////////////////////////////////////////
-			// Keywords
-			//////////////////////////////////////////////////////////////////////////
+		//////////////////////////////////////////////////////////////////////////
+		/// summary: Run the compiled program starting at pc with the dispatch
+		/// chosen by set_dispatch_mode
+		bool Basic::execute( size_t pc ) {
+#if defined( DAW_BASIC_THREADED_DISPATCH )
+			if( DispatchMode::THREADED == m_dispatch_mode ) {
+				return execute_code<true>( pc );
+			}
+#endif
+			return execute_code<false>( pc );
+		}
 
-			m_keywords["NEW"] = [&]( boost::string_ref ) {
-				reset( );
-				return true;
+// Every handler ends by going to the next instruction.  Threaded dispatch
+// jumps from there straight to the handler of the next instruction so that
+// each handler has an indirect branch of its own to predict, otherwise the
+// switch at the top of the loop is used.  DAW_BASIC_NEXT must not be used
+// inside a block that has locals
+#if defined( DAW_BASIC_THREADED_DISPATCH )
+#define DAW_BASIC_HANDLER( name ) \
+	case OpCode::name:              \
+		handler_##name
+#define DAW_BASIC_NEXT( )                                        \
+	if( threaded ) {                                               \
+		instruction = &code[pc++];                                   \
+		goto *handlers[static_cast<size_t>( instruction->op )];      \
+	}                                                              \
+	continue
+#else
+#define DAW_BASIC_HANDLER( name ) case OpCode::name
+#define DAW_BASIC_NEXT( ) continue
+#endif
+
+		template<bool threaded>
+		bool Basic::execute_code( size_t pc ) {
+			using bytecode::OpCode;
+			auto const &code = m_compiled.code;
+			std::vector<BasicValue> stack;
+			std::vector<UnboxedValue> unboxed;
+			std::vector<size_t> return_stack;
+			stack.reserve( 64 );
+			unboxed.reserve( 64 );
+
+			// A guard of unboxed code failed.  Run the tagged code after it instead
+			auto const fall_back = [&]( int32_t tagged ) {
+				unboxed.clear( );
+				pc = static_cast<size_t>( tagged );
 			};
 
-			m_keywords["CLR"] = [&]( boost::string_ref parse_string ) {
-				parse_string = trim( parse_string );
-				if( parse_string.empty( ) ) {
-					clear_variables( );
-				} else {
-					remove_variable( parse_string );
-				}
-				return true;
+			// TIERED mode reached a statement that is not compiled.  The interpreter
+			// continues from it once execute_code returns
+			auto const leave = [&]( ProgramType::iterator line, size_t token ) {
+				m_program_it = line;
+				m_resume_token = token;
+				m_tier.exited = true;
 			};
 
-			m_keywords["DELETE"] = [&]( boost::string_ref parse_string ) {
-				if( ValueType::INTEGER != get_value_type( parse_string ) ) {
-					throw create_basic_exception( ErrorTypes::SYNTAX,
-					                              "DELETE requires an INTEGER parameter for the line number to delete" );
-				}
-				remove_line( to_integer( parse_string ) );
-				return true;
+#if defined( DAW_BASIC_THREADED_DISPATCH )
+			// In the same order as OpCode
+			static void *const handlers[] = {
+			  &&handler_LINE, &&handler_PUSH_CONSTANT, &&handler_LOAD_VARIABLE, &&handler_LOAD_ARRAY,
+			  &&handler_STORE_VARIABLE, &&handler_STORE_ARRAY, &&handler_CALL_FUNCTION, &&handler_UNARY_OPERATOR,
+			  &&handler_BINARY_OPERATOR, &&handler_USER_OPERATOR, &&handler_DUPLICATE, &&handler_PRINT,
+			  &&handler_PRINT_NEWLINE, &&handler_JUMP, &&handler_JUMP_IF_FALSE, &&handler_SHORT_CIRCUIT, &&handler_TO_BOOLEAN,
+			  &&handler_GOTO, &&handler_GOSUB, &&handler_RETURN, &&handler_FOR_LOOP, &&handler_NEXT_LOOP,
+			  &&handler_LOAD_INTEGER, &&handler_LOAD_REAL, &&handler_PUSH_INTEGER, &&handler_PUSH_REAL,
+			  &&handler_INTEGER_OPERATOR, &&handler_REAL_OPERATOR, &&handler_DUPLICATE_UNBOXED, &&handler_STORE_INTEGER,
+			  &&handler_STORE_REAL, &&handler_BRANCH_UNBOXED, &&handler_INCREMENT_VARIABLE, &&handler_DECREMENT_VARIABLE,
+			  &&handler_COMPARE_AND_JUMP, &&handler_LOAD_ELEMENT, &&handler_STORE_ELEMENT, &&handler_PRINT_VARIABLE,
+			  &&handler_LOAD_IN_BOUNDS, &&handler_STORE_IN_BOUNDS, &&handler_TIERED_GOSUB, &&handler_TIERED_RETURN,
+			  &&handler_EXIT_TO_LINE, &&handler_KEYWORD, &&handler_USER_KEYWORD, &&handler_STOP, &&handler_END};
+			static_assert( sizeof( handlers ) / sizeof( handlers[0] ) == static_cast<size_t>( OpCode::END ) + 1,
+			               "handlers must match OpCode" );
+#endif
+
+			bytecode::Instruction const *instruction = nullptr;
+
+			// A loop jumped back to its start.  Once the start is hot the loop runs
+			// as machine code when the JIT is on, up to where the VM continues
+			auto const loop_back = [&]( size_t target ) {
+				pc = m_jit.enabled && &code[target] <= instruction && stack.empty( ) ? jit_enter( target ) : target;
 			};
 
-			m_keywords["DIM"] = [&]( boost::string_ref parse_string ) {
-				auto var_name_and_param = split_in_two_on_char( parse_string, '(' );
-				if( 2 != var_name_and_param.size( ) ) {
-					throw create_basic_exception( ErrorTypes::SYNTAX, "Could not find parameters surrounded by ( )" );
+			while( pc < code.size( ) ) {
+				instruction = &code[pc++];
+#if defined( DAW_BASIC_THREADED_DISPATCH )
+				if( threaded ) {
+					goto *handlers[static_cast<size_t>( instruction->op )];
 				}
-				var_name_and_param[1] = var_name_and_param[1].substr( 0, find_end_of_bracket( var_name_and_param[1] ) );
-
-				auto params = evaluate_parameters( var_name_and_param[1] );
-				if( 2 < params.size( ) || 1 > params.size( ) ) {
-					throw create_basic_exception( ErrorTypes::SYNTAX,
-					                              "Must specify at least 1 size parameter to DIM and optionally 2" );
+#endif
+				switch( instruction->op ) {
+				DAW_BASIC_HANDLER( LINE ) :
+					m_program_it = std::begin( m_program ) + instruction->a;
+					DAW_BASIC_NEXT( );
+				DAW_BASIC_HANDLER( PUSH_CONSTANT ) :
+					stack.push_back( m_compiled.constants[static_cast<size_t>( instruction->a )] );
+					DAW_BASIC_NEXT( );
+				DAW_BASIC_HANDLER( LOAD_VARIABLE ) : {
+					auto const &variable = m_variables[static_cast<size_t>( instruction->a )];
+					if( !variable.is_set ) {
+						throw create_basic_exception( ErrorTypes::SYNTAX,
+						                              "Unknown symbol '" + m_symbols[static_cast<size_t>( instruction->a )] + "'" );
+					}
+					stack.push_back( variable.value );
 				}
-
-				// 				size_t dim_1 = to_integer( params[0] );
-				// 				size_t dim_2 = 0;
-				// 				if( 2 == params.size( ) ) {
-				// 					dim_2 = to_integer( params[1] );
-				// 				}
-
-				auto var_name = var_name_and_param[0];
-				if( is_keyword( var_name ) || is_function( var_name ) || is_constant( var_name ) ) {
-					throw create_basic_exception( ErrorTypes::SYNTAX,
-					                              "Cannot create an array with the same name as a keyword or function" );
+					DAW_BASIC_NEXT( );
+				DAW_BASIC_HANDLER( STORE_VARIABLE ) : {
+					auto &variable = m_variables[static_cast<size_t>( instruction->a )];
+					variable.value = std::move( stack.back( ) );
+					variable.is_set = true;
+					stack.pop_back( );
 				}
-				if( is_variable( var_name ) ) {
-					// Do error or erase.  check in spec but for now erase
-					remove_variable( var_name );
-				} else if( is_array( var_name ) ) {
-					throw create_basic_exception( ErrorTypes::SYNTAX, "Attempt to Re-DIM an existing array" );
+					DAW_BASIC_NEXT( );
+				DAW_BASIC_HANDLER( BINARY_OPERATOR ) : {
+					auto &lhs = stack[stack.size( ) - 2];
+					lhs = apply_operator( static_cast<Operator>( instruction->a ), lhs, stack.back( ) );
+					stack.pop_back( );
 				}
-				add_array_variable( var_name, params );
-
-				return true;
-			};
-
-			m_keywords["LET"] = [&]( boost::string_ref parse_string ) { return let_helper( parse_string ); };
-
-			m_keywords["STOP"] = [&]( boost::string_ref ) {
-				if( RunMode::IMMEDIATE == m_run_mode ) {
-					throw create_basic_exception( ErrorTypes::SYNTAX, "Attempt to STOP from outside a program" );
+					DAW_BASIC_NEXT( );
+				DAW_BASIC_HANDLER( LOAD_ARRAY ) :
+				DAW_BASIC_HANDLER( STORE_ARRAY ) :
+				DAW_BASIC_HANDLER( LOAD_ELEMENT ) :
+				DAW_BASIC_HANDLER( STORE_ELEMENT ) :
+				DAW_BASIC_HANDLER( INCREMENT_VARIABLE ) :
+				DAW_BASIC_HANDLER( DECREMENT_VARIABLE ) :
+				DAW_BASIC_HANDLER( CALL_FUNCTION ) :
+				DAW_BASIC_HANDLER( UNARY_OPERATOR ) :
+				DAW_BASIC_HANDLER( USER_OPERATOR ) :
+				DAW_BASIC_HANDLER( DUPLICATE ) :
+				DAW_BASIC_HANDLER( TO_BOOLEAN ) :
+					execute_instruction( m_compiled, *instruction, stack );
+					DAW_BASIC_NEXT( );
+				DAW_BASIC_HANDLER( PRINT ) :
+					std::cout << to_string( pop( stack ) ) << "\n";
+					DAW_BASIC_NEXT( );
+				DAW_BASIC_HANDLER( PRINT_VARIABLE ) : {
+					auto const &variable = m_variables[static_cast<size_t>( instruction->a )];
+					if( !variable.is_set ) {
+						throw create_basic_exception( ErrorTypes::SYNTAX,
+						                              "Unknown symbol '" + m_symbols[static_cast<size_t>( instruction->a )] + "'" );
+					}
+					std::cout << to_string( variable.value ) << "\n";
 				}
-				std::cout << "BREAK IN " << m_program_it->first << std::endl;
-				m_exiting = true;
-				return true;
-			};
-
-			m_keywords["CONT"] = [&]( boost::string_ref ) {
-				if( RunMode::DEFERRED == m_run_mode ) {
-					throw create_basic_exception( ErrorTypes::SYNTAX, "Attempt to CONT from inside a program" );
+					DAW_BASIC_NEXT( );
+				DAW_BASIC_HANDLER( LOAD_IN_BOUNDS ) : {
+					// The FOR over the index checked the array when the loop was entered
+					if( auto const array = m_hoisted[pc - 1] ) {
+						auto const index = m_variables[static_cast<size_t>( instruction->b )].value.integer_value( );
+						stack.push_back( array->at( static_cast<size_t>( index ) ) );
+					} else {
+						stack.push_back( get_array_element( m_compiled.names[static_cast<size_t>( instruction->a )],
+						                                    static_cast<uint32_t>( instruction->b ) ) );
+					}
 				}
-				m_basic->m_run_mode = RunMode::DEFERRED;
-				return m_basic->continue_run( );
-			};
-
-			m_keywords["GOTO"] = [&]( boost::string_ref parse_string ) {
-				if( RunMode::IMMEDIATE == m_run_mode ) {
-					throw create_basic_exception( ErrorTypes::SYNTAX, "Attempt to GOTO from outside a program" );
+					DAW_BASIC_NEXT( );
+				DAW_BASIC_HANDLER( STORE_IN_BOUNDS ) : {
+					auto const array = m_hoisted[pc - 1];
+					auto const &index = m_variables[static_cast<size_t>( instruction->b )].value;
+					if( nullptr == array || !array->store( static_cast<size_t>( index.integer_value( ) ), stack.back( ) ) ) {
+						set_array_element( m_compiled.names[static_cast<size_t>( instruction->a )],
+						                   static_cast<uint32_t>( instruction->b ), std::move( stack.back( ) ) );
+					}
+					stack.pop_back( );
 				}
-				{
-					auto value_type = get_value_type( parse_string );
-					if( ValueType::INTEGER != value_type ) {
-						throw create_basic_exception( ErrorTypes::SYNTAX, "Can only GOTO line numbers" );
+					DAW_BASIC_NEXT( );
+				DAW_BASIC_HANDLER( PRINT_NEWLINE ) :
+					std::cout << std::endl;
+					DAW_BASIC_NEXT( );
+				DAW_BASIC_HANDLER( JUMP ) :
+					loop_back( static_cast<size_t>( instruction->a ) );
+					DAW_BASIC_NEXT( );
+				DAW_BASIC_HANDLER( JUMP_IF_FALSE ) :
+					if( !to_boolean( stack.back( ) ) ) {
+						pc = static_cast<size_t>( instruction->a );
+					}
+					stack.pop_back( );
+					DAW_BASIC_NEXT( );
+				DAW_BASIC_HANDLER( SHORT_CIRCUIT ) :
+					if( short_circuits( static_cast<Operator>( instruction->b ), stack ) ) {
+						pc = static_cast<size_t>( instruction->a );
+					}
+					DAW_BASIC_NEXT( );
+				DAW_BASIC_HANDLER( COMPARE_AND_JUMP ) : {
+					auto const holds = comparison_holds( static_cast<Operator>( instruction->b ), stack[stack.size( ) - 2],
+					                                     stack.back( ) );
+					stack.resize( stack.size( ) - 2 );
+					if( holds ) {
+						loop_back( static_cast<size_t>( instruction->a ) );
 					}
 				}
-				set_program_it( to_integer( parse_string ), -1 );
-				return true;
-			};
-
-			m_keywords["GOSUB"] = [&]( boost::string_ref parse_string ) {
-				// Store program line on stack and then call goto
-				if( RunMode::IMMEDIATE == m_run_mode ) {
-					throw create_basic_exception( ErrorTypes::SYNTAX, "Attempt to GOSUB from outside a program" );
+					DAW_BASIC_NEXT( );
+				DAW_BASIC_HANDLER( GOSUB ) :
+					return_stack.push_back( pc );
+					pc = static_cast<size_t>( instruction->a );
+					DAW_BASIC_NEXT( );
+				DAW_BASIC_HANDLER( GOTO ) :
+					throw create_basic_exception( ErrorTypes::FATAL, "Attempt to run a program that was not linked" );
+				DAW_BASIC_HANDLER( RETURN ) :
+					if( return_stack.empty( ) ) {
+						throw create_basic_exception( ErrorTypes::SYNTAX, "Attempt to RETURN without a preceding GOSUB" );
+					}
+					pc = pop( return_stack );
+					DAW_BASIC_NEXT( );
+				DAW_BASIC_HANDLER( FOR_LOOP ) : {
+					LoopStackType::ForLoop loop{};
+					loop.variable = static_cast<uint32_t>( instruction->a );
+					loop.body_pc = pc;
+					loop.body_line = std::end( m_program ); // Only continued by compiled code
+					check_hoisted_bounds( pc - 1, stack );
+					auto const step = pop( stack );
+					auto const limit = pop( stack );
+					auto const start = pop( stack );
+					if( !enter_loop( loop, start, limit, step ) ) {
+						pc = static_cast<size_t>( instruction->b );
+					}
 				}
-				m_program_stack.push_back( m_program_it );
-				return m_keywords["GOTO"]( parse_string );
-			};
-
-			m_keywords["RETURN"] = [&]( boost::string_ref parse_string ) {
-				// Pop program line from stack and then run GOTO
-				if( RunMode::IMMEDIATE == m_run_mode ) {
-					throw create_basic_exception( ErrorTypes::SYNTAX, "Attempt to RETURN from outside a program" );
-				} else if( m_program_stack.empty( ) ) {
-					throw create_basic_exception( ErrorTypes::SYNTAX, "Attempt to RETURN without a preceding GOSUB" );
+					DAW_BASIC_NEXT( );
+				DAW_BASIC_HANDLER( NEXT_LOOP ) : {
+					auto loop = m_loop_stack.find( static_cast<uint32_t>( instruction->a ) );
+					if( nullptr == loop ) {
+						throw create_basic_exception( ErrorTypes::SYNTAX, "NEXT without FOR" );
+					}
+					if( !next_iteration( *loop ) ) {
+						m_loop_stack.pop( );
+					} else if( 0 != loop->body_pc ) {
+						loop_back( loop->body_pc );
+					} else {
+						// Started by the interpreter before the loop was compiled in TIERED mode
+						auto const body = compiled_pc( loop->body_line, loop->body_token );
+						if( npos == body ) {
+							leave( loop->body_line, loop->body_token );
+							return true;
+						}
+						loop->body_pc = body;
+						loop_back( body );
+					}
+				}
+					DAW_BASIC_NEXT( );
+				DAW_BASIC_HANDLER( LOAD_INTEGER ) :
+				DAW_BASIC_HANDLER( LOAD_REAL ) : {
+					auto const &variable = m_variables[static_cast<size_t>( instruction->a )];
+					auto const type = OpCode::LOAD_INTEGER == instruction->op ? ValueType::INTEGER : ValueType::REAL;
+					if( !variable.is_set || type != variable.value.type( ) ) {
+						fall_back( instruction->b );
+						break;
+					}
+					UnboxedValue value;
+					if( ValueType::INTEGER == type ) {
+						value.i = variable.value.integer_value( );
+					} else {
+						value.r = variable.value.real_value( );
+					}
+					unboxed.push_back( value );
+				}
+					DAW_BASIC_NEXT( );
+				DAW_BASIC_HANDLER( PUSH_INTEGER ) : {
+					UnboxedValue value;
+					value.i = instruction->a;
+					unboxed.push_back( value );
+				}
+					DAW_BASIC_NEXT( );
+				DAW_BASIC_HANDLER( PUSH_REAL ) : {
+					UnboxedValue value;
+					value.r = m_compiled.constants[static_cast<size_t>( instruction->a )].real_value( );
+					unboxed.push_back( value );
+				}
+					DAW_BASIC_NEXT( );
+				DAW_BASIC_HANDLER( INTEGER_OPERATOR ) : {
+					auto const oper = static_cast<Operator>( instruction->a );
+					int64_t result = 0;
+					bool applied = false;
+					if( Operator::NEGATE == oper ) {
+						applied = apply_unboxed_operator( oper, unboxed.back( ).i, 0, result );
+					} else {
+						auto const rhs = pop( unboxed ).i;
+						applied = apply_unboxed_operator( oper, unboxed.back( ).i, rhs, result );
+					}
+					if( !applied ) {
+						fall_back( instruction->b );
+						break;
+					}
+					unboxed.back( ).i = result;
+				}
+					DAW_BASIC_NEXT( );
+				DAW_BASIC_HANDLER( DUPLICATE_UNBOXED ) :
+					unboxed.push_back( unboxed.back( ) );
+					DAW_BASIC_NEXT( );
+				DAW_BASIC_HANDLER( REAL_OPERATOR ) : {
+					auto const oper = static_cast<Operator>( instruction->a );
+					if( Operator::NEGATE == oper ) {
+						unboxed.back( ) = apply_unboxed_operator( oper, unboxed.back( ).r, 0.0 );
+					} else {
+						auto const rhs = pop( unboxed ).r;
+						unboxed.back( ) = apply_unboxed_operator( oper, unboxed.back( ).r, rhs );
+					}
+				}
+					DAW_BASIC_NEXT( );
+				DAW_BASIC_HANDLER( STORE_INTEGER ) :
+				DAW_BASIC_HANDLER( STORE_REAL ) : {
+					auto &variable = m_variables[static_cast<size_t>( instruction->a )];
+					auto const value = pop( unboxed );
+					if( OpCode::STORE_INTEGER == instruction->op ) {
+						variable.value = basic_value_integer( static_cast<integer>( value.i ) );
+					} else {
+						variable.value = basic_value_real( value.r );
+					}
+					variable.is_set = true;
+					pc = static_cast<size_t>( instruction->b );
+				}
+					DAW_BASIC_NEXT( );
+				DAW_BASIC_HANDLER( BRANCH_UNBOXED ) :
+					pc = static_cast<size_t>( 0 != pop( unboxed ).i ? instruction->b : instruction->a );
+					DAW_BASIC_NEXT( );
+				DAW_BASIC_HANDLER( TIERED_GOSUB ) : {
+					// Like the interpreter, return to the token after the GOSUB
+					auto const &params = m_compiled.parameters[static_cast<size_t>( instruction->b )];
+					m_program_stack.emplace_back( std::begin( m_program ) + ( params.line - m_program.data( ) ),
+					                              params.last + 1 );
+					pc = static_cast<size_t>( instruction->a );
+				}
+					DAW_BASIC_NEXT( );
+				DAW_BASIC_HANDLER( TIERED_RETURN ) : {
+					if( m_program_stack.empty( ) ) {
+						throw create_basic_exception( ErrorTypes::SYNTAX, "Attempt to RETURN without a preceding GOSUB" );
+					}
+					auto const caller = pop( m_program_stack );
+					auto line = caller.first;
+					auto token = caller.second;
+					if( token >= line->tokens.size( ) ) {
+						++line;
+						token = 0;
+					}
+					auto const target = std::end( m_program ) == line ? npos : compiled_pc( line, token );
+					if( npos == target ) {
+						leave( line, token );
+						return true;
+					}
+					pc = target;
+				}
+					DAW_BASIC_NEXT( );
+				DAW_BASIC_HANDLER( EXIT_TO_LINE ) : {
+					auto const line = find_line( instruction->a );
+					if( std::end( m_program ) == line ) {
+						throw create_basic_exception( ErrorTypes::SYNTAX, "Attempt to jump to an invalid line" );
+					}
+					leave( line, 0 );
 				}
-
-				set_program_it( pop( m_program_stack )->first );
-				return true;
-
-			};
-
-			m_keywords["PRINT"] = [&]( boost::string_ref parse_string ) {
-				parse_string = trim( parse_string );
-				if( parse_string.empty( ) ) {
-					std::cout << std::endl;
 					return true;
+				DAW_BASIC_HANDLER( KEYWORD ) :
+				DAW_BASIC_HANDLER( USER_KEYWORD ) : {
+					auto const &params = m_compiled.parameters[static_cast<size_t>( instruction->b )];
+					auto const result =
+					  OpCode::KEYWORD == instruction->op
+					    ? execute_keyword( static_cast<Keyword>( instruction->a ), params )
+					    : ( *m_compiled.keywords[static_cast<size_t>( instruction->a )] )( params );
+					if( m_exiting ) {
+						m_exiting = false;
+						return true;
+					}
+					if( !result ) {
+						return false;
+					}
 				}
+					DAW_BASIC_NEXT( );
+				DAW_BASIC_HANDLER( STOP ) :
+					std::cout << "BREAK IN " << m_program_it->number << std::endl;
+					return true;
+				DAW_BASIC_HANDLER( END ) :
+					return true;
+				}
+			}
+			return true;
+		}
 
-				std::string evaluated_value = to_string( evaluate( std::move( parse_string ) ) );
-				std::cout << evaluated_value << "\n";
-				return true;
-			};
-
-			m_keywords["QUIT"] = [&]( boost::string_ref ) {
-				std::cout << "Good bye\n" << std::endl;
-				m_exiting = true;
-				return true;
-			};
-
-			m_keywords["EXIT"] = [&]( boost::string_ref ) {
-				m_exiting = true;
-				return true;
-			};
+#undef DAW_BASIC_HANDLER
+#undef DAW_BASIC_NEXT
 
-			m_keywords["END"] = [&]( boost::string_ref ) {
-				if( RunMode::IMMEDIATE == m_run_mode ) {
-					throw create_basic_exception( ErrorTypes::SYNTAX, "Attempt to END from outside a program" );
+		bool Basic::run_compiled( integer line_number ) {
+			try {
+				m_loop_stack.clear( );
+				compile( );
+				link( );
+				hoist_bounds_checks( );
+				size_t pc = 0;
+				if( 0 <= line_number ) {
+					auto line_start = m_compiled.line_starts.find( line_number );
+					if( std::end( m_compiled.line_starts ) == line_start ) {
+						throw create_basic_exception( ErrorTypes::SYNTAX, "Attempt to jump to an invalid line" );
+					}
+					pc = line_start->second;
 				}
-				m_exiting = true;
-				return true;
-			};
-
-			m_keywords["REM"] = []( boost::string_ref ) {
-				// truly do nothing
-				return true;
-			};
+				return execute( pc );
+			} catch( ... ) {
+				return report_run_error( );
+			}
+		}
 
-			m_keywords["LIST"] = [&]( boost::string_ref ) {
-				sort_program_code( );
-				for( auto const &current_line : m_program ) {
-					if( 0 <= current_line.first ) {
-						std::cout << current_line.first << "	" << current_line.second << "\n";
+		//////////////////////////////////////////////////////////////////////////
+		/// summary: Report the exception being handled while running compiled
+		/// code.  Returns false when the error is fatal
+		bool Basic::report_run_error( ) {
+			try {
+				throw;
+			} catch( BasicException const &se ) {
+				std::cerr << std::endl << se.what( ) << std::endl;
+				switch( se.error_type ) {
+				case ErrorTypes::SYNTAX:
+					if( std::end( m_program ) != m_program_it ) {
+						std::cerr << "Error was on line " << m_program_it->number << std::endl;
 					}
+					return true;
+				case ErrorTypes::FATAL:
+					return false;
 				}
-				std::cout << std::endl;
-				return true;
-			};
+			} catch( std::exception const &ex ) {
+				std::cerr << std::endl << "UNKNOWN ERROR: while running: " << ex.what( ) << std::endl;
+				if( std::end( m_program ) != m_program_it ) {
+					std::cerr << "ERROR on line " << m_program_it->number << std::endl;
+				}
+				return false;
+			}
+			return true;
+		}
 
-			m_keywords["RUN"] = [&]( boost::string_ref parse_line ) {
-				sort_program_code( );
-				integer line_number = -1;
-				if( !parse_line.empty( ) && ValueType::INTEGER == get_value_type( parse_line ) ) {
-					line_number = to_integer( parse_line );
+		//////////////////////////////////////////////////////////////////////////
+		/// summary: Load the numbered lines of program_text and compile them
+		/// like RUN does.  Lines without a number are an error, they would run
+		/// as soon as they are read
+		aot::Runtime::Runtime( std::string const &program_text, bool optimize, bool short_circuit ) {
+			m_basic.m_optimize = optimize;
+			m_basic.m_short_circuit = short_circuit;
+			std::istringstream lines( program_text );
+			for( std::string text; std::getline( lines, text ); ) {
+				auto const line = trim( text );
+				if( line.empty( ) ) {
+					continue;
 				}
-				if( !m_basic || 0 <= line_number ) {
-					m_basic.reset( new Basic( ) );
+				auto const number_end = static_cast<size_t>(
+				  std::distance( line.begin( ), std::find_if_not( line.begin( ), line.end( ), is_digit ) ) );
+				if( 0 == number_end ) {
+					throw m_basic.create_basic_exception( ErrorTypes::SYNTAX,
+					                                      "Only numbered lines can be translated: " + line.to_string( ) );
 				}
-				m_basic->m_run_mode = RunMode::DEFERRED;
-				m_basic->m_program = m_program;
-				return m_basic->run( line_number );
-			};
+				integer line_number = 0;
+				try {
+					line_number = to_integer( line.substr( 0, number_end ) );
+				} catch( boost::bad_lexical_cast const & ) {
+					throw m_basic.create_basic_exception( ErrorTypes::SYNTAX, "Line number is out of range" );
+				}
+				auto const line_text = trim( line.substr( number_end ) );
+				if( line_text.empty( ) ) {
+					m_basic.remove_line( line_number );
+				} else {
+					m_basic.add_line( line_number, line_text );
+				}
+			}
+			m_basic.m_run_mode = Basic::RunMode::DEFERRED;
+			m_basic.m_variables.resize( m_basic.m_symbols.size( ) );
+			m_basic.m_loop_stack.clear( );
+			m_basic.compile( );
+			m_basic.link( );
+			m_arrays.assign( m_basic.m_compiled.names.size( ), nullptr );
+			stack.reserve( 64 );
+		}
 
-			m_keywords["VARS"] = [&]( boost::string_ref ) {
-				std::cout << "Constants:\n" << list_constants( ) << "\n";
-				std::cout << "\nVariables:\n" << list_variables( ) << "\n";
-				return true;
+		//////////////////////////////////////////////////////////////////////////
+		/// summary: FNV-1a of the compiled program.  A translation only runs on
+		/// a library that compiles its program to the same code
+		uint64_t aot::Runtime::code_hash( ) const {
+			uint64_t hash = 14695981039346656037ull;
+			auto const add = [&hash]( uint64_t value ) {
+				for( size_t n = 0; n < sizeof( value ); ++n ) {
+					hash = ( hash ^ ( ( value >> ( 8 * n ) ) & 0xFFu ) ) * 1099511628211ull;
+				}
 			};
+			add( m_basic.m_symbols.size( ) );
+			for( auto const &current : m_basic.m_compiled.code ) {
+				add( static_cast<uint64_t>( current.op ) );
+				add( static_cast<uint32_t>( current.a ) );
+				add( static_cast<uint32_t>( current.b ) );
+			}
+			return hash;
+		}
 
-			m_keywords["FUNCTIONS"] = [&]( boost::string_ref ) {
-				std::cout << list_functions( ) << std::endl;
-				return true;
-			};
+		//////////////////////////////////////////////////////////////////////////
+		/// summary: Run a translated program and report its errors like RUN
+		/// does.  Returns the exit status of the process
+		int aot::Runtime::run( bool ( *program )( Runtime & ), uint64_t code_hash ) {
+			if( this->code_hash( ) != code_hash ) {
+				std::cerr << "The program was translated with another version of the library.  Translate it again"
+				          << std::endl;
+				return EXIT_FAILURE;
+			}
+			try {
+				program( *this );
+			} catch( ... ) {
+				m_basic.report_run_error( );
+				return EXIT_FAILURE;
+			}
+			return EXIT_SUCCESS;
+		}
 
-			m_keywords["KEYWORDS"] = [&]( boost::string_ref ) {
-				std::cout << list_keywords( ) << std::endl;
-				return true;
-			};
+		Basic::BasicArray *aot::Runtime::array( int32_t name ) {
+			// Arrays are never removed and DIM replaces them in place, so what was
+			// found stays valid
+			auto &array = m_arrays[static_cast<size_t>( name )];
+			if( nullptr == array ) {
+				auto const found = m_basic.m_arrays.find( m_basic.m_compiled.names[static_cast<size_t>( name )] );
+				if( std::end( m_basic.m_arrays ) == found ) {
+					return nullptr;
+				}
+				array = &found->second;
+			}
+			return array;
+		}
 
-			m_keywords["THEN"] = [&]( boost::string_ref ) -> bool {
-				throw create_basic_exception( ErrorTypes::SYNTAX, "THEN is invalid without a preceeding IF and condition" );
-			};
+		bool aot::Runtime::enter_loop( int32_t pc ) {
+			auto const &current = instruction( pc );
+			Basic::LoopStackType::ForLoop loop{};
+			loop.variable = static_cast<uint32_t>( current.a );
+			loop.body_pc = static_cast<size_t>( pc ) + 1;
+			loop.body_line = std::end( m_basic.m_program );
+			auto const step = pop( stack );
+			auto const limit = pop( stack );
+			auto const start = pop( stack );
+			return m_basic.enter_loop( loop, start, limit, step );
+		}
 
-			// 			m_keywords["IF"] = [&]( std::string parse_string ) -> bool {
-			// 				if( RunMode::IMMEDIATE == m_run_mode ) {
-			// 					throw CreateError( ErrorTypes::SYNTAX,  "Attempt to IF from outside a program" );
-			// 				}
-			// 				// IF <condition> <THEN [GOTO] <LINE NUMBER>>
-			//
-			// 				// Verify that last token is an integer
-			// 				auto then_pos = boost::algorithm::to_upper_copy( parse_string ).find( "THEN" );
-			// 				if( std::string::npos == then_pos ) {
-			// 					throw CreateError( ErrorTypes::SYNTAX,  "IF keyword must have a THEN clause" );
-			// 				}
-			// 				// Evaluate condition
-			// 				auto condition = evaluate( parse_string.substr( 0, then_pos ) );
-			// 				if( to_boolean( condition ) ) {
-			// 					std::string goto_clause = parse_string.substr( then_pos + 4 );
-			// 					auto goto_pos = boost::algorithm::to_upper_copy( goto_clause ).find( "GOTO" );
-			// 					if( std::string::npos != goto_pos ) {
-			// 						goto_clause = goto_clause.substr( goto_pos + 4 );
-			// 					}
-			// 					goto_clause = boost::algorithm::trim_copy( goto_clause );
-			// 					if( ValueType::INTEGER != get_value_type( goto_clause ) ) {
-			// 						throw CreateError( ErrorTypes::SYNTAX,  "Error parsing IF after the THEN" );
-			// 					}
-			// 					return m_keywords["GOTO"]( goto_clause );
-			// 				}
-			// 				return true;
-			// 			};
-
-			m_keywords["IF"] = [&]( boost::string_ref parse_string ) {
-				// IF <CONDITION> THEN <statement>
-				// IF <CONDITION> THEN <line_number>
-				// IF <CONDITION> GOTO <line_number>
+		bool aot::Runtime::next_loop( int32_t symbol, size_t &body ) {
+			auto loop = m_basic.m_loop_stack.find( static_cast<uint32_t>( symbol ) );
+			if( nullptr == loop ) {
+				throw m_basic.create_basic_exception( ErrorTypes::SYNTAX, "NEXT without FOR" );
+			}
+			if( !m_basic.next_iteration( *loop ) ) {
+				m_basic.m_loop_stack.pop( );
+				return false;
+			}
+			body = loop->body_pc;
+			return true;
+		}
 
-				// Find end of condition
-				size_t start_of_thengoto_clause = std::string::npos;
-				{
-					auto is_then_goto = [&]( size_t pos ) {
-						std::vector<std::string> const strings_to_find{"THEN", "GOTO"};
-						for( auto &string_to_find : strings_to_find ) {
-							if( pos + string_to_find.size( ) < static_cast<size_t>( parse_string[pos] ) ) {
-								return string_to_find == to_upper( parse_string.substr( pos, string_to_find.size( ) ) );
-							}
-						}
-						return false;
-					};
-
-					for( size_t pos = 0; pos < parse_string.size( ); ++pos ) {
-						const auto current_char = parse_string[pos];
-						if( '"' == current_char ) {
-							pos += find_end_of_string( parse_string.substr( pos ) );
-						} else if( '(' == current_char ) {
-							pos += find_end_of_bracket( parse_string.substr( pos ) );
-						} else if( is_then_goto( pos ) ) {
-							start_of_thengoto_clause = pos;
-							break;
-						}
-					}
-					if( std::string::npos == start_of_thengoto_clause ) {
-						throw create_basic_exception( ErrorTypes::SYNTAX, "Unable to find end of condition in IF keyword" );
-					}
-				}
-				auto condition = parse_string.substr( 0, start_of_thengoto_clause );
-				if( to_boolean( evaluate( condition ) ) ) {
-					auto str_action = parse_string.substr( start_of_thengoto_clause + 4 );
-					if( ValueType::INTEGER == get_value_type( str_action ) ) {
-						str_action = "GOTO " + str_action;
-					}
-					return parse_line( str_action );
-				}
-				// Do nothing
-				return true;
-			};
+		void aot::Runtime::print( ) {
+			print( stack.back( ) );
+			stack.pop_back( );
+		}
 
-			//////////////////////////////////////////////////////////////////////////
-			// Constants
-			//////////////////////////////////////////////////////////////////////////
+		void aot::Runtime::print( BasicValue const &value ) {
+			std::cout << to_string( value ) << "\n";
+		}
 
-			add_constant( "TRUE", "", basic_value_boolean( true ) );
-			add_constant( "FALSE", "", basic_value_boolean( false ) );
-			add_constant( "PI", "Trigometric Pi value", basic_value_real( boost::math::constants::pi<real>( ) ) );
+		void aot::Runtime::print_variable( int32_t pc ) {
+			auto const symbol = instruction( pc ).a;
+			auto const &current = variable( symbol );
+			if( !current.is_set ) {
+				throw m_basic.create_basic_exception( ErrorTypes::SYNTAX,
+				                                      "Unknown symbol '" + m_basic.m_symbols[static_cast<size_t>( symbol )] + "'" );
+			}
+			print( current.value );
+		}
 
-			clear_program( );
+		void aot::Runtime::print_newline( ) {
+			std::cout << std::endl;
 		}
 
-		void Basic::sort_program_code( ) {
-			std::sort( std::begin( m_program ), std::end( m_program ),
-			           []( ProgramLine a, ProgramLine b ) { return a.first < b.first; } );
+		//////////////////////////////////////////////////////////////////////////
+		/// summary: Pop the condition of JUMP_IF_FALSE
+		bool aot::Runtime::condition( ) {
+			return to_boolean( pop( stack ) );
 		}
 
-		void Basic::set_program_it( integer line_number, integer offset ) {
-			sort_program_code( );
-			auto line_it =
-			  std::begin( m_program ) + std::distance( std::begin( m_program ), find_line( line_number ) + offset );
-			if( std::end( m_program ) == line_it ) {
-				throw create_basic_exception( ErrorTypes::SYNTAX, "Attempt to jump to an invalid line" );
-			}
-			m_program_it = line_it;
+		//////////////////////////////////////////////////////////////////////////
+		/// summary: Pop the left operand of the SHORT_CIRCUIT at pc.  Returns
+		/// whether it jumps past the right operand, leaving the result
+		bool aot::Runtime::short_circuit( int32_t pc ) {
+			return short_circuits( static_cast<Operator>( instruction( pc ).b ), stack );
 		}
 
-		bool Basic::continue_run( ) {
-			auto next_line = m_program_it + 1;
-			if( std::end( m_program ) == next_line ) {
-				throw create_basic_exception( ErrorTypes::SYNTAX, "Cannot continue.  End of program reached" );
+		//////////////////////////////////////////////////////////////////////////
+		/// summary: Pop the operands of COMPARE_AND_JUMP at pc.  Returns whether
+		/// it jumps
+		bool aot::Runtime::compare( int32_t pc ) {
+			auto const holds = comparison_holds( static_cast<Operator>( instruction( pc ).b ), stack[stack.size( ) - 2],
+			                                     stack.back( ) );
+			stack.resize( stack.size( ) - 2 );
+			return holds;
+		}
+
+		//////////////////////////////////////////////////////////////////////////
+		/// summary: Run the KEYWORD or USER_KEYWORD at pc.  Returns false when
+		/// the program ends, result is then what it returns
+		bool aot::Runtime::keyword( int32_t pc, bool &result ) {
+			auto const &current = instruction( pc );
+			auto const &params = m_basic.m_compiled.parameters[static_cast<size_t>( current.b )];
+			result = bytecode::OpCode::KEYWORD == current.op
+			           ? m_basic.execute_keyword( static_cast<Keyword>( current.a ), params )
+			           : ( *m_basic.m_compiled.keywords[static_cast<size_t>( current.a )] )( params );
+			if( m_basic.m_exiting ) {
+				m_basic.m_exiting = false;
+				result = true;
+				return false;
 			}
-			return run( next_line->first );
+			return result;
 		}
 
-		ProgramType::iterator Basic::first_line( ) {
-			return std::begin( m_program ) + 1;
+		void aot::Runtime::stop( ) {
+			std::cout << "BREAK IN " << m_basic.m_program_it->number << std::endl;
 		}
 
-		bool Basic::run( integer line_number ) {
-			m_has_syntax_error = false;
-			if( 0 <= line_number ) {
-				set_program_it( line_number );
-			} else {
-				m_program_it = first_line( );
+		void aot::Runtime::fail( char const *message ) {
+			throw m_basic.create_basic_exception( ErrorTypes::SYNTAX, message );
+		}
+
+		bool aot::Runtime::equal( real lhs, real rhs ) {
+			return almost_equal( lhs, rhs );
+		}
+
+		//////////////////////////////////////////////////////////////////////////
+		/// summary: Count a start of the statement at token of m_program_it by
+		/// the interpreter and compile its line once the line is hot.  Returns
+		/// where the compiled statement starts, npos while it is interpreted
+		size_t Basic::tier_up( size_t token ) {
+			auto pc = compiled_pc( m_program_it, token );
+			if( npos != pc ) {
+				return pc;
 			}
-			while( m_program_it != std::end( m_program ) ) {
-				if( 0 <= m_program_it->first ) {
-					add_constant( "CURRENT_LINE", "Current Line of program execution",
-					              basic_value_integer( m_program_it->first ) );
-					if( !parse_line( m_program_it->second ) ) {
-						return false;
-					}
-					if( m_has_syntax_error ) {
-						std::cerr << "Error was on line " << m_program_it->first << std::endl;
-						m_has_syntax_error = false;
-						break;
-					}
-					if( m_exiting ) {
-						m_exiting = false;
-						break;
+			auto const line = static_cast<size_t>( std::distance( std::begin( m_program ), m_program_it ) );
+			if( ++m_tier.counts[line] < m_tier.threshold || m_tier.failed[line] || !compile_region( line ) ) {
+				return npos;
+			}
+			return compiled_pc( m_program_it, token );
+		}
+
+		//////////////////////////////////////////////////////////////////////////
+		/// summary: Compile the hot line with the innermost loop around it.  A
+		/// FOR and its NEXT are always compiled together, so loops sharing a
+		/// line with the region are added until none is left half in it.  The
+		/// types are specialized to what the variables hold now, guards catch
+		/// any that change.  Returns false, leaving the lines to the interpreter,
+		/// when one does not compile
+		bool Basic::compile_region( size_t hot ) {
+			auto first = hot;
+			auto last = hot;
+			for( auto const &loop : m_tier.loops ) {
+				if( loop.first <= hot && hot <= loop.second &&
+				    ( first == last || loop.second - loop.first < last - first ) ) {
+					first = loop.first;
+					last = loop.second;
+				}
+			}
+			for( bool grown = true; grown; ) {
+				grown = false;
+				for( auto const &loop : m_tier.loops ) {
+					auto const overlaps = loop.first <= last && first <= loop.second;
+					if( overlaps && ( loop.first < first || last < loop.second ) ) {
+						first = std::min( first, loop.first );
+						last = std::max( last, loop.second );
+						grown = true;
 					}
-					++m_program_it;
 				}
 			}
+			auto const current_it = m_program_it;
+			auto const region_first = std::begin( m_program ) + static_cast<std::ptrdiff_t>( first );
+			auto const region_last = std::begin( m_program ) + static_cast<std::ptrdiff_t>( last + 1 );
+
+			// Find the types from code without unboxing, then compile it for real
+			CompiledProgram untyped;
+			try {
+				compile_lines( untyped, region_first, region_last );
+			} catch( BasicException const & ) {
+				m_program_it = current_it;
+				std::fill( std::begin( m_tier.failed ) + static_cast<std::ptrdiff_t>( first ),
+				           std::begin( m_tier.failed ) + static_cast<std::ptrdiff_t>( last + 1 ), true );
+				return false;
+			}
+			untyped.variable_types.assign( m_symbols.size( ), 0 );
+			for( size_t symbol = 0; symbol != m_variables.size( ); ++symbol ) {
+				if( m_variables[symbol].is_set ) {
+					untyped.variable_types[symbol] = value_types( m_variables[symbol].value.type( ) );
+				}
+			}
+			infer_types( untyped );
+			m_compiled.variable_types = std::move( untyped.variable_types );
+			auto const start = m_compiled.code.size( );
+			compile_lines( m_compiled, region_first, region_last );
+			m_program_it = current_it;
+			link( start );
+
+			// Code compiled earlier jumps straight to the new lines from now on
+			for( auto stub = std::begin( m_compiled.exit_stubs ); stub != std::end( m_compiled.exit_stubs ); ) {
+				auto const line_start = m_compiled.line_starts.find( stub->first );
+				if( std::end( m_compiled.line_starts ) == line_start ) {
+					++stub;
+					continue;
+				}
+				m_compiled.code[stub->second] =
+				  bytecode::Instruction{bytecode::OpCode::JUMP, static_cast<int32_t>( line_start->second ), 0};
+				stub = m_compiled.exit_stubs.erase( stub );
+			}
+			m_tier.transitions.push_back(
+			  TierTransition{m_program[hot].number, m_tier.counts[hot], region_first->number, m_program[last].number} );
 			return true;
 		}
 
-		Basic::Basic( )
-		  : m_basic{nullptr}
-		  , m_program_it( std::end( m_program ) )
-		  , m_run_mode( RunMode::IMMEDIATE )
-		  , m_exiting( false )
-		  , m_has_syntax_error( false ) {
-			init( );
+		//////////////////////////////////////////////////////////////////////////
+		/// summary: Where the compiled code of the statement at token of line
+		/// starts, npos when it is not compiled
+		size_t Basic::compiled_pc( ProgramType::iterator line, size_t token ) {
+			auto const index = static_cast<size_t>( std::distance( std::begin( m_program ), line ) );
+			auto const start = m_compiled.statement_starts.find( LoopStackType::key( index, token ) );
+			if( std::end( m_compiled.statement_starts ) == start ) {
+				return npos;
+			}
+			return start->second;
 		}
 
-		std::vector<std::string> Basic::split( std::string text, char delimiter ) {
-			std::string str_delimeter( " " );
-			str_delimeter[0] = delimiter;
-			return split( text, str_delimeter );
+		ExecutionMode Basic::execution_mode( ) const {
+			return m_execution_mode;
 		}
 
-		std::vector<std::string> Basic::split( std::string text, std::string delimiter ) {
-			std::vector<std::string> tokens;
-			size_t pos = 0;
-			std::string token;
-
-			while( std::string::npos != ( pos = text.find( delimiter ) ) ) {
-				token = text.substr( 0, pos );
-				tokens.push_back( token );
-				text.erase( 0, pos + delimiter.length( ) );
-			}
-			tokens.push_back( text );
+		void Basic::set_execution_mode( ExecutionMode mode ) {
+			m_execution_mode = mode;
+		}
 
-			return tokens;
+		size_t Basic::tier_threshold( ) const {
+			return m_tier.threshold;
 		}
 
-		Basic::Basic( std::string program_code )
-		  : m_basic( nullptr )
-		  , m_program_it( std::end( m_program ) )
-		  , m_run_mode( RunMode::IMMEDIATE )
-		  , m_exiting( false )
-		  , m_has_syntax_error( false ) {
-			init( );
-			for( auto current_line : split( program_code, '\n' ) ) {
-				parse_line( current_line );
-			}
+		//////////////////////////////////////////////////////////////////////////
+		/// summary: Set how many times the interpreter starts a line before
+		/// TIERED mode compiles it.  0 and 1 compile a line the first time
+		void Basic::set_tier_threshold( size_t threshold ) {
+			m_tier.threshold = threshold;
 		}
 
-		BasicException Basic::create_basic_exception( ErrorTypes error_type, std::string msg ) {
-			switch( error_type ) {
-			case ErrorTypes::SYNTAX:
-				msg = "SYNTAX ERROR: " + msg;
-				if( RunMode::DEFERRED == m_run_mode && std::end( m_program ) != m_program_it ) {
-					msg += "\nError on line " + std::to_string( m_program_it->first );
-				}
-				return BasicException( std::move( msg ), std::move( error_type ) );
-			case ErrorTypes::FATAL:
-				msg = "FATAL ERROR: " + msg;
-				if( RunMode::DEFERRED == m_run_mode && std::end( m_program ) != m_program_it ) {
-					msg += "\nError on line " + std::to_string( m_program_it->first );
+		//////////////////////////////////////////////////////////////////////////
+		/// summary: The counters of the program last run in TIERED mode.  RUN
+		/// runs the program in another Basic, which is the one reported on
+		std::vector<LineProfile> Basic::line_profile( ) const {
+			auto const &basic = m_basic ? *m_basic : *this;
+			std::vector<LineProfile> result;
+			auto const lines = std::min( basic.m_tier.counts.size( ), basic.m_program.size( ) );
+			for( size_t line = 0; line != lines; ++line ) {
+				auto const number = basic.m_program[line].number;
+				if( 0 <= number ) {
+					result.push_back(
+					  LineProfile{number, basic.m_tier.counts[line], 0 != basic.m_compiled.line_starts.count( number )} );
 				}
-				return BasicException( std::move( msg ), std::move( error_type ) );
 			}
-			throw std::runtime_error( "Unknown error type tried to be thrown" );
+			return result;
 		}
 
-		bool Basic::parse_line( boost::string_ref parse_string, bool show_ready ) {
-			m_exiting = false;
-			auto parsed_string( split_in_two_on_char( parse_string, ' ' ) );
-			try {
-				const auto value_type = get_value_type( parsed_string[0] );
-				if( ValueType::INTEGER == value_type ) {
-					auto line_number = to_integer( parsed_string[0] );
-					if( 0 > line_number ) {
-						throw create_basic_exception( ErrorTypes::SYNTAX, "Line numbers cannot be negative" );
-					}
-					if( parsed_string.size( ) > 1 && !parsed_string[1].empty( ) ) {
-						add_line( line_number, parsed_string[1] );
-					} else {
-						remove_line( line_number );
-					}
-					return true;
-				} else if( ValueType::STRING == value_type ) {
-					if( trim( parse_string ).empty( ) ) {
-						return true;
-					}
+		//////////////////////////////////////////////////////////////////////////
+		/// summary: The lines compiled by the program last run in TIERED mode,
+		/// in the order they were compiled
+		std::vector<TierTransition> Basic::tier_transitions( ) const {
+			auto const &basic = m_basic ? *m_basic : *this;
+			return basic.m_tier.transitions;
+		}
 
-					// Except within quoted areas, split string on colon : boundaries
-
-					std::vector<boost::string_ref> statements;
-					{
-						size_t last_pos = 0;
-						size_t pos = 0;
-						for( ; pos < parse_string.size( ); ++pos ) {
-							const auto current_char = parse_string[pos];
-							switch( current_char ) {
-							case '"':
-								pos += find_end_of_string( parse_string.substr( pos ) );
-								break;
-							case ':':
-								statements.push_back( parse_string.substr( last_pos, pos - last_pos ) );
-								if( pos + 1 < parse_string.size( ) ) {
-									++pos;
-								}
-								last_pos = pos;
-								break;
-							}
-						}
-						statements.push_back( parse_string.substr( last_pos, pos - last_pos ) );
-					}
+		bool Basic::jit( ) const {
+			return m_jit.enabled;
+		}
 
-					for( auto current_statement : statements ) {
-						boost::string_ref params;
-						parsed_string = split_in_two_on_char( current_statement, ' ' );
-						if( 2 == parsed_string.size( ) ) {
-							params = parsed_string[1];
-						}
-						auto keyword = to_upper( parsed_string[0] );
-						bool result = false;
-						if( !is_keyword( keyword ) ) {
-							// Try assignment if the above fails
-							if( !( result = let_helper( current_statement, false ) ) ) {
-								throw create_basic_exception( ErrorTypes::SYNTAX, "Invalid keyword '" + keyword + "'" );
-							}
-						} else {
-							result = m_keywords[keyword]( params );
-						}
-						if( m_exiting ) {
-							return m_run_mode != RunMode::IMMEDIATE;
-						}
-						if( !result ) {
-							return result;
-						}
-					}
-					if( show_ready && RunMode::IMMEDIATE == m_run_mode ) {
-						std::cout << "\nREADY" << std::endl;
-					}
-				}
-			} catch( BasicException se ) {
-				std::cerr << std::endl << se.what( ) << std::endl;
-				switch( se.error_type ) {
-				case ErrorTypes::SYNTAX: {
-					if( show_ready ) {
-						std::cout << "\nREADY" << std::endl;
-					}
-					m_has_syntax_error = true;
-				}
-					return true;
-				case ErrorTypes::FATAL:
-					return false;
-				}
-			} catch( std::exception ex ) {
-				std::cerr << std::endl << "UNKNOWN ERROR: while parsing: " << ex.what( ) << std::endl;
-				if( RunMode::DEFERRED == m_run_mode ) {
-					std::cerr << "ERROR on line " << m_program_it->first << std::endl;
-				}
-				return false;
-			}
-			return true;
+		//////////////////////////////////////////////////////////////////////////
+		/// summary: Turn the JIT for hot loops of compiled programs on or off.
+		/// It stays off when the library was built without it or the machine is
+		/// not one it generates code for
+		void Basic::set_jit( bool enabled ) {
+			m_jit.enabled = enabled && jit::supported( );
 		}
 
-		// Basic::LoopStackType
-		Basic::LoopStackType::LoopStackValueType &Basic::LoopStackType::peek_full( ) {
-			return *( std::end( loop_stack ) );
+		size_t Basic::jit_threshold( ) const {
+			return m_jit.threshold;
 		}
 
-		ProgramType::iterator Basic::LoopStackType::peek( ) {
-			return peek_full( ).start_of_loop;
+		//////////////////////////////////////////////////////////////////////////
+		/// summary: Set how many times a loop jumps back to its start before the
+		/// JIT compiles it.  0 and 1 compile it the first time
+		void Basic::set_jit_threshold( size_t threshold ) {
+			m_jit.threshold = threshold;
 		}
 
-		ProgramType::iterator Basic::LoopStackType::pop( ) {
-			auto result = peek( );
-			loop_stack.pop_back( );
-			return result;
+		//////////////////////////////////////////////////////////////////////////
+		/// summary: What the JIT did in the program last run.  Like line_profile
+		/// this reports on the Basic that RUN ran the program in
+		JitStatistics Basic::jit_statistics( ) const {
+			auto const &basic = m_basic ? *m_basic : *this;
+			return basic.m_jit.statistics;
 		}
 
-		bool Basic::LoopStackType::empty( ) const {
-			return 0 == size( );
+		DispatchMode Basic::dispatch_mode( ) const {
+			return m_dispatch_mode;
+		}
+
+		//////////////////////////////////////////////////////////////////////////
+		/// summary: Choose how compiled programs are dispatched.  THREADED stays
+		/// SWITCH when the library was built without computed goto
+		void Basic::set_dispatch_mode( DispatchMode mode ) {
+#if defined( DAW_BASIC_THREADED_DISPATCH )
+			m_dispatch_mode = mode;
+#else
+			(void)mode;
+			m_dispatch_mode = DispatchMode::SWITCH;
+#endif
 		}
 
-		bool Basic::LoopStackType::LoopStackValueType::can_enter_loop_body( ) {
+		bool Basic::optimize( ) const {
+			return m_optimize;
+		}
 
-			return false;
+		//////////////////////////////////////////////////////////////////////////
+		/// summary: Turn constant folding and strength reduction on or off.  Off
+		/// runs every operator as written which helps when debugging them
+		void Basic::set_optimize( bool enabled ) {
+			m_optimize = enabled;
+			invalidate_expressions( );
 		}
 
-		size_t Basic::LoopStackType::size( ) const {
-			return loop_stack.size( );
+		bool Basic::short_circuit( ) const {
+			return m_short_circuit;
 		}
 
-		namespace {
-			struct for_loop_parts_string {
-				boost::string_ref counter_variable;
-				boost::string_ref start_value;
-				boost::string_ref end_value;
-				boost::string_ref step_value;
-			};
+		//////////////////////////////////////////////////////////////////////////
+		/// summary: Turn short circuit evaluation of AND and OR on or off.  On, the
+		/// right operand is only evaluated when the left one does not decide the
+		/// result so errors in it are not raised then.  Off, both always are
+		void Basic::set_short_circuit( bool enabled ) {
+			m_short_circuit = enabled;
+			invalidate_expressions( );
+		}
 
-			struct for_loop_parts {
-				boost::string_ref counter_variable;
-				BasicValue start_value;
-				BasicValue end_value;
-				BasicValue step_value;
-				for_loop_parts( ) = delete;
-				for_loop_parts( for_loop_parts_string &&value )
-				  : counter_variable( value.counter_variable )
-				  , start_value( basic::basic_value_numeric( std::move( value.start_value ) ) )
-				  , end_value( basic::basic_value_numeric( std::move( value.end_value ) ) )
-				  , step_value( basic::basic_value_numeric( std::move( value.step_value ) ) ) {}
-			};
+		// Basic::LoopStackType
+		uint64_t Basic::LoopStackType::key( size_t line, size_t token ) {
+			return ( static_cast<uint64_t>( line ) << 32u ) | static_cast<uint64_t>( token );
+		}
 
-			for_loop_parts_string parse_for_loop( boost::string_ref for_loop ) {
-				// {FOR<WS>}Variable[WS]=<evaluate start><WS>TO<WS><evaluate end>[<WS>STEP<evaluate step>]
-				// { } - denotes already parsed away
-				auto statement_parts = split_in_two_on_char( for_loop, '=' );
-				// if(  )
-				for_loop_parts_string result;
-				return result;
+		//////////////////////////////////////////////////////////////////////////
+		/// summary: Entering a loop again drops it and the loops inside it, as
+		/// happens when GOTO leaves a loop before its NEXT
+		void Basic::LoopStackType::push( ForLoop loop ) {
+			if( auto existing = find( loop.variable ) ) {
+				*existing = loop;
+				return;
 			}
-		} // namespace
+			loop_stack.push_back( loop );
+		}
+
+		//////////////////////////////////////////////////////////////////////////
+		/// summary: The innermost loop of variable.  Loops inside it are dropped
+		/// like they are when NEXT names an outer loop
+		Basic::LoopStackType::ForLoop *Basic::LoopStackType::find( uint32_t variable ) {
+			auto pos = std::find_if( loop_stack.rbegin( ), loop_stack.rend( ),
+			                         [variable]( ForLoop const &loop ) { return variable == loop.variable; } );
+			if( loop_stack.rend( ) == pos ) {
+				return nullptr;
+			}
+			loop_stack.erase( pos.base( ), std::end( loop_stack ) );
+			return &loop_stack.back( );
+		}
+
+		Basic::LoopStackType::ForLoop *Basic::LoopStackType::peek( ) {
+			return loop_stack.empty( ) ? nullptr : &loop_stack.back( );
+		}
 
-		Basic::LoopStackType::LoopStackValueType::LoopStackValueType( std::shared_ptr<LoopType> loopControl,
-		                                                              ProgramType::iterator program_line )
-		  : loop_control( loopControl ), start_of_loop( program_line ) {}
+		void Basic::LoopStackType::pop( ) {
+			loop_stack.pop_back( );
+		}
 
-		void Basic::LoopStackType::push( std::shared_ptr<LoopType> type_of_loop, ProgramType::iterator start_of_loop ) {
-			loop_stack.emplace_back( type_of_loop, start_of_loop );
+		bool Basic::LoopStackType::empty( ) const {
+			return 0 == size( );
 		}
 
-		Basic::LoopStackType::LoopType::~LoopType( ){};
+		size_t Basic::LoopStackType::size( ) const {
+			return loop_stack.size( );
+		}
 
-		Basic::LoopStackType::ForLoop::ForLoop( boost::string_ref variable_name, BasicValue start_value,
-		                                        BasicValue end_value, BasicValue step_value )
-		  : Basic::LoopStackType::LoopType( )
-		  , m_variable_name( variable_name.to_string( ) )
-		  , m_start_value( start_value )
-		  , m_end_value( end_value )
-		  , m_step_value( step_value ) {
-			daw::exception::syntax_errror_on_false( is_numeric( start_value ), "Start Value must be numeric" );
-			daw::exception::syntax_errror_on_false( is_numeric( end_value ), "End Value must be numeric" );
-			daw::exception::syntax_errror_on_false( is_numeric( step_value ), "Step Value must be numeric" );
+		void Basic::LoopStackType::clear( ) {
+			loop_stack.clear( );
+			loop_exits.clear( );
 		}
 
-		std::shared_ptr<Basic::LoopStackType::LoopType>
-		Basic::LoopStackType::ForLoop::create_for_loop( ProgramType::iterator program_line ) {
-			auto parts_of_for_loop = for_loop_parts( parse_for_loop( program_line->second ) );
-			return std::shared_ptr<LoopType>( new ForLoop( parts_of_for_loop.counter_variable, parts_of_for_loop.start_value,
-			                                               parts_of_for_loop.end_value, parts_of_for_loop.step_value ) );
+		void Basic::LoopStackType::add_exit( uint64_t for_key, Position exit ) {
+			loop_exits[for_key] = exit;
 		}
 
-		bool Basic::LoopStackType::ForLoop::can_enter_loop_body( ) {
-			return false;
+		Basic::LoopStackType::Position const &Basic::LoopStackType::exit( uint64_t for_key ) const {
+			return loop_exits.at( for_key );
 		}
 
 	} // namespace basic
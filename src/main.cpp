@@ -25,10 +25,37 @@
 
 #include "dawbasic.h"
 
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 
 int main( int argc, char *argv[] ) {
 	daw::basic::Basic b;
+	for( int n = 1; n < argc; ++n ) {
+		if( 0 == std::strcmp( argv[n], "--interpreted" ) ) {
+			// Run programs from their text instead of compiling them
+			b.set_execution_mode( daw::basic::ExecutionMode::INTERPRETED );
+		} else if( 0 == std::strcmp( argv[n], "--tiered" ) ) {
+			// Interpret lines until they are hot, then compile them
+			b.set_execution_mode( daw::basic::ExecutionMode::TIERED );
+		} else if( 0 == std::strcmp( argv[n], "--tier-threshold" ) && n + 1 < argc ) {
+			b.set_tier_threshold( std::strtoul( argv[++n], nullptr, 10 ) );
+		} else if( 0 == std::strcmp( argv[n], "--jit" ) ) {
+			// Translate hot loops of compiled programs into machine code
+			b.set_jit( true );
+			if( !b.jit( ) ) {
+				std::cerr << "The JIT is not available on this machine" << std::endl;
+			}
+		} else if( 0 == std::strcmp( argv[n], "--jit-threshold" ) && n + 1 < argc ) {
+			b.set_jit_threshold( std::strtoul( argv[++n], nullptr, 10 ) );
+		} else if( 0 == std::strcmp( argv[n], "--no-optimize" ) ) {
+			// Run every operator as written, without folding or reducing them
+			b.set_optimize( false );
+		} else if( 0 == std::strcmp( argv[n], "--short-circuit" ) ) {
+			// Only evaluate the right operand of AND and OR when it is needed
+			b.set_short_circuit( true );
+		}
+	}
 	std::string current_line;
 	std::cout << "DAW BASIC v0.1\nREADY" << std::endl;
 	while( std::getline( std::cin, current_line ).good( ) ) {
@@ -0,0 +1,10 @@
+10 DIM A(1000) : S = 0 : J = 0
+20 FOR K = 1 TO 3
+30 FOR J = 0 TO 999
+40 A(J) = J * K
+50 NEXT J
+60 FOR J = 0 TO 999
+70 S = ( S + A(J) ) % 1000003
+80 NEXT J
+90 NEXT K
+100 PRINT S
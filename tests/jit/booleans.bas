@@ -0,0 +1,8 @@
+10 N = 0 : B = FALSE
+20 FOR I = 1 TO 500
+30 B = I > 100 AND I < 200
+40 IF B THEN N = N + 1
+50 IF -I < -450 THEN N = N + 2
+60 NEXT I
+70 PRINT N
+80 PRINT B
@@ -0,0 +1,5 @@
+10 DIM A(50) : J = 0
+20 FOR J = 0 TO 60
+30 A(J) = J
+40 NEXT J
+50 PRINT A(50)
@@ -0,0 +1,5 @@
+10 X = 0
+20 FOR I = 1 TO 100
+30 X = X + 1000 / ( 60 - I )
+40 NEXT I
+50 PRINT X
@@ -0,0 +1,8 @@
+10 S = 0 : T = 0
+20 FOR I = 1 TO 20000
+30 S = ( S + I * 7 - I / 3 ) % 100000
+40 T = T - I % 13 + 2
+50 NEXT I
+60 PRINT S
+70 PRINT T
+80 PRINT I
@@ -0,0 +1,4 @@
+10 DIM A%(3) : DIM B%(3)
+20 MAT B% = CON
+30 MAT A% = (0.5) * B%
+40 PRINT A%(0)
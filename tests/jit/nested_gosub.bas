@@ -0,0 +1,11 @@
+10 T = 0 : I = 0 : J = 0
+20 FOR I = 1 TO 200
+30 FOR J = 1 TO 50
+40 GOSUB 100
+50 NEXT J
+60 NEXT I
+70 PRINT T
+80 END
+100 T = T + I - J
+110 IF T > 5000 THEN T = T - 5000
+120 RETURN
@@ -0,0 +1,7 @@
+10 X = 1 : N = 0
+20 FOR I = 1 TO 100
+30 X = X * 3
+40 N = N + 1
+50 NEXT I
+60 PRINT X
+70 PRINT N
@@ -0,0 +1,7 @@
+10 I = 0 : R = 0.5 : X = 0.0
+20 I = I + 1
+30 R = ( R * 1.5 + 1.0 ) / 1.25 - R / 2.0 + -R ^ 2 / 8.0
+40 X = X + R * 0.25
+50 IF I < 10000 THEN 20
+60 PRINT R
+70 PRINT X
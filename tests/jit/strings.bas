@@ -0,0 +1,7 @@
+10 S$ = "" : N = 0
+20 FOR I = 1 TO 300
+30 N = N + I
+40 S$ = S$ + "AB"
+50 NEXT I
+60 PRINT LEN( S$ )
+70 PRINT N
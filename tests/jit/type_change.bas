@@ -0,0 +1,7 @@
+10 X = 1 : Y = 0
+20 FOR I = 1 TO 2000
+30 Y = Y + X
+40 IF I = 1000 THEN X = 0.5
+50 NEXT I
+60 PRINT Y
+70 PRINT X
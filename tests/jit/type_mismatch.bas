@@ -0,0 +1,7 @@
+10 DIM A%(10) : DIM R#(10) : X = 1
+20 FOR I = 0 TO 9
+30 IF I = 8 THEN X = 1.5
+40 R#(I) = X
+50 A%(I) = X
+60 NEXT I
+70 PRINT A%(7)
@@ -0,0 +1,108 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Runs each program named on the command line with the JIT, compiled up front
+// and tiered, at several thresholds, and compares what it prints with the
+// interpreter.  The programs in tests/jit change types, overflow, divide by
+// zero and use strings inside hot loops so that the machine code has to hand
+// back to the VM.  Fails when any output differs or a program ends the session
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "bench_run.h"
+#include "dawbasic.h"
+
+namespace {
+	using daw::basic::Basic;
+	using daw::basic::ExecutionMode;
+	using daw::basic::bench::capture;
+	using daw::basic::bench::load;
+
+	// Prints and errors of RUN, without the READY lines of interactive use
+	std::string run( std::vector<std::string> const &program, ExecutionMode mode, bool jit, size_t threshold ) {
+		Basic basic;
+		basic.set_execution_mode( mode );
+		basic.set_jit( jit );
+		basic.set_jit_threshold( threshold );
+		auto running = false;
+		auto result = capture( [&]( ) {
+			load( basic, program );
+			running = basic.parse_line( "RUN", false );
+		} );
+		if( !running ) {
+			// Errors in a program must leave the session running
+			result.printed += "The session ended\n";
+		}
+		return result.printed;
+	}
+
+	bool same_with_jit( std::string const &file_name ) {
+		std::ifstream file( file_name );
+		if( !file ) {
+			std::cout << "Cannot open " << file_name << '\n';
+			return false;
+		}
+		std::vector<std::string> program;
+		for( std::string line; std::getline( file, line ); ) {
+			program.push_back( line );
+		}
+
+		auto const expected = run( program, ExecutionMode::INTERPRETED, false, 0 );
+		bool same = std::string::npos == expected.find( "The session ended" );
+		if( !same ) {
+			std::cout << file_name << " ends the session\n" << expected;
+		}
+		// Threshold 0 compiles every loop at once, the others let types settle
+		for( size_t threshold : {0, 1, 16} ) {
+			for( auto mode : {ExecutionMode::COMPILED, ExecutionMode::TIERED} ) {
+				auto const actual = run( program, mode, true, threshold );
+				if( actual != expected ) {
+					same = false;
+					std::cout << file_name << " differs with threshold " << threshold
+					          << ( ExecutionMode::TIERED == mode ? " when tiered" : "" ) << "\nexpected:\n"
+					          << expected << "actual:\n"
+					          << actual;
+				}
+			}
+		}
+		return same;
+	}
+} // namespace
+
+int main( int argc, char **argv ) {
+	Basic probe;
+	probe.set_jit( true );
+	if( !probe.jit( ) ) {
+		std::cout << "The JIT is not available on this machine\n";
+		return EXIT_SUCCESS;
+	}
+
+	bool failed = false;
+	for( int arg = 1; arg < argc; ++arg ) {
+		failed |= !same_with_jit( argv[arg] );
+	}
+	return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}